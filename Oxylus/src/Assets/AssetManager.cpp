@@ -1,66 +1,127 @@
 #include "AssetManager.h"
 
 #include "MaterialSerializer.h"
+#include "TextureCompressor.h"
 #include "Core/Project.h"
 #include "Render/Mesh.h"
 #include "Render/ShaderLibrary.h"
+#include "Render/Vulkan/VulkanRenderer.h"
+#include "Thread/JobSystem.h"
 
 #include "Utils/FileUtils.h"
 #include "Utils/Profiler.h"
 
 namespace Oxylus {
   AssetManager::AssetsLibrary AssetManager::s_AssetsLibrary;
+  AssetManager::AssetCache AssetManager::s_ImageCache{.MemoryBudget = 1024ull * 1024 * 1024};
+  AssetManager::AssetCache AssetManager::s_MeshCache{.MemoryBudget = 256ull * 1024 * 1024};
+  AssetManager::AssetCache AssetManager::s_MaterialCache;
+  std::vector<AssetManager::RetiredAsset<VulkanImage>> AssetManager::s_RetiredImages;
+  std::vector<AssetManager::RetiredAsset<Mesh>> AssetManager::s_RetiredMeshes;
+  std::vector<AssetManager::RetiredAsset<Material>> AssetManager::s_RetiredMaterials;
+  uint64_t AssetManager::s_Frame = 0;
   std::mutex AssetManager::s_AssetMutex;
+  std::condition_variable AssetManager::s_AssetLoaded;
+
+  template <typename T>
+  static Asset<T> FindByHandle(const std::unordered_map<AssetHandle, Asset<T>>& assets, const AssetHandle handle) {
+    const auto it = assets.find(handle);
+    return it != assets.end() ? it->second : Asset<T>{};
+  }
 
   std::filesystem::path AssetManager::GetAssetFileSystemPath(const std::filesystem::path& path) {
     return Project::GetAssetDirectory() / path;
   }
 
   Asset<VulkanImage> AssetManager::GetImageAsset(const std::string& path) {
-    OX_SCOPED_ZONE;
-    for (auto& [handle, asset] : s_AssetsLibrary.ImageAssets) {
-      if (asset.Path == path) {
-        return asset;
-      }
-    }
-
     VulkanImageDescription desc;
     desc.Path = path;
     desc.CreateDescriptorSet = true;
-    return LoadImageAsset(desc);
+    return GetImageAsset(desc);
   }
 
   Asset<VulkanImage> AssetManager::GetImageAsset(const VulkanImageDescription& description) {
     OX_SCOPED_ZONE;
-    for (auto& [handle, asset] : s_AssetsLibrary.ImageAssets) {
-      if (asset.Path == description.Path) {
-        return asset;
-      }
-    }
+    return GetOrLoad(s_AssetsLibrary.ImageAssets, s_ImageCache, description.Path, [&description] { return LoadImageAsset(description); });
+  }
+
+  Asset<VulkanImage> AssetManager::GetImageAsset(const AssetHandle handle) {
+    std::lock_guard lock(s_AssetMutex);
+    return FindByHandle(s_AssetsLibrary.ImageAssets, handle);
+  }
 
-    return LoadImageAsset(description);
+  Asset<VulkanImage> AssetManager::FindImageAsset(const std::string& path) {
+    OX_SCOPED_ZONE;
+    std::unique_lock lock(s_AssetMutex);
+    return Find(lock, s_AssetsLibrary.ImageAssets, s_ImageCache, path);
+  }
+
+  Asset<VulkanImage> AssetManager::AddImageAsset(const Ref<VulkanImage>& image, const std::string& path) {
+    OX_SCOPED_ZONE;
+    Asset<VulkanImage> asset;
+    asset.Data = image;
+    asset.Path = path;
+    asset.Type = AssetType::Image;
+    std::lock_guard lock(s_AssetMutex);
+    return Add(s_AssetsLibrary.ImageAssets, s_ImageCache, asset);
   }
 
   Asset<Mesh> AssetManager::GetMeshAsset(const std::string& path, const int32_t loadingFlags) {
     OX_SCOPED_ZONE;
-    for (auto& [handle, asset] : s_AssetsLibrary.MeshAssets) {
-      if (asset.Path == path) {
-        return asset;
-      }
-    }
+    return GetOrLoad(s_AssetsLibrary.MeshAssets, s_MeshCache, path, [&path, loadingFlags] { return LoadMeshAsset(path, loadingFlags); });
+  }
 
-    return LoadMeshAsset(path, loadingFlags);
+  Asset<Mesh> AssetManager::GetMeshAsset(const AssetHandle handle) {
+    std::lock_guard lock(s_AssetMutex);
+    return FindByHandle(s_AssetsLibrary.MeshAssets, handle);
   }
 
   Asset<Material> AssetManager::GetMaterialAsset(const std::string& path) {
     OX_SCOPED_ZONE;
-    for (auto& [handle, asset] : s_AssetsLibrary.MaterialAssets) {
-      if (asset.Path == path) {
-        return asset;
-      }
-    }
+    return GetOrLoad(s_AssetsLibrary.MaterialAssets, s_MaterialCache, path, [&path] { return LoadMaterialAsset(path); });
+  }
 
-    return LoadMaterialAsset(path);
+  Asset<Material> AssetManager::GetMaterialAsset(const AssetHandle handle) {
+    std::lock_guard lock(s_AssetMutex);
+    return FindByHandle(s_AssetsLibrary.MaterialAssets, handle);
+  }
+
+  void AssetManager::SetMemoryBudget(const AssetType type, const size_t bytes) {
+    std::lock_guard lock(s_AssetMutex);
+    GetCache(type).MemoryBudget = bytes;
+  }
+
+  size_t AssetManager::GetMemoryBudget(const AssetType type) {
+    std::lock_guard lock(s_AssetMutex);
+    return GetCache(type).MemoryBudget;
+  }
+
+  size_t AssetManager::GetMemoryUsage(const AssetType type) {
+    std::lock_guard lock(s_AssetMutex);
+    return GetCache(type).MemoryUsage;
+  }
+
+  void AssetManager::Update() {
+    OX_SCOPED_ZONE;
+    std::lock_guard lock(s_AssetMutex);
+    s_Frame++;
+    Evict(s_AssetsLibrary.ImageAssets, s_ImageCache, s_RetiredImages, true);
+    Evict(s_AssetsLibrary.MeshAssets, s_MeshCache, s_RetiredMeshes, true);
+    Evict(s_AssetsLibrary.MaterialAssets, s_MaterialCache, s_RetiredMaterials, true);
+
+    // Evicted assets may still be used by the frames that were in flight when they got evicted
+    const uint64_t framesInFlight = VulkanRenderer::s_SwapChain.MaxFramesInFlight;
+    const auto isSafe = [framesInFlight](const auto& retired) { return s_Frame - retired.Frame > framesInFlight; };
+    std::erase_if(s_RetiredImages,
+      [&isSafe](const RetiredAsset<VulkanImage>& retired) {
+        if (!isSafe(retired))
+          return false;
+        if (retired.Data)
+          retired.Data->Destroy();
+        return true;
+      });
+    std::erase_if(s_RetiredMeshes, isSafe);
+    std::erase_if(s_RetiredMaterials, isSafe);
   }
 
   void AssetManager::PackageAssets() {
@@ -68,7 +129,6 @@ namespace Oxylus {
 
     // TODO(hatrickek): Pack materials inside of meshes(glb).
     // TODO(hatrickek): Pack/compress audio files.
-    // TODO(hatrickek): Convert all png etc. files to KTX files.
 
     constexpr auto meshDirectory = "Assets/Objects";
     constexpr auto textureDirectory = "Assets/Textures";
@@ -77,60 +137,70 @@ namespace Oxylus {
 
     std::filesystem::create_directory("Assets");
 
-    // Package mesh files
-    for (auto& [handle, asset] : s_AssetsLibrary.MeshAssets) {
+    std::vector<Asset<Mesh>> meshes;
+    std::vector<Asset<VulkanImage>> images;
+    {
+      std::lock_guard lock(s_AssetMutex);
+      for (const auto& [handle, asset] : s_AssetsLibrary.MeshAssets)
+        meshes.emplace_back(asset);
+      for (const auto& [handle, asset] : s_AssetsLibrary.ImageAssets)
+        images.emplace_back(asset);
+    }
+
+    // Package mesh files, cooked so they load without parsing
+    for (const auto& asset : meshes) {
       const auto filePath = std::filesystem::path(asset.Path);
-      auto outPath = std::filesystem::path(meshDirectory) / filePath.filename();
+      auto outPath = std::filesystem::path(meshDirectory) / filePath.filename().replace_extension(Mesh::CookedExtension);
       outPath = FileUtils::GetPreferredPath(outPath.string());
       auto dir = FileUtils::GetPreferredPath(meshDirectory);
       std::filesystem::create_directory(dir);
-      const auto exported = Mesh::ExportAsBinary(asset.Path, outPath.string());
+      const auto exported = Mesh::Cook(asset.Path, outPath.string(), asset.Data ? (int)asset.Data->LoadingFlags : Mesh::None);
       if (!exported)
         OX_CORE_ERROR("Couldn't export mesh asset: {}", asset.Path);
       else
         OX_CORE_INFO("Exported mesh asset to: {}", outPath.string());
     }
 
-    // Package texture files
-    for (auto& [handle, asset] : s_AssetsLibrary.ImageAssets) {
-      const auto filePath = std::filesystem::path(asset.Path);
-      const auto outPath = std::filesystem::path(textureDirectory) / filePath.filename();
-      std::filesystem::create_directory(textureDirectory);
-      const auto exported = std::filesystem::copy_file(asset.Path, outPath);
-      if (!exported)
-        OX_CORE_ERROR("Couldn't export image asset: {}", asset.Path);
-      else
-        OX_CORE_INFO("Exported image asset to: {}", outPath.string());
-    }
+    // Package texture files, encoded to KTX2 with their mips on the workers. KTX files are copied as they are.
+    std::filesystem::create_directory(textureDirectory);
+    JobSystem::ParallelFor((uint32_t)images.size(),
+      1,
+      [&images, textureDirectory](const uint32_t index) {
+        const auto& asset = images[index];
+        const auto filePath = std::filesystem::path(asset.Path);
+        const auto extension = filePath.extension();
+        auto outPath = std::filesystem::path(textureDirectory) / filePath.filename();
+        bool exported = false;
+        if (extension == ".ktx" || extension == ".ktx2") {
+          std::error_code error;
+          exported = std::filesystem::copy_file(asset.Path, outPath, std::filesystem::copy_options::overwrite_existing, error);
+        }
+        else {
+          outPath.replace_extension(TextureCompressor::Extension);
+          exported = TextureCompressor::CompressFile(asset.Path, outPath.string());
+        }
+        if (!exported)
+          OX_CORE_ERROR("Couldn't export image asset: {}", asset.Path);
+        else
+          OX_CORE_INFO("Exported image asset to: {}", outPath.string());
+      });
   }
 
   void AssetManager::FreeUnusedAssets() {
     OX_SCOPED_ZONE;
-    for (auto& [handle, asset] : s_AssetsLibrary.MeshAssets) {
-      if (asset.Data.use_count())
-        return;
-      s_AssetsLibrary.MeshAssets.erase(handle);
-    }
-    for (auto& [handle, asset] : s_AssetsLibrary.MaterialAssets) {
-      if (asset.Data.use_count())
-        return;
-      s_AssetsLibrary.MaterialAssets.erase(handle);
-    }
-    for (auto& [handle, asset] : s_AssetsLibrary.ImageAssets) {
-      if (asset.Data.use_count())
-        return;
-      s_AssetsLibrary.ImageAssets.erase(handle);
-    }
+    std::lock_guard lock(s_AssetMutex);
+    Evict(s_AssetsLibrary.MeshAssets, s_MeshCache, s_RetiredMeshes, false);
+    Evict(s_AssetsLibrary.MaterialAssets, s_MaterialCache, s_RetiredMaterials, false);
+    Evict(s_AssetsLibrary.ImageAssets, s_ImageCache, s_RetiredImages, false);
   }
 
   Asset<VulkanImage> AssetManager::LoadImageAsset(const VulkanImageDescription& description) {
     OX_SCOPED_ZONE;
     Asset<VulkanImage> asset;
-    std::lock_guard lock(s_AssetMutex);
     asset.Data = CreateRef<VulkanImage>(description);
     asset.Path = description.Path;
     asset.Type = AssetType::Image;
-    return s_AssetsLibrary.ImageAssets.emplace(asset.Handle, asset).first->second;
+    return asset;
   }
 
   Asset<Mesh> AssetManager::LoadMeshAsset(const std::string& path, int32_t loadingFlags) {
@@ -139,7 +209,7 @@ namespace Oxylus {
     asset.Data = CreateRef<Mesh>(path, loadingFlags);
     asset.Path = path;
     asset.Type = AssetType::Mesh;
-    return s_AssetsLibrary.MeshAssets.emplace(asset.Handle, asset).first->second;
+    return asset;
   }
 
   Asset<Material> AssetManager::LoadMaterialAsset(const std::string& path) {
@@ -151,6 +221,100 @@ namespace Oxylus {
     serializer.Deserialize(path);
     asset.Path = path;
     asset.Type = AssetType::Material;
-    return s_AssetsLibrary.MaterialAssets.emplace(asset.Handle, asset).first->second;
+    return asset;
+  }
+
+  template <typename T, typename LoadFunction>
+  Asset<T> AssetManager::GetOrLoad(std::unordered_map<AssetHandle, Asset<T>>& assets,
+                                   AssetCache& cache,
+                                   const std::string& path,
+                                   LoadFunction&& load) {
+    std::unique_lock lock(s_AssetMutex);
+    if (auto asset = Find(lock, assets, cache, path))
+      return asset;
+
+    // Loaded without holding the lock, loading an asset may look up others
+    cache.LoadingPaths.emplace(path);
+    lock.unlock();
+    const Asset<T> loaded = load();
+    lock.lock();
+    cache.LoadingPaths.erase(path);
+    auto asset = Add(assets, cache, loaded);
+    lock.unlock();
+    s_AssetLoaded.notify_all();
+    return asset;
+  }
+
+  template <typename T>
+  Asset<T> AssetManager::Find(std::unique_lock<std::mutex>& lock,
+                              std::unordered_map<AssetHandle, Asset<T>>& assets,
+                              AssetCache& cache,
+                              const std::string& path) {
+    // Another thread is loading it, wait for it instead of loading it twice
+    s_AssetLoaded.wait(lock, [&cache, &path] { return !cache.LoadingPaths.contains(path); });
+
+    const auto it = cache.PathIndex.find(path);
+    if (it == cache.PathIndex.end())
+      return {};
+    const auto position = cache.Entries.at(it->second).first;
+    cache.UsageOrder.splice(cache.UsageOrder.begin(), cache.UsageOrder, position);
+    return assets.at(it->second);
+  }
+
+  template <typename T>
+  Asset<T> AssetManager::Add(std::unordered_map<AssetHandle, Asset<T>>& assets, AssetCache& cache, const Asset<T>& asset) {
+    if (const auto it = cache.PathIndex.find(asset.Path); it != cache.PathIndex.end())
+      return assets.at(it->second);
+
+    const size_t size = GetMemorySize(asset);
+    cache.UsageOrder.emplace_front(asset.Handle);
+    cache.Entries.emplace(asset.Handle, std::make_pair(cache.UsageOrder.begin(), size));
+    cache.PathIndex.emplace(asset.Path, asset.Handle);
+    cache.MemoryUsage += size;
+    return assets.emplace(asset.Handle, asset).first->second;
+  }
+
+  template <typename T>
+  void AssetManager::Evict(std::unordered_map<AssetHandle, Asset<T>>& assets,
+                           AssetCache& cache,
+                           std::vector<RetiredAsset<T>>& retired,
+                           const bool overBudgetOnly) {
+    // Least recently used first, assets that are referenced outside of the registry stay
+    for (auto it = cache.UsageOrder.end(); it != cache.UsageOrder.begin();) {
+      if (overBudgetOnly && cache.MemoryUsage <= cache.MemoryBudget)
+        break;
+      --it;
+      const AssetHandle handle = *it;
+      auto& asset = assets.at(handle);
+      if (asset.Data.use_count() > 1)
+        continue;
+
+      cache.MemoryUsage -= cache.Entries.at(handle).second;
+      cache.Entries.erase(handle);
+      cache.PathIndex.erase(asset.Path);
+      retired.push_back({std::move(asset.Data), s_Frame});
+      assets.erase(handle);
+      it = cache.UsageOrder.erase(it);
+    }
+  }
+
+  AssetManager::AssetCache& AssetManager::GetCache(const AssetType type) {
+    switch (type) {
+      case AssetType::Mesh: return s_MeshCache;
+      case AssetType::Material: return s_MaterialCache;
+      case AssetType::Image:
+      default: return s_ImageCache;
+    }
+  }
+
+  size_t AssetManager::GetMemorySize(const Asset<VulkanImage>& asset) {
+    return asset.Data ? asset.Data->ImageSize : 0;
+  }
+
+  size_t AssetManager::GetMemorySize(const Asset<Mesh>& asset) {
+    if (!asset.Data || asset.Data->Geometry == GeometryBuffer::InvalidHandle || !GeometryBuffer::Get())
+      return 0;
+    const auto& range = asset.Data->GetGeometry();
+    return range.VertexCount * sizeof(Mesh::PackedVertex) + range.IndexCount * sizeof(uint32_t);
   }
 }
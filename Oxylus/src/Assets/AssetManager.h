@@ -2,7 +2,11 @@
 
 #include "Assets/Assets.h"
 
+#include <condition_variable>
 #include <filesystem>
+#include <list>
+#include <mutex>
+#include <unordered_set>
 #include <vector>
 
 namespace Oxylus {
@@ -11,6 +15,10 @@ namespace Oxylus {
   class Material;
   class Mesh;
 
+  /// Registry of every loaded asset, safe to use from any thread.
+  /// Assets are looked up by path in constant time. A lookup of an asset another thread is loading waits for it.
+  /// Images and meshes count their GPU memory against a budget per type. Once over budget the least recently used
+  /// assets nothing else references are evicted, their GPU resources are destroyed once no frame can use them anymore.
   class AssetManager {
   public:
     struct AssetsLibrary {
@@ -25,26 +33,78 @@ namespace Oxylus {
     static Asset<VulkanImage> GetImageAsset(const std::string& path);
     // Assumes the path already points to an existing asset file.
     static Asset<VulkanImage> GetImageAsset(const VulkanImageDescription& description);
-    static Asset<VulkanImage> GetImageAsset(const AssetHandle handle) { return s_AssetsLibrary.ImageAssets[handle]; }
+    static Asset<VulkanImage> GetImageAsset(AssetHandle handle);
+    /// Returns the image loaded from the path, or an empty asset when it isn't loaded yet.
+    static Asset<VulkanImage> FindImageAsset(const std::string& path);
+    /// Registers an image that was created outside of the asset manager under its path.
+    /// If the path got loaded in the meantime the already registered image is returned instead.
+    static Asset<VulkanImage> AddImageAsset(const Ref<VulkanImage>& image, const std::string& path);
     // Assumes the path already points to an existing asset file.
     static Asset<Mesh> GetMeshAsset(const std::string& path, int32_t loadingFlags = 0);
-    static Asset<Mesh> GetMeshAsset(const AssetHandle handle) { return s_AssetsLibrary.MeshAssets[handle]; }
+    static Asset<Mesh> GetMeshAsset(AssetHandle handle);
     // Assumes the path already points to an existing asset file.
     static Asset<Material> GetMaterialAsset(const std::string& path);
-    static Asset<Material> GetMaterialAsset(AssetHandle handle) { return s_AssetsLibrary.MaterialAssets[handle]; }
+    static Asset<Material> GetMaterialAsset(AssetHandle handle);
 
+    /// Not synchronized, only iterate it on the main thread while no assets are being loaded.
     static const AssetsLibrary& GetAssetLibrary() { return s_AssetsLibrary; }
 
+    /// Bytes of GPU memory the assets of the type may use before unused ones are evicted.
+    static void SetMemoryBudget(AssetType type, size_t bytes);
+    static size_t GetMemoryBudget(AssetType type);
+    static size_t GetMemoryUsage(AssetType type);
+
+    /// Called once per frame. Evicts unused assets of types that are over budget and destroys the GPU resources
+    /// of evicted assets that are no longer used by any frame in flight.
+    static void Update();
+
     static void PackageAssets();
     static void FreeUnusedAssets();
 
   private:
+    /// Path index and usage order of the assets of one type.
+    struct AssetCache {
+      std::unordered_map<std::string, AssetHandle> PathIndex{};
+      std::unordered_set<std::string> LoadingPaths{};
+      std::list<AssetHandle> UsageOrder{}; // Most recently used first
+      std::unordered_map<AssetHandle, std::pair<std::list<AssetHandle>::iterator, size_t>> Entries{};
+      size_t MemoryUsage = 0;
+      size_t MemoryBudget = SIZE_MAX;
+    };
+
+    template <typename T>
+    struct RetiredAsset {
+      Ref<T> Data = nullptr;
+      uint64_t Frame = 0;
+    };
+
     static Asset<VulkanImage> LoadImageAsset(const VulkanImageDescription& description);
     static Asset<Mesh> LoadMeshAsset(const std::string& path, int32_t loadingFlags);
     static Asset<Material> LoadMaterialAsset(const std::string& path);
 
+    template <typename T, typename LoadFunction>
+    static Asset<T> GetOrLoad(std::unordered_map<AssetHandle, Asset<T>>& assets, AssetCache& cache, const std::string& path, LoadFunction&& load);
+    template <typename T>
+    static Asset<T> Find(std::unique_lock<std::mutex>& lock, std::unordered_map<AssetHandle, Asset<T>>& assets, AssetCache& cache, const std::string& path);
+    template <typename T>
+    static Asset<T> Add(std::unordered_map<AssetHandle, Asset<T>>& assets, AssetCache& cache, const Asset<T>& asset);
+    template <typename T>
+    static void Evict(std::unordered_map<AssetHandle, Asset<T>>& assets, AssetCache& cache, std::vector<RetiredAsset<T>>& retired, bool overBudgetOnly);
+    static AssetCache& GetCache(AssetType type);
+    static size_t GetMemorySize(const Asset<VulkanImage>& asset);
+    static size_t GetMemorySize(const Asset<Mesh>& asset);
+    static size_t GetMemorySize(const Asset<Material>& asset) { return 0; }
+
     static AssetsLibrary s_AssetsLibrary;
+    static AssetCache s_ImageCache;
+    static AssetCache s_MeshCache;
+    static AssetCache s_MaterialCache;
+    static std::vector<RetiredAsset<VulkanImage>> s_RetiredImages;
+    static std::vector<RetiredAsset<Mesh>> s_RetiredMeshes;
+    static std::vector<RetiredAsset<Material>> s_RetiredMaterials;
+    static uint64_t s_Frame;
 
     static std::mutex s_AssetMutex;
+    static std::condition_variable s_AssetLoaded;
   };
 }
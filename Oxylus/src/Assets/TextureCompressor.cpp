@@ -0,0 +1,138 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <glm/glm.hpp>
+#include <ktx.h>
+#include <stb_image.h>
+#include <vulkan/vulkan.h>
+
+#include "Utils/Log.h"
+#include "Utils/Profiler.h"
+
+namespace Oxylus {
+  // zstd goes up to 22, higher levels barely shrink the files but take much longer to encode
+  static constexpr uint32_t ZstdLevel = 18;
+
+  static std::vector<uint8_t> DownsampleLevel(const std::vector<uint8_t>& source,
+                                              const uint32_t width,
+                                              const uint32_t height,
+                                              const bool normalMap) {
+    const uint32_t mipWidth = std::max(width / 2, 1u);
+    const uint32_t mipHeight = std::max(height / 2, 1u);
+    std::vector<uint8_t> mip((size_t)mipWidth * mipHeight * 4);
+    for (uint32_t y = 0; y < mipHeight; y++) {
+      for (uint32_t x = 0; x < mipWidth; x++) {
+        // 2x2 box filter, odd edges reuse their last texel
+        glm::vec4 sum{0.0f};
+        for (uint32_t sy = 0; sy < 2; sy++) {
+          for (uint32_t sx = 0; sx < 2; sx++) {
+            const uint32_t srcX = std::min(x * 2 + sx, width - 1);
+            const uint32_t srcY = std::min(y * 2 + sy, height - 1);
+            const uint8_t* texel = &source[((size_t)srcY * width + srcX) * 4];
+            sum += glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.0f;
+          }
+        }
+        glm::vec4 result = sum * 0.25f;
+        if (normalMap) {
+          const glm::vec3 normal = glm::vec3(result) * 2.0f - 1.0f;
+          const float length = glm::length(normal);
+          if (length > 0.0f)
+            result = glm::vec4(normal / length * 0.5f + 0.5f, result.w);
+        }
+        uint8_t* texel = &mip[((size_t)y * mipWidth + x) * 4];
+        for (int c = 0; c < 4; c++)
+          texel[c] = (uint8_t)(glm::clamp(result[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+      }
+    }
+    return mip;
+  }
+
+  bool TextureCompressor::CompressFile(const std::string& inPath, const std::string& outPath, const bool normalMap) {
+    int width = 0, height = 0, channels = 0;
+    stbi_uc* pixels = stbi_load(inPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+      OX_CORE_ERROR("Couldn't decode image to compress: {}", inPath);
+      return false;
+    }
+    const bool compressed = Compress(pixels, (uint32_t)width, (uint32_t)height, outPath, normalMap);
+    stbi_image_free(pixels);
+    return compressed;
+  }
+
+  bool TextureCompressor::CompressMemory(const uint8_t* data, const size_t size, const std::string& outPath, const bool normalMap) {
+    int width = 0, height = 0, channels = 0;
+    stbi_uc* pixels = stbi_load_from_memory(data, (int)size, &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+      OX_CORE_ERROR("Couldn't decode image to compress into: {}", outPath);
+      return false;
+    }
+    const bool compressed = Compress(pixels, (uint32_t)width, (uint32_t)height, outPath, normalMap);
+    stbi_image_free(pixels);
+    return compressed;
+  }
+
+  bool TextureCompressor::Compress(const uint8_t* pixels,
+                                   const uint32_t width,
+                                   const uint32_t height,
+                                   const std::string& outPath,
+                                   const bool normalMap) {
+    OX_SCOPED_ZONE;
+    const uint32_t levelCount = (uint32_t)std::floor(std::log2(std::max(width, height))) + 1;
+
+    // Textures are sampled as UNORM everywhere, the same format the runtime creates them with
+    ktxTextureCreateInfo createInfo{};
+    createInfo.vkFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    createInfo.baseWidth = width;
+    createInfo.baseHeight = height;
+    createInfo.baseDepth = 1;
+    createInfo.numDimensions = 2;
+    createInfo.numLevels = levelCount;
+    createInfo.numLayers = 1;
+    createInfo.numFaces = 1;
+    createInfo.isArray = KTX_FALSE;
+    createInfo.generateMipmaps = KTX_FALSE;
+
+    ktxTexture2* texture = nullptr;
+    ktxResult result = ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture);
+    if (result != KTX_SUCCESS) {
+      OX_CORE_ERROR("Couldn't create the KTX texture. {0}, {1}", ktxErrorString(result), outPath);
+      return false;
+    }
+
+    std::vector<uint8_t> level(pixels, pixels + (size_t)width * height * 4);
+    uint32_t levelWidth = width;
+    uint32_t levelHeight = height;
+    for (uint32_t i = 0; i < levelCount && result == KTX_SUCCESS; i++) {
+      if (i > 0) {
+        level = DownsampleLevel(level, levelWidth, levelHeight, normalMap);
+        levelWidth = std::max(levelWidth / 2, 1u);
+        levelHeight = std::max(levelHeight / 2, 1u);
+      }
+      result = ktxTexture_SetImageFromMemory(ktxTexture(texture), i, 0, 0, level.data(), level.size());
+    }
+
+    if (result == KTX_SUCCESS) {
+      // Images are encoded in parallel by the caller, one thread per image
+      ktxBasisParams params{};
+      params.structSize = sizeof(params);
+      params.uastc = KTX_TRUE;
+      params.uastcFlags = KTX_PACK_UASTC_LEVEL_DEFAULT;
+      params.threadCount = 1;
+      params.normalMap = normalMap ? KTX_TRUE : KTX_FALSE;
+      result = ktxTexture2_CompressBasisEx(texture, &params);
+    }
+    if (result == KTX_SUCCESS)
+      result = ktxTexture2_DeflateZstd(texture, ZstdLevel);
+    if (result == KTX_SUCCESS)
+      result = ktxTexture_WriteToNamedFile(ktxTexture(texture), outPath.c_str());
+    ktxTexture_Destroy(ktxTexture(texture));
+
+    if (result != KTX_SUCCESS) {
+      OX_CORE_ERROR("Couldn't compress the KTX texture. {0}, {1}", ktxErrorString(result), outPath);
+      return false;
+    }
+    return true;
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Oxylus {
+  /// Offline encoder that turns source images into KTX2 files which load without decoding or generating mips.
+  /// Images are stored as UASTC with their whole mip chain and zstd supercompression. On load they are transcoded
+  /// to a block compressed format the device supports.
+  class TextureCompressor {
+  public:
+    static constexpr auto Extension = ".ktx2";
+
+    /// Normal map mips are renormalized instead of only averaged.
+    static bool CompressFile(const std::string& inPath, const std::string& outPath, bool normalMap = false);
+    /// Compresses an encoded image (png, jpg, ...) held in memory.
+    static bool CompressMemory(const uint8_t* data, size_t size, const std::string& outPath, bool normalMap = false);
+    /// Compresses RGBA8 pixels.
+    static bool Compress(const uint8_t* pixels, uint32_t width, uint32_t height, const std::string& outPath, bool normalMap = false);
+  };
+}
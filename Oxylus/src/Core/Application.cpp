@@ -1,6 +1,7 @@
 #include "Application.h"
 #include "Core.h"
 #include "Layer.h"
+#include "Assets/AssetManager.h"
 #include "Render/Window.h"
 #include "Render/Vulkan/VulkanRenderer.h"
 #include "Utils/Profiler.h"
@@ -62,6 +63,9 @@ namespace Oxylus {
       //Render Loop
       UpdateRenderer();
 
+      //Assets
+      AssetManager::Update();
+
       //ImGui Loop
       UpdateImGui();
 
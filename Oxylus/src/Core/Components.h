@@ -4,6 +4,7 @@
 #include <string>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <entt/entity/entity.hpp>
 
 #include "Types.h"
 #include "UUID.h"
@@ -38,9 +39,14 @@ namespace Oxylus {
     explicit TagComponent(std::string tag) : Tag(std::move(tag)) { }
   };
 
+  /// Runtime hierarchy stored as an intrusive list of siblings. UUIDs are only used when (de)serializing it.
   struct RelationshipComponent {
-    UUID Parent = 0;
-    std::vector<UUID> Children{};
+    entt::entity Parent = entt::null;
+    entt::entity FirstChild = entt::null;
+    entt::entity LastChild = entt::null;
+    entt::entity PrevSibling = entt::null;
+    entt::entity NextSibling = entt::null;
+    uint32_t ChildCount = 0;
   };
 
   struct PrefabComponent {
@@ -59,6 +65,21 @@ namespace Oxylus {
     TransformComponent(const Vec3& translation) : Translation(translation) { }
   };
 
+  /// World matrix cached by Scene::UpdateTransforms(). Only rebuilt when the entity or one of its parents changed.
+  struct WorldTransformComponent {
+    Mat4 World = Mat4(1);
+
+    // Local state World was built from
+    Vec3 Translation = Vec3(0);
+    Vec3 Rotation = Vec3(0);
+    Vec3 Scale = Vec3(1);
+    entt::entity Parent = entt::null;
+    bool Valid = false;
+    // Bumped every time World is rebuilt so systems can cheaply spot moved entities
+    uint32_t Version = 0;
+    uint32_t ParentVersion = 0; // Version of the parent's World this one was built from
+  };
+
   // Rendering
   struct MaterialComponent {
     std::vector<Ref<Material>> Materials{};
@@ -84,6 +105,19 @@ namespace Oxylus {
     }
   };
 
+  /// Plays an animation clip of the mesh of the entity's MeshRendererComponent, whose node has to have the skin the
+  /// clip was made for.
+  struct AnimationComponent {
+    uint32_t ClipIndex = 0;
+    float Time = 0.0f;
+    float Speed = 1.0f;
+    bool Loop = true;
+    int32_t BlendClipIndex = -1; // Second clip of the same skin, played along and blended in by BlendWeight
+    float BlendWeight = 0.0f;
+
+    std::vector<Mat4> SkinningMatrices; // Written by the scene every update, the renderer skins the mesh with them
+  };
+
   struct ParticleSystemComponent {
     Ref<ParticleSystem> System = nullptr;
 
@@ -149,12 +183,6 @@ namespace Oxylus {
 
     // Stored as JPH::Body
     void* RuntimeBody = nullptr;
-
-    // For interpolation/extrapolation
-    Vec3 PreviousTranslation = Vec3(0.0f);
-    glm::quat PreviousRotation = Vec3(0.0f);
-    Vec3 Translation = Vec3(0.0f);
-    glm::quat Rotation = Vec3(0.0f);
   };
 
   struct BoxColliderComponent {
@@ -285,10 +313,11 @@ namespace Oxylus {
   template <typename... Component>
   struct ComponentGroup { };
 
-  using AllComponents = ComponentGroup<TransformComponent, RelationshipComponent, PrefabComponent, CameraComponent,
+  // RelationshipComponent is left out, its handles are only valid inside their own scene.
+  using AllComponents = ComponentGroup<TransformComponent, PrefabComponent, CameraComponent,
 
                                        // Render
-                                       LightComponent, MeshRendererComponent, SkyLightComponent, ParticleSystemComponent, MaterialComponent,
+                                       LightComponent, MeshRendererComponent, AnimationComponent, SkyLightComponent, ParticleSystemComponent, MaterialComponent,
 
                                        //  Physics
                                        RigidbodyComponent,
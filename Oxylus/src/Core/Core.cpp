@@ -5,6 +5,7 @@
 #include "Core/Input.h"
 
 #include "Render/Window.h"
+#include "Thread/JobSystem.h"
 #include "Physics/Physics.h"
 #include "Render/Vulkan/VulkanContext.h"
 #include "Render/Vulkan/VulkanRenderer.h"
@@ -23,6 +24,7 @@ namespace Oxylus {
 
     FileDialogs::InitNFD();
     Project::New();
+    JobSystem::Init();
     Window::InitWindow(spec);
     VulkanContext::CreateContext(spec);
     VulkanRenderer::Init();
@@ -39,6 +41,7 @@ namespace Oxylus {
     AudioEngine::Shutdown();
 
     ThreadManager::Get()->WaitAllThreads();
+    JobSystem::Shutdown();
 
     Window::CloseWindow(Window::GetGLFWWindow());
   }
@@ -74,76 +74,121 @@ namespace Oxylus {
       if (!m_Scene)
         return {};
 
-      const auto& rc = GetComponent<RelationshipComponent>();
-      return rc.Parent != 0 ? m_Scene->GetEntityByUUID(rc.Parent) : Entity{};
+      const auto parent = GetRelationship().Parent;
+      return parent != entt::null ? Entity{parent, m_Scene} : Entity{};
     }
 
     Entity GetChild(uint32_t index = 0) const {
-      const auto& rc = GetComponent<RelationshipComponent>();
-      return GetScene()->GetEntityByUUID(rc.Children[index]);
+      auto child = GetRelationship().FirstChild;
+      for (uint32_t i = 0; i < index && child != entt::null; i++)
+        child = m_Scene->m_Registry.get<RelationshipComponent>(child).NextSibling;
+      return child != entt::null ? Entity{child, m_Scene} : Entity{};
+    }
+
+    /// Calls function(Entity) for every direct child, in order.
+    template <typename Function>
+    void ForEachChild(Function&& function) const {
+      auto child = GetRelationship().FirstChild;
+      while (child != entt::null) {
+        // Read the link first so the callback may reparent or destroy the child
+        const auto next = m_Scene->m_Registry.get<RelationshipComponent>(child).NextSibling;
+        function(Entity{child, m_Scene});
+        child = next;
+      }
     }
 
+    /// All descendants, depth first.
     std::vector<Entity> GetAllChildren() const {
       std::vector<Entity> entities;
-
-      const std::vector<UUID> children = GetComponent<RelationshipComponent>().Children;
-      for (const auto& child : children) {
-        Entity entity = GetScene()->GetEntityByUUID(child);
-        entities.push_back(entity);
-        GetAllChildren();
-      }
-
+      GetAllChildren(*this, entities);
       return entities;
     }
 
     static void GetAllChildren(Entity parent, std::vector<Entity>& outEntities) {
-      const std::vector<UUID> children = parent.GetComponent<RelationshipComponent>().Children;
-      for (const auto& child : children) {
-        Entity entity = parent.GetScene()->GetEntityByUUID(child);
-        outEntities.push_back(entity);
-        GetAllChildren(entity, outEntities);
-      }
+      parent.ForEachChild([&outEntities](Entity child) {
+        outEntities.push_back(child);
+        GetAllChildren(child, outEntities);
+      });
     }
 
     Entity SetParent(Entity parent) const {
-      OX_CORE_ASSERT(m_Scene->m_EntityMap.contains(parent.GetUUID()), "Parent is not in the same scene as entity");
+      OX_CORE_ASSERT(parent.m_Scene == m_Scene, "Parent is not in the same scene as entity");
+
+      for (Entity ancestor = parent; ancestor; ancestor = ancestor.GetParent()) {
+        if (ancestor == *this) {
+          OX_CORE_ERROR("Can't parent {0} to one of its own children!", GetName());
+          return *this;
+        }
+      }
+
       Deparent();
 
-      auto& [Parent, Children] = GetComponent<RelationshipComponent>();
-      Parent = parent.GetUUID();
-      parent.GetRelationship().Children.emplace_back(GetUUID());
+      auto& rc = GetRelationship();
+      auto& parentRc = parent.GetRelationship();
+      rc.Parent = parent.m_EntityHandle;
+      rc.PrevSibling = parentRc.LastChild;
+      if (parentRc.LastChild != entt::null)
+        m_Scene->m_Registry.get<RelationshipComponent>(parentRc.LastChild).NextSibling = m_EntityHandle;
+      else
+        parentRc.FirstChild = m_EntityHandle;
+      parentRc.LastChild = m_EntityHandle;
+      parentRc.ChildCount++;
+      m_Scene->m_HierarchyChanged = true;
 
       return *this;
     }
 
     void Deparent() const {
-      auto& transform = GetRelationship();
-      const UUID uuid = GetUUID();
-      const Entity parentEntity = GetParent();
-
-      if (!parentEntity)
+      auto& rc = GetRelationship();
+      if (rc.Parent == entt::null)
         return;
 
-      auto& parent = parentEntity.GetRelationship();
-      for (auto it = parent.Children.begin(); it != parent.Children.end(); ++it) {
-        if (*it == uuid) {
-          parent.Children.erase(it);
-          break;
-        }
+      auto& registry = m_Scene->m_Registry;
+      auto& parentRc = registry.get<RelationshipComponent>(rc.Parent);
+      if (rc.PrevSibling != entt::null)
+        registry.get<RelationshipComponent>(rc.PrevSibling).NextSibling = rc.NextSibling;
+      else
+        parentRc.FirstChild = rc.NextSibling;
+      if (rc.NextSibling != entt::null)
+        registry.get<RelationshipComponent>(rc.NextSibling).PrevSibling = rc.PrevSibling;
+      else
+        parentRc.LastChild = rc.PrevSibling;
+      parentRc.ChildCount--;
+
+      rc.Parent = entt::null;
+      rc.PrevSibling = entt::null;
+      rc.NextSibling = entt::null;
+      m_Scene->m_HierarchyChanged = true;
+    }
+
+    /// Returns the matrix cached by the last Scene::UpdateTransforms() unless the entity or its parent moved since
+    /// then. Only the direct parent is looked at to keep this constant time, moves further up the hierarchy show once
+    /// the next update propagated them.
+    glm::mat4 GetWorldTransform() const {
+      const Entity parent = GetParent();
+      if (IsWorldTransformCached() && (!parent || parent.IsWorldTransformCached())) {
+        const auto& cached = m_Scene->m_Registry.get<WorldTransformComponent>(m_EntityHandle);
+        if (!parent || m_Scene->m_Registry.get<WorldTransformComponent>(parent.m_EntityHandle).Version == cached.ParentVersion)
+          return cached.World;
       }
-      transform.Parent = 0;
-    }
-
 
-    glm::mat4 GetWorldTransform() const {
       const auto& transform = GetTransform();
-      const auto& rc = GetRelationship();
-      const Entity parent = m_Scene->GetEntityByUUID(rc.Parent);
       const glm::mat4 parentTransform = parent ? parent.GetWorldTransform() : glm::mat4(1.0f);
       return parentTransform * glm::translate(glm::mat4(1.0f), transform.Translation) *
              glm::toMat4(glm::quat(transform.Rotation)) * glm::scale(glm::mat4(1.0f), transform.Scale);
     }
 
+    /// Whether the cached world matrix was built from the current local transform and parent of the entity. The
+    /// parent's own matrix may still be stale.
+    bool IsWorldTransformCached() const {
+      const auto* cached = m_Scene->m_Registry.try_get<WorldTransformComponent>(m_EntityHandle);
+      if (!cached || !cached->Valid)
+        return false;
+      const auto& transform = GetTransform();
+      return cached->Parent == GetRelationship().Parent && cached->Translation == transform.Translation &&
+             cached->Rotation == transform.Rotation && cached->Scale == transform.Scale;
+    }
+
     glm::mat4 GetLocalTransform() const {
       const auto& transform = GetTransform();
       return glm::translate(glm::mat4(1.0f), transform.Translation) * glm::toMat4(glm::quat(transform.Rotation)) *
@@ -6,11 +6,20 @@
 #include "Base.h"
 
 namespace Oxylus {
+  /// Capacity of the physics world. Jolt allocates everything up front, bodies beyond MaxBodies can't be created.
+  struct PhysicsConfig {
+    uint32_t MaxBodies = 65536;
+    uint32_t MaxBodyPairs = 65536;
+    uint32_t MaxContactConstraints = 10240;
+    uint32_t TempAllocatorSize = 32 * 1024 * 1024; // Bytes the solver may use per step
+  };
+
   struct ProjectConfig {
     std::string Name = "Untitled";
 
     std::string StartScene;
     std::string AssetDirectory;
+    PhysicsConfig Physics;
   };
 
   class Project {
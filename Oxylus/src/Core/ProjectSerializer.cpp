@@ -23,6 +23,13 @@ namespace Oxylus {
     node["StartScene"] << config.StartScene;
     node["AssetDirectory"] << config.AssetDirectory;
 
+    auto physicsNode = node["Physics"];
+    physicsNode |= ryml::MAP;
+    physicsNode["MaxBodies"] << config.Physics.MaxBodies;
+    physicsNode["MaxBodyPairs"] << config.Physics.MaxBodyPairs;
+    physicsNode["MaxContactConstraints"] << config.Physics.MaxContactConstraints;
+    physicsNode["TempAllocatorSize"] << config.Physics.TempAllocatorSize;
+
     std::stringstream ss;
     ss << tree;
     std::ofstream filestream(filePath);
@@ -32,7 +39,7 @@ namespace Oxylus {
   }
 
   bool ProjectSerializer::Deserialize(const std::filesystem::path& filePath) const {
-    auto& [Name, StartScene, AssetDirectory] = m_Project->GetConfig();
+    auto& [Name, StartScene, AssetDirectory, Physics] = m_Project->GetConfig();
 
     const auto& content = FileUtils::ReadFile(filePath.string());
     if (!content) {
@@ -53,6 +60,15 @@ namespace Oxylus {
     nodeRoot["StartScene"] >> StartScene;
     nodeRoot["AssetDirectory"] >> AssetDirectory;
 
+    // Older projects don't have physics settings and keep the defaults
+    if (nodeRoot.has_child("Physics")) {
+      const ryml::ConstNodeRef physicsNode = nodeRoot["Physics"];
+      TryLoad(physicsNode, "MaxBodies", Physics.MaxBodies);
+      TryLoad(physicsNode, "MaxBodyPairs", Physics.MaxBodyPairs);
+      TryLoad(physicsNode, "MaxContactConstraints", Physics.MaxContactConstraints);
+      TryLoad(physicsNode, "TempAllocatorSize", Physics.TempAllocatorSize);
+    }
+
     return true;
   }
 }
@@ -5,14 +5,9 @@
 
 #include <string>
 
-namespace JPH {
-  class ContactSettings;
-  class ContactManifold;
-  class Body;
-}
-
 namespace Oxylus {
   class Scene;
+  struct ContactEvent;
 
   class System {
   public:
@@ -44,9 +39,11 @@ namespace Oxylus {
     /// Called right after main loop is finished before the core shutdown process.
     virtual void OnShutdown() { }
 
-    /// Physics interfaces
-    virtual void OnContactAdded(Scene* scene, const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, const JPH::ContactSettings& settings) { }
-    virtual void OnContactPersisted(Scene* scene, const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, const JPH::ContactSettings& settings) { }
+    /// Physics interfaces. Contacts of all the physics steps of a frame are handed out on the main thread after
+    /// stepping, every added one first, then the persisted and the removed ones.
+    virtual void OnContactAdded(Scene* scene, const ContactEvent& contact) { }
+    virtual void OnContactPersisted(Scene* scene, const ContactEvent& contact) { }
+    virtual void OnContactRemoved(Scene* scene, const ContactEvent& contact) { }
 
     void SetDispatcher(EventDispatcher* dispatcher) { m_Dispatcher = dispatcher; }
 
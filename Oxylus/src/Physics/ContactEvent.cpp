@@ -0,0 +1,49 @@
+#include "ContactEvent.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace Oxylus {
+  void ReduceContactEvents(std::vector<ContactEvent>& events) {
+    // Bring the events of each contact together, the sort is stable so they stay in the order they were recorded in
+    const auto key = [](const ContactEvent& contact) {
+      return std::tuple(contact.Body1.GetIndexAndSequenceNumber(),
+                        contact.Body2.GetIndexAndSequenceNumber(),
+                        contact.SubShape1.GetValue(),
+                        contact.SubShape2.GetValue());
+    };
+    std::stable_sort(events.begin(),
+      events.end(),
+      [&key](const ContactEvent& a, const ContactEvent& b) { return key(a) < key(b); });
+
+    // Reduce every contact to what changed over the frame. Whether it touched before the frame follows from its
+    // first event, whether it still touches from its last one. The latest manifold is handed out.
+    std::vector<ContactEvent> contacts;
+    contacts.reserve(events.size());
+    for (auto begin = events.begin(); begin != events.end();) {
+      const auto end = std::find_if(begin, events.end(), [&](const ContactEvent& contact) { return key(contact) != key(*begin); });
+      const ContactEvent& last = *(end - 1);
+      const bool wasTouching = begin->Type != ContactEvent::Phase::Added;
+      const bool isTouching = last.Type != ContactEvent::Phase::Removed;
+
+      if (isTouching) {
+        contacts.emplace_back(last).Type = wasTouching ? ContactEvent::Phase::Persisted : ContactEvent::Phase::Added;
+      }
+      else if (wasTouching) {
+        contacts.emplace_back(last);
+      }
+      else {
+        // Started and ended within the frame
+        contacts.emplace_back(*begin);
+        contacts.emplace_back(last);
+      }
+      begin = end;
+    }
+
+    // Group the contacts by phase, a contact added and removed within the frame is added first
+    std::stable_sort(contacts.begin(),
+      contacts.end(),
+      [](const ContactEvent& a, const ContactEvent& b) { return a.Type < b.Type; });
+    events = std::move(contacts);
+  }
+}
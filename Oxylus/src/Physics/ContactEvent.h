@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include <entt/entity/entity.hpp>
+
+#include "JoltBuild.h"
+#include "Core/Types.h"
+
+namespace Oxylus {
+  /// Contact between two sub shapes recorded while the physics system steps. Systems get them after the step on the
+  /// main thread, so unlike Jolt's callbacks they are free to touch the scene.
+  struct ContactEvent {
+    enum class Phase : uint8_t {
+      Added,
+      Persisted,
+      Removed,
+    };
+
+    Phase Type = Phase::Added;
+    JPH::BodyID Body1;
+    JPH::BodyID Body2;
+    JPH::SubShapeID SubShape1;
+    JPH::SubShapeID SubShape2;
+    /// Entities owning the bodies, null if a body was destroyed before the event was handed out.
+    entt::entity Entity1 = entt::null;
+    entt::entity Entity2 = entt::null;
+
+    // Summary of the contact manifold, removed contacts don't have one
+    Vec3 Normal = {};   // World space, pointing from body 1 towards body 2
+    Vec3 Position = {}; // Average of the contact points on body 1 in world space
+    float PenetrationDepth = 0.0f;
+    uint32_t PointCount = 0;
+  };
+
+  /// Reduces the events recorded over a frame to one per contact, telling whether it was added, persisted or removed
+  /// over the whole frame. A contact that started and ended within the frame keeps both events. Sorted by phase.
+  void ReduceContactEvents(std::vector<ContactEvent>& events);
+}
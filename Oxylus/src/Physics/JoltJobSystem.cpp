@@ -0,0 +1,47 @@
+#include "JoltJobSystem.h"
+
+#include "Thread/JobSystem.h"
+
+namespace Oxylus {
+  JoltJobSystem::JoltJobSystem(uint32_t maxBarriers) : JobSystemWithBarrier(maxBarriers) { }
+
+  int JoltJobSystem::GetMaxConcurrency() const {
+    return (int)Oxylus::JobSystem::GetThreadCount();
+  }
+
+  JPH::JobSystem::JobHandle JoltJobSystem::CreateJob(const char* inName,
+                                                     JPH::ColorArg inColor,
+                                                     const JobFunction& inJobFunction,
+                                                     JPH::uint32 inNumDependencies) {
+    Job* job = new Job(inName, inColor, this, inJobFunction, inNumDependencies);
+    JobHandle handle(job);
+
+    // Jobs with dependencies are queued by Jolt once the last one finishes
+    if (inNumDependencies == 0)
+      QueueJob(job);
+
+    return handle;
+  }
+
+  void JoltJobSystem::QueueJob(Job* inJob) {
+    // Keeps the job alive until a worker got to it
+    inJob->AddRef();
+
+    // Physics steps are frame critical, so they go ahead of asset loading and the like
+    Oxylus::JobSystem::Execute([inJob] {
+                                 inJob->Execute();
+                                 inJob->Release();
+                               },
+                               nullptr,
+                               JobPriority::High);
+  }
+
+  void JoltJobSystem::QueueJobs(Job** inJobs, JPH::uint inNumJobs) {
+    for (JPH::uint i = 0; i < inNumJobs; i++)
+      QueueJob(inJobs[i]);
+  }
+
+  void JoltJobSystem::FreeJob(Job* inJob) {
+    delete inJob;
+  }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "JoltBuild.h"
+
+namespace Oxylus {
+  /// Runs Jolt's jobs on the engine's job system workers instead of a thread pool of its own.
+  class JoltJobSystem final : public JPH::JobSystemWithBarrier {
+  public:
+    explicit JoltJobSystem(uint32_t maxBarriers);
+    ~JoltJobSystem() override = default;
+
+    int GetMaxConcurrency() const override;
+    JobHandle CreateJob(const char* inName,
+                        JPH::ColorArg inColor,
+                        const JobFunction& inJobFunction,
+                        JPH::uint32 inNumDependencies = 0) override;
+
+  protected:
+    void QueueJob(Job* inJob) override;
+    void QueueJobs(Job** inJobs, JPH::uint inNumJobs) override;
+    void FreeJob(Job* inJob) override;
+  };
+}
@@ -1,7 +1,7 @@
 ﻿#include "PhyiscsInterfaces.h"
 
 #include "PhysicsMaterial.h"
-#include "Scene/Scene.h"
+#include "Thread/JobSystem.h"
 #include "Utils/Profiler.h"
 
 
@@ -58,14 +58,53 @@ bool ObjectVsBroadPhaseLayerFilterImpl::ShouldCollide(JPH::ObjectLayer inLayer1,
 void Physics3DBodyActivationListener::OnBodyActivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData) {
   OX_SCOPED_ZONE;
 
-  /* Body Activated */
+  // Called from the physics jobs
+  std::lock_guard lock(m_Mutex);
+  const uint32_t index = inBodyID.GetIndex();
+  if (index >= m_ActiveSlots.size())
+    m_ActiveSlots.resize(index + 1, InvalidSlot);
+  if (m_ActiveSlots[index] < DeactivatedSlot)
+    return;
+
+  m_ActiveSlots[index] = (uint32_t)m_ActiveBodies.size();
+  m_ActiveBodies.emplace_back(inBodyID);
 }
+
 void Physics3DBodyActivationListener::OnBodyDeactivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData) {
   OX_SCOPED_ZONE;
 
-  /* Body Deactivated */
+  std::lock_guard lock(m_Mutex);
+  const uint32_t index = inBodyID.GetIndex();
+  if (index >= m_ActiveSlots.size() || m_ActiveSlots[index] >= DeactivatedSlot)
+    return;
+
+  // Swap with the last one to keep the set compact
+  const uint32_t slot = m_ActiveSlots[index];
+  const JPH::BodyID last = m_ActiveBodies.back();
+  m_ActiveBodies[slot] = last;
+  m_ActiveSlots[last.GetIndex()] = slot;
+  m_ActiveBodies.pop_back();
+  m_ActiveSlots[index] = DeactivatedSlot;
+
+  m_DeactivatedBodies.emplace_back(inBodyID);
 }
 
+void Physics3DBodyActivationListener::TakeDeactivatedBodies(std::vector<JPH::BodyID>& outBodies) {
+  std::lock_guard lock(m_Mutex);
+  for (const auto& id : m_DeactivatedBodies) {
+    // Bodies woken up again after falling asleep are synced as active ones. A body that fell asleep twice is in the
+    // list twice but only taken once.
+    uint32_t& slot = m_ActiveSlots[id.GetIndex()];
+    if (slot == DeactivatedSlot) {
+      outBodies.emplace_back(id);
+      slot = InvalidSlot;
+    }
+  }
+  m_DeactivatedBodies.clear();
+}
+
+Physics3DContactListener::Physics3DContactListener() : m_ThreadEvents(Oxylus::JobSystem::GetThreadCount()) { }
+
 void Physics3DContactListener::GetFrictionAndRestitution(const JPH::Body& inBody, const JPH::SubShapeID& inSubShapeID, float& outFriction, float& outRestitution) {
   OX_SCOPED_ZONE;
 
@@ -104,7 +143,7 @@ void Physics3DContactListener::OnContactAdded(const JPH::Body& inBody1, const JP
 
   OverrideContactSettings(inBody1, inBody2, inManifold, ioSettings);
 
-  m_Scene->OnContactAdded(inBody1, inBody2, inManifold, ioSettings);
+  Record(CreateEvent(Oxylus::ContactEvent::Phase::Added, inBody1, inBody2, inManifold));
 }
 
 void Physics3DContactListener::OnContactPersisted(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings) {
@@ -112,11 +151,66 @@ void Physics3DContactListener::OnContactPersisted(const JPH::Body& inBody1, cons
 
   OverrideContactSettings(inBody1, inBody2, inManifold, ioSettings);
 
-  m_Scene->OnContactPersisted(inBody1, inBody2, inManifold, ioSettings);
+  Record(CreateEvent(Oxylus::ContactEvent::Phase::Persisted, inBody1, inBody2, inManifold));
 }
 
 void Physics3DContactListener::OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) {
   OX_SCOPED_ZONE;
 
-  /* On Collision Exit */
+  // The bodies may already be gone, their entities are looked up once the event is handed out
+  Oxylus::ContactEvent event;
+  event.Type = Oxylus::ContactEvent::Phase::Removed;
+  event.Body1 = inSubShapePair.GetBody1ID();
+  event.Body2 = inSubShapePair.GetBody2ID();
+  event.SubShape1 = inSubShapePair.GetSubShapeID1();
+  event.SubShape2 = inSubShapePair.GetSubShapeID2();
+  Record(event);
+}
+
+void Physics3DContactListener::TakeEvents(std::vector<Oxylus::ContactEvent>& outEvents) {
+  for (auto& buffer : m_ThreadEvents) {
+    outEvents.insert(outEvents.end(), buffer.Events.begin(), buffer.Events.end());
+    buffer.Events.clear();
+  }
+
+  std::lock_guard lock(m_ForeignMutex);
+  outEvents.insert(outEvents.end(), m_ForeignEvents.begin(), m_ForeignEvents.end());
+  m_ForeignEvents.clear();
+}
+
+void Physics3DContactListener::Record(const Oxylus::ContactEvent& event) {
+  // Called from the physics jobs
+  const uint32_t threadIndex = Oxylus::JobSystem::GetThreadIndex();
+  if (threadIndex < m_ThreadEvents.size()) {
+    m_ThreadEvents[threadIndex].Events.emplace_back(event);
+    return;
+  }
+
+  std::lock_guard lock(m_ForeignMutex);
+  m_ForeignEvents.emplace_back(event);
+}
+
+Oxylus::ContactEvent Physics3DContactListener::CreateEvent(const Oxylus::ContactEvent::Phase phase, const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold) {
+  Oxylus::ContactEvent event;
+  event.Type = phase;
+  event.Body1 = inBody1.GetID();
+  event.Body2 = inBody2.GetID();
+  event.SubShape1 = inManifold.mSubShapeID1;
+  event.SubShape2 = inManifold.mSubShapeID2;
+  // The scene stores the entity of every body in its user data
+  event.Entity1 = static_cast<entt::entity>(inBody1.GetUserData());
+  event.Entity2 = static_cast<entt::entity>(inBody2.GetUserData());
+
+  const JPH::uint pointCount = inManifold.mRelativeContactPointsOn1.size();
+  JPH::RVec3 position = JPH::RVec3::sZero();
+  for (JPH::uint i = 0; i < pointCount; i++)
+    position += inManifold.GetWorldSpaceContactPointOn1(i);
+  if (pointCount > 0)
+    position /= (float)pointCount;
+
+  event.Normal = {inManifold.mWorldSpaceNormal.GetX(), inManifold.mWorldSpaceNormal.GetY(), inManifold.mWorldSpaceNormal.GetZ()};
+  event.Position = {position.GetX(), position.GetY(), position.GetZ()};
+  event.PenetrationDepth = inManifold.mPenetrationDepth;
+  event.PointCount = pointCount;
+  return event;
 }
@@ -1,12 +1,11 @@
 ﻿#pragma once
+#include <mutex>
+#include <vector>
 #include <tracy/Tracy.hpp>
 
+#include "ContactEvent.h"
 #include "JoltBuild.h"
 
-namespace Oxylus {
-  class Scene;
-}
-
 namespace PhysicsLayers {
   static constexpr JPH::ObjectLayer NON_MOVING = 0;
   static constexpr JPH::ObjectLayer MOVING = 1;
@@ -54,16 +53,34 @@ public:
   bool ShouldCollide(JPH::ObjectLayer inLayer1, JPH::BroadPhaseLayer inLayer2) const override;
 };
 
+// Keeps track of the awake bodies so only those have to be synced back to the scene
 class Physics3DBodyActivationListener : public JPH::BodyActivationListener {
 public:
   void OnBodyActivated([[maybe_unused]] const JPH::BodyID& inBodyID, [[maybe_unused]] JPH::uint64 inBodyUserData) override;
 
   void OnBodyDeactivated([[maybe_unused]] const JPH::BodyID& inBodyID, [[maybe_unused]] JPH::uint64 inBodyUserData) override;
+
+  // Awake bodies in no particular order. Bodies wake up and fall asleep while the physics system steps, so this is
+  // only valid in between steps.
+  const std::vector<JPH::BodyID>& GetActiveBodies() const { return m_ActiveBodies; }
+
+  // Appends the bodies that fell asleep since the last call and are still asleep, their last step moved them.
+  void TakeDeactivatedBodies(std::vector<JPH::BodyID>& outBodies);
+
+private:
+  static constexpr uint32_t InvalidSlot = UINT32_MAX;
+  static constexpr uint32_t DeactivatedSlot = UINT32_MAX - 1; // Asleep, but not taken yet
+
+  std::mutex m_Mutex;
+  std::vector<JPH::BodyID> m_ActiveBodies;
+  std::vector<uint32_t> m_ActiveSlots; // Position in m_ActiveBodies, indexed by the index of the body ID
+  std::vector<JPH::BodyID> m_DeactivatedBodies;
 };
 
+// Records contacts while the physics system steps, Scene hands them to the systems afterwards
 class Physics3DContactListener : public JPH::ContactListener {
 public:
-  Physics3DContactListener(Oxylus::Scene* scene) : m_Scene(scene) {}
+  Physics3DContactListener();
   JPH::ValidateResult OnContactValidate(const JPH::Body& inBody1, const JPH::Body& inBody2, JPH::RVec3Arg inBaseOffset, const JPH::CollideShapeResult& inCollisionResult) override;
 
   void OnContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings) override;
@@ -72,8 +89,23 @@ public:
 
   void OnContactRemoved([[maybe_unused]] const JPH::SubShapeIDPair& inSubShapePair) override;
 
+  // Appends the contacts recorded since the last call in no particular order. Only call it in between steps.
+  void TakeEvents(std::vector<Oxylus::ContactEvent>& outEvents);
+
 private:
-  Oxylus::Scene* m_Scene = nullptr;
+  // One buffer per job system thread so recording a contact doesn't take a lock, padded to keep them on their own cache lines
+  struct alignas(64) ThreadEvents {
+    std::vector<Oxylus::ContactEvent> Events;
+  };
+
+  std::vector<ThreadEvents> m_ThreadEvents;
+  // Threads the job system doesn't know about share this one
+  std::mutex m_ForeignMutex;
+  std::vector<Oxylus::ContactEvent> m_ForeignEvents;
+
+  void Record(const Oxylus::ContactEvent& event);
+  static Oxylus::ContactEvent CreateEvent(Oxylus::ContactEvent::Phase phase, const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold);
+
   static void GetFrictionAndRestitution(const JPH::Body& inBody, const JPH::SubShapeID& inSubShapeID, float& outFriction, float& outRestitution);
 
   static void OverrideContactSettings(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings);
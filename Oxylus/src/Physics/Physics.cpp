@@ -1,4 +1,6 @@
 #include "Physics.h"
+#include "JoltJobSystem.h"
+#include "ShapeCache.h"
 
 #include "Core/Base.h"
 #include "Utils/Log.h"
@@ -10,7 +12,7 @@ namespace Oxylus {
   ObjectVsBroadPhaseLayerFilterImpl Physics::s_ObjectVsBroadPhaseLayerFilterInterface;
   ObjectLayerPairFilterImpl Physics::s_ObjectLayerPairFilterInterface;
   JPH::PhysicsSystem* Physics::s_PhysicsSystem = nullptr;
-  JPH::JobSystemThreadPool* Physics::s_JobSystem = nullptr;
+  JoltJobSystem* Physics::s_JobSystem = nullptr;
 
   std::map<Physics::EntityLayer, Physics::EntityLayerData> Physics::LayerCollisionMask =
   {
@@ -37,7 +39,7 @@ namespace Oxylus {
   };
 #endif
 
-  void Physics::Init() {
+  void Physics::Init(const PhysicsConfig& config) {
     // TODO: Override default allocators with Oxylus allocators.
     JPH::RegisterDefaultAllocator();
 
@@ -50,16 +52,15 @@ namespace Oxylus {
     JPH::Factory::sInstance = new JPH::Factory();
     JPH::RegisterTypes();
 
-    s_TempAllocator = new JPH::TempAllocatorImpl(10 * 1024 * 1024);
+    s_TempAllocator = new JPH::TempAllocatorImpl(config.TempAllocatorSize);
 
-    s_JobSystem = new JPH::JobSystemThreadPool();
-    s_JobSystem->Init(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, (int)std::thread::hardware_concurrency() - 1);
+    s_JobSystem = new JoltJobSystem(JPH::cMaxPhysicsBarriers);
     s_PhysicsSystem = new JPH::PhysicsSystem();
     s_PhysicsSystem->Init(
-      MAX_BODIES,
+      config.MaxBodies,
       0,
-      MAX_BODY_PAIRS,
-      MAX_CONTACT_CONSTRAINS,
+      config.MaxBodyPairs,
+      config.MaxContactConstraints,
       s_LayerInterface,
       s_ObjectVsBroadPhaseLayerFilterInterface,
       s_ObjectLayerPairFilterInterface);
@@ -74,6 +75,8 @@ namespace Oxylus {
   }
 
   void Physics::Shutdown() {
+    // Bodies hold references to the shared shapes, so they are freed once the physics system below is gone
+    ShapeCache::Clear();
     JPH::UnregisterTypes();
     delete JPH::Factory::sInstance;
     JPH::Factory::sInstance = nullptr;
@@ -3,8 +3,11 @@
 
 #include "JoltBuild.h"
 #include "PhyiscsInterfaces.h"
+#include "Core/Project.h"
 
 namespace Oxylus {
+  class JoltJobSystem;
+
   class Physics {
   public:
     using EntityLayer = uint16_t;
@@ -17,14 +20,12 @@ namespace Oxylus {
 
     static std::map<EntityLayer, EntityLayerData> LayerCollisionMask;
 
-    static constexpr uint32_t MAX_BODIES = 1024;
-    static constexpr uint32_t MAX_BODY_PAIRS = 1024;
-    static constexpr uint32_t MAX_CONTACT_CONSTRAINS = 1024;
     static BPLayerInterfaceImpl s_LayerInterface;
     static ObjectVsBroadPhaseLayerFilterImpl s_ObjectVsBroadPhaseLayerFilterInterface;
     static ObjectLayerPairFilterImpl s_ObjectLayerPairFilterInterface;
 
-    static void Init();
+    /// The world can't grow past the capacity it is created with.
+    static void Init(const PhysicsConfig& config = {});
     static void Step(float physicsTs);
     static void Shutdown();
 
@@ -34,6 +35,6 @@ namespace Oxylus {
   private:
     static JPH::PhysicsSystem* s_PhysicsSystem;
     static JPH::TempAllocatorImpl* s_TempAllocator;
-    static JPH::JobSystemThreadPool* s_JobSystem;
+    static JoltJobSystem* s_JobSystem;
   };
 }
@@ -0,0 +1,183 @@
+#include "PhysicsQueries.h"
+
+#include <algorithm>
+
+#include "Jolt/Physics/Body/BodyLock.h"
+#include "Jolt/Physics/Collision/CastResult.h"
+#include "Jolt/Physics/Collision/CollideShape.h"
+#include "Jolt/Physics/Collision/CollisionCollectorImpl.h"
+#include "Jolt/Physics/Collision/NarrowPhaseQuery.h"
+#include "Jolt/Physics/Collision/RayCast.h"
+#include "Jolt/Physics/Collision/ShapeCast.h"
+#include "Thread/JobSystem.h"
+#include "Utils/Profiler.h"
+
+namespace Oxylus {
+  static constexpr uint32_t QueryBatchSize = 32;
+
+  /// Accepts the object layers of every entity layer the query layer collides with.
+  class QueryLayerFilter final : public JPH::ObjectLayerFilter {
+  public:
+    explicit QueryLayerFilter(const Physics::EntityLayer layer) {
+      const auto it = Physics::LayerCollisionMask.find(layer);
+      const Physics::EntityLayer flags = it != Physics::LayerCollisionMask.end() ? it->second.Flags : 0xFFFF;
+      for (const auto& [entityLayer, data] : Physics::LayerCollisionMask) {
+        if (flags & entityLayer)
+          m_ObjectLayers |= 1u << data.Index;
+      }
+    }
+
+    bool ShouldCollide(const JPH::ObjectLayer layer) const override {
+      return layer < 32 && (m_ObjectLayers >> layer & 1);
+    }
+
+  private:
+    uint32_t m_ObjectLayers = 0;
+  };
+
+  /// Skips the body of the ignored entity, bodies store their entity in their user data.
+  class QueryBodyFilter final : public JPH::BodyFilter {
+  public:
+    explicit QueryBodyFilter(const entt::entity ignore) : m_Ignore(ignore) { }
+
+    bool ShouldCollideLocked(const JPH::Body& body) const override {
+      return static_cast<entt::entity>(body.GetUserData()) != m_Ignore;
+    }
+
+  private:
+    entt::entity m_Ignore;
+  };
+
+  static JPH::Vec3 ToJolt(const Vec3& v) {
+    return {v.x, v.y, v.z};
+  }
+
+  static Vec3 FromJolt(const JPH::Vec3& v) {
+    return {v.GetX(), v.GetY(), v.GetZ()};
+  }
+
+  static JPH::RMat44 GetWorldTransform(const Vec3& position, const glm::quat& rotation) {
+    return JPH::RMat44::sRotationTranslation({rotation.x, rotation.y, rotation.z, rotation.w}, ToJolt(position));
+  }
+
+  /// Entity of the hit body and its surface normal at the hit position.
+  static void ResolveHit(const JPH::BodyID& body, const JPH::SubShapeID& subShape, PhysicsQueries::CastHit& hit) {
+    const JPH::BodyLockRead lock(Physics::GetPhysicsSystem()->GetBodyLockInterface(), body);
+    if (!lock.Succeeded())
+      return;
+    hit.Entity = static_cast<entt::entity>(lock.GetBody().GetUserData());
+    hit.Normal = FromJolt(lock.GetBody().GetWorldSpaceSurfaceNormal(subShape, ToJolt(hit.Position)));
+  }
+
+  void PhysicsQueries::Raycast(const std::vector<RaycastRequest>& requests, std::vector<CastHit>& hits) {
+    OX_SCOPED_ZONE;
+    hits.assign(requests.size(), {});
+    const JPH::NarrowPhaseQuery& query = Physics::GetPhysicsSystem()->GetNarrowPhaseQuery();
+
+    JobSystem::ParallelFor((uint32_t)requests.size(),
+      QueryBatchSize,
+      [&](const uint32_t index) {
+        const RaycastRequest& request = requests[index];
+        const JPH::RRayCast ray(ToJolt(request.Origin), ToJolt(request.Direction));
+        JPH::RayCastResult result;
+        if (!query.CastRay(ray, result, {}, QueryLayerFilter(request.Filter.Layer), QueryBodyFilter(request.Filter.Ignore)))
+          return;
+
+        CastHit& hit = hits[index];
+        hit.Body = result.mBodyID;
+        hit.Fraction = result.mFraction;
+        hit.Position = FromJolt(ray.GetPointOnRay(result.mFraction));
+        ResolveHit(result.mBodyID, result.mSubShapeID2, hit);
+      });
+  }
+
+  void PhysicsQueries::ShapeCast(const std::vector<ShapeCastRequest>& requests, std::vector<CastHit>& hits) {
+    OX_SCOPED_ZONE;
+    hits.assign(requests.size(), {});
+    const JPH::NarrowPhaseQuery& query = Physics::GetPhysicsSystem()->GetNarrowPhaseQuery();
+
+    JobSystem::ParallelFor((uint32_t)requests.size(),
+      QueryBatchSize,
+      [&](const uint32_t index) {
+        const ShapeCastRequest& request = requests[index];
+        if (!request.Shape)
+          return;
+
+        const JPH::RShapeCast cast = JPH::RShapeCast::sFromWorldTransform(request.Shape,
+          JPH::Vec3::sReplicate(1.0f),
+          GetWorldTransform(request.Position, request.Rotation),
+          ToJolt(request.Direction));
+        JPH::ShapeCastSettings settings;
+        settings.mReturnDeepestPoint = true;
+        JPH::ClosestHitCollisionCollector<JPH::CastShapeCollector> collector;
+        query.CastShape(cast, settings, JPH::RVec3::sZero(), collector, {}, QueryLayerFilter(request.Filter.Layer), QueryBodyFilter(request.Filter.Ignore));
+        if (!collector.HadHit())
+          return;
+
+        const JPH::ShapeCastResult& result = collector.mHit;
+        CastHit& hit = hits[index];
+        hit.Body = result.mBodyID2;
+        hit.Fraction = result.mFraction;
+        hit.Position = FromJolt(result.mContactPointOn2);
+        hit.PenetrationDepth = result.mPenetrationDepth;
+        ResolveHit(result.mBodyID2, result.mSubShapeID2, hit);
+      });
+  }
+
+  void PhysicsQueries::Overlap(const std::vector<OverlapRequest>& requests, std::vector<OverlapResult>& results, std::vector<OverlapHit>& hits) {
+    OX_SCOPED_ZONE;
+    results.assign(requests.size(), {});
+    hits.clear();
+    const JPH::PhysicsSystem* physicsSystem = Physics::GetPhysicsSystem();
+    const JPH::NarrowPhaseQuery& query = physicsSystem->GetNarrowPhaseQuery();
+
+    // Every thread collects its hits on its own, the ranges are made global once all requests are done. The last
+    // buffer belongs to the calling thread if the job system doesn't own it.
+    std::vector<std::vector<OverlapHit>> threadHits(JobSystem::GetThreadCount() + 1);
+    std::vector<uint32_t> resultThreads(requests.size(), 0);
+    JobSystem::ParallelFor((uint32_t)requests.size(),
+      QueryBatchSize,
+      [&](const uint32_t index) {
+        const OverlapRequest& request = requests[index];
+        if (!request.Shape)
+          return;
+
+        JPH::CollideShapeSettings settings;
+        JPH::AllHitCollisionCollector<JPH::CollideShapeCollector> collector;
+        query.CollideShape(request.Shape,
+          JPH::Vec3::sReplicate(1.0f),
+          GetWorldTransform(request.Position, request.Rotation).PreTranslated(request.Shape->GetCenterOfMass()),
+          settings,
+          JPH::RVec3::sZero(),
+          collector,
+          {},
+          QueryLayerFilter(request.Filter.Layer),
+          QueryBodyFilter(request.Filter.Ignore));
+
+        std::vector<JPH::BodyID> bodies;
+        bodies.reserve(collector.mHits.size());
+        for (const auto& result : collector.mHits)
+          bodies.emplace_back(result.mBodyID2);
+        std::sort(bodies.begin(), bodies.end());
+        bodies.erase(std::unique(bodies.begin(), bodies.end()), bodies.end());
+
+        const uint32_t threadIndex = JobSystem::GetThreadIndex();
+        const uint32_t thread = threadIndex < JobSystem::GetThreadCount() ? threadIndex : (uint32_t)threadHits.size() - 1;
+        auto& output = threadHits[thread];
+        resultThreads[index] = thread;
+        results[index] = {(uint32_t)output.size(), (uint32_t)bodies.size()};
+        for (const auto& body : bodies) {
+          const JPH::BodyLockRead lock(physicsSystem->GetBodyLockInterface(), body);
+          output.emplace_back(OverlapHit{lock.Succeeded() ? static_cast<entt::entity>(lock.GetBody().GetUserData()) : entt::entity(entt::null), body});
+        }
+      });
+
+    std::vector<uint32_t> threadOffsets(threadHits.size(), 0);
+    for (uint32_t thread = 0; thread < (uint32_t)threadHits.size(); thread++) {
+      threadOffsets[thread] = (uint32_t)hits.size();
+      hits.insert(hits.end(), threadHits[thread].begin(), threadHits[thread].end());
+    }
+    for (uint32_t index = 0; index < (uint32_t)results.size(); index++)
+      results[index].FirstHit += threadOffsets[resultThreads[index]];
+  }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <entt/entity/entity.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Physics.h"
+#include "Core/Base.h"
+#include "Core/Types.h"
+
+namespace Oxylus {
+  /// Batched spatial queries against the physics world. Every batch is spread over the job system and waited for, hits
+  /// name the entity of the body they hit. Queries read the world, so they can't run while the physics system steps.
+  class PhysicsQueries {
+  public:
+    /// What a query can hit, tested like a body of the given layer would be through Physics::LayerCollisionMask.
+    struct QueryFilter {
+      Physics::EntityLayer Layer = BIT(1); // Default layer
+      entt::entity Ignore = entt::null;    // Usually the entity issuing the query
+    };
+
+    struct RaycastRequest {
+      Vec3 Origin = {};
+      Vec3 Direction = {}; // Its length is the distance the ray goes
+      QueryFilter Filter = {};
+    };
+
+    struct ShapeCastRequest {
+      const JPH::Shape* Shape = nullptr;
+      Vec3 Position = {};
+      glm::quat Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+      Vec3 Direction = {}; // Its length is the distance the shape is moved
+      QueryFilter Filter = {};
+    };
+
+    struct OverlapRequest {
+      const JPH::Shape* Shape = nullptr;
+      Vec3 Position = {};
+      glm::quat Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+      QueryFilter Filter = {};
+    };
+
+    /// Closest hit of a ray or shape cast. Casts that hit nothing have a null entity.
+    struct CastHit {
+      entt::entity Entity = entt::null;
+      JPH::BodyID Body;
+      Vec3 Position = {};
+      Vec3 Normal = {};      // Surface normal of the hit body
+      float Fraction = 1.0f; // How far along the direction the hit is
+      float PenetrationDepth = 0.0f;
+
+      bool HasHit() const { return !Body.IsInvalid(); }
+    };
+
+    /// Bodies an overlap request touches, a range of the hits the batch wrote.
+    struct OverlapResult {
+      uint32_t FirstHit = 0;
+      uint32_t HitCount = 0;
+    };
+
+    struct OverlapHit {
+      entt::entity Entity = entt::null;
+      JPH::BodyID Body;
+    };
+
+    /// Writes the closest hit of every ray into `hits`, which is resized to the request count.
+    static void Raycast(const std::vector<RaycastRequest>& requests, std::vector<CastHit>& hits);
+    /// Same as Raycast for shapes swept along their direction.
+    static void ShapeCast(const std::vector<ShapeCastRequest>& requests, std::vector<CastHit>& hits);
+    /// Finds every body each shape overlaps. A body is listed once per request no matter how many of its sub shapes
+    /// are touched.
+    static void Overlap(const std::vector<OverlapRequest>& requests, std::vector<OverlapResult>& results, std::vector<OverlapHit>& hits);
+  };
+}
@@ -0,0 +1,172 @@
+#include "ShapeCache.h"
+
+#include <cstring>
+#include <fmt/format.h>
+
+#include "Jolt/Physics/Collision/Shape/CapsuleShape.h"
+#include "Jolt/Physics/Collision/Shape/CylinderShape.h"
+#include "Jolt/Physics/Collision/Shape/MutableCompoundShape.h"
+#include "Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h"
+#include "Jolt/Physics/Collision/Shape/StaticCompoundShape.h"
+#include "Jolt/Physics/Collision/Shape/TaperedCapsuleShape.h"
+#include "Utils/Log.h"
+#include "Utils/Profiler.h"
+
+namespace Oxylus {
+  // Descriptions are hashed by their bytes
+  static_assert(sizeof(ColliderDescription) == sizeof(uint32_t) + sizeof(float) * 9);
+
+  std::mutex ShapeCache::s_Mutex;
+  std::unordered_map<std::string, JPH::RefConst<JPH::Shape>> ShapeCache::s_Shapes;
+  std::unordered_map<uint64_t, JPH::RefConst<PhysicsMaterial3D>> ShapeCache::s_Materials;
+
+  static constexpr float ConvexRadius = 0.05f;
+
+  /// Adding zero turns -0 into 0, so both give the same key.
+  static ColliderDescription Normalize(ColliderDescription collider) {
+    collider.Dimensions += 0.0f;
+    collider.Offset += 0.0f;
+    collider.Density += 0.0f;
+    collider.Friction += 0.0f;
+    collider.Restitution += 0.0f;
+    return collider;
+  }
+
+  static JPH::RefConst<JPH::Shape> GetResult(const JPH::ShapeSettings::ShapeResult& result) {
+    if (result.HasError()) {
+      OX_CORE_ERROR("Couldn't create a collision shape: {}", result.GetError().c_str());
+      return nullptr;
+    }
+    return result.Get();
+  }
+
+  JPH::RefConst<JPH::Shape> ShapeCache::GetShape(const ColliderDescription* colliders, const uint32_t count) {
+    OX_SCOPED_ZONE;
+    std::string key(count * sizeof(ColliderDescription), '\0');
+    for (uint32_t i = 0; i < count; i++) {
+      const ColliderDescription collider = Normalize(colliders[i]);
+      std::memcpy(key.data() + i * sizeof(ColliderDescription), &collider, sizeof(ColliderDescription));
+    }
+
+    {
+      std::lock_guard lock(s_Mutex);
+      const auto it = s_Shapes.find(key);
+      if (it != s_Shapes.end())
+        return it->second;
+    }
+
+    // Two threads may create the same shape at once, the first one to finish is kept
+    const JPH::RefConst<JPH::Shape> shape = CreateShape(colliders, count);
+    if (!shape)
+      return nullptr;
+
+    std::lock_guard lock(s_Mutex);
+    return s_Shapes.try_emplace(std::move(key), shape).first->second;
+  }
+
+  JPH::RefConst<PhysicsMaterial3D> ShapeCache::GetMaterial(float friction, float restitution) {
+    friction += 0.0f;
+    restitution += 0.0f;
+    uint32_t frictionBits, restitutionBits;
+    std::memcpy(&frictionBits, &friction, sizeof(float));
+    std::memcpy(&restitutionBits, &restitution, sizeof(float));
+    const uint64_t key = (uint64_t)frictionBits << 32 | restitutionBits;
+
+    std::lock_guard lock(s_Mutex);
+    auto& material = s_Materials[key];
+    if (!material)
+      material = new PhysicsMaterial3D(fmt::format("Friction {} Restitution {}", friction, restitution), JPH::ColorArg(255, 0, 0), friction, restitution);
+    return material;
+  }
+
+  uint32_t ShapeCache::GetShapeCount() {
+    std::lock_guard lock(s_Mutex);
+    return (uint32_t)s_Shapes.size();
+  }
+
+  uint32_t ShapeCache::GetMaterialCount() {
+    std::lock_guard lock(s_Mutex);
+    return (uint32_t)s_Materials.size();
+  }
+
+  uint64_t ShapeCache::GetShapeMemory() {
+    std::lock_guard lock(s_Mutex);
+    JPH::Shape::VisitedShapes visited;
+    JPH::Shape::StatsRecursive stats;
+    for (const auto& [key, shape] : s_Shapes)
+      shape->GetStatsRecursive(stats, visited);
+    return stats.mSizeBytes;
+  }
+
+  void ShapeCache::Clear() {
+    std::lock_guard lock(s_Mutex);
+    s_Shapes.clear();
+    s_Materials.clear();
+  }
+
+  JPH::RefConst<JPH::Shape> ShapeCache::CreateShape(const ColliderDescription* colliders, const uint32_t count) {
+    // Jolt's static compounds need two sub shapes, a body without colliders keeps getting an empty mutable one
+    if (count == 0)
+      return GetResult(JPH::MutableCompoundShapeSettings().Create());
+
+    if (count == 1) {
+      const ColliderDescription& collider = colliders[0];
+      if (collider.Offset == Vec3(0.0f))
+        return CreateColliderShape(collider);
+
+      // The untranslated shape is shared with every other body using it
+      ColliderDescription centered = collider;
+      centered.Offset = Vec3(0.0f);
+      const JPH::RefConst<JPH::Shape> shape = GetShape(&centered, 1);
+      if (!shape)
+        return nullptr;
+      const JPH::RotatedTranslatedShapeSettings settings({collider.Offset.x, collider.Offset.y, collider.Offset.z}, JPH::Quat::sIdentity(), shape);
+      return GetResult(settings.Create());
+    }
+
+    JPH::StaticCompoundShapeSettings settings;
+    for (uint32_t i = 0; i < count; i++) {
+      ColliderDescription centered = colliders[i];
+      centered.Offset = Vec3(0.0f);
+      const JPH::RefConst<JPH::Shape> shape = GetShape(&centered, 1);
+      if (!shape)
+        return nullptr;
+      settings.AddShape({colliders[i].Offset.x, colliders[i].Offset.y, colliders[i].Offset.z}, JPH::Quat::sIdentity(), shape);
+    }
+    return GetResult(settings.Create());
+  }
+
+  JPH::RefConst<JPH::Shape> ShapeCache::CreateColliderShape(const ColliderDescription& collider) {
+    const JPH::RefConst<PhysicsMaterial3D> material = GetMaterial(collider.Friction, collider.Restitution);
+    const Vec3& size = collider.Dimensions;
+
+    switch (collider.ShapeType) {
+      case ColliderDescription::Type::Box: {
+        JPH::BoxShapeSettings settings({size.x, size.y, size.z}, ConvexRadius, material);
+        settings.SetDensity(collider.Density);
+        return GetResult(settings.Create());
+      }
+      case ColliderDescription::Type::Sphere: {
+        JPH::SphereShapeSettings settings(size.x, material);
+        settings.SetDensity(collider.Density);
+        return GetResult(settings.Create());
+      }
+      case ColliderDescription::Type::Capsule: {
+        JPH::CapsuleShapeSettings settings(size.x, size.y, material);
+        settings.SetDensity(collider.Density);
+        return GetResult(settings.Create());
+      }
+      case ColliderDescription::Type::TaperedCapsule: {
+        JPH::TaperedCapsuleShapeSettings settings(size.x, size.y, size.z, material);
+        settings.SetDensity(collider.Density);
+        return GetResult(settings.Create());
+      }
+      case ColliderDescription::Type::Cylinder: {
+        JPH::CylinderShapeSettings settings(size.x, size.y, ConvexRadius, material);
+        settings.SetDensity(collider.Density);
+        return GetResult(settings.Create());
+      }
+    }
+    return nullptr;
+  }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "JoltBuild.h"
+#include "PhysicsMaterial.h"
+#include "Core/Types.h"
+
+namespace Oxylus {
+  /// One collider of a body with its scale already applied. Colliders with equal descriptions create equal shapes.
+  struct ColliderDescription {
+    enum class Type : uint32_t {
+      Box,
+      Sphere,
+      Capsule,
+      TaperedCapsule,
+      Cylinder,
+    };
+
+    Type ShapeType = Type::Box;
+    /// Box: half extents. Sphere: radius. Capsule and cylinder: half height, radius.
+    /// Tapered capsule: half height, top radius, bottom radius.
+    Vec3 Dimensions = {};
+    Vec3 Offset = {};
+    float Density = 1.0f;
+    float Friction = 0.5f;
+    float Restitution = 0.0f;
+  };
+
+  /// Shares collision shapes and physics materials between bodies with identical colliders, so a level full of the
+  /// same crate only has one crate shape. Entries live until Clear, which the physics system calls on shutdown.
+  /// Thread safe, bodies are built on the job system.
+  class ShapeCache {
+  public:
+    /// Shape of a body made of the given colliders. A single collider is used directly, or translated by its offset,
+    /// instead of being wrapped in a compound.
+    static JPH::RefConst<JPH::Shape> GetShape(const ColliderDescription* colliders, uint32_t count);
+    static JPH::RefConst<PhysicsMaterial3D> GetMaterial(float friction, float restitution);
+
+    static uint32_t GetShapeCount();
+    static uint32_t GetMaterialCount();
+    /// Bytes the cached shapes take up, shapes shared by several bodies only count once.
+    static uint64_t GetShapeMemory();
+
+    static void Clear();
+
+  private:
+    static std::mutex s_Mutex;
+    static std::unordered_map<std::string, JPH::RefConst<JPH::Shape>> s_Shapes;
+    static std::unordered_map<uint64_t, JPH::RefConst<PhysicsMaterial3D>> s_Materials;
+
+    static JPH::RefConst<JPH::Shape> CreateShape(const ColliderDescription* colliders, uint32_t count);
+    static JPH::RefConst<JPH::Shape> CreateColliderShape(const ColliderDescription& collider);
+  };
+}
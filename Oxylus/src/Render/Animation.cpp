@@ -0,0 +1,206 @@
+#include "Animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Utils/Log.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OX_ANIMATION_SSE 1
+#include <xmmintrin.h>
+#else
+#define OX_ANIMATION_SSE 0
+#endif
+
+namespace Oxylus {
+  // result = a + (b - a) * weight for `count` floats, a multiple of four
+  static void Lerp(const float* a, const float* b, const float weight, float* result, const uint32_t count) {
+#if OX_ANIMATION_SSE
+    const __m128 w = _mm_set1_ps(weight);
+    for (uint32_t i = 0; i < count; i += 4) {
+      const __m128 va = _mm_loadu_ps(a + i);
+      const __m128 vb = _mm_loadu_ps(b + i);
+      _mm_storeu_ps(result + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), w)));
+    }
+#else
+    for (uint32_t i = 0; i < count; i++)
+      result[i] = a[i] + (b[i] - a[i]) * weight;
+#endif
+  }
+
+  // Normalized linear interpolation of the rotation streams. With `shortestPath` every rotation of `b` is flipped into
+  // the hemisphere of the one in `a` first, clip frames already are.
+  static void Nlerp(const float* a, const float* b, const float weight, float* result, const uint32_t stride, const bool shortestPath) {
+#if OX_ANIMATION_SSE
+    const __m128 w = _mm_set1_ps(weight);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    for (uint32_t i = 0; i < stride; i += 4) {
+      __m128 va[4], vb[4];
+      for (uint32_t c = 0; c < 4; c++) {
+        va[c] = _mm_loadu_ps(a + c * stride + i);
+        vb[c] = _mm_loadu_ps(b + c * stride + i);
+      }
+      if (shortestPath) {
+        const __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(va[0], vb[0]), _mm_mul_ps(va[1], vb[1])),
+                                      _mm_add_ps(_mm_mul_ps(va[2], vb[2]), _mm_mul_ps(va[3], vb[3])));
+        const __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), signBit);
+        for (auto& component : vb)
+          component = _mm_xor_ps(component, flip);
+      }
+      __m128 lengthSquared = zero;
+      for (uint32_t c = 0; c < 4; c++) {
+        va[c] = _mm_add_ps(va[c], _mm_mul_ps(_mm_sub_ps(vb[c], va[c]), w));
+        lengthSquared = _mm_add_ps(lengthSquared, _mm_mul_ps(va[c], va[c]));
+      }
+      const __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(lengthSquared, _mm_set1_ps(1e-12f))));
+      for (uint32_t c = 0; c < 4; c++)
+        _mm_storeu_ps(result + c * stride + i, _mm_mul_ps(va[c], inverseLength));
+    }
+#else
+    for (uint32_t i = 0; i < stride; i++) {
+      float sign = 1.0f;
+      if (shortestPath) {
+        float dot = 0.0f;
+        for (uint32_t c = 0; c < 4; c++)
+          dot += a[c * stride + i] * b[c * stride + i];
+        sign = dot < 0.0f ? -1.0f : 1.0f;
+      }
+      float q[4];
+      float lengthSquared = 0.0f;
+      for (uint32_t c = 0; c < 4; c++) {
+        q[c] = a[c * stride + i] + (sign * b[c * stride + i] - a[c * stride + i]) * weight;
+        lengthSquared += q[c] * q[c];
+      }
+      const float inverseLength = 1.0f / std::sqrt(std::max(lengthSquared, 1e-12f));
+      for (uint32_t c = 0; c < 4; c++)
+        result[c * stride + i] = q[c] * inverseLength;
+    }
+#endif
+  }
+
+  void Pose::Resize(const uint32_t jointCount) {
+    m_JointCount = jointCount;
+    m_Stride = (jointCount + 3) & ~3u;
+    m_Data.assign((size_t)m_Stride * StreamCount, 0.0f);
+    std::fill_n(GetStream(RotationW), m_Stride, 1.0f);
+    for (const Stream stream : {ScaleX, ScaleY, ScaleZ})
+      std::fill_n(GetStream(stream), m_Stride, 1.0f);
+  }
+
+  void Pose::SetJoint(const uint32_t joint, const Vec3& translation, const glm::quat& rotation, const Vec3& scale) {
+    const float values[StreamCount] = {
+      translation.x, translation.y, translation.z,
+      rotation.x, rotation.y, rotation.z, rotation.w,
+      scale.x, scale.y, scale.z
+    };
+    for (uint32_t stream = 0; stream < StreamCount; stream++)
+      m_Data[stream * m_Stride + joint] = values[stream];
+  }
+
+  Mat4 Pose::GetLocalMatrix(const uint32_t joint) const {
+    const auto value = [this, joint](const Stream stream) { return m_Data[stream * m_Stride + joint]; };
+    const glm::quat rotation = glm::quat(value(RotationW), value(RotationX), value(RotationY), value(RotationZ));
+    Mat4 matrix = Mat4(glm::mat3_cast(rotation));
+    matrix[0] *= value(ScaleX);
+    matrix[1] *= value(ScaleY);
+    matrix[2] *= value(ScaleZ);
+    matrix[3] = Vec4(value(TranslationX), value(TranslationY), value(TranslationZ), 1.0f);
+    return matrix;
+  }
+
+  void Pose::Blend(const Pose& a, const Pose& b, const float weight, Pose& result) {
+    OX_CORE_ASSERT(a.m_Stride == b.m_Stride && a.m_Stride == result.m_Stride);
+    const uint32_t stride = a.m_Stride;
+    Lerp(a.GetStream(TranslationX), b.GetStream(TranslationX), weight, result.GetStream(TranslationX), stride * 3);
+    Nlerp(a.GetStream(RotationX), b.GetStream(RotationX), weight, result.GetStream(RotationX), stride, true);
+    Lerp(a.GetStream(ScaleX), b.GetStream(ScaleX), weight, result.GetStream(ScaleX), stride * 3);
+  }
+
+  void Skeleton::ComputeSkinningMatrices(const Pose& pose, Mat4* matrices) const {
+    // Parents come first, so their global transforms are done by the time their children need them
+    const uint32_t jointCount = GetJointCount();
+    for (uint32_t joint = 0; joint < jointCount; joint++) {
+      const Mat4 local = pose.GetLocalMatrix(joint);
+      matrices[joint] = Parents[joint] < 0 ? RootTransforms[joint] * local : matrices[Parents[joint]] * local;
+    }
+    for (uint32_t joint = 0; joint < jointCount; joint++)
+      matrices[joint] *= InverseBindMatrices[joint];
+  }
+
+  AABB Skeleton::ComputeBounds(const Mat4* skinningMatrices) const {
+    // Skinned vertices are weighted averages of their joints' transforms, so they stay inside the union of the boxes
+    AABB bounds;
+    for (uint32_t joint = 0; joint < GetJointCount(); joint++) {
+      if (JointBounds[joint].IsValid())
+        bounds.Merge(JointBounds[joint].Transform(skinningMatrices[joint]));
+    }
+    return bounds;
+  }
+
+  void AnimationClip::Create(const float duration, const uint32_t jointCount) {
+    Duration = std::max(duration, 0.0f);
+    m_JointCount = jointCount;
+    m_Stride = (jointCount + 3) & ~3u;
+    m_FrameCount = (uint32_t)std::ceil(Duration * SampleRate) + 1;
+    m_Frames.assign((size_t)m_FrameCount * m_Stride * Pose::StreamCount, 0.0f);
+  }
+
+  void AnimationClip::SetFrame(const uint32_t frame, const Pose& pose) {
+    OX_CORE_ASSERT(pose.GetStride() == m_Stride && frame < m_FrameCount);
+    const size_t frameSize = (size_t)m_Stride * Pose::StreamCount;
+    float* data = m_Frames.data() + frame * frameSize;
+    std::copy_n(pose.GetData(), frameSize, data);
+    if (frame == 0)
+      return;
+
+    // Interpolating neighbouring frames then never has to check which way around the rotations are shorter
+    const float* previous = data - frameSize;
+    float* rotations = data + Pose::RotationX * m_Stride;
+    const float* previousRotations = previous + Pose::RotationX * m_Stride;
+    for (uint32_t joint = 0; joint < m_Stride; joint++) {
+      float dot = 0.0f;
+      for (uint32_t c = 0; c < 4; c++)
+        dot += rotations[c * m_Stride + joint] * previousRotations[c * m_Stride + joint];
+      if (dot >= 0.0f)
+        continue;
+      for (uint32_t c = 0; c < 4; c++)
+        rotations[c * m_Stride + joint] = -rotations[c * m_Stride + joint];
+    }
+  }
+
+  float AnimationClip::GetFrameTime(const uint32_t frame) const {
+    return std::min((float)frame / SampleRate, Duration);
+  }
+
+  void AnimationClip::Sample(float time, const bool loop, Pose& pose) const {
+    OX_CORE_ASSERT(pose.GetStride() == m_Stride);
+    if (!m_FrameCount)
+      return;
+
+    if (loop && Duration > 0.0f) {
+      time = std::fmod(time, Duration);
+      if (time < 0.0f)
+        time += Duration;
+    }
+    else {
+      time = std::clamp(time, 0.0f, Duration);
+    }
+
+    // The last interval is shorter when the clip doesn't end on a frame
+    const uint32_t first = std::min((uint32_t)(time * SampleRate), m_FrameCount - 1);
+    const uint32_t second = std::min(first + 1, m_FrameCount - 1);
+    const float span = GetFrameTime(second) - GetFrameTime(first);
+    const float weight = span > 0.0f ? std::clamp((time - GetFrameTime(first)) / span, 0.0f, 1.0f) : 0.0f;
+
+    const size_t frameSize = (size_t)m_Stride * Pose::StreamCount;
+    const float* a = m_Frames.data() + first * frameSize;
+    const float* b = m_Frames.data() + second * frameSize;
+    float* result = pose.GetData();
+    Lerp(a, b, weight, result, m_Stride * 3);
+    Nlerp(a + Pose::RotationX * m_Stride, b + Pose::RotationX * m_Stride, weight, result + Pose::RotationX * m_Stride, m_Stride, false);
+    Lerp(a + Pose::ScaleX * m_Stride, b + Pose::ScaleX * m_Stride, weight, result + Pose::ScaleX * m_Stride, m_Stride * 3);
+  }
+}
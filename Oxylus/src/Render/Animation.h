@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Core/Types.h"
+#include "Render/Frustum.h"
+
+namespace Oxylus {
+  /// Local transforms of the joints of a skeleton. Every component of every joint has its own stream of floats, so
+  /// poses are sampled and blended four joints at a time.
+  class Pose {
+  public:
+    enum Stream : uint32_t {
+      TranslationX, TranslationY, TranslationZ,
+      RotationX, RotationY, RotationZ, RotationW,
+      ScaleX, ScaleY, ScaleZ,
+      StreamCount
+    };
+
+    /// Padding joints are identity transforms so they can be processed like the others.
+    void Resize(uint32_t jointCount);
+
+    uint32_t GetJointCount() const { return m_JointCount; }
+    /// Floats per stream, the joint count rounded up to a multiple of four.
+    uint32_t GetStride() const { return m_Stride; }
+
+    float* GetData() { return m_Data.data(); }
+    const float* GetData() const { return m_Data.data(); }
+    uint32_t GetSize() const { return (uint32_t)m_Data.size(); }
+    float* GetStream(const Stream stream) { return m_Data.data() + stream * m_Stride; }
+    const float* GetStream(const Stream stream) const { return m_Data.data() + stream * m_Stride; }
+
+    void SetJoint(uint32_t joint, const Vec3& translation, const glm::quat& rotation, const Vec3& scale);
+    Mat4 GetLocalMatrix(uint32_t joint) const;
+
+    /// Interpolates from `a` towards `b`, rotations take the shorter way. All three poses have the same joint count.
+    static void Blend(const Pose& a, const Pose& b, float weight, Pose& result);
+
+  private:
+    std::vector<float> m_Data;
+    uint32_t m_JointCount = 0;
+    uint32_t m_Stride = 0;
+  };
+
+  /// Joints of a skin, ordered so every joint comes after its parent.
+  struct Skeleton {
+    std::string Name;
+    std::vector<int32_t> Parents;          // -1 for root joints
+    std::vector<Mat4> InverseBindMatrices;
+    std::vector<Mat4> RootTransforms;      // Nodes above each root joint that aren't joints themselves, unused for other joints
+    std::vector<uint32_t> JointNodes;      // Index of the node of every joint in the mesh file
+    std::vector<AABB> JointBounds;         // Bind pose vertices each joint moves, invalid for joints without any
+    Pose RestPose;
+    AABB Bounds;                           // Skinned vertices in the rest pose and every frame of the clips of the skin
+
+    uint32_t GetJointCount() const { return (uint32_t)Parents.size(); }
+
+    /// Global joint transforms times the inverse bind matrices, which is what vertices are skinned with.
+    void ComputeSkinningMatrices(const Pose& pose, Mat4* matrices) const;
+    /// Bounds of the vertices skinned with the given matrices.
+    AABB ComputeBounds(const Mat4* skinningMatrices) const;
+  };
+
+  /// Joint animation of one skin. Clips are resampled at a fixed rate when they are loaded, so sampling interpolates
+  /// two neighbouring frames without searching keys. Frames are stored one after the other in the layout of Pose, with
+  /// the rotations of every frame in the same hemisphere as the ones of the frame before.
+  class AnimationClip {
+  public:
+    static constexpr float SampleRate = 30.0f;
+
+    std::string Name;
+    int32_t SkinIndex = -1;
+    float Duration = 0.0f;
+
+    /// Makes room for the frames of a clip of the given length.
+    void Create(float duration, uint32_t jointCount);
+    /// Frames have to be set in order, each one is flipped into the hemispheres of the one before.
+    void SetFrame(uint32_t frame, const Pose& pose);
+
+    /// Time of the frame in seconds, the last frame is at the end of the clip.
+    float GetFrameTime(uint32_t frame) const;
+    uint32_t GetFrameCount() const { return m_FrameCount; }
+    uint32_t GetJointCount() const { return m_JointCount; }
+    uint32_t GetStride() const { return m_Stride; }
+    std::vector<float>& GetFrames() { return m_Frames; }
+    const std::vector<float>& GetFrames() const { return m_Frames; }
+
+    /// The pose has to be sized for the clip's skin. Times outside the clip wrap around if `loop` is set and are
+    /// clamped otherwise.
+    void Sample(float time, bool loop, Pose& pose) const;
+
+  private:
+    std::vector<float> m_Frames;
+    uint32_t m_FrameCount = 0;
+    uint32_t m_JointCount = 0;
+    uint32_t m_Stride = 0;
+  };
+}
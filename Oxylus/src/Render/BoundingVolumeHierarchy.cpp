@@ -0,0 +1,259 @@
+#include "BoundingVolumeHierarchy.h"
+
+#include "Utils/Log.h"
+#include "Utils/Profiler.h"
+
+namespace Oxylus {
+  int32_t BoundingVolumeHierarchy::CreateProxy(const AABB& aabb, uint32_t userData) {
+    const int32_t proxyId = AllocateNode();
+    m_Nodes[proxyId].Bounds = aabb.Expanded(Margin);
+    m_Nodes[proxyId].UserData = userData;
+    m_Nodes[proxyId].Height = 0;
+    InsertLeaf(proxyId);
+    m_ProxyCount++;
+    return proxyId;
+  }
+
+  void BoundingVolumeHierarchy::DestroyProxy(int32_t proxyId) {
+    OX_CORE_ASSERT(m_Nodes[proxyId].IsLeaf());
+    RemoveLeaf(proxyId);
+    FreeNode(proxyId);
+    m_ProxyCount--;
+  }
+
+  bool BoundingVolumeHierarchy::MoveProxy(int32_t proxyId, const AABB& aabb) {
+    OX_CORE_ASSERT(m_Nodes[proxyId].IsLeaf());
+    if (m_Nodes[proxyId].Bounds.Contains(aabb))
+      return false;
+
+    RemoveLeaf(proxyId);
+    m_Nodes[proxyId].Bounds = aabb.Expanded(Margin);
+    InsertLeaf(proxyId);
+    return true;
+  }
+
+  void BoundingVolumeHierarchy::Clear() {
+    m_Nodes.clear();
+    m_Root = NullNode;
+    m_FreeList = NullNode;
+    m_ProxyCount = 0;
+  }
+
+  void BoundingVolumeHierarchy::Query(const Frustum& frustum, std::vector<uint32_t>& outUserData) const {
+    OX_SCOPED_ZONE;
+    if (m_Root == NullNode)
+      return;
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(m_Root);
+    while (!stack.empty()) {
+      const int32_t index = stack.back();
+      stack.pop_back();
+
+      const Node& node = m_Nodes[index];
+      switch (frustum.Intersect(node.Bounds)) {
+        case FrustumIntersection::Outside: break;
+        case FrustumIntersection::Inside: CollectLeaves(index, outUserData);
+          break;
+        case FrustumIntersection::Intersects:
+          if (node.IsLeaf()) {
+            outUserData.push_back(node.UserData);
+          }
+          else {
+            stack.push_back(node.Left);
+            stack.push_back(node.Right);
+          }
+          break;
+      }
+    }
+  }
+
+  void BoundingVolumeHierarchy::CollectLeaves(int32_t node, std::vector<uint32_t>& outUserData) const {
+    if (m_Nodes[node].IsLeaf()) {
+      outUserData.push_back(m_Nodes[node].UserData);
+      return;
+    }
+    CollectLeaves(m_Nodes[node].Left, outUserData);
+    CollectLeaves(m_Nodes[node].Right, outUserData);
+  }
+
+  int32_t BoundingVolumeHierarchy::AllocateNode() {
+    if (m_FreeList == NullNode) {
+      m_Nodes.emplace_back();
+      return (int32_t)m_Nodes.size() - 1;
+    }
+
+    const int32_t node = m_FreeList;
+    m_FreeList = m_Nodes[node].Parent;
+    m_Nodes[node] = Node{};
+    return node;
+  }
+
+  void BoundingVolumeHierarchy::FreeNode(int32_t node) {
+    m_Nodes[node].Parent = m_FreeList;
+    m_Nodes[node].Height = -1;
+    m_FreeList = node;
+  }
+
+  void BoundingVolumeHierarchy::InsertLeaf(int32_t leaf) {
+    if (m_Root == NullNode) {
+      m_Root = leaf;
+      m_Nodes[leaf].Parent = NullNode;
+      return;
+    }
+
+    // Find the best sibling by the surface area heuristic
+    const AABB leafBounds = m_Nodes[leaf].Bounds;
+    int32_t index = m_Root;
+    while (!m_Nodes[index].IsLeaf()) {
+      const Node& node = m_Nodes[index];
+      const float area = node.Bounds.GetSurfaceArea();
+      const float combinedArea = AABB::Merge(node.Bounds, leafBounds).GetSurfaceArea();
+
+      // Cost of making a new parent for this node and the new leaf
+      const float cost = 2.0f * combinedArea;
+      // Minimum cost of pushing the leaf further down the tree
+      const float inheritanceCost = 2.0f * (combinedArea - area);
+
+      const auto descendCost = [&](int32_t child) {
+        const AABB merged = AABB::Merge(leafBounds, m_Nodes[child].Bounds);
+        if (m_Nodes[child].IsLeaf())
+          return merged.GetSurfaceArea() + inheritanceCost;
+        return merged.GetSurfaceArea() - m_Nodes[child].Bounds.GetSurfaceArea() + inheritanceCost;
+      };
+
+      const float leftCost = descendCost(node.Left);
+      const float rightCost = descendCost(node.Right);
+      if (cost < leftCost && cost < rightCost)
+        break;
+
+      index = leftCost < rightCost ? node.Left : node.Right;
+    }
+
+    const int32_t sibling = index;
+    const int32_t oldParent = m_Nodes[sibling].Parent;
+    const int32_t newParent = AllocateNode();
+    m_Nodes[newParent].Parent = oldParent;
+    m_Nodes[newParent].Bounds = AABB::Merge(leafBounds, m_Nodes[sibling].Bounds);
+    m_Nodes[newParent].Height = m_Nodes[sibling].Height + 1;
+    m_Nodes[newParent].Left = sibling;
+    m_Nodes[newParent].Right = leaf;
+    m_Nodes[sibling].Parent = newParent;
+    m_Nodes[leaf].Parent = newParent;
+
+    if (oldParent == NullNode) {
+      m_Root = newParent;
+    }
+    else if (m_Nodes[oldParent].Left == sibling) {
+      m_Nodes[oldParent].Left = newParent;
+    }
+    else {
+      m_Nodes[oldParent].Right = newParent;
+    }
+
+    FixUpwards(m_Nodes[leaf].Parent);
+  }
+
+  void BoundingVolumeHierarchy::RemoveLeaf(int32_t leaf) {
+    if (leaf == m_Root) {
+      m_Root = NullNode;
+      return;
+    }
+
+    const int32_t parent = m_Nodes[leaf].Parent;
+    const int32_t grandParent = m_Nodes[parent].Parent;
+    const int32_t sibling = m_Nodes[parent].Left == leaf ? m_Nodes[parent].Right : m_Nodes[parent].Left;
+
+    m_Nodes[sibling].Parent = grandParent;
+    if (grandParent == NullNode) {
+      m_Root = sibling;
+    }
+    else {
+      if (m_Nodes[grandParent].Left == parent)
+        m_Nodes[grandParent].Left = sibling;
+      else
+        m_Nodes[grandParent].Right = sibling;
+    }
+    FreeNode(parent);
+    m_Nodes[leaf].Parent = NullNode;
+
+    if (grandParent != NullNode)
+      FixUpwards(grandParent);
+  }
+
+  void BoundingVolumeHierarchy::FixUpwards(int32_t node) {
+    while (node != NullNode) {
+      node = Balance(node);
+
+      Node& current = m_Nodes[node];
+      current.Height = 1 + std::max(m_Nodes[current.Left].Height, m_Nodes[current.Right].Height);
+      current.Bounds = AABB::Merge(m_Nodes[current.Left].Bounds, m_Nodes[current.Right].Bounds);
+
+      node = current.Parent;
+    }
+  }
+
+  int32_t BoundingVolumeHierarchy::Balance(int32_t iA) {
+    Node& A = m_Nodes[iA];
+    if (A.IsLeaf() || A.Height < 2)
+      return iA;
+
+    const int32_t iB = A.Left;
+    const int32_t iC = A.Right;
+    Node& B = m_Nodes[iB];
+    Node& C = m_Nodes[iC];
+
+    const int32_t balance = C.Height - B.Height;
+
+    // Rotates the taller child up into A's place
+    const auto rotateUp = [this, iA, &A](int32_t iUp, Node& up, const Node& other, bool upIsRight) {
+      const int32_t iF = up.Left;
+      const int32_t iG = up.Right;
+      Node& F = m_Nodes[iF];
+      Node& G = m_Nodes[iG];
+
+      up.Left = iA;
+      up.Parent = A.Parent;
+      A.Parent = iUp;
+
+      if (up.Parent == NullNode)
+        m_Root = iUp;
+      else if (m_Nodes[up.Parent].Left == iA)
+        m_Nodes[up.Parent].Left = iUp;
+      else
+        m_Nodes[up.Parent].Right = iUp;
+
+      // The taller grandchild stays with the rotated node, the other one moves under A
+      const bool keepF = F.Height > G.Height;
+      const int32_t iKeep = keepF ? iF : iG;
+      const int32_t iMove = keepF ? iG : iF;
+      Node& keep = m_Nodes[iKeep];
+      Node& move = m_Nodes[iMove];
+
+      up.Right = iKeep;
+      if (upIsRight)
+        A.Right = iMove;
+      else
+        A.Left = iMove;
+      move.Parent = iA;
+
+      A.Bounds = AABB::Merge(other.Bounds, move.Bounds);
+      A.Height = 1 + std::max(other.Height, move.Height);
+      up.Bounds = AABB::Merge(A.Bounds, keep.Bounds);
+      up.Height = 1 + std::max(A.Height, keep.Height);
+    };
+
+    if (balance > 1) {
+      rotateUp(iC, C, B, true);
+      return iC;
+    }
+
+    if (balance < -1) {
+      rotateUp(iB, B, C, false);
+      return iB;
+    }
+
+    return iA;
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "Frustum.h"
+
+namespace Oxylus {
+  /// Dynamic AABB tree. Leaves store slightly enlarged bounds so small movements don't touch the tree,
+  /// and the tree is kept balanced with rotations as proxies are inserted and removed.
+  class BoundingVolumeHierarchy {
+  public:
+    static constexpr int32_t NullNode = -1;
+    static constexpr float Margin = 0.1f;
+
+    int32_t CreateProxy(const AABB& aabb, uint32_t userData);
+    void DestroyProxy(int32_t proxyId);
+    /// Returns true if the proxy left its enlarged bounds and had to be reinserted.
+    bool MoveProxy(int32_t proxyId, const AABB& aabb);
+    void Clear();
+
+    uint32_t GetUserData(int32_t proxyId) const { return m_Nodes[proxyId].UserData; }
+    const AABB& GetFatAABB(int32_t proxyId) const { return m_Nodes[proxyId].Bounds; }
+    uint32_t GetProxyCount() const { return m_ProxyCount; }
+    int32_t GetHeight() const { return m_Root == NullNode ? 0 : m_Nodes[m_Root].Height; }
+
+    /// Appends the user data of every proxy that may be visible in the frustum.
+    void Query(const Frustum& frustum, std::vector<uint32_t>& outUserData) const;
+
+  private:
+    struct Node {
+      AABB Bounds = {};
+      int32_t Parent = NullNode; // Next free node while on the free list
+      int32_t Left = NullNode;
+      int32_t Right = NullNode;
+      int32_t Height = 0;        // Leaves are 0, free nodes -1
+      uint32_t UserData = 0;
+
+      bool IsLeaf() const { return Left == NullNode; }
+    };
+
+    std::vector<Node> m_Nodes;
+    int32_t m_Root = NullNode;
+    int32_t m_FreeList = NullNode;
+    uint32_t m_ProxyCount = 0;
+
+    int32_t AllocateNode();
+    void FreeNode(int32_t node);
+    void InsertLeaf(int32_t leaf);
+    void RemoveLeaf(int32_t leaf);
+    int32_t Balance(int32_t node);
+    void FixUpwards(int32_t node);
+    void CollectLeaves(int32_t node, std::vector<uint32_t>& outUserData) const;
+  };
+}
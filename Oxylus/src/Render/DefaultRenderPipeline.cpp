@@ -1,8 +1,12 @@
 ﻿#include "DefaultRenderPipeline.h"
 
+#include <bit>
+#include <unordered_set>
+
 #include "DebugRenderer.h"
 #include "ResourcePool.h"
 #include "ShaderLibrary.h"
+#include "TextureStreamer.h"
 #include "Assets/AssetManager.h"
 #include "Core/Entity.h"
 #include "Core/Resources.h"
@@ -14,20 +18,17 @@
 #include "Vulkan/Utils/VulkanUtils.h"
 
 namespace Oxylus {
-  void DefaultRenderPipeline::OnInit() {
-    m_RendererContext.PostProcessCommandBuffer.CreateBuffer();
-    m_RendererContext.PBRPassCommandBuffer.CreateBuffer();
-    m_RendererContext.BloomPassCommandBuffer.CreateBuffer();
-    m_RendererContext.SSRCommandBuffer.CreateBuffer();
-    m_RendererContext.FrustumCommandBuffer.CreateBuffer();
-    m_RendererContext.LightListCommandBuffer.CreateBuffer();
-    m_RendererContext.DepthPassCommandBuffer.CreateBuffer();
-    m_RendererContext.SSAOCommandBuffer.CreateBuffer();
-    m_RendererContext.DirectShadowCommandBuffer.CreateBuffer();
-    m_RendererContext.CompositeCommandBuffer.CreateBuffer();
-    m_RendererContext.AtmosphereCommandBuffer.CreateBuffer();
-    m_RendererContext.DepthOfFieldCommandBuffer.CreateBuffer();
+  /// Primitives RenderNode draws for the node, the ones without a material are left out like the GPU scene does.
+  static uint32_t CountNodeDraws(const Mesh::Node* node, const std::vector<Ref<Material>>& materials) {
+    uint32_t count = 0;
+    for (const auto& primitive : node->Primitives)
+      count += primitive->materialIndex < (int32_t)materials.size() ? 1 : 0;
+    for (const auto& child : node->Children)
+      count += CountNodeDraws(child, materials);
+    return count;
+  }
 
+  void DefaultRenderPipeline::OnInit() {
     m_RendererData.SkyboxBuffer.CreateBuffer(vBU::eUniformBuffer, vMP::eHostVisible | vMP::eHostCoherent, sizeof RendererData::UBO_VS, &m_RendererData.UBO_VS).Map();
     m_RendererData.ParametersBuffer.CreateBuffer(vBU::eUniformBuffer, vMP::eHostVisible | vMP::eHostCoherent, sizeof RendererData::UBO_PbrPassParams, &m_RendererData.UBO_PbrPassParams).Map();
     m_RendererData.VSBuffer.CreateBuffer(vBU::eUniformBuffer, vMP::eHostVisible | vMP::eHostCoherent, sizeof RendererData::UBO_VS, &m_RendererData.UBO_VS).Map();
@@ -154,6 +155,14 @@ namespace Oxylus {
 
     m_DepthOfFieldDescriptorSet.CreateFromShader(m_Pipelines.DepthOfFieldPipeline.GetShader());
 
+    // GPU driven rendering. The instance set is shared by every indirect pipeline.
+    m_GPUScene.Init();
+    m_InstanceDescriptorSet.CreateFromShader(m_Pipelines.PBRIndirectPipeline.GetShader(), 2);
+    m_GPUCullDescriptorSet.CreateFromShader(m_Pipelines.GPUCullPipeline.GetShader());
+    m_HiZDescriptorSet.CreateFromShader(m_Pipelines.HiZPipeline.GetShader());
+    m_GPUSkinning.Init();
+    m_SkinningDescriptorSet.CreateFromShader(m_Pipelines.SkinningPipeline.GetShader());
+
     GeneratePrefilter();
 
     InitRenderGraph();
@@ -190,16 +199,23 @@ namespace Oxylus {
     // Mesh
     {
       OX_SCOPED_ZONE_N("Mesh System");
-      const auto view = scene->m_Registry.view<TransformComponent, MeshRendererComponent, MaterialComponent, TagComponent>();
-      for (const auto&& [entity, transform, meshrenderer, material, tag] : view.each()) {
-        auto e = Entity(entity, scene);
-        auto parent = e.GetParent();
-        bool parentEnabled = true;
-        if (parent)
-          parentEnabled = parent.GetComponent<TagComponent>().Enabled;
-        if (tag.Enabled && parentEnabled)
-          m_MeshDrawList.emplace_back(*meshrenderer.MeshGeometry, e.GetWorldTransform(), material.Materials, meshrenderer.SubmesIndex);
+      const auto& gpuDrivenConfig = RendererConfig::Get()->GPUDrivenConfig;
+      m_GPUDriven = gpuDrivenConfig.Enabled && VulkanContext::Context.SupportsDrawIndirectCount;
+      m_HiZEnabled = m_GPUDriven && gpuDrivenConfig.OcclusionCulling;
+
+      UpdateMeshProxies(scene);
+      UpdateSkinning(scene);
+      if (m_GPUDriven) {
+        UpdateGPUScene();
+      }
+      else {
+        const Camera* camera = m_RendererContext.CurrentCamera;
+        CullMeshes(camera->GetProjectionMatrixFlipped() * camera->GetViewMatrix(), false, GetCameraLodView(), m_MeshDrawList);
+        m_CameraDrawCount = 0;
+        for (const auto& mesh : m_MeshDrawList)
+          m_CameraDrawCount += CountNodeDraws(mesh.MeshGeometry.LinearNodes[mesh.SubmeshIndex], mesh.Materials);
       }
+      UpdateTextureStreaming();
     }
 
     // Particle system
@@ -229,6 +245,30 @@ namespace Oxylus {
         m_SceneLights = std::move(lights);
         m_LightBufferDispatcher.trigger(LightChangeEvent{});
       }
+      // Directional shadows
+      {
+        for (auto& drawList : m_ShadowMeshDrawLists)
+          drawList.clear();
+        bool directionalShadows = false;
+        for (const auto& e : m_SceneLights) {
+          if (e.GetComponent<LightComponent>().Type != LightComponent::LightType::Directional)
+            continue;
+
+          UpdateCascades(e, m_RendererContext.CurrentCamera, m_RendererData.UBO_DirectShadow);
+          m_RendererData.DirectShadowBuffer.Copy(&m_RendererData.UBO_DirectShadow, sizeof m_RendererData.UBO_DirectShadow);
+          directionalShadows = true;
+
+          // Depth clamping keeps casters behind the cascade near plane in the shadow map
+          if (!m_GPUDriven) {
+            for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++)
+              CullMeshes(m_RendererData.UBO_DirectShadow.cascadeViewProjMat[i], true, GetCascadeLodView(i), m_ShadowMeshDrawLists[i]);
+          }
+          break;
+        }
+
+        if (m_GPUDriven)
+          UpdateGPUViews(directionalShadows);
+      }
       // Sky light
       {
         const auto view = scene->m_Registry.view<SkyLightComponent>();
@@ -256,16 +296,21 @@ namespace Oxylus {
     dispatcher.sink<SceneRenderer::SkyboxLoadEvent>().connect<&DefaultRenderPipeline::UpdateSkybox>(*this);
   }
 
-  void DefaultRenderPipeline::OnShutdown() { }
+  void DefaultRenderPipeline::OnShutdown() {
+    m_GPUSkinning.Destroy();
+  }
 
-  void DefaultRenderPipeline::RenderNode(const Mesh::Node* node, const vk::CommandBuffer& commandBuffer, const VulkanPipeline& pipeline, const std::function<bool(Mesh::Primitive* prim)>& perMeshFunc) {
+  void DefaultRenderPipeline::RenderNode(const Mesh& mesh, const Mesh::Node* node, const float lodPixelsPerUnit, const int32_t vertexOffset, const vk::CommandBuffer& commandBuffer, const VulkanPipeline& pipeline, const std::function<bool(Mesh::Primitive* prim)>& perMeshFunc) {
+    const auto& geometry = mesh.GetGeometry();
+    const float lodThreshold = RendererConfig::Get()->LodConfig.ErrorThreshold;
     for (const auto& part : node->Primitives) {
       if (!perMeshFunc(part))
         continue;
-      commandBuffer.drawIndexed(part->indexCount, 1, part->firstIndex, 0, 0);
+      const auto lod = mesh.SelectLod(*part, lodPixelsPerUnit, lodThreshold);
+      commandBuffer.drawIndexed(lod.IndexCount, 1, geometry.IndexOffset + lod.FirstIndex, vertexOffset, 0);
     }
     for (const auto& child : node->Children) {
-      RenderNode(child, commandBuffer, pipeline, perMeshFunc);
+      RenderNode(mesh, child, lodPixelsPerUnit, vertexOffset, commandBuffer, pipeline, perMeshFunc);
     }
   }
 
@@ -278,11 +323,423 @@ namespace Oxylus {
       return;
     }
 
-    constexpr vk::DeviceSize offsets[1] = {0};
-    commandBuffer.bindVertexBuffers(0, mesh.MeshGeometry.VerticiesBuffer.Get(), offsets);
-    commandBuffer.bindIndexBuffer(mesh.MeshGeometry.IndiciesBuffer.Get(), 0, vk::IndexType::eUint32);
+    GeometryBuffer::Get()->Bind(commandBuffer);
+
+    RenderNode(mesh.MeshGeometry, mesh.MeshGeometry.LinearNodes[mesh.SubmeshIndex], mesh.LodPixelsPerUnit, mesh.VertexOffset, commandBuffer, pipeline, perMeshFunc);
+  }
+
+  void DefaultRenderPipeline::RenderIndirect(const uint32_t view, const vk::CommandBuffer& commandBuffer, const VulkanPipeline& pipeline, const std::function<bool(const GPUScene::Batch& batch)>& perBatchFunc) {
+    if (view >= m_GPUScene.GetViewCount())
+      return;
+
+    pipeline.BindPipeline(commandBuffer);
+    GeometryBuffer::Get()->Bind(commandBuffer);
+
+    const auto& batches = m_GPUScene.GetBatches();
+    const Mesh* currentMesh = nullptr;
+    bool skipMesh = false;
+    for (uint32_t i = 0; i < (uint32_t)batches.size(); i++) {
+      const auto& batch = batches[i];
+      if (batch.MeshGeometry != currentMesh) {
+        currentMesh = batch.MeshGeometry;
+        skipMesh = batch.MeshGeometry->ShouldUpdate || m_ForceUpdateMaterials;
+        if (skipMesh) {
+          batch.MeshGeometry->UpdateMaterials();
+          batch.MeshGeometry->ShouldUpdate = false;
+          continue;
+        }
+      }
+
+      if (skipMesh || !perBatchFunc(batch))
+        continue;
+
+      commandBuffer.drawIndexedIndirectCount(m_GPUScene.GetCommandBuffer().Get(),
+        m_GPUScene.GetCommandOffset(view, batch),
+        m_GPUScene.GetCountBuffer().Get(),
+        m_GPUScene.GetCountOffset(view, i),
+        batch.MaxCommandCount,
+        sizeof(vk::DrawIndexedIndirectCommand));
+    }
+  }
+
+  /// Bounds of everything RenderNode draws for the node, in the space of the owning entity.
+  static AABB GetNodeBounds(const Mesh::Node* node) {
+    AABB bounds = {};
+    for (const auto& primitive : node->Primitives)
+      bounds.Merge(AABB(primitive->dimensions.min, primitive->dimensions.max));
+    for (const auto& child : node->Children)
+      bounds.Merge(GetNodeBounds(child));
+    return bounds;
+  }
+
+  static size_t HashMaterials(const std::vector<Ref<Material>>& materials) {
+    size_t hash = materials.size();
+    for (const auto& material : materials) {
+      hash = hash * 31 + std::hash<const Material*>()(material.get());
+      hash = hash * 31 + (size_t)(material ? material->AlphaMode : Material::AlphaMode::Opaque);
+    }
+    return hash;
+  }
+
+  void DefaultRenderPipeline::UpdateMeshProxies(Scene* scene) {
+    OX_SCOPED_ZONE;
+    if (m_CulledScene != scene) {
+      for (const uint32_t index : m_ActiveMeshProxies)
+        m_GPUSkinning.RemoveInstance(m_MeshProxies[index].Skinning);
+      m_MeshBVH.Clear();
+      m_MeshProxies.clear();
+      m_ActiveMeshProxies.clear();
+      m_CulledScene = scene;
+      m_GPUDrawsDirty = true;
+    }
+    m_CullingFrame++;
+
+    const auto view = scene->m_Registry.view<WorldTransformComponent, MeshRendererComponent, MaterialComponent, TagComponent>();
+    for (const auto&& [entity, worldTransform, meshrenderer, material, tag] : view.each()) {
+      auto e = Entity(entity, scene);
+      auto parent = e.GetParent();
+      bool parentEnabled = true;
+      if (parent)
+        parentEnabled = parent.GetComponent<TagComponent>().Enabled;
+      if (!tag.Enabled || !parentEnabled || !meshrenderer.MeshGeometry || !*meshrenderer.MeshGeometry)
+        continue;
+
+      const uint32_t index = (uint32_t)entt::to_entity(entity);
+      if (index >= m_MeshProxies.size())
+        m_MeshProxies.resize(index + 1);
+
+      auto& proxy = m_MeshProxies[index];
+      // The slot belonged to a destroyed entity that got recycled
+      if (proxy.ProxyId != BoundingVolumeHierarchy::NullNode && proxy.Handle != entity) {
+        m_MeshBVH.DestroyProxy(proxy.ProxyId);
+        ResetMeshProxy(proxy);
+      }
+
+      const bool meshChanged = proxy.MeshGeometry != meshrenderer.MeshGeometry.get() || proxy.SubmeshIndex != meshrenderer.SubmesIndex;
+      if (meshChanged) {
+        proxy.MeshGeometry = meshrenderer.MeshGeometry.get();
+        proxy.SubmeshIndex = meshrenderer.SubmesIndex;
+        const auto* node = proxy.MeshGeometry->LinearNodes[proxy.SubmeshIndex];
+        // Skinned vertices can end up anywhere the clips of the skin move them
+        m_GPUSkinning.RemoveInstance(proxy.Skinning);
+        proxy.Skinning = m_GPUSkinning.AddInstance(*proxy.MeshGeometry, proxy.SubmeshIndex);
+        proxy.SkinningAtRest = false;
+        proxy.LocalBounds = proxy.Skinning != GPUSkinning::InvalidHandle
+                              ? proxy.MeshGeometry->Skins[node->SkinIndex].Bounds
+                              : GetNodeBounds(node);
+      }
+      proxy.Materials = &material.Materials;
+      proxy.LastSeenFrame = m_CullingFrame;
+
+      const size_t materialsHash = HashMaterials(material.Materials);
+      if (meshChanged || proxy.MaterialsHash != materialsHash) {
+        proxy.MaterialsHash = materialsHash;
+        proxy.TextureViewVersion = UINT64_MAX;
+        m_GPUDrawsDirty = true;
+      }
+
+      if (proxy.ProxyId == BoundingVolumeHierarchy::NullNode) {
+        proxy.Handle = entity;
+        proxy.Transform = worldTransform.World;
+        proxy.TransformVersion = worldTransform.Version;
+        proxy.ProxyId = m_MeshBVH.CreateProxy(proxy.LocalBounds.Transform(proxy.Transform), index);
+        m_ActiveMeshProxies.emplace_back(index);
+        m_GPUScene.SetInstance(index, proxy.Transform);
+        m_GPUDrawsDirty = true;
+      }
+      else if (meshChanged || proxy.TransformVersion != worldTransform.Version) {
+        proxy.Transform = worldTransform.World;
+        proxy.TransformVersion = worldTransform.Version;
+        m_MeshBVH.MoveProxy(proxy.ProxyId, proxy.LocalBounds.Transform(proxy.Transform));
+        m_GPUScene.SetInstance(index, proxy.Transform);
+      }
+    }
+
+    // Drop the proxies of meshes that were destroyed, disabled or lost their components
+    for (size_t i = 0; i < m_ActiveMeshProxies.size();) {
+      auto& proxy = m_MeshProxies[m_ActiveMeshProxies[i]];
+      if (proxy.ProxyId != BoundingVolumeHierarchy::NullNode && proxy.LastSeenFrame == m_CullingFrame) {
+        i++;
+        continue;
+      }
+      if (proxy.ProxyId != BoundingVolumeHierarchy::NullNode)
+        m_MeshBVH.DestroyProxy(proxy.ProxyId);
+      ResetMeshProxy(proxy);
+      m_ActiveMeshProxies[i] = m_ActiveMeshProxies.back();
+      m_ActiveMeshProxies.pop_back();
+      m_GPUDrawsDirty = true;
+    }
+  }
+
+  void DefaultRenderPipeline::ResetMeshProxy(MeshProxy& proxy) {
+    m_GPUSkinning.RemoveInstance(proxy.Skinning);
+    proxy = {};
+  }
+
+  int32_t DefaultRenderPipeline::GetProxyVertexOffset(const MeshProxy& proxy) const {
+    if (proxy.Skinning != GPUSkinning::InvalidHandle)
+      return m_GPUSkinning.GetVertexOffset(proxy.Skinning);
+    return (int32_t)proxy.MeshGeometry->GetGeometry().VertexOffset;
+  }
+
+  void DefaultRenderPipeline::CullMeshes(const Mat4& viewProjection, bool ignoreNearPlane, const LodView& lodView, std::vector<MeshData>& outDrawList) {
+    OX_SCOPED_ZONE;
+    m_VisibleMeshProxies.clear();
+    m_MeshBVH.Query(Frustum(viewProjection, ignoreNearPlane), m_VisibleMeshProxies);
+
+    // Keep the draw order stable between frames regardless of the tree layout
+    std::sort(m_VisibleMeshProxies.begin(), m_VisibleMeshProxies.end());
+    const bool lodEnabled = RendererConfig::Get()->LodConfig.Enabled;
+    for (const uint32_t index : m_VisibleMeshProxies) {
+      const auto& proxy = m_MeshProxies[index];
+      // One level per instance, picked from its bounds like the GPU path does per primitive
+      float lodPixelsPerUnit = FLT_MAX;
+      if (lodEnabled) {
+        const float scale = std::max({glm::length(Vec3(proxy.Transform[0])), glm::length(Vec3(proxy.Transform[1])), glm::length(Vec3(proxy.Transform[2]))});
+        lodPixelsPerUnit = lodView.PixelsPerUnit * scale;
+        if (lodView.Perspective) {
+          const AABB bounds = proxy.LocalBounds.Transform(proxy.Transform);
+          lodPixelsPerUnit /= std::max(glm::distance(bounds.GetCenter(), lodView.Position) - glm::length(bounds.GetExtents()), 0.01f);
+        }
+      }
+      outDrawList.emplace_back(*proxy.MeshGeometry, proxy.Transform, *proxy.Materials, proxy.SubmeshIndex, lodPixelsPerUnit, GetProxyVertexOffset(proxy));
+    }
+  }
+
+  DefaultRenderPipeline::LodView DefaultRenderPipeline::GetCameraLodView() const {
+    const Camera* camera = m_RendererContext.CurrentCamera;
+    const float pixelsPerUnit = std::abs(camera->GetProjectionMatrixFlipped()[1][1]) * 0.5f * (float)m_Framebuffers.PostProcessPassFB.GetImage()[0].GetHeight();
+    return {camera->GetPosition(), pixelsPerUnit, true};
+  }
+
+  DefaultRenderPipeline::LodView DefaultRenderPipeline::GetCascadeLodView(const uint32_t cascadeIndex) const {
+    // Cascades are orthographic, a unit covers the same pixels at any distance
+    const Mat4& viewProjection = m_RendererData.UBO_DirectShadow.cascadeViewProjMat[cascadeIndex];
+    const float unitsToClip = glm::length(Vec3(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0]));
+    return {Vec3(0.0f), unitsToClip * 0.5f * (float)RendererConfig::Get()->DirectShadowsConfig.Size, false};
+  }
+
+  void DefaultRenderPipeline::UpdateTextureStreaming() {
+    OX_SCOPED_ZONE;
+    auto* streamer = TextureStreamer::Get();
+    if (!streamer)
+      return;
+
+    // Only the CPU path culled against the camera already
+    const Camera* camera = m_RendererContext.CurrentCamera;
+    if (m_GPUDriven) {
+      m_VisibleMeshProxies.clear();
+      m_MeshBVH.Query(Frustum(camera->GetProjectionMatrixFlipped() * camera->GetViewMatrix(), false), m_VisibleMeshProxies);
+    }
+
+    // The screen size of the mesh bounds is used as feedback, it doesn't need a readback of the PBR pass
+    const float pixelsPerUnit = std::abs(camera->GetProjectionMatrixFlipped()[1][1]) * 0.5f * (float)GetFinalImage().GetHeight();
+    for (const uint32_t index : m_VisibleMeshProxies) {
+      const auto& proxy = m_MeshProxies[index];
+      const AABB bounds = proxy.LocalBounds.Transform(proxy.Transform);
+      const float radius = glm::length(bounds.GetExtents());
+      const float distance = std::max(glm::distance(bounds.GetCenter(), camera->GetPosition()) - radius, 0.01f);
+      const float pixels = 2.0f * radius * pixelsPerUnit / distance;
+      for (const auto& material : *proxy.Materials) {
+        if (!material)
+          continue;
+        const float texturePixels = pixels / (float)std::max(material->Parameters.UVScale, 1u);
+        for (const auto& texture : {material->AlbedoTexture, material->NormalTexture, material->RoughnessTexture, material->MetallicTexture, material->AOTexture})
+          streamer->Request(texture.get(), texturePixels);
+      }
+    }
+
+    const auto& updatedImages = streamer->Update();
+    const uint64_t viewVersion = streamer->GetViewVersion();
+    const auto isUpdated = [&updatedImages](const Ref<VulkanImage>& image) {
+      return std::binary_search(updatedImages.begin(), updatedImages.end(), image.get());
+    };
+
+    // Rewrites the materials using new views. Proxies that missed earlier swaps, e.g. while disabled, rewrite all of theirs.
+    std::unordered_set<const Material*> updatedMaterials;
+    for (const uint32_t index : m_ActiveMeshProxies) {
+      auto& proxy = m_MeshProxies[index];
+      if (proxy.TextureViewVersion == viewVersion)
+        continue;
+      const bool missedSwaps = proxy.TextureViewVersion + 1 != viewVersion;
+      proxy.TextureViewVersion = viewVersion;
+      for (const auto& material : *proxy.Materials) {
+        if (!material || updatedMaterials.contains(material.get()))
+          continue;
+        if (missedSwaps || isUpdated(material->AlbedoTexture) || isUpdated(material->NormalTexture) || isUpdated(material->RoughnessTexture) ||
+            isUpdated(material->MetallicTexture) || isUpdated(material->AOTexture)) {
+          material->Update();
+          updatedMaterials.emplace(material.get());
+        }
+      }
+    }
+  }
+
+  void DefaultRenderPipeline::UpdateGPUScene() {
+    OX_SCOPED_ZONE;
+    // Draws store geometry offsets, which move when the geometry buffer grows or gets compacted
+    if (m_GeometryVersion != GeometryBuffer::Get()->GetVersion()) {
+      m_GeometryVersion = GeometryBuffer::Get()->GetVersion();
+      m_GPUDrawsDirty = true;
+    }
+
+    if (m_GPUDrawsDirty) {
+      m_GPUScene.BeginDraws();
+      for (const uint32_t index : m_ActiveMeshProxies) {
+        const auto& proxy = m_MeshProxies[index];
+        if (proxy.Skinning != GPUSkinning::InvalidHandle) {
+          const GPUScene::Skinning skinning = {GetProxyVertexOffset(proxy), proxy.LocalBounds};
+          m_GPUScene.AddDraws(index, *proxy.MeshGeometry, proxy.SubmeshIndex, *proxy.Materials, &skinning);
+          continue;
+        }
+        m_GPUScene.AddDraws(index, *proxy.MeshGeometry, proxy.SubmeshIndex, *proxy.Materials);
+      }
+      m_GPUScene.EndDraws();
+      m_GPUDrawsDirty = false;
+    }
+
+    UpdateHiZ();
+
+    if (m_GPUSceneBufferVersion != m_GPUScene.GetBufferVersion()) {
+      m_GPUSceneBufferVersion = m_GPUScene.GetBufferVersion();
+      UpdateGPUDescriptorSets();
+    }
+  }
+
+  void DefaultRenderPipeline::UpdateSkinning(Scene* scene) {
+    OX_SCOPED_ZONE;
+    std::vector<Mat4> restMatrices;
+    for (const uint32_t index : m_ActiveMeshProxies) {
+      auto& proxy = m_MeshProxies[index];
+      if (proxy.Skinning == GPUSkinning::InvalidHandle)
+        continue;
+
+      const uint32_t jointCount = m_GPUSkinning.GetJointCount(proxy.Skinning);
+      const auto* animation = scene->m_Registry.try_get<AnimationComponent>(proxy.Handle);
+      if (animation && animation->SkinningMatrices.size() == jointCount) {
+        m_GPUSkinning.SetJoints(proxy.Skinning, animation->SkinningMatrices.data());
+        proxy.SkinningAtRest = false;
+        continue;
+      }
+
+      // Meshes without a playing clip show the rest pose of their skin
+      if (proxy.SkinningAtRest)
+        continue;
+      const auto& skin = proxy.MeshGeometry->Skins[proxy.MeshGeometry->LinearNodes[proxy.SubmeshIndex]->SkinIndex];
+      restMatrices.resize(jointCount);
+      skin.ComputeSkinningMatrices(skin.RestPose, restMatrices.data());
+      m_GPUSkinning.SetJoints(proxy.Skinning, restMatrices.data());
+      proxy.SkinningAtRest = true;
+    }
+
+    m_SkinningActive = !m_GPUSkinning.UpdateDispatches().empty();
+    if (!m_SkinningActive)
+      return;
+
+    // Skinned vertices are written into the geometry buffer itself, which moves when it grows or gets compacted
+    const auto* geometryBuffer = GeometryBuffer::Get();
+    if (m_SkinningGeometryVersion != geometryBuffer->GetVersion() || m_SkinningBufferVersion != m_GPUSkinning.GetBufferVersion()) {
+      m_SkinningGeometryVersion = geometryBuffer->GetVersion();
+      m_SkinningBufferVersion = m_GPUSkinning.GetBufferVersion();
+      m_SkinningDescriptorSet.WriteDescriptorSets[0].pBufferInfo = &geometryBuffer->GetVertexBuffer().GetDescriptor();
+      m_SkinningDescriptorSet.WriteDescriptorSets[1].pBufferInfo = &geometryBuffer->GetSkinBuffer().GetDescriptor();
+      m_SkinningDescriptorSet.WriteDescriptorSets[2].pBufferInfo = &m_GPUSkinning.GetJointBuffer().GetDescriptor();
+      m_SkinningDescriptorSet.Update();
+    }
+  }
+
+  void DefaultRenderPipeline::UpdateGPUViews(const bool directionalShadows) {
+    const Camera* camera = m_RendererContext.CurrentCamera;
+    const Mat4 viewProjection = camera->GetProjectionMatrixFlipped() * camera->GetViewMatrix();
+
+    const auto setPlanes = [](GPUScene::View& view, const Frustum& frustum) {
+      for (uint32_t i = 0; i < 6; i++)
+        view.Planes[i] = frustum.GetPlane(i);
+    };
+
+    // The camera is always the first view, followed by the shadow cascades
+    GPUScene::View views[GPUScene::MaxViews] = {};
+    uint32_t viewCount = 0;
+    auto& cameraView = views[viewCount++];
+    setPlanes(cameraView, Frustum(viewProjection));
+    cameraView.PreviousViewProjection = m_HiZViewProjection;
+    if (m_HiZEnabled && m_HiZValid)
+      cameraView.HiZParams = Vec4(m_HiZImage.GetWidth(), m_HiZImage.GetHeight(), m_HiZImage.GetDesc().MipLevels, 1.0f);
+    // Shadow passes cull front faces, so only the camera skips meshlets facing away
+    cameraView.Position = Vec4(camera->GetPosition(), 1.0f);
+
+    const auto& lodConfig = RendererConfig::Get()->LodConfig;
+    const auto setLodParams = [&lodConfig](GPUScene::View& view, const LodView& lodView) {
+      view.LodParams = Vec4(lodView.PixelsPerUnit, lodView.Perspective ? 1.0f : 0.0f, lodConfig.ErrorThreshold, lodConfig.Enabled ? 1.0f : 0.0f);
+    };
+    setLodParams(cameraView, GetCameraLodView());
+
+    if (directionalShadows) {
+      for (uint32_t i = 0; i < SHADOW_MAP_CASCADE_COUNT; i++) {
+        setPlanes(views[viewCount], Frustum(m_RendererData.UBO_DirectShadow.cascadeViewProjMat[i], true));
+        setLodParams(views[viewCount++], GetCascadeLodView(i));
+      }
+    }
+    m_GPUScene.SetViews(views, viewCount);
+
+    // The Hi-Z pass of this frame is what the next frame culls against
+    m_HiZValid = m_HiZEnabled;
+    m_HiZViewProjection = viewProjection;
+  }
+
+  void DefaultRenderPipeline::UpdateHiZ() {
+    const auto& depthImage = m_Framebuffers.DepthNormalPassFB.GetImage()[1];
+    if (m_HiZDepthView == depthImage.GetImageView())
+      return;
+
+    const auto& LogicalDevice = VulkanContext::GetDevice();
+    if (m_HiZDepthView) {
+      VulkanRenderer::WaitDeviceIdle();
+      for (const auto& mip : m_HiZMipDescriptors)
+        LogicalDevice.destroyImageView(mip.imageView);
+      m_HiZImage.Destroy();
+    }
+    m_HiZDepthView = depthImage.GetImageView();
+    m_HiZValid = false;
+
+    // Power of two mips so every texel of a mip covers exactly 2x2 texels of the one above
+    VulkanImageDescription hiZDesc;
+    hiZDesc.Width = std::bit_floor(depthImage.GetWidth());
+    hiZDesc.Height = std::bit_floor(depthImage.GetHeight());
+    hiZDesc.MipLevels = VulkanImage::GetMaxMipmapLevel(hiZDesc.Width, hiZDesc.Height, 1);
+    hiZDesc.Format = vk::Format::eR32Sfloat;
+    hiZDesc.UsageFlags = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled |
+                         vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
+    hiZDesc.FinalImageLayout = vk::ImageLayout::eGeneral;
+    hiZDesc.MinFiltering = vk::Filter::eNearest;
+    hiZDesc.MagFiltering = vk::Filter::eNearest;
+    hiZDesc.SamplerAddressMode = vk::SamplerAddressMode::eClampToEdge;
+    m_HiZImage.Create(hiZDesc);
+
+    // Unused array elements point to the last mip
+    m_HiZMipDescriptors = m_HiZImage.GetMipDescriptors();
+    const uint32_t maxMips = m_HiZDescriptorSet.WriteDescriptorSets[1].descriptorCount;
+    m_HiZMipInfos = m_HiZMipDescriptors;
+    m_HiZMipInfos.resize(std::max(maxMips, (uint32_t)m_HiZMipInfos.size()), m_HiZMipDescriptors.back());
+    m_HiZDescriptorSet.WriteDescriptorSets[0].pImageInfo = &depthImage.GetDescImageInfo();
+    m_HiZDescriptorSet.WriteDescriptorSets[1].pImageInfo = m_HiZMipInfos.data();
+    m_HiZDescriptorSet.Update();
+
+    UpdateGPUDescriptorSets();
+  }
 
-    RenderNode(mesh.MeshGeometry.LinearNodes[mesh.SubmeshIndex], commandBuffer, pipeline, perMeshFunc);
+  void DefaultRenderPipeline::UpdateGPUDescriptorSets() {
+    m_InstanceDescriptorSet.WriteDescriptorSets[0].pBufferInfo = &m_GPUScene.GetInstanceBuffer().GetDescriptor();
+    m_InstanceDescriptorSet.Update();
+
+    m_GPUCullDescriptorSet.WriteDescriptorSets[0].pBufferInfo = &m_GPUScene.GetViewBuffer().GetDescriptor();
+    m_GPUCullDescriptorSet.WriteDescriptorSets[1].pBufferInfo = &m_GPUScene.GetInstanceBuffer().GetDescriptor();
+    m_GPUCullDescriptorSet.WriteDescriptorSets[2].pBufferInfo = &m_GPUScene.GetDrawBuffer().GetDescriptor();
+    m_GPUCullDescriptorSet.WriteDescriptorSets[3].pBufferInfo = &m_GPUScene.GetBatchBuffer().GetDescriptor();
+    m_GPUCullDescriptorSet.WriteDescriptorSets[4].pBufferInfo = &m_GPUScene.GetCommandBuffer().GetDescriptor();
+    m_GPUCullDescriptorSet.WriteDescriptorSets[5].pBufferInfo = &m_GPUScene.GetCountBuffer().GetDescriptor();
+    m_GPUCullDescriptorSet.WriteDescriptorSets[6].pImageInfo = &m_HiZImage.GetDescImageInfo();
+    m_GPUCullDescriptorSet.Update();
   }
 
   void DefaultRenderPipeline::UpdateSkybox(const SceneRenderer::SkyboxLoadEvent& e) {
@@ -461,26 +918,101 @@ namespace Oxylus {
 
   void DefaultRenderPipeline::InitRenderGraph() {
     m_RenderGraph = CreateRef<RenderGraph>();
+    m_RenderGraph->SetOutput(m_Framebuffers.PostProcessPassFB);
 
     std::array<vk::ClearValue, 2> clearValues;
     clearValues[0].color = vk::ClearColorValue(std::array{0.0f, 0.0f, 0.0f, 1.0f});
     clearValues[1].depthStencil = vk::ClearDepthStencilValue{1.0f, 0};
 
+    RenderGraphPass skinningPass(
+      "Skinning Pass",
+      &m_Pipelines.SkinningPipeline,
+      {},
+      [this](VulkanCommandBuffer& commandBuffer, int32_t) {
+        OX_SCOPED_ZONE_N("Skinning Pass");
+        OX_TRACE_GPU(commandBuffer.Get(), "Skinning Pass")
+        // The graph doesn't track vertex input, the draws of the previous frame may still read the skinned vertices
+        commandBuffer.Get().pipelineBarrier(vk::PipelineStageFlagBits::eVertexInput, vk::PipelineStageFlagBits::eComputeShader, {}, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        const auto& layout = m_Pipelines.SkinningPipeline.GetPipelineLayout();
+        m_Pipelines.SkinningPipeline.BindPipeline(commandBuffer.Get());
+        m_Pipelines.SkinningPipeline.BindDescriptorSets(commandBuffer.Get(), {m_SkinningDescriptorSet.Get()});
+        for (const auto& dispatch : m_GPUSkinning.GetDispatches()) {
+          commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof dispatch, &dispatch);
+          commandBuffer.Dispatch((dispatch.VertexCount + GPUSkinning::GroupSize - 1) / GPUSkinning::GroupSize, 1, 1);
+        }
+
+        const vk::MemoryBarrier skinningBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eVertexAttributeRead};
+        commandBuffer.Get().pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eVertexInput, {}, 1, &skinningBarrier, 0, nullptr, 0, nullptr);
+      },
+      {},
+      &VulkanContext::VulkanQueue.GraphicsQueue);
+    skinningPass.Write(GeometryBuffer::Get()->GetVertexBuffer())
+                .RunWithCondition(m_SkinningActive)
+                .AddToGraphCompute(m_RenderGraph);
+
+    RenderGraphPass gpuCullPass(
+      "GPU Cull Pass",
+      &m_Pipelines.GPUCullPipeline,
+      {},
+      [this](VulkanCommandBuffer& commandBuffer, int32_t) {
+        OX_SCOPED_ZONE_N("GPU Cull Pass");
+        OX_TRACE_GPU(commandBuffer.Get(), "GPU Cull Pass")
+        // The draws and the readback of the previous frame may still read the counts
+        const auto& countBuffer = m_GPUScene.GetCountBuffer();
+        commandBuffer.Get().pipelineBarrier(vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 0, nullptr);
+        commandBuffer.Get().fillBuffer(countBuffer.Get(), 0, VK_WHOLE_SIZE, 0);
+        const vk::MemoryBarrier fillBarrier{
+          vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+        };
+        commandBuffer.Get().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, 1, &fillBarrier, 0, nullptr, 0, nullptr);
+
+        if (m_GPUScene.GetDrawCount()) {
+          m_Pipelines.GPUCullPipeline.BindPipeline(commandBuffer.Get());
+          m_Pipelines.GPUCullPipeline.BindDescriptorSets(commandBuffer.Get(), {m_GPUCullDescriptorSet.Get()});
+          commandBuffer.Dispatch((m_GPUScene.GetDrawCount() + 64 - 1) / 64, m_GPUScene.GetViewCount(), 1);
+        }
+        m_CameraDrawCount = m_GPUScene.ReadBackDrawCount(commandBuffer.Get(), 0, VulkanRenderer::s_SwapChain.CurrentFrame);
+      },
+      {},
+      &VulkanContext::VulkanQueue.GraphicsQueue);
+    gpuCullPass.Write(m_GPUScene.GetCommandBuffer())
+               .Write(m_GPUScene.GetCountBuffer())
+               .ReadHistory(m_HiZImage)
+               .RunWithCondition(m_GPUDriven)
+               .AddToGraphCompute(m_RenderGraph);
+
     RenderGraphPass depthPrePass(
       "Depth Pre Pass",
-      {&m_RendererContext.DepthPassCommandBuffer},
       &m_Pipelines.DepthPrePassPipeline,
       {&m_Framebuffers.DepthNormalPassFB},
       [this](VulkanCommandBuffer& commandBuffer, int32_t) {
         OX_SCOPED_ZONE_N("DepthPrePass");
         OX_TRACE_GPU(commandBuffer.Get(), "Depth Pre Pass")
         commandBuffer.SetViwportWindow().SetScissorWindow();
+        if (m_GPUDriven) {
+          // Transparent surfaces would hide what's behind them in the Hi-Z
+          RenderIndirect(0,
+            commandBuffer.Get(),
+            m_Pipelines.DepthPrePassIndirectPipeline,
+            [&](const GPUScene::Batch& batch) {
+              if (batch.Transparent)
+                return false;
+              const auto& layout = m_Pipelines.DepthPrePassIndirectPipeline.GetPipelineLayout();
+              commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eFragment, sizeof(glm::mat4), sizeof Material::Parameters, &batch.BatchMaterial->Parameters);
+
+              m_Pipelines.DepthPrePassIndirectPipeline.BindDescriptorSets(commandBuffer.Get(), {m_DepthDescriptorSet.Get(), batch.BatchMaterial->DepthDescriptorSet.Get(), m_InstanceDescriptorSet.Get()});
+              return true;
+            });
+          return;
+        }
+
         for (const auto& mesh : m_MeshDrawList) {
           if (!mesh.MeshGeometry)
             continue;
 
           RenderMesh(mesh,
-            m_RendererContext.DepthPassCommandBuffer.Get(),
+            commandBuffer.Get(),
             m_Pipelines.DepthPrePassPipeline,
             [&](const Mesh::Primitive* part) {
               const auto& material = mesh.Materials[part->materialIndex];
@@ -495,11 +1027,50 @@ namespace Oxylus {
       },
       {clearValues},
       &VulkanContext::VulkanQueue.GraphicsQueue);
+    depthPrePass.Read(m_GPUScene.GetCommandBuffer()).Read(m_GPUScene.GetCountBuffer()).Read(GeometryBuffer::Get()->GetVertexBuffer());
     m_RenderGraph->AddRenderPass(depthPrePass);
 
+    RenderGraphPass hiZPass(
+      "Hi-Z Pass",
+      &m_Pipelines.HiZPipeline,
+      {},
+      [this](VulkanCommandBuffer& commandBuffer, int32_t) {
+        OX_SCOPED_ZONE_N("Hi-Z Pass");
+        OX_TRACE_GPU(commandBuffer.Get(), "Hi-Z Pass")
+        m_Pipelines.HiZPipeline.BindPipeline(commandBuffer.Get());
+        m_Pipelines.HiZPipeline.BindDescriptorSets(commandBuffer.Get(), {m_HiZDescriptorSet.Get()});
+        const auto& layout = m_Pipelines.HiZPipeline.GetPipelineLayout();
+
+        struct PushConst {
+          IVec2 SourceSize = {};
+          int32_t Mip = 0;
+        } pushConst;
+        const auto& depthImage = m_Framebuffers.DepthNormalPassFB.GetImage()[1];
+        pushConst.SourceSize = IVec2(depthImage.GetWidth(), depthImage.GetHeight());
+
+        // Each mip reduces the one written before it
+        const vk::MemoryBarrier mipBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead};
+        for (uint32_t mip = 0; mip < m_HiZImage.GetDesc().MipLevels; mip++) {
+          if (mip > 0)
+            commandBuffer.Get().pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, 1, &mipBarrier, 0, nullptr, 0, nullptr);
+
+          const IVec2 mipSize = glm::max(IVec2(m_HiZImage.GetWidth() >> mip, m_HiZImage.GetHeight() >> mip), IVec2(1));
+          pushConst.Mip = (int32_t)mip;
+          commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(PushConst), &pushConst);
+          commandBuffer.Dispatch((mipSize.x + 8 - 1) / 8, (mipSize.y + 8 - 1) / 8, 1);
+          pushConst.SourceSize = mipSize;
+        }
+      },
+      {},
+      &VulkanContext::VulkanQueue.GraphicsQueue);
+    hiZPass.Read(m_Framebuffers.DepthNormalPassFB)
+           .Write(m_HiZImage)
+           .SetHasSideEffects()
+           .RunWithCondition(m_HiZEnabled)
+           .AddToGraphCompute(m_RenderGraph);
+
     RenderGraphPass directShadowDepthPass(
       "Direct Shadow Depth Pass",
-      {&m_RendererContext.DirectShadowCommandBuffer},
       &m_Pipelines.DirectShadowDepthPipeline,
       {
         {
@@ -516,45 +1087,51 @@ namespace Oxylus {
         }).SetScissor(vk::Rect2D{
           {}, {RendererConfig::Get()->DirectShadowsConfig.Size, RendererConfig::Get()->DirectShadowsConfig.Size,}
         });
-        for (const auto& e : m_SceneLights) {
-          const auto& lightComponent = e.GetComponent<LightComponent>();
-          if (lightComponent.Type != LightComponent::LightType::Directional)
-            continue;
-
-          UpdateCascades(e, m_RendererContext.CurrentCamera, m_RendererData.UBO_DirectShadow);
-          m_RendererData.DirectShadowBuffer.Copy(&m_RendererData.UBO_DirectShadow, sizeof m_RendererData.UBO_DirectShadow);
+        if (m_GPUDriven) {
+          const uint32_t cascadeIndex = framebufferIndex;
+          RenderIndirect(1 + cascadeIndex,
+            commandBuffer.Get(),
+            m_Pipelines.DirectShadowDepthIndirectPipeline,
+            [&](const GPUScene::Batch&) {
+              const auto& layout = m_Pipelines.DirectShadowDepthIndirectPipeline.GetPipelineLayout();
+              commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(uint32_t), &cascadeIndex);
+              m_Pipelines.DirectShadowDepthIndirectPipeline.BindDescriptorSets(commandBuffer.Get(), {m_ShadowDepthDescriptorSet.Get(), m_InstanceDescriptorSet.Get()});
+              return true;
+            });
+          return;
+        }
 
-          for (const auto& mesh : m_MeshDrawList) {
-            if (!mesh.MeshGeometry)
-              continue;
-            m_Pipelines.DirectShadowDepthPipeline.BindDescriptorSets(commandBuffer.Get(), {m_ShadowDepthDescriptorSet.Get()});
-            struct PushConst {
-              glm::mat4 modelMatrix{};
-              uint32_t cascadeIndex = 0;
-            } pushConst;
-            pushConst.modelMatrix = mesh.Transform;
-            pushConst.cascadeIndex = framebufferIndex;
-            const auto& layout = m_Pipelines.DirectShadowDepthPipeline.GetPipelineLayout();
-            commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(PushConst), &pushConst);
-            RenderMesh(mesh,
-              commandBuffer.Get(),
-              m_Pipelines.DirectShadowDepthPipeline,
-              [&](const Mesh::Primitive*) {
-                return true;
-              }
-            );
-          }
+        for (const auto& mesh : m_ShadowMeshDrawLists[framebufferIndex]) {
+          m_Pipelines.DirectShadowDepthPipeline.BindDescriptorSets(commandBuffer.Get(), {m_ShadowDepthDescriptorSet.Get()});
+          struct PushConst {
+            glm::mat4 modelMatrix{};
+            uint32_t cascadeIndex = 0;
+          } pushConst;
+          pushConst.modelMatrix = mesh.Transform;
+          pushConst.cascadeIndex = framebufferIndex;
+          const auto& layout = m_Pipelines.DirectShadowDepthPipeline.GetPipelineLayout();
+          commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(PushConst), &pushConst);
+          RenderMesh(mesh,
+            commandBuffer.Get(),
+            m_Pipelines.DirectShadowDepthPipeline,
+            [&](const Mesh::Primitive*) {
+              return true;
+            }
+          );
         }
       },
       {vk::ClearDepthStencilValue{1.0f, 0}, vk::ClearColorValue(std::array{0.0f, 0.0f, 0.0f, 1.0f})},
       &VulkanContext::VulkanQueue.GraphicsQueue);
-    directShadowDepthPass.SetRenderArea(vk::Rect2D{
+    directShadowDepthPass.Write(m_Resources.DirectShadowsDepthArray)
+                         .Read(m_GPUScene.GetCommandBuffer())
+                         .Read(m_GPUScene.GetCountBuffer())
+                         .Read(GeometryBuffer::Get()->GetVertexBuffer())
+                         .SetRenderArea(vk::Rect2D{
       {}, {RendererConfig::Get()->DirectShadowsConfig.Size, RendererConfig::Get()->DirectShadowsConfig.Size},
     }).AddToGraph(m_RenderGraph);
 
     RenderGraphPass ssaoPass(
       "SSAO Pass",
-      {&m_RendererContext.SSAOCommandBuffer},
       &m_Pipelines.SSAOPassPipeline,
       {},
       [this](const VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -567,10 +1144,12 @@ namespace Oxylus {
       {clearValues},
       &VulkanContext::VulkanQueue.GraphicsQueue);
     ssaoPass
+     .Read(m_Framebuffers.DepthNormalPassFB)
+     .Write(m_Framebuffers.SSAOPassImage)
+     .Write(m_Framebuffers.SSAOBlurPassImage)
      .RunWithCondition(RendererConfig::Get()->SSAOConfig.Enabled)
      .AddInnerPass(RenderGraphPass(
         "SSAO Blur Pass",
-        {},
         &m_Pipelines.GaussianBlurPipeline,
         {},
         [this](VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -612,7 +1191,6 @@ namespace Oxylus {
 
     RenderGraphPass pbrPass(
       "PBR Pass",
-      {&m_RendererContext.PBRPassCommandBuffer},
       &m_Pipelines.SkyboxPipeline,
       {&m_Framebuffers.PBRPassFB},
       [this](VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -628,49 +1206,80 @@ namespace Oxylus {
         m_SkyboxCube.Draw(commandBuffer.Get());
 
         //PBR pipeline
-        for (const auto& mesh : m_MeshDrawList) {
-          if (!mesh.MeshGeometry)
-            continue;
+        if (m_GPUDriven) {
+          const auto pbrBatch = [&](const VulkanPipeline& pipeline, const GPUScene::Batch& batch) {
+            const auto& layout = pipeline.GetPipelineLayout();
+            commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eFragment, sizeof(glm::mat4), sizeof Material::Parameters, &batch.BatchMaterial->Parameters);
 
-          RenderMesh(mesh,
+            pipeline.BindDescriptorSets(commandBuffer.Get(), {Material::s_DescriptorSet.Get(), batch.BatchMaterial->MaterialDescriptorSet.Get(), m_InstanceDescriptorSet.Get()}, 0);
+          };
+          RenderIndirect(0,
             commandBuffer.Get(),
-            m_Pipelines.PBRPipeline,
-            [&](const Mesh::Primitive* part) {
-              const auto& material = mesh.Materials[part->materialIndex];
-              if (material->AlphaMode == Material::AlphaMode::Blend) {
-                m_TransparentMeshDrawList.emplace_back(mesh);
+            m_Pipelines.PBRIndirectPipeline,
+            [&](const GPUScene::Batch& batch) {
+              if (batch.Transparent)
                 return false;
-              }
-              const auto& layout = m_Pipelines.PBRPipeline.GetPipelineLayout();
-              commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4), &mesh.Transform);
-              commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eFragment, sizeof(glm::mat4), sizeof Material::Parameters, &material->Parameters);
+              pbrBatch(m_Pipelines.PBRIndirectPipeline, batch);
+              return true;
+            });
+          m_ForceUpdateMaterials = false;
 
-              m_Pipelines.PBRPipeline.BindDescriptorSets(commandBuffer.Get(), {Material::s_DescriptorSet.Get(), material->MaterialDescriptorSet.Get()}, 0);
+          // Transparency pass
+          RenderIndirect(0,
+            commandBuffer.Get(),
+            m_Pipelines.PBRBlendIndirectPipeline,
+            [&](const GPUScene::Batch& batch) {
+              if (!batch.Transparent)
+                return false;
+              pbrBatch(m_Pipelines.PBRBlendIndirectPipeline, batch);
               return true;
             });
         }
-        m_ForceUpdateMaterials = false;
-        m_MeshDrawList.clear();
+        else {
+          for (const auto& mesh : m_MeshDrawList) {
+            if (!mesh.MeshGeometry)
+              continue;
 
-        // Transparency pass
-        for (const auto& mesh : m_TransparentMeshDrawList) {
-          if (!mesh.MeshGeometry)
-            continue;
+            RenderMesh(mesh,
+              commandBuffer.Get(),
+              m_Pipelines.PBRPipeline,
+              [&](const Mesh::Primitive* part) {
+                const auto& material = mesh.Materials[part->materialIndex];
+                if (material->AlphaMode == Material::AlphaMode::Blend) {
+                  m_TransparentMeshDrawList.emplace_back(mesh);
+                  return false;
+                }
+                const auto& layout = m_Pipelines.PBRPipeline.GetPipelineLayout();
+                commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4), &mesh.Transform);
+                commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eFragment, sizeof(glm::mat4), sizeof Material::Parameters, &material->Parameters);
+
+                m_Pipelines.PBRPipeline.BindDescriptorSets(commandBuffer.Get(), {Material::s_DescriptorSet.Get(), material->MaterialDescriptorSet.Get()}, 0);
+                return true;
+              });
+          }
+          m_ForceUpdateMaterials = false;
+          m_MeshDrawList.clear();
 
-          RenderMesh(mesh,
-            commandBuffer.Get(),
-            m_Pipelines.PBRBlendPipeline,
-            [&](const Mesh::Primitive* part) {
-              const auto& material = mesh.Materials[part->materialIndex];
-              const auto& layout = m_Pipelines.PBRBlendPipeline.GetPipelineLayout();
-              commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4), &mesh.Transform);
-              commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eFragment, sizeof(glm::mat4), sizeof Material::Parameters, &material->Parameters);
+          // Transparency pass
+          for (const auto& mesh : m_TransparentMeshDrawList) {
+            if (!mesh.MeshGeometry)
+              continue;
 
-              m_Pipelines.PBRBlendPipeline.BindDescriptorSets(commandBuffer.Get(), {Material::s_DescriptorSet.Get(), material->MaterialDescriptorSet.Get()}, 0);
-              return true;
-            });
+            RenderMesh(mesh,
+              commandBuffer.Get(),
+              m_Pipelines.PBRBlendPipeline,
+              [&](const Mesh::Primitive* part) {
+                const auto& material = mesh.Materials[part->materialIndex];
+                const auto& layout = m_Pipelines.PBRBlendPipeline.GetPipelineLayout();
+                commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(glm::mat4), &mesh.Transform);
+                commandBuffer.PushConstants(layout, vk::ShaderStageFlagBits::eFragment, sizeof(glm::mat4), sizeof Material::Parameters, &material->Parameters);
+
+                m_Pipelines.PBRBlendPipeline.BindDescriptorSets(commandBuffer.Get(), {Material::s_DescriptorSet.Get(), material->MaterialDescriptorSet.Get()}, 0);
+                return true;
+              });
+          }
+          m_TransparentMeshDrawList.clear();
         }
-        m_TransparentMeshDrawList.clear();
 
         // Depth-tested debug renderer pass
         auto& shapes = DebugRenderer::GetInstance()->GetShapes();
@@ -699,7 +1308,6 @@ namespace Oxylus {
 
     pbrPass.AddInnerPass(RenderGraphPass(
       "Debug Renderer NDT Pass",
-      {&m_RendererContext.PBRPassCommandBuffer},
       &m_Pipelines.DebugRenderPipelineNDT,
       {&m_Framebuffers.PBRPassFB},
       [this](VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -729,11 +1337,14 @@ namespace Oxylus {
       clearValues,
       &VulkanContext::VulkanQueue.GraphicsQueue
     ));
-    pbrPass.AddToGraph(m_RenderGraph);
+    pbrPass.Read(m_Resources.DirectShadowsDepthArray)
+           .Read(m_GPUScene.GetCommandBuffer())
+           .Read(m_GPUScene.GetCountBuffer())
+           .Read(GeometryBuffer::Get()->GetVertexBuffer())
+           .AddToGraph(m_RenderGraph);
 
     RenderGraphPass ssrPass(
       "SSR Pass",
-      {&m_RendererContext.SSRCommandBuffer},
       &m_Pipelines.SSRPipeline,
       {},
       [this](const VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -745,12 +1356,14 @@ namespace Oxylus {
       },
       clearValues,
       &VulkanContext::VulkanQueue.GraphicsQueue);
-    ssrPass.RunWithCondition(RendererConfig::Get()->SSRConfig.Enabled)
+    ssrPass.Read(m_Framebuffers.PBRPassFB)
+           .Read(m_Framebuffers.DepthNormalPassFB)
+           .Write(m_Framebuffers.SSRPassImage)
+           .RunWithCondition(RendererConfig::Get()->SSRConfig.Enabled)
            .AddToGraphCompute(m_RenderGraph);
 
     RenderGraphPass bloomPass(
       "Bloom Pass",
-      {&m_RendererContext.BloomPassCommandBuffer},
       &m_Pipelines.BloomPipeline,
       {},
       [this](VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -835,12 +1448,14 @@ namespace Oxylus {
       },
       clearValues,
       &VulkanContext::VulkanQueue.GraphicsQueue);
-    bloomPass.RunWithCondition(RendererConfig::Get()->BloomConfig.Enabled)
+    bloomPass.Read(m_Framebuffers.PBRPassFB)
+             .Write(m_Framebuffers.BloomDownsampleImage)
+             .Write(m_Framebuffers.BloomUpsampleImage)
+             .RunWithCondition(RendererConfig::Get()->BloomConfig.Enabled)
              .AddToGraphCompute(m_RenderGraph);
 
     RenderGraphPass dofPass(
       "DepthOfField Pass",
-      {&m_RendererContext.DepthOfFieldCommandBuffer},
       &m_Pipelines.DepthOfFieldPipeline,
       {},
       [this](const VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -853,11 +1468,12 @@ namespace Oxylus {
       clearValues,
       &VulkanContext::VulkanQueue.GraphicsQueue
     );
-    dofPass.AddToGraphCompute(m_RenderGraph);
+    dofPass.Read(m_Framebuffers.PBRPassFB)
+           .Write(m_Framebuffers.DepthOfFieldImage)
+           .AddToGraphCompute(m_RenderGraph);
 
     RenderGraphPass atmospherePass(
       "Atmosphere Pass",
-      {&m_RendererContext.AtmosphereCommandBuffer},
       &m_Pipelines.AtmospherePipeline,
       {},
       [this](const VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -894,11 +1510,11 @@ namespace Oxylus {
       },
       clearValues,
       &VulkanContext::VulkanQueue.GraphicsQueue);
+    atmospherePass.Write(m_Framebuffers.AtmosphereImage);
     //atmospherePass.AddToGraphCompute(renderGraph);
 
     RenderGraphPass compositePass(
       "Composite Pass",
-      {&m_RendererContext.CompositeCommandBuffer},
       &m_Pipelines.CompositePipeline,
       {},
       [this](VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -910,11 +1526,16 @@ namespace Oxylus {
       },
       clearValues,
       &VulkanContext::VulkanQueue.GraphicsQueue);
-    compositePass.AddToGraphCompute(m_RenderGraph);
+    compositePass.Read(m_Framebuffers.DepthOfFieldImage)
+                 .Read(m_Framebuffers.SSAOBlurPassImage)
+                 .Read(m_Framebuffers.BloomUpsampleImage)
+                 .Read(m_Framebuffers.SSRPassImage)
+                 .ReadHistory(m_Framebuffers.PostProcessPassFB)
+                 .Write(m_Framebuffers.CompositePassImage)
+                 .AddToGraphCompute(m_RenderGraph);
 
     RenderGraphPass ppPass({
       "PP Pass",
-      {&m_RendererContext.PostProcessCommandBuffer},
       &m_Pipelines.PostProcessPipeline,
       {&m_Framebuffers.PostProcessPassFB},
       [this](VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -927,18 +1548,18 @@ namespace Oxylus {
       },
       clearValues, &VulkanContext::VulkanQueue.GraphicsQueue
     });
-    ppPass.AddToGraph(m_RenderGraph);
+    ppPass.Read(m_Framebuffers.CompositePassImage)
+          .AddToGraph(m_RenderGraph);
 
     RenderGraphPass frustumPass(
       "Frustum Pass",
-      {&m_RendererContext.FrustumCommandBuffer},
       {},
       {},
       [this](const VulkanCommandBuffer& commandBuffer, int32_t) {
         OX_SCOPED_ZONE_N("FrustumPass");
         OX_TRACE_GPU(commandBuffer.Get(), "Frustum Pass")
         m_Pipelines.FrustumGridPipeline.BindPipeline(commandBuffer.Get());
-        m_Pipelines.FrustumGridPipeline.BindDescriptorSets(m_RendererContext.FrustumCommandBuffer.Get(), {m_LightListDescriptorSet.Get()});
+        m_Pipelines.FrustumGridPipeline.BindDescriptorSets(commandBuffer.Get(), {m_LightListDescriptorSet.Get()});
         commandBuffer.Dispatch(m_RendererData.UBO_PbrPassParams.numThreadGroups.x, m_RendererData.UBO_PbrPassParams.numThreadGroups.y, 1);
       },
       {},
@@ -947,7 +1568,6 @@ namespace Oxylus {
 
     RenderGraphPass lightListPass(
       "Light List Pass",
-      {&m_RendererContext.LightListCommandBuffer},
       {},
       {},
       [this](const VulkanCommandBuffer& commandBuffer, int32_t) {
@@ -1077,6 +1697,36 @@ namespace Oxylus {
       .Name = "GaussianBlur",
       .ComputePath = Resources::GetResourcesPath("Shaders/GaussianBlur.comp"),
     });
+    auto pbrIndirectShader = ShaderLibrary::CreateShaderAsync(ShaderCI{
+      .VertexPath = Resources::GetResourcesPath("Shaders/PBRTiledIndirect.vert"),
+      .FragmentPath = Resources::GetResourcesPath("Shaders/PBRTiled.frag"),
+      .EntryPoint = "main", .Name = "PBRTiledIndirect",
+    });
+    auto depthPassIndirectShader = ShaderLibrary::CreateShaderAsync(ShaderCI{
+      .VertexPath = Resources::GetResourcesPath("Shaders/DepthNormalPassIndirect.vert"),
+      .FragmentPath = Resources::GetResourcesPath("Shaders/DepthNormalPass.frag"),
+      .EntryPoint = "main", .Name = "DepthPassIndirect"
+    });
+    auto directShadowIndirectShader = ShaderLibrary::CreateShaderAsync(ShaderCI{
+      .VertexPath = Resources::GetResourcesPath("Shaders/DirectShadowDepthPassIndirect.vert"),
+      .FragmentPath = Resources::GetResourcesPath("Shaders/DirectShadowDepthPass.frag"),
+      .EntryPoint = "main", .Name = "DirectShadowDepthIndirect"
+    });
+    auto gpuCullShader = ShaderLibrary::CreateShaderAsync(ShaderCI{
+      .EntryPoint = "main",
+      .Name = "GPUCull",
+      .ComputePath = Resources::GetResourcesPath("Shaders/GPUCull.comp"),
+    });
+    auto hiZShader = ShaderLibrary::CreateShaderAsync(ShaderCI{
+      .EntryPoint = "main",
+      .Name = "HiZ",
+      .ComputePath = Resources::GetResourcesPath("Shaders/HiZ.comp"),
+    });
+    auto skinningShader = ShaderLibrary::CreateShaderAsync(ShaderCI{
+      .EntryPoint = "main",
+      .Name = "Skinning",
+      .ComputePath = Resources::GetResourcesPath("Shaders/Skinning.comp"),
+    });
 
     PipelineDescription pbrPipelineDesc{};
     pbrPipelineDesc.Name = "Skybox Pipeline";
@@ -1109,6 +1759,11 @@ namespace Oxylus {
     pbrPipelineDesc.RasterizerDesc.CullMode = vk::CullModeFlagBits::eBack;
     m_Pipelines.PBRPipeline.CreateGraphicsPipeline(pbrPipelineDesc);
 
+    PipelineDescription pbrIndirectDesc = pbrPipelineDesc;
+    pbrIndirectDesc.Name = "PBR Indirect Pipeline";
+    pbrIndirectDesc.Shader = pbrIndirectShader.get();
+    m_Pipelines.PBRIndirectPipeline.CreateGraphicsPipeline(pbrIndirectDesc);
+
     pbrPipelineDesc.Name = "PBR Blend Pipeline";
     pbrPipelineDesc.BlendStateDesc.RenderTargets[0].BlendEnable = true;
     pbrPipelineDesc.BlendStateDesc.RenderTargets[0].SrcBlend = vk::BlendFactor::eSrcAlpha;
@@ -1117,6 +1772,10 @@ namespace Oxylus {
     pbrPipelineDesc.BlendStateDesc.RenderTargets[0].BlendOpAlpha = vk::BlendOp::eAdd;
     m_Pipelines.PBRBlendPipeline.CreateGraphicsPipeline(pbrPipelineDesc);
 
+    pbrIndirectDesc.Name = "PBR Blend Indirect Pipeline";
+    pbrIndirectDesc.BlendStateDesc = pbrPipelineDesc.BlendStateDesc;
+    m_Pipelines.PBRBlendIndirectPipeline.CreateGraphicsPipeline(pbrIndirectDesc);
+
     PipelineDescription depthpassdescription;
     depthpassdescription.Name = "Depth Pass Pipeline";
     depthpassdescription.Shader = depthPassShader.get();
@@ -1131,6 +1790,10 @@ namespace Oxylus {
     }));
     m_Pipelines.DepthPrePassPipeline.CreateGraphicsPipeline(depthpassdescription);
 
+    depthpassdescription.Name = "Depth Pass Indirect Pipeline";
+    depthpassdescription.Shader = depthPassIndirectShader.get();
+    m_Pipelines.DepthPrePassIndirectPipeline.CreateGraphicsPipeline(depthpassdescription);
+
     PipelineDescription directShadowPipelineDescription;
     directShadowPipelineDescription.VertexInputState = VertexInputDescription(VertexLayout({
       VertexComponent::POSITION, VertexComponent::NORMAL, VertexComponent::UV
@@ -1150,6 +1813,10 @@ namespace Oxylus {
     directShadowPipelineDescription.DepthAttachmentLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
     m_Pipelines.DirectShadowDepthPipeline.CreateGraphicsPipeline(directShadowPipelineDescription);
 
+    directShadowPipelineDescription.Name = "Direct Shadow Indirect Pipeline";
+    directShadowPipelineDescription.Shader = directShadowIndirectShader.get();
+    m_Pipelines.DirectShadowDepthIndirectPipeline.CreateGraphicsPipeline(directShadowPipelineDescription);
+
     PipelineDescription debugDescription;
     debugDescription.Name = "Debug Renderer Pipeline";
     debugDescription.Shader = unlitShader.get();
@@ -1160,7 +1827,7 @@ namespace Oxylus {
     debugDescription.RasterizerDesc.FillMode = vk::PolygonMode::eLine;
     debugDescription.RasterizerDesc.LineWidth = 1.0f;
     debugDescription.VertexInputState = VertexInputDescription(VertexLayout({
-      VertexComponent::POSITION, VertexComponent::NORMAL, VertexComponent::UV, VertexComponent::COLOR
+      VertexComponent::POSITION, VertexComponent::NORMAL, VertexComponent::UV
     }));
     m_Pipelines.DebugRenderPipeline.CreateGraphicsPipeline(debugDescription);
 
@@ -1213,9 +1880,15 @@ namespace Oxylus {
     PipelineDescription ppPass;
     ppPass.Shader = postProcessShader.get();
     ppPass.RasterizerDesc.CullMode = vk::CullModeFlagBits::eNone;
-    ppPass.VertexInputState = VertexInputDescription(VertexLayout({
-      VertexComponent::POSITION, VertexComponent::NORMAL, VertexComponent::UV
-    }));
+    // Draws the fullscreen triangle of the renderer, not a mesh
+    using TriangleVertex = VulkanRenderer::RendererData::Vertex;
+    ppPass.VertexInputState.bindingDescriptions = {
+      vk::VertexInputBindingDescription{0, sizeof(TriangleVertex), vk::VertexInputRate::eVertex},
+    };
+    ppPass.VertexInputState.attributeDescriptions = {
+      vk::VertexInputAttributeDescription{0, 0, vk::Format::eR32G32B32Sfloat, (uint32_t)offsetof(TriangleVertex, Position)},
+      vk::VertexInputAttributeDescription{2, 0, vk::Format::eR32G32Sfloat, (uint32_t)offsetof(TriangleVertex, UV)},
+    };
     ppPass.DepthDesc.DepthEnable = false;
     m_Pipelines.PostProcessPipeline.CreateGraphicsPipeline(ppPass);
 
@@ -1225,6 +1898,21 @@ namespace Oxylus {
 
     computePipelineDesc.Shader = lightListShader.get();
     m_Pipelines.LightListPipeline.CreateComputePipeline(computePipelineDesc);
+
+    PipelineDescription gpuCullDesc;
+    gpuCullDesc.Name = "GPU Cull Pipeline";
+    gpuCullDesc.Shader = gpuCullShader.get();
+    m_Pipelines.GPUCullPipeline.CreateComputePipeline(gpuCullDesc);
+
+    PipelineDescription skinningDesc;
+    skinningDesc.Name = "Skinning Pipeline";
+    skinningDesc.Shader = skinningShader.get();
+    m_Pipelines.SkinningPipeline.CreateComputePipeline(skinningDesc);
+
+    PipelineDescription hiZDesc;
+    hiZDesc.Name = "Hi-Z Pipeline";
+    hiZDesc.Shader = hiZShader.get();
+    m_Pipelines.HiZPipeline.CreateComputePipeline(hiZDesc);
   }
 
   void DefaultRenderPipeline::CreateFramebuffers() {
@@ -1,4 +1,7 @@
 ﻿#pragma once
+#include "BoundingVolumeHierarchy.h"
+#include "GPUScene.h"
+#include "GPUSkinning.h"
 #include "RendererConfig.h"
 #include "RenderGraph.h"
 #include "RenderPipeline.h"
@@ -24,24 +27,15 @@ namespace Oxylus {
     void OnDispatcherEvents(EventDispatcher& dispatcher) override;
     void OnShutdown() override;
 
+    /// Draws the camera view issued for the opaque and transparent meshes, one per primitive on the CPU path and one
+    /// per meshlet on the GPU driven path. The GPU driven count is read back and lags behind by the frames in flight.
+    uint32_t GetCameraDrawCount() const { return m_CameraDrawCount; }
+
   protected:
     void InitRenderGraph() override;
 
   private:
     struct RendererContext {
-      VulkanCommandBuffer LightListCommandBuffer;
-      VulkanCommandBuffer DirectShadowCommandBuffer;
-      VulkanCommandBuffer PBRPassCommandBuffer;
-      VulkanCommandBuffer PostProcessCommandBuffer;
-      VulkanCommandBuffer BloomPassCommandBuffer;
-      VulkanCommandBuffer FrustumCommandBuffer;
-      VulkanCommandBuffer DepthPassCommandBuffer;
-      VulkanCommandBuffer SSAOCommandBuffer;
-      VulkanCommandBuffer SSRCommandBuffer;
-      VulkanCommandBuffer CompositeCommandBuffer;
-      VulkanCommandBuffer AtmosphereCommandBuffer;
-      VulkanCommandBuffer DepthOfFieldCommandBuffer;
-
       //Camera
       Camera* CurrentCamera = nullptr;
     } m_RendererContext;
@@ -163,6 +157,13 @@ namespace Oxylus {
       VulkanPipeline DepthOfFieldPipeline;
       VulkanPipeline DebugRenderPipeline;
       VulkanPipeline DebugRenderPipelineNDT;
+      VulkanPipeline PBRIndirectPipeline;
+      VulkanPipeline PBRBlendIndirectPipeline;
+      VulkanPipeline DepthPrePassIndirectPipeline;
+      VulkanPipeline DirectShadowDepthIndirectPipeline;
+      VulkanPipeline GPUCullPipeline;
+      VulkanPipeline HiZPipeline;
+      VulkanPipeline SkinningPipeline;
     } m_Pipelines;
 
     struct FrameBuffers {
@@ -193,6 +194,10 @@ namespace Oxylus {
     VulkanDescriptorSet m_CompositeDescriptorSet;
     VulkanDescriptorSet m_AtmosphereDescriptorSet;
     VulkanDescriptorSet m_DepthOfFieldDescriptorSet;
+    VulkanDescriptorSet m_InstanceDescriptorSet;
+    VulkanDescriptorSet m_GPUCullDescriptorSet;
+    VulkanDescriptorSet m_HiZDescriptorSet;
+    VulkanDescriptorSet m_SkinningDescriptorSet;
 
     Scene* m_Scene = nullptr;
 
@@ -204,18 +209,99 @@ namespace Oxylus {
       std::vector<Ref<Material>>& Materials;
       Mat4 Transform;
       uint32_t SubmeshIndex = 0;
+      float LodPixelsPerUnit = FLT_MAX; // Projects the LOD errors of the mesh onto the screen, the default keeps full detail
+      int32_t VertexOffset = 0;         // Skinned copies of the vertices are drawn in place of the ones of the mesh
+
+      MeshData(Mesh& mesh,
+               const Mat4& transform,
+               std::vector<Ref<Material>>& materials,
+               const uint32_t submeshIndex,
+               const float lodPixelsPerUnit = FLT_MAX) : MeshData(mesh, transform, materials, submeshIndex, lodPixelsPerUnit,
+                                                                  (int32_t)mesh.GetGeometry().VertexOffset) {}
 
       MeshData(Mesh& mesh,
                const Mat4& transform,
                std::vector<Ref<Material>>& materials,
-               const uint32_t submeshIndex) : MeshGeometry(mesh), Materials(materials), Transform(transform),
-                                              SubmeshIndex(submeshIndex) {}
+               const uint32_t submeshIndex,
+               const float lodPixelsPerUnit,
+               const int32_t vertexOffset) : MeshGeometry(mesh), Materials(materials), Transform(transform),
+                                             SubmeshIndex(submeshIndex), LodPixelsPerUnit(lodPixelsPerUnit), VertexOffset(vertexOffset) {}
     };
 
     std::vector<MeshData> m_MeshDrawList;
     std::vector<MeshData> m_TransparentMeshDrawList;
+    std::vector<MeshData> m_ShadowMeshDrawLists[SHADOW_MAP_CASCADE_COUNT];
+
+    // Culling
+    struct MeshProxy {
+      entt::entity Handle = entt::null;
+      int32_t ProxyId = BoundingVolumeHierarchy::NullNode;
+      uint32_t TransformVersion = 0;
+      Mesh* MeshGeometry = nullptr;
+      std::vector<Ref<Material>>* Materials = nullptr;
+      uint32_t SubmeshIndex = 0;
+      Mat4 Transform = Mat4(1);
+      AABB LocalBounds = {};
+      uint64_t LastSeenFrame = 0;
+      size_t MaterialsHash = 0;
+      uint64_t TextureViewVersion = UINT64_MAX; // Streamer view version the material descriptors were written for
+      GPUSkinning::Handle Skinning = GPUSkinning::InvalidHandle;
+      bool SkinningAtRest = false; // The joints hold the rest pose of the skin
+    };
+
+    /// How the LOD errors of meshes project onto the screen of a view.
+    struct LodView {
+      Vec3 Position = {};          // Perspective views divide by the distance from here
+      float PixelsPerUnit = 0.0f;  // At distance 1 for perspective views
+      bool Perspective = true;
+    };
 
-    void RenderNode(const Mesh::Node* node,
+    BoundingVolumeHierarchy m_MeshBVH;
+    std::vector<MeshProxy> m_MeshProxies; // Indexed by entity
+    std::vector<uint32_t> m_ActiveMeshProxies;
+    std::vector<uint32_t> m_VisibleMeshProxies;
+    Scene* m_CulledScene = nullptr;
+    uint64_t m_CullingFrame = 0;
+
+    void UpdateMeshProxies(Scene* scene);
+    void ResetMeshProxy(MeshProxy& proxy);
+    /// Vertex offset the draws of the proxy use, the one of its skinned vertices if it has a skin.
+    int32_t GetProxyVertexOffset(const MeshProxy& proxy) const;
+    void CullMeshes(const Mat4& viewProjection, bool ignoreNearPlane, const LodView& lodView, std::vector<MeshData>& outDrawList);
+    LodView GetCameraLodView() const;
+    LodView GetCascadeLodView(uint32_t cascadeIndex) const;
+    void UpdateTextureStreaming();
+
+    // GPU driven rendering
+    GPUScene m_GPUScene;
+    bool m_GPUDriven = false;
+    bool m_HiZEnabled = false;
+    bool m_GPUDrawsDirty = true;
+    uint32_t m_CameraDrawCount = 0;
+    uint32_t m_GPUSceneBufferVersion = UINT32_MAX;
+    uint32_t m_GeometryVersion = UINT32_MAX;
+    // Skinning
+    GPUSkinning m_GPUSkinning;
+    bool m_SkinningActive = false;
+    uint32_t m_SkinningGeometryVersion = UINT32_MAX;
+    uint32_t m_SkinningBufferVersion = UINT32_MAX;
+    VulkanImage m_HiZImage;
+    vk::ImageView m_HiZDepthView = {};       // Depth buffer view the Hi-Z was created for
+    std::vector<vk::DescriptorImageInfo> m_HiZMipDescriptors;
+    std::vector<vk::DescriptorImageInfo> m_HiZMipInfos; // Mip array of m_HiZDescriptorSet, padded to its size
+    bool m_HiZValid = false;                 // The Hi-Z holds the depth of the previous frame
+    Mat4 m_HiZViewProjection = Mat4(1);
+
+    void UpdateGPUScene();
+    void UpdateGPUViews(bool directionalShadows);
+    void UpdateHiZ();
+    void UpdateGPUDescriptorSets();
+    void UpdateSkinning(Scene* scene);
+
+    void RenderNode(const Mesh& mesh,
+                    const Mesh::Node* node,
+                    float lodPixelsPerUnit,
+                    int32_t vertexOffset,
                     const vk::CommandBuffer& commandBuffer,
                     const VulkanPipeline& pipeline,
                     const std::function<bool(Mesh::Primitive* prim)>& perMeshFunc);
@@ -223,6 +309,11 @@ namespace Oxylus {
                     const vk::CommandBuffer& commandBuffer,
                     const VulkanPipeline& pipeline,
                     const std::function<bool(Mesh::Primitive* prim)>& perMeshFunc);
+    /// Draws the batches accepted by perBatchFunc with the commands the GPU cull pass wrote for the view.
+    void RenderIndirect(uint32_t view,
+                        const vk::CommandBuffer& commandBuffer,
+                        const VulkanPipeline& pipeline,
+                        const std::function<bool(const GPUScene::Batch& batch)>& perBatchFunc);
 
     // Lighting
     struct LightingData {
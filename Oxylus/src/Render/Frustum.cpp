@@ -0,0 +1,99 @@
+#include "Frustum.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OX_FRUSTUM_SSE 1
+#include <xmmintrin.h>
+#else
+#define OX_FRUSTUM_SSE 0
+#endif
+
+namespace Oxylus {
+  AABB AABB::Transform(const Mat4& matrix) const {
+    // Arvo's method: project the extents onto the transformed axes
+    const Vec3 center = Vec3(matrix * Vec4(GetCenter(), 1.0f));
+    const Vec3 extents = GetExtents();
+    const Vec3 newExtents = glm::abs(Vec3(matrix[0])) * extents.x +
+                            glm::abs(Vec3(matrix[1])) * extents.y +
+                            glm::abs(Vec3(matrix[2])) * extents.z;
+    return {center - newExtents, center + newExtents};
+  }
+
+  Frustum::Frustum(const Mat4& viewProjection, bool ignoreNearPlane) {
+    const auto row = [&viewProjection](int i) {
+      return Vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+
+    const Vec4 planes[6] = {
+      row(3) + row(0), // Left
+      row(3) - row(0), // Right
+      row(3) + row(1), // Bottom
+      row(3) - row(1), // Top
+      row(2),          // Near
+      row(3) - row(2), // Far
+    };
+
+    for (uint32_t i = 0; i < 8; i++) {
+      // The padding planes accept everything
+      Vec4 plane = Vec4(0.0f, 0.0f, 0.0f, FLT_MAX);
+      if (i < 6 && !(ignoreNearPlane && i == 4)) {
+        const float length = glm::length(Vec3(planes[i]));
+        plane = length > 0.0f ? planes[i] / length : planes[i];
+      }
+
+      m_NormalX[i] = plane.x;
+      m_NormalY[i] = plane.y;
+      m_NormalZ[i] = plane.z;
+      m_AbsNormalX[i] = glm::abs(plane.x);
+      m_AbsNormalY[i] = glm::abs(plane.y);
+      m_AbsNormalZ[i] = glm::abs(plane.z);
+      m_Distance[i] = plane.w;
+    }
+  }
+
+  FrustumIntersection Frustum::Intersect(const AABB& aabb) const {
+    const Vec3 center = aabb.GetCenter();
+    const Vec3 extents = aabb.GetExtents();
+
+#if OX_FRUSTUM_SSE
+    const __m128 centerX = _mm_set1_ps(center.x);
+    const __m128 centerY = _mm_set1_ps(center.y);
+    const __m128 centerZ = _mm_set1_ps(center.z);
+    const __m128 extentX = _mm_set1_ps(extents.x);
+    const __m128 extentY = _mm_set1_ps(extents.y);
+    const __m128 extentZ = _mm_set1_ps(extents.z);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 outside = zero;
+    __m128 crossing = zero;
+    for (uint32_t i = 0; i < 8; i += 4) {
+      // Signed distance of the box center and the box radius along each plane normal
+      __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_load_ps(m_NormalX + i), centerX), _mm_load_ps(m_Distance + i));
+      distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(m_NormalY + i), centerY));
+      distance = _mm_add_ps(distance, _mm_mul_ps(_mm_load_ps(m_NormalZ + i), centerZ));
+
+      __m128 radius = _mm_mul_ps(_mm_load_ps(m_AbsNormalX + i), extentX);
+      radius = _mm_add_ps(radius, _mm_mul_ps(_mm_load_ps(m_AbsNormalY + i), extentY));
+      radius = _mm_add_ps(radius, _mm_mul_ps(_mm_load_ps(m_AbsNormalZ + i), extentZ));
+
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+      crossing = _mm_or_ps(crossing, _mm_cmplt_ps(_mm_sub_ps(distance, radius), zero));
+    }
+
+    if (_mm_movemask_ps(outside))
+      return FrustumIntersection::Outside;
+    if (_mm_movemask_ps(crossing))
+      return FrustumIntersection::Intersects;
+    return FrustumIntersection::Inside;
+#else
+    bool crossing = false;
+    for (uint32_t i = 0; i < 8; i++) {
+      const float distance = m_NormalX[i] * center.x + m_NormalY[i] * center.y + m_NormalZ[i] * center.z + m_Distance[i];
+      const float radius = m_AbsNormalX[i] * extents.x + m_AbsNormalY[i] * extents.y + m_AbsNormalZ[i] * extents.z;
+      if (distance + radius < 0.0f)
+        return FrustumIntersection::Outside;
+      crossing |= distance - radius < 0.0f;
+    }
+    return crossing ? FrustumIntersection::Intersects : FrustumIntersection::Inside;
+#endif
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cfloat>
+
+#include "Core/Types.h"
+
+namespace Oxylus {
+  struct AABB {
+    Vec3 Min = Vec3(FLT_MAX);
+    Vec3 Max = Vec3(-FLT_MAX);
+
+    AABB() = default;
+    AABB(const Vec3& min, const Vec3& max) : Min(min), Max(max) { }
+
+    bool IsValid() const { return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z; }
+    Vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+    Vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+    float GetSurfaceArea() const {
+      const Vec3 size = Max - Min;
+      return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    bool Contains(const AABB& other) const {
+      return glm::all(glm::lessThanEqual(Min, other.Min)) && glm::all(glm::greaterThanEqual(Max, other.Max));
+    }
+
+    void Merge(const AABB& other) {
+      Min = glm::min(Min, other.Min);
+      Max = glm::max(Max, other.Max);
+    }
+
+    static AABB Merge(const AABB& a, const AABB& b) { return {glm::min(a.Min, b.Min), glm::max(a.Max, b.Max)}; }
+
+    AABB Expanded(float margin) const { return {Min - Vec3(margin), Max + Vec3(margin)}; }
+
+    /// Bounds of this box after transforming it by the given matrix.
+    AABB Transform(const Mat4& matrix) const;
+  };
+
+  enum class FrustumIntersection {
+    Outside,
+    Intersects,
+    Inside
+  };
+
+  /// View frustum built from a view projection matrix with a [0, 1] depth range.
+  class Frustum {
+  public:
+    Frustum() = default;
+    /// Skipping the near plane keeps everything between the eye and the far plane, which is what
+    /// depth clamped passes like shadow maps still rasterize.
+    explicit Frustum(const Mat4& viewProjection, bool ignoreNearPlane = false);
+
+    FrustumIntersection Intersect(const AABB& aabb) const;
+    bool IsVisible(const AABB& aabb) const { return Intersect(aabb) != FrustumIntersection::Outside; }
+
+    /// Normalized plane as (normal, distance). Planes are left, right, bottom, top, near, far.
+    Vec4 GetPlane(uint32_t index) const {
+      return {m_NormalX[index], m_NormalY[index], m_NormalZ[index], m_Distance[index]};
+    }
+
+  private:
+    // The six planes stored as structure of arrays and padded to eight, so they are tested four at a time
+    alignas(16) float m_NormalX[8] = {};
+    alignas(16) float m_NormalY[8] = {};
+    alignas(16) float m_NormalZ[8] = {};
+    alignas(16) float m_AbsNormalX[8] = {};
+    alignas(16) float m_AbsNormalY[8] = {};
+    alignas(16) float m_AbsNormalZ[8] = {};
+    alignas(16) float m_Distance[8] = {};
+  };
+}
@@ -0,0 +1,250 @@
+#include "GPUScene.h"
+
+#include "Mesh.h"
+#include "Assets/Material.h"
+#include "Utils/Profiler.h"
+#include "Vulkan/VulkanRenderer.h"
+
+namespace Oxylus {
+  static constexpr uint32_t InitialInstanceCapacity = 1024;
+  static constexpr uint32_t InitialDrawCapacity = 1024;
+  static constexpr uint32_t InitialBatchCapacity = 64;
+
+  void GPUScene::Init() {
+    m_ViewBuffer.CreateBuffer(vBU::eUniformBuffer, vMP::eHostVisible | vMP::eHostCoherent, sizeof(ViewsUB), &m_ViewsData).Map();
+    CreateInstanceBuffer(InitialInstanceCapacity);
+    CreateDrawBuffers(InitialDrawCapacity, InitialBatchCapacity);
+  }
+
+  void GPUScene::Destroy() {
+    m_ViewBuffer.Destroy();
+    m_InstanceBuffer.Destroy();
+    m_DrawBuffer.Destroy();
+    m_BatchBuffer.Destroy();
+    m_CommandBuffer.Destroy();
+    m_CountBuffer.Destroy();
+    if (m_CountReadbackCapacity)
+      m_CountReadbackBuffer.Destroy();
+  }
+
+  void GPUScene::SetInstance(const uint32_t instanceIndex, const Mat4& transform) {
+    if (instanceIndex >= (uint32_t)m_Instances.size())
+      m_Instances.resize(instanceIndex + 1, Mat4(1));
+    m_Instances[instanceIndex] = transform;
+
+    if (instanceIndex >= m_InstanceCapacity) {
+      CreateInstanceBuffer(std::max(m_InstanceCapacity * 2, instanceIndex + 1));
+      return;
+    }
+    m_InstanceBuffer.Copy(&transform, sizeof(Mat4), instanceIndex * sizeof(Mat4));
+  }
+
+  void GPUScene::BeginDraws() {
+    m_Draws.clear();
+    m_Batches.clear();
+    m_BatchLookup.clear();
+  }
+
+  void GPUScene::AddDraws(const uint32_t instanceIndex,
+                          Mesh& mesh,
+                          const uint32_t submeshIndex,
+                          const std::vector<Ref<Material>>& materials,
+                          const Skinning* skinning) {
+    const auto& geometry = mesh.GetGeometry();
+    std::vector<const Mesh::Node*> nodes = {mesh.LinearNodes[submeshIndex]};
+    while (!nodes.empty()) {
+      const Mesh::Node* node = nodes.back();
+      nodes.pop_back();
+      nodes.insert(nodes.end(), node->Children.begin(), node->Children.end());
+
+      for (const auto& primitive : node->Primitives) {
+        if (primitive->materialIndex >= (int32_t)materials.size())
+          continue;
+
+        Material* material = materials[primitive->materialIndex].get();
+        const auto [it, inserted] = m_BatchLookup.try_emplace(BatchKey{&mesh, material}, (uint32_t)m_Batches.size());
+        if (inserted)
+          m_Batches.emplace_back(Batch{&mesh, material, material->AlphaMode == Material::AlphaMode::Blend});
+
+        // Skinned meshlets move with the joints, so every level of the primitive is drawn whole and without the cone test
+        if (skinning) {
+          const Vec3 extents = skinning->Bounds.GetExtents();
+          const Vec4 bounds = Vec4(skinning->Bounds.GetCenter(), glm::length(extents));
+          m_Batches[it->second].MaxCommandCount += primitive->lodCount + 1;
+          for (uint32_t level = 0; level <= primitive->lodCount; level++) {
+            const Mesh::Lod lod = level == 0
+                                    ? Mesh::Lod{primitive->firstIndex, primitive->indexCount, primitive->firstMeshlet, primitive->meshletCount, 0.0f}
+                                    : mesh.Lods[primitive->firstLod + level - 1];
+            const float coarserError = level < primitive->lodCount ? mesh.Lods[primitive->firstLod + level].Error : FLT_MAX;
+            m_Draws.emplace_back(GPUDraw{
+              bounds, Vec4(extents, 0.0f), Vec4(0, 0, 0, 1), bounds,
+              instanceIndex, geometry.IndexOffset + lod.FirstIndex, lod.IndexCount, it->second, skinning->VertexOffset,
+              lod.Error, coarserError
+            });
+          }
+          continue;
+        }
+
+        const Vec4 lodBounds = Vec4(primitive->dimensions.center, primitive->dimensions.radius);
+        if (!primitive->meshletCount) {
+          m_Batches[it->second].MaxCommandCount++;
+          const Vec3 extents = (primitive->dimensions.max - primitive->dimensions.min) * 0.5f;
+          m_Draws.emplace_back(GPUDraw{
+            Vec4(primitive->dimensions.center, glm::length(extents)), Vec4(extents, 0.0f), Vec4(0, 0, 0, 1), lodBounds,
+            instanceIndex, geometry.IndexOffset + primitive->firstIndex, primitive->indexCount, it->second, (int32_t)geometry.VertexOffset
+          });
+          continue;
+        }
+
+        // Meshlets of every level are added, culling keeps the ones of the level each view selects
+        const bool doubleSided = material->Parameters.DoubleSided;
+        for (uint32_t level = 0; level <= primitive->lodCount; level++) {
+          const Mesh::Lod lod = level == 0
+                                  ? Mesh::Lod{primitive->firstIndex, primitive->indexCount, primitive->firstMeshlet, primitive->meshletCount, 0.0f}
+                                  : mesh.Lods[primitive->firstLod + level - 1];
+          const float coarserError = level < primitive->lodCount ? mesh.Lods[primitive->firstLod + level].Error : FLT_MAX;
+          m_Batches[it->second].MaxCommandCount += lod.MeshletCount;
+          for (uint32_t i = 0; i < lod.MeshletCount; i++) {
+            const Meshlet& meshlet = mesh.Meshlets[lod.FirstMeshlet + i];
+            m_Draws.emplace_back(GPUDraw{
+              Vec4(meshlet.Center, meshlet.Radius), Vec4((meshlet.BoundsMax - meshlet.BoundsMin) * 0.5f, 0.0f),
+              Vec4(meshlet.ConeAxis, doubleSided ? 1.0f : meshlet.ConeCutoff), lodBounds,
+              instanceIndex, geometry.IndexOffset + meshlet.FirstIndex, meshlet.IndexCount, it->second, (int32_t)geometry.VertexOffset,
+              lod.Error, coarserError
+            });
+          }
+        }
+      }
+    }
+  }
+
+  void GPUScene::EndDraws() {
+    OX_SCOPED_ZONE;
+    // Opaque batches first, and batches of the same mesh next to each other so their materials are updated together
+    std::vector<uint32_t> order(m_Batches.size());
+    for (uint32_t i = 0; i < (uint32_t)order.size(); i++)
+      order[i] = i;
+    std::sort(order.begin(), order.end(), [this](const uint32_t a, const uint32_t b) {
+      const Batch& lhs = m_Batches[a];
+      const Batch& rhs = m_Batches[b];
+      if (lhs.Transparent != rhs.Transparent)
+        return rhs.Transparent;
+      if (lhs.MeshGeometry != rhs.MeshGeometry)
+        return lhs.MeshGeometry < rhs.MeshGeometry;
+      return lhs.BatchMaterial < rhs.BatchMaterial;
+    });
+
+    std::vector<uint32_t> remap(m_Batches.size());
+    std::vector<Batch> sorted;
+    sorted.reserve(m_Batches.size());
+    uint32_t commandOffset = 0;
+    for (const uint32_t index : order) {
+      remap[index] = (uint32_t)sorted.size();
+      Batch& batch = sorted.emplace_back(m_Batches[index]);
+      batch.CommandOffset = commandOffset;
+      commandOffset += batch.MaxCommandCount;
+    }
+    m_Batches = std::move(sorted);
+    for (auto& draw : m_Draws)
+      draw.BatchIndex = remap[draw.BatchIndex];
+    m_BatchLookup.clear();
+
+    const auto drawCount = (uint32_t)m_Draws.size();
+    const auto batchCount = (uint32_t)m_Batches.size();
+    if (drawCount > m_DrawCapacity || batchCount > m_BatchCapacity)
+      CreateDrawBuffers(std::max(m_DrawCapacity, drawCount * 2), std::max(m_BatchCapacity, batchCount * 2));
+
+    m_DrawBuffer.Copy(m_Draws);
+    std::vector<uint32_t> batchOffsets(batchCount);
+    for (uint32_t i = 0; i < batchCount; i++)
+      batchOffsets[i] = m_Batches[i].CommandOffset;
+    m_BatchBuffer.Copy(batchOffsets);
+  }
+
+  void GPUScene::SetViews(const View* views, const uint32_t viewCount) {
+    OX_CORE_ASSERT(viewCount <= MaxViews);
+    m_ViewCount = viewCount;
+    for (uint32_t i = 0; i < viewCount; i++)
+      m_ViewsData.Views[i] = views[i];
+    m_ViewsData.DrawCount = (uint32_t)m_Draws.size();
+    m_ViewsData.CommandsPerView = m_DrawCapacity;
+    m_ViewsData.CountsPerView = m_BatchCapacity;
+    m_ViewsData.ViewCount = viewCount;
+    m_ViewBuffer.Copy(&m_ViewsData, sizeof m_ViewsData);
+  }
+
+  vk::DeviceSize GPUScene::GetCommandOffset(const uint32_t view, const Batch& batch) const {
+    return ((vk::DeviceSize)view * m_DrawCapacity + batch.CommandOffset) * sizeof(vk::DrawIndexedIndirectCommand);
+  }
+
+  vk::DeviceSize GPUScene::GetCountOffset(const uint32_t view, const uint32_t batchIndex) const {
+    return ((vk::DeviceSize)view * m_BatchCapacity + batchIndex) * sizeof(uint32_t);
+  }
+
+  uint32_t GPUScene::ReadBackDrawCount(const vk::CommandBuffer& commandBuffer, const uint32_t view, const uint32_t frame) {
+    OX_SCOPED_ZONE;
+    const uint32_t frameCount = VulkanRenderer::s_SwapChain.MaxFramesInFlight;
+    if (m_CountReadbackCapacity != m_BatchCapacity || (uint32_t)m_CountReadbackBatches.size() != frameCount) {
+      if (m_CountReadbackCapacity) {
+        VulkanRenderer::WaitDeviceIdle();
+        m_CountReadbackBuffer.Destroy();
+      }
+      m_CountReadbackCapacity = m_BatchCapacity;
+      m_CountReadbackBatches.assign(frameCount, 0);
+      m_CountReadbackBuffer.CreateBuffer(vBU::eTransferDst, vMP::eHostVisible | vMP::eHostCoherent, sizeof(uint32_t) * m_BatchCapacity * frameCount).Map();
+    }
+
+    // The fence of the frame guards the region, it holds what the frame copied the last time it was recorded
+    const auto* counts = static_cast<const uint32_t*>(m_CountReadbackBuffer.GetMapped()) + (size_t)frame * m_CountReadbackCapacity;
+    uint32_t drawCount = 0;
+    for (uint32_t i = 0; i < m_CountReadbackBatches[frame]; i++)
+      drawCount += counts[i];
+
+    const uint32_t batchCount = view < m_ViewCount ? (uint32_t)m_Batches.size() : 0;
+    m_CountReadbackBatches[frame] = batchCount;
+    if (!batchCount)
+      return drawCount;
+
+    const vk::MemoryBarrier cullBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead};
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer, {}, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+    const vk::BufferCopy region{GetCountOffset(view, 0), sizeof(uint32_t) * frame * m_CountReadbackCapacity, sizeof(uint32_t) * batchCount};
+    commandBuffer.copyBuffer(m_CountBuffer.Get(), m_CountReadbackBuffer.Get(), 1, &region);
+    const vk::MemoryBarrier hostBarrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead};
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+    return drawCount;
+  }
+
+  void GPUScene::CreateInstanceBuffer(const uint32_t capacity) {
+    if (m_InstanceCapacity) {
+      VulkanRenderer::WaitDeviceIdle();
+      m_InstanceBuffer.Destroy();
+    }
+
+    m_InstanceCapacity = capacity;
+    m_InstanceBuffer.CreateBuffer(vBU::eStorageBuffer, vMP::eHostVisible | vMP::eHostCoherent, sizeof(Mat4) * capacity).Map();
+    m_InstanceBuffer.Copy(m_Instances);
+    m_BufferVersion++;
+  }
+
+  void GPUScene::CreateDrawBuffers(const uint32_t drawCapacity, const uint32_t batchCapacity) {
+    if (m_DrawCapacity) {
+      VulkanRenderer::WaitDeviceIdle();
+      m_DrawBuffer.Destroy();
+      m_BatchBuffer.Destroy();
+      m_CommandBuffer.Destroy();
+      m_CountBuffer.Destroy();
+    }
+
+    m_DrawCapacity = drawCapacity;
+    m_BatchCapacity = batchCapacity;
+    m_DrawBuffer.CreateBuffer(vBU::eStorageBuffer, vMP::eHostVisible | vMP::eHostCoherent, sizeof(GPUDraw) * drawCapacity).Map();
+    m_BatchBuffer.CreateBuffer(vBU::eStorageBuffer, vMP::eHostVisible | vMP::eHostCoherent, sizeof(uint32_t) * batchCapacity).Map();
+    m_CommandBuffer.CreateBuffer(vBU::eStorageBuffer | vBU::eIndirectBuffer,
+      vMP::eDeviceLocal,
+      sizeof(vk::DrawIndexedIndirectCommand) * drawCapacity * MaxViews);
+    m_CountBuffer.CreateBuffer(vBU::eStorageBuffer | vBU::eIndirectBuffer | vBU::eTransferDst,
+      vMP::eDeviceLocal,
+      sizeof(uint32_t) * batchCapacity * MaxViews);
+    m_BufferVersion++;
+  }
+}
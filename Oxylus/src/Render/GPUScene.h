@@ -0,0 +1,147 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "Core/Base.h"
+#include "Core/Types.h"
+#include "Render/Frustum.h"
+#include "Vulkan/VulkanBuffer.h"
+
+namespace Oxylus {
+  class Material;
+  class Mesh;
+
+  /// Scene data for GPU driven rendering. Instance transforms and draws live in storage buffers and a compute pass
+  /// culls every draw for every view, writing the indirect commands that the render passes consume batch by batch.
+  /// Primitives are drawn meshlet by meshlet so parts of large meshes can be culled on their own.
+  class GPUScene {
+  public:
+    static constexpr uint32_t MaxViews = 5;
+
+    /// Draws sharing the same geometry and material, recorded with a single indirect count call per view.
+    struct Batch {
+      Mesh* MeshGeometry = nullptr;
+      Material* BatchMaterial = nullptr;
+      bool Transparent = false;
+      uint32_t CommandOffset = 0; // First command of the batch inside a view
+      uint32_t MaxCommandCount = 0;
+    };
+
+    struct View {
+      Mat4 PreviousViewProjection = Mat4(1); // The view projection the Hi-Z was rendered with
+      Vec4 Planes[6] = {};
+      Vec4 HiZParams = Vec4(0);              // xy: size of the first Hi-Z mip, z: Hi-Z mip count, w: 1 to test against the Hi-Z
+      Vec4 Position = Vec4(0);               // xyz: world space position, w: 1 to cull meshlets facing away from it
+      Vec4 LodParams = Vec4(0);              // x: pixels per unit, at distance 1 for perspective views, y: 1 for perspective views,
+                                             // z: error threshold in pixels, w: 1 to select LODs, otherwise only full detail is drawn
+    };
+
+    /// Skinned instances draw the vertices the skinning pass wrote for them, within bounds that hold every pose.
+    struct Skinning {
+      int32_t VertexOffset = 0;
+      AABB Bounds = {};
+    };
+
+    void Init();
+    void Destroy();
+
+    void SetInstance(uint32_t instanceIndex, const Mat4& transform);
+
+    /// Draws are rebuilt from scratch whenever meshes are added, removed or get different materials.
+    void BeginDraws();
+    void AddDraws(uint32_t instanceIndex,
+                  Mesh& mesh,
+                  uint32_t submeshIndex,
+                  const std::vector<Ref<Material>>& materials,
+                  const Skinning* skinning = nullptr);
+    void EndDraws();
+
+    void SetViews(const View* views, uint32_t viewCount);
+
+    const std::vector<Batch>& GetBatches() const { return m_Batches; }
+    uint32_t GetDrawCount() const { return (uint32_t)m_Draws.size(); }
+    uint32_t GetViewCount() const { return m_ViewCount; }
+
+    vk::DeviceSize GetCommandOffset(uint32_t view, const Batch& batch) const;
+    vk::DeviceSize GetCountOffset(uint32_t view, uint32_t batchIndex) const;
+
+    /// Records a copy of the draw counts the cull pass wrote for the view into the readback region of the frame in
+    /// flight. Returns the draws counted by the copy recorded the last time the frame used the region, so the value
+    /// lags behind by the frames in flight. Call it after the frame's fence was waited on.
+    uint32_t ReadBackDrawCount(const vk::CommandBuffer& commandBuffer, uint32_t view, uint32_t frame);
+
+    VulkanBuffer& GetInstanceBuffer() { return m_InstanceBuffer; }
+    VulkanBuffer& GetDrawBuffer() { return m_DrawBuffer; }
+    VulkanBuffer& GetBatchBuffer() { return m_BatchBuffer; }
+    VulkanBuffer& GetViewBuffer() { return m_ViewBuffer; }
+    VulkanBuffer& GetCommandBuffer() { return m_CommandBuffer; }
+    VulkanBuffer& GetCountBuffer() { return m_CountBuffer; }
+
+    /// Changes whenever the buffers are recreated and the descriptor sets pointing at them have to be rewritten.
+    uint32_t GetBufferVersion() const { return m_BufferVersion; }
+
+  private:
+    // Matches the layout of the draws in GPUCull.comp
+    struct GPUDraw {
+      Vec4 BoundsCenter = {};  // Local space, w: bounding sphere radius
+      Vec4 BoundsExtents = {};
+      Vec4 Cone = {0, 0, 0, 1}; // xyz: normal cone axis, w: cutoff, 1 disables the backface test
+      Vec4 LodBounds = {};      // Bounding sphere of the primitive, all its meshlets pick their level from it
+      uint32_t InstanceIndex = 0;
+      uint32_t FirstIndex = 0;
+      uint32_t IndexCount = 0;
+      uint32_t BatchIndex = 0;
+      int32_t VertexOffset = 0;
+      float LodError = 0.0f;          // Error of the draw's level
+      float CoarserLodError = FLT_MAX; // Error of the next coarser level of the primitive
+      uint32_t Padding = 0;
+    };
+
+    struct ViewsUB {
+      View Views[MaxViews] = {};
+      uint32_t DrawCount = 0;
+      uint32_t CommandsPerView = 0;
+      uint32_t CountsPerView = 0;
+      uint32_t ViewCount = 0;
+    } m_ViewsData;
+
+    struct BatchKey {
+      const Mesh* MeshGeometry = nullptr;
+      const Material* BatchMaterial = nullptr;
+
+      bool operator==(const BatchKey& other) const {
+        return MeshGeometry == other.MeshGeometry && BatchMaterial == other.BatchMaterial;
+      }
+    };
+
+    struct BatchKeyHash {
+      size_t operator()(const BatchKey& key) const {
+        return std::hash<const void*>()(key.MeshGeometry) ^ std::hash<const void*>()(key.BatchMaterial) * 31;
+      }
+    };
+
+    std::vector<Mat4> m_Instances;
+    std::vector<GPUDraw> m_Draws;
+    std::vector<Batch> m_Batches;
+    std::unordered_map<BatchKey, uint32_t, BatchKeyHash> m_BatchLookup;
+
+    VulkanBuffer m_InstanceBuffer;
+    VulkanBuffer m_DrawBuffer;
+    VulkanBuffer m_BatchBuffer;
+    VulkanBuffer m_ViewBuffer;
+    VulkanBuffer m_CommandBuffer;
+    VulkanBuffer m_CountBuffer;
+    VulkanBuffer m_CountReadbackBuffer;           // One region of m_BatchCapacity counts per frame in flight
+    std::vector<uint32_t> m_CountReadbackBatches; // Batches copied into each region
+
+    uint32_t m_InstanceCapacity = 0;
+    uint32_t m_DrawCapacity = 0;
+    uint32_t m_BatchCapacity = 0;
+    uint32_t m_ViewCount = 0;
+    uint32_t m_BufferVersion = 0;
+    uint32_t m_CountReadbackCapacity = 0;
+
+    void CreateInstanceBuffer(uint32_t capacity);
+    void CreateDrawBuffers(uint32_t drawCapacity, uint32_t batchCapacity);
+  };
+}
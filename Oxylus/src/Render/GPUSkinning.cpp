@@ -0,0 +1,137 @@
+#include "GPUSkinning.h"
+
+#include "Mesh.h"
+#include "Utils/Profiler.h"
+#include "Vulkan/VulkanRenderer.h"
+
+namespace Oxylus {
+  static constexpr uint32_t InitialJointCapacity = 4 * 1024;
+
+  void GPUSkinning::Init() {
+    CreateJointBuffer(InitialJointCapacity);
+  }
+
+  void GPUSkinning::Destroy() {
+    for (Handle handle = 0; handle < (Handle)m_Instances.size(); handle++)
+      RemoveInstance(handle);
+    m_Instances.clear();
+    m_FreeHandles.clear();
+    m_JointBuffer.Destroy();
+  }
+
+  GPUSkinning::Handle GPUSkinning::AddInstance(Mesh& mesh, const uint32_t nodeIndex) {
+    OX_SCOPED_ZONE;
+    const Mesh::Node* root = mesh.LinearNodes[nodeIndex];
+    if (root->SkinIndex < 0 || root->SkinIndex >= (int32_t)mesh.Skins.size())
+      return InvalidHandle;
+
+    // Children are loaded before their parents, so the vertices of a node and its children are next to each other
+    uint32_t firstVertex = UINT32_MAX;
+    uint32_t endVertex = 0;
+    std::vector<const Mesh::Node*> nodes = {root};
+    while (!nodes.empty()) {
+      const Mesh::Node* node = nodes.back();
+      nodes.pop_back();
+      nodes.insert(nodes.end(), node->Children.begin(), node->Children.end());
+      for (const auto& primitive : node->Primitives) {
+        firstVertex = std::min(firstVertex, primitive->firstVertex);
+        endVertex = std::max(endVertex, primitive->firstVertex + primitive->vertexCount);
+      }
+    }
+    if (firstVertex >= endVertex || !mesh.GetGeometry().SkinCount)
+      return InvalidHandle;
+
+    Instance instance;
+    instance.MeshGeometry = &mesh;
+    instance.FirstVertex = firstVertex;
+    instance.VertexCount = endVertex - firstVertex;
+    instance.Output = GeometryBuffer::Get()->Allocate(instance.VertexCount);
+    instance.JointCount = mesh.Skins[root->SkinIndex].GetJointCount();
+    instance.JointOffset = m_JointAllocator.Allocate(instance.JointCount);
+    if (instance.JointOffset == RangeAllocator::InvalidOffset) {
+      CreateJointBuffer(std::max(m_JointAllocator.GetCapacity() * 2, m_JointAllocator.GetCapacity() + instance.JointCount));
+      instance.JointOffset = m_JointAllocator.Allocate(instance.JointCount);
+    }
+
+    Handle handle;
+    if (!m_FreeHandles.empty()) {
+      handle = m_FreeHandles.back();
+      m_FreeHandles.pop_back();
+      m_Instances[handle] = instance;
+    }
+    else {
+      handle = (Handle)m_Instances.size();
+      m_Instances.emplace_back(instance);
+    }
+
+    // Until the first pose is set the mesh shows its bind pose
+    std::vector<Mat4> matrices(instance.JointCount, Mat4(1.0f));
+    SetJoints(handle, matrices.data());
+    return handle;
+  }
+
+  void GPUSkinning::RemoveInstance(const Handle handle) {
+    if (handle == InvalidHandle || !m_Instances[handle].MeshGeometry)
+      return;
+
+    Instance& instance = m_Instances[handle];
+    // The geometry buffer may already be gone when the renderer shuts down
+    if (GeometryBuffer::Get())
+      GeometryBuffer::Get()->Free(instance.Output);
+    m_JointAllocator.Free(instance.JointOffset, instance.JointCount);
+    instance = {};
+    m_FreeHandles.emplace_back(handle);
+  }
+
+  void GPUSkinning::SetJoints(const Handle handle, const Mat4* matrices) {
+    const Instance& instance = m_Instances[handle];
+    std::copy_n(matrices, instance.JointCount, m_Joints.begin() + instance.JointOffset);
+  }
+
+  int32_t GPUSkinning::GetVertexOffset(const Handle handle) const {
+    const Instance& instance = m_Instances[handle];
+    return (int32_t)GeometryBuffer::Get()->GetRange(instance.Output).VertexOffset - (int32_t)instance.FirstVertex;
+  }
+
+  const std::vector<GPUSkinning::Dispatch>& GPUSkinning::UpdateDispatches() {
+    OX_SCOPED_ZONE;
+    if (m_RegionCount != VulkanRenderer::s_SwapChain.MaxFramesInFlight + 1)
+      CreateJointBuffer(m_JointAllocator.GetCapacity());
+
+    // The region written now was last read RegionCount frames ago, which the GPU is done with
+    m_Region = (m_Region + 1) % m_RegionCount;
+    const uint32_t regionOffset = m_Region * m_JointAllocator.GetCapacity();
+    m_Dispatches.clear();
+    for (const auto& instance : m_Instances) {
+      if (!instance.MeshGeometry)
+        continue;
+      const auto& source = instance.MeshGeometry->GetGeometry();
+      m_JointBuffer.Copy(m_Joints.data() + instance.JointOffset, sizeof(Mat4) * instance.JointCount, sizeof(Mat4) * (regionOffset + instance.JointOffset));
+      m_Dispatches.emplace_back(Dispatch{
+        source.VertexOffset + instance.FirstVertex,
+        GeometryBuffer::Get()->GetRange(instance.Output).VertexOffset,
+        source.SkinOffset + instance.FirstVertex,
+        instance.VertexCount,
+        regionOffset + instance.JointOffset
+      });
+    }
+    return m_Dispatches;
+  }
+
+  void GPUSkinning::CreateJointBuffer(const uint32_t capacity) {
+    if (m_JointAllocator.GetCapacity()) {
+      VulkanRenderer::WaitDeviceIdle();
+      m_JointBuffer.Destroy();
+      m_JointAllocator.Grow(capacity);
+    }
+    else {
+      m_JointAllocator.Reset(capacity);
+    }
+
+    m_Joints.resize(capacity, Mat4(1.0f));
+    m_RegionCount = VulkanRenderer::s_SwapChain.MaxFramesInFlight + 1;
+    m_Region = 0;
+    m_JointBuffer.CreateBuffer(vBU::eStorageBuffer, vMP::eHostVisible | vMP::eHostCoherent, sizeof(Mat4) * capacity * m_RegionCount).Map();
+    m_BufferVersion++;
+  }
+}
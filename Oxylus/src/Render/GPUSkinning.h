@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.h"
+#include "Render/GeometryBuffer.h"
+#include "Render/RangeAllocator.h"
+#include "Vulkan/VulkanBuffer.h"
+
+namespace Oxylus {
+  class Mesh;
+
+  /// Skins the vertices of animated meshes on the GPU. Every instance gets its own copy of the vertices of the node it
+  /// draws inside the geometry buffer, which a compute pass rewrites each frame from the bind pose vertices and the
+  /// joint matrices of the instance. Draws of the instance use the copy through GetVertexOffset.
+  /// The joint buffer holds one copy of the joints for every frame that can be in flight, plus the one being recorded,
+  /// so the matrices of a frame are never written while the GPU may still read them.
+  class GPUSkinning {
+  public:
+    using Handle = uint32_t;
+    static constexpr Handle InvalidHandle = UINT32_MAX;
+    static constexpr uint32_t GroupSize = 64;
+
+    /// Push constants of Skinning.comp, one dispatch per instance.
+    struct Dispatch {
+      uint32_t SourceOffset = 0; // First bind pose vertex in the geometry buffer
+      uint32_t TargetOffset = 0; // First skinned vertex
+      uint32_t SkinOffset = 0;   // Joints and weights of the first vertex
+      uint32_t VertexCount = 0;
+      uint32_t JointOffset = 0;  // First matrix of the instance in the joint buffer, inside the region of the frame
+    };
+
+    void Init();
+    void Destroy();
+
+    /// Returns InvalidHandle if the node has no skin. Vertices of child nodes are skinned along with it.
+    Handle AddInstance(Mesh& mesh, uint32_t nodeIndex);
+    void RemoveInstance(Handle handle);
+    /// One matrix per joint of the skin, as Skeleton::ComputeSkinningMatrices writes them. They reach the GPU with the
+    /// next UpdateDispatches.
+    void SetJoints(Handle handle, const Mat4* matrices);
+
+    /// Vertex offset the draws of the instance use in place of the one of the mesh.
+    int32_t GetVertexOffset(Handle handle) const;
+
+    /// Gathers the push constants of every instance and writes their joints into the region of the frame. Geometry
+    /// offsets move when the geometry buffer is compacted, so this runs every frame before the skinning pass.
+    const std::vector<Dispatch>& UpdateDispatches();
+    const std::vector<Dispatch>& GetDispatches() const { return m_Dispatches; }
+    uint32_t GetJointCount(Handle handle) const { return m_Instances[handle].JointCount; }
+
+    VulkanBuffer& GetJointBuffer() { return m_JointBuffer; }
+
+    /// Changes whenever the joint buffer is recreated and the descriptor sets pointing at it have to be rewritten.
+    uint32_t GetBufferVersion() const { return m_BufferVersion; }
+
+  private:
+    struct Instance {
+      const Mesh* MeshGeometry = nullptr;
+      uint32_t FirstVertex = 0; // Vertices of the node and its children, relative to the mesh
+      uint32_t VertexCount = 0;
+      GeometryBuffer::Handle Output = GeometryBuffer::InvalidHandle;
+      uint32_t JointOffset = 0;
+      uint32_t JointCount = 0;
+    };
+
+    std::vector<Instance> m_Instances;
+    std::vector<Handle> m_FreeHandles;
+    std::vector<Dispatch> m_Dispatches;
+    std::vector<Mat4> m_Joints;
+
+    VulkanBuffer m_JointBuffer;
+    RangeAllocator m_JointAllocator;
+    uint32_t m_BufferVersion = 0;
+    uint32_t m_RegionCount = 0;
+    uint32_t m_Region = 0;
+
+    void CreateJointBuffer(uint32_t capacity);
+  };
+}
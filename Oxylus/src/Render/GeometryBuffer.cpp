@@ -0,0 +1,240 @@
+#include "GeometryBuffer.h"
+
+#include <algorithm>
+
+#include "Mesh.h"
+#include "Utils/Log.h"
+#include "Utils/Profiler.h"
+#include "Vulkan/UploadManager.h"
+#include "Vulkan/VulkanRenderer.h"
+
+namespace Oxylus {
+  GeometryBuffer* GeometryBuffer::s_Instance = nullptr;
+
+  static constexpr uint32_t InitialVertexCapacity = 256 * 1024;
+  static constexpr uint32_t InitialIndexCapacity = 1024 * 1024;
+  static constexpr uint32_t InitialSkinCapacity = 64 * 1024;
+
+  // Buffer copies on the graphics queue, ordered against the draws and skinning dispatches that use the ranges before and after.
+  static void SubmitCopies(const std::function<void(const vk::CommandBuffer& copyCmd)>& recordCopies) {
+    constexpr auto drawStages = vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eDrawIndirect |
+                                vk::PipelineStageFlagBits::eComputeShader;
+    VulkanRenderer::SubmitOnce(CommandPoolManager::Get()->GetFreePool(),
+      [&](const VulkanCommandBuffer& copyCmd) {
+        copyCmd.Get().pipelineBarrier(drawStages, vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 0, nullptr);
+        recordCopies(copyCmd.Get());
+        const vk::MemoryBarrier copyBarrier{
+          vk::AccessFlagBits::eTransferWrite,
+          vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+        };
+        copyCmd.Get().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, drawStages, {}, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+      });
+  }
+
+  void GeometryBuffer::Init() {
+    if (s_Instance)
+      return;
+
+    s_Instance = new GeometryBuffer();
+
+    auto& vertices = s_Instance->m_Vertices;
+    // The skinning pass reads and writes vertices as storage buffer
+    vertices.Usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer;
+    vertices.Stride = sizeof(Mesh::PackedVertex);
+    vertices.Offset = &Range::VertexOffset;
+    vertices.Count = &Range::VertexCount;
+
+    auto& indices = s_Instance->m_Indices;
+    indices.Usage = vk::BufferUsageFlagBits::eIndexBuffer;
+    indices.Stride = sizeof(uint32_t);
+    indices.Offset = &Range::IndexOffset;
+    indices.Count = &Range::IndexCount;
+
+    auto& skinVertices = s_Instance->m_SkinVertices;
+    skinVertices.Usage = vk::BufferUsageFlagBits::eStorageBuffer;
+    skinVertices.Stride = sizeof(Mesh::SkinVertex);
+    skinVertices.Offset = &Range::SkinOffset;
+    skinVertices.Count = &Range::SkinCount;
+
+    CreateBuffer(vertices, vertices.Buffer, InitialVertexCapacity);
+    vertices.Allocator.Reset(InitialVertexCapacity);
+    CreateBuffer(indices, indices.Buffer, InitialIndexCapacity);
+    indices.Allocator.Reset(InitialIndexCapacity);
+    CreateBuffer(skinVertices, skinVertices.Buffer, InitialSkinCapacity);
+    skinVertices.Allocator.Reset(InitialSkinCapacity);
+  }
+
+  void GeometryBuffer::Release() {
+    if (!s_Instance)
+      return;
+
+    s_Instance->m_Vertices.Buffer.Destroy();
+    s_Instance->m_Indices.Buffer.Destroy();
+    s_Instance->m_SkinVertices.Buffer.Destroy();
+    delete s_Instance;
+    s_Instance = nullptr;
+  }
+
+  GeometryBuffer::Handle GeometryBuffer::Upload(const void* vertices,
+                                                const uint32_t vertexCount,
+                                                const uint32_t* indices,
+                                                const uint32_t indexCount,
+                                                const void* skinVertices) {
+    OX_SCOPED_ZONE;
+    Range range;
+    range.VertexCount = vertexCount;
+    range.IndexCount = indexCount;
+    range.SkinCount = skinVertices ? vertexCount : 0;
+    range.VertexOffset = Allocate(m_Vertices, vertexCount);
+    range.IndexOffset = Allocate(m_Indices, indexCount);
+    range.SkinOffset = Allocate(m_SkinVertices, range.SkinCount);
+
+    // Draws wait for the upload queue, so the mesh can be used before the copies have finished
+    auto* uploads = UploadManager::Get();
+    uploads->UploadBuffer(m_Vertices.Buffer.Get(),
+      (vk::DeviceSize)range.VertexOffset * m_Vertices.Stride,
+      vertices,
+      (vk::DeviceSize)vertexCount * m_Vertices.Stride);
+    uploads->UploadBuffer(m_Indices.Buffer.Get(),
+      (vk::DeviceSize)range.IndexOffset * m_Indices.Stride,
+      indices,
+      (vk::DeviceSize)indexCount * m_Indices.Stride);
+    if (range.SkinCount) {
+      uploads->UploadBuffer(m_SkinVertices.Buffer.Get(),
+        (vk::DeviceSize)range.SkinOffset * m_SkinVertices.Stride,
+        skinVertices,
+        (vk::DeviceSize)range.SkinCount * m_SkinVertices.Stride);
+    }
+
+    return AddRange(range);
+  }
+
+  GeometryBuffer::Handle GeometryBuffer::Allocate(const uint32_t vertexCount) {
+    Range range;
+    range.VertexCount = vertexCount;
+    range.VertexOffset = Allocate(m_Vertices, vertexCount);
+    return AddRange(range);
+  }
+
+  void GeometryBuffer::Free(const Handle handle) {
+    if (handle == InvalidHandle)
+      return;
+
+    Range& range = m_Ranges[handle];
+    m_Vertices.Allocator.Free(range.VertexOffset, range.VertexCount);
+    m_Indices.Allocator.Free(range.IndexOffset, range.IndexCount);
+    m_SkinVertices.Allocator.Free(range.SkinOffset, range.SkinCount);
+    range = {};
+    m_FreeHandles.emplace_back(handle);
+  }
+
+  void GeometryBuffer::Defragment() {
+    OX_SCOPED_ZONE;
+    Compact(m_Vertices);
+    Compact(m_Indices);
+    Compact(m_SkinVertices);
+  }
+
+  void GeometryBuffer::Bind(const vk::CommandBuffer& commandBuffer) const {
+    constexpr vk::DeviceSize offsets[1] = {0};
+    commandBuffer.bindVertexBuffers(0, m_Vertices.Buffer.Get(), offsets);
+    commandBuffer.bindIndexBuffer(m_Indices.Buffer.Get(), 0, vk::IndexType::eUint32);
+  }
+
+  GeometryBuffer::Handle GeometryBuffer::AddRange(const Range& range) {
+    Handle handle;
+    if (!m_FreeHandles.empty()) {
+      handle = m_FreeHandles.back();
+      m_FreeHandles.pop_back();
+      m_Ranges[handle] = range;
+    }
+    else {
+      handle = (Handle)m_Ranges.size();
+      m_Ranges.emplace_back(range);
+    }
+    return handle;
+  }
+
+  uint32_t GeometryBuffer::Allocate(Arena& arena, const uint32_t count) {
+    uint32_t offset = arena.Allocator.Allocate(count);
+    if (offset != RangeAllocator::InvalidOffset)
+      return offset;
+
+    // There is enough space in total, just not in one piece
+    if (arena.Allocator.GetFreeSize() >= count)
+      Compact(arena);
+    else
+      Grow(arena, std::max(arena.Allocator.GetCapacity() * 2, arena.Allocator.GetCapacity() + count));
+
+    offset = arena.Allocator.Allocate(count);
+    OX_CORE_ASSERT(offset != RangeAllocator::InvalidOffset);
+    return offset;
+  }
+
+  void GeometryBuffer::Grow(Arena& arena, const uint32_t capacity) {
+    OX_SCOPED_ZONE;
+    const uint32_t oldCapacity = arena.Allocator.GetCapacity();
+    OX_CORE_TRACE("Growing geometry buffer from {} to {} elements", oldCapacity, capacity);
+
+    VulkanBuffer buffer;
+    CreateBuffer(arena, buffer, capacity);
+    SubmitCopies([&](const vk::CommandBuffer& copyCmd) {
+      arena.Buffer.CopyTo(buffer.Get(), copyCmd, {0, 0, (vk::DeviceSize)oldCapacity * arena.Stride});
+    });
+    arena.Buffer.Destroy();
+    arena.Buffer = buffer;
+    arena.Allocator.Grow(capacity);
+    m_Version++;
+  }
+
+  void GeometryBuffer::Compact(Arena& arena) {
+    OX_SCOPED_ZONE;
+    std::vector<Range*> ranges;
+    ranges.reserve(m_Ranges.size());
+    for (auto& range : m_Ranges) {
+      if (range.*arena.Count)
+        ranges.emplace_back(&range);
+    }
+    std::sort(ranges.begin(), ranges.end(), [&arena](const Range* a, const Range* b) {
+      return a->*arena.Offset < b->*arena.Offset;
+    });
+
+    // Ranges are packed into a new buffer, copying in place would need the copies to not overlap
+    std::vector<vk::BufferCopy> regions;
+    regions.reserve(ranges.size());
+    uint32_t packedOffset = 0;
+    for (Range* range : ranges) {
+      const uint32_t offset = range->*arena.Offset;
+      const uint32_t count = range->*arena.Count;
+      if (!regions.empty() && regions.back().srcOffset + regions.back().size == (vk::DeviceSize)offset * arena.Stride)
+        regions.back().size += (vk::DeviceSize)count * arena.Stride;
+      else
+        regions.emplace_back((vk::DeviceSize)offset * arena.Stride, (vk::DeviceSize)packedOffset * arena.Stride, (vk::DeviceSize)count * arena.Stride);
+      range->*arena.Offset = packedOffset;
+      packedOffset += count;
+    }
+
+    const uint32_t capacity = arena.Allocator.GetCapacity();
+    VulkanBuffer buffer;
+    CreateBuffer(arena, buffer, capacity);
+    if (!regions.empty()) {
+      SubmitCopies([&](const vk::CommandBuffer& copyCmd) {
+        copyCmd.copyBuffer(arena.Buffer.Get(), buffer.Get(), (uint32_t)regions.size(), regions.data());
+      });
+    }
+    arena.Buffer.Destroy();
+    arena.Buffer = buffer;
+
+    arena.Allocator.Reset(capacity);
+    arena.Allocator.Allocate(packedOffset);
+    m_Version++;
+  }
+
+  void GeometryBuffer::CreateBuffer(const Arena& arena, VulkanBuffer& buffer, const uint32_t capacity) {
+    buffer.CreateBuffer(arena.Usage | vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst,
+      vk::MemoryPropertyFlagBits::eDeviceLocal,
+      (vk::DeviceSize)capacity * arena.Stride,
+      nullptr,
+      VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+  }
+}
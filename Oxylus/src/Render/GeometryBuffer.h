@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include "RangeAllocator.h"
+#include "Vulkan/VulkanBuffer.h"
+
+namespace Oxylus {
+  /// Vertices and indices of every mesh, suballocated from one large device local vertex buffer and one index buffer,
+  /// so the geometry is bound once per pass instead of once per mesh. Skinned meshes also keep their joints and weights
+  /// in a third buffer, which the skinning pass reads next to the vertices.
+  /// Buffers grow when they run out of space and get compacted when they are too fragmented to fit an upload.
+  class GeometryBuffer {
+  public:
+    using Handle = uint32_t;
+    static constexpr Handle InvalidHandle = UINT32_MAX;
+
+    /// Element offsets of a mesh inside the shared buffers. Primitive index ranges are relative to the mesh,
+    /// so draws add IndexOffset to their first index and use VertexOffset as the vertex offset.
+    struct Range {
+      uint32_t VertexOffset = 0;
+      uint32_t VertexCount = 0;
+      uint32_t IndexOffset = 0;
+      uint32_t IndexCount = 0;
+      uint32_t SkinOffset = 0;
+      uint32_t SkinCount = 0;
+    };
+
+    GeometryBuffer() = default;
+    ~GeometryBuffer() = default;
+
+    static void Init();
+    static void Release();
+
+    static GeometryBuffer* Get() { return s_Instance; }
+
+    /// Copies the geometry into the shared buffers. Vertices have to be laid out as Mesh::PackedVertex, skin vertices
+    /// as Mesh::SkinVertex with one for every vertex.
+    Handle Upload(const void* vertices,
+                  uint32_t vertexCount,
+                  const uint32_t* indices,
+                  uint32_t indexCount,
+                  const void* skinVertices = nullptr);
+    /// Vertices without indices or contents, which the GPU fills in itself.
+    Handle Allocate(uint32_t vertexCount);
+    void Free(Handle handle);
+
+    /// Packs every live range to the front of the buffers. Offsets change, anything that baked them in has
+    /// to check GetVersion.
+    void Defragment();
+
+    const Range& GetRange(Handle handle) const { return m_Ranges[handle]; }
+    void Bind(const vk::CommandBuffer& commandBuffer) const;
+
+    /// Buffers are recreated when they grow or get compacted, descriptors pointing at them have to check GetVersion.
+    const VulkanBuffer& GetVertexBuffer() const { return m_Vertices.Buffer; }
+    const VulkanBuffer& GetSkinBuffer() const { return m_SkinVertices.Buffer; }
+
+    /// Changes whenever the buffers are recreated or ranges move.
+    uint32_t GetVersion() const { return m_Version; }
+
+  private:
+    static GeometryBuffer* s_Instance;
+
+    struct Arena {
+      VulkanBuffer Buffer;
+      RangeAllocator Allocator;
+      vk::BufferUsageFlags Usage = {};
+      uint32_t Stride = 0;
+      uint32_t Range::* Offset = nullptr;
+      uint32_t Range::* Count = nullptr;
+    };
+
+    Arena m_Vertices;
+    Arena m_Indices;
+    Arena m_SkinVertices;
+    std::vector<Range> m_Ranges;
+    std::vector<Handle> m_FreeHandles;
+    uint32_t m_Version = 0;
+
+    Handle AddRange(const Range& range);
+    uint32_t Allocate(Arena& arena, uint32_t count);
+    void Grow(Arena& arena, uint32_t capacity);
+    void Compact(Arena& arena);
+    static void CreateBuffer(const Arena& arena, VulkanBuffer& buffer, uint32_t capacity);
+  };
+}
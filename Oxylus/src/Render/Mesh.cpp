@@ -2,10 +2,22 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "Mesh.h"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <unordered_map>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Assets/AssetManager.h"
+#include "Assets/TextureCompressor.h"
+#include "Render/MeshSimplifier.h"
+#include "Render/TextureStreamer.h"
+#include "Utils/MappedFile.h"
+#include "Utils/OxMath.h"
 #include "Utils/Profiler.h"
+#include "Thread/JobSystem.h"
 #include "Vulkan/VulkanContext.h"
 #include "Vulkan/VulkanRenderer.h"
 #include "Utils/Log.h"
@@ -19,28 +31,461 @@ namespace Oxylus {
     Destroy();
   }
 
-  bool IsImageKtx(const tinygltf::Image& image) {
-    if (image.uri.find_last_of('.') != std::string::npos) {
-      if (image.uri.substr(image.uri.find_last_of('.') + 1) == "ktx") { return true; }
+  // Primitives below this aren't simplified any further
+  static constexpr uint32_t MinLodIndexCount = MeshletBuilder::MaxTriangles * 3;
+
+  static Mesh::PackedVertex PackVertex(const Mesh::Vertex& vertex) {
+    Mesh::PackedVertex packed;
+    packed.Pos = vertex.Pos;
+
+    // Missing normals come out of the loader as NaN
+    Vec3 normal = vertex.Normal;
+    if (!(glm::dot(normal, normal) > 0.0f))
+      normal = Vec3(0.0f, 0.0f, 1.0f);
+    packed.Normal = glm::packSnorm2x16(Math::OctEncode(glm::normalize(normal)));
+
+    // Without tangents any vector perpendicular to the normal does, shaders orthogonalize it anyway
+    Vec3 tangent = Vec3(vertex.Tangent);
+    if (!(glm::dot(tangent, tangent) > 1e-12f))
+      tangent = glm::cross(normal, glm::abs(normal.x) < 0.9f ? Vec3(1.0f, 0.0f, 0.0f) : Vec3(0.0f, 1.0f, 0.0f));
+    const Vec2 octTangent = Math::OctEncode(glm::normalize(tangent));
+    // The bitangent sign moves the second component into [0.5, 1] or [-1, -0.5]
+    const float sign = vertex.Tangent.w < 0.0f ? -1.0f : 1.0f;
+    packed.Tangent = glm::packSnorm2x16(Vec2(octTangent.x, sign * (0.75f + 0.25f * octTangent.y)));
+
+    packed.UV = glm::packHalf2x16(vertex.UV);
+    return packed;
+  }
+
+  static Mesh::SkinVertex PackSkinVertex(const Mesh::Vertex& vertex) {
+    Mesh::SkinVertex packed = {};
+    const float weightSum = vertex.Weight0.x + vertex.Weight0.y + vertex.Weight0.z + vertex.Weight0.w;
+    if (!(weightSum > 0.0f))
+      return packed;
+
+    // The rounding error goes to the largest weight so the weights still add up to one
+    uint32_t weights[4];
+    int32_t remaining = 255;
+    uint32_t largest = 0;
+    for (uint32_t k = 0; k < 4; k++) {
+      weights[k] = (uint32_t)std::lround(std::clamp(vertex.Weight0[k] / weightSum, 0.0f, 1.0f) * 255.0f);
+      remaining -= (int32_t)weights[k];
+      if (vertex.Weight0[k] > vertex.Weight0[largest])
+        largest = k;
+    }
+    weights[largest] = (uint32_t)std::clamp((int32_t)weights[largest] + remaining, 0, 255);
+
+    packed.Joints[0] = (uint32_t)vertex.Joint0.x | (uint32_t)vertex.Joint0.y << 16;
+    packed.Joints[1] = (uint32_t)vertex.Joint0.z | (uint32_t)vertex.Joint0.w << 16;
+    packed.Weights = weights[0] | weights[1] << 8 | weights[2] << 16 | weights[3] << 24;
+    return packed;
+  }
+
+  // Every component of every element of an accessor as floats, normalized integers are mapped to [0, 1] or [-1, 1]
+  static std::vector<float> ReadAccessor(const tinygltf::Model& model, const int accessorIndex) {
+    const auto& accessor = model.accessors[accessorIndex];
+    if (accessor.bufferView < 0)
+      return {};
+    const auto& view = model.bufferViews[accessor.bufferView];
+    const uint8_t* data = model.buffers[view.buffer].data.data() + view.byteOffset + accessor.byteOffset;
+    const int32_t components = tinygltf::GetNumComponentsInType((uint32_t)accessor.type);
+    const int32_t stride = accessor.ByteStride(view);
+    if (components <= 0 || stride <= 0)
+      return {};
+
+    std::vector<float> values(accessor.count * components);
+    for (size_t i = 0; i < accessor.count; i++) {
+      const uint8_t* element = data + i * stride;
+      for (int32_t c = 0; c < components; c++) {
+        float& value = values[i * components + c];
+        switch (accessor.componentType) {
+          case TINYGLTF_COMPONENT_TYPE_FLOAT: value = reinterpret_cast<const float*>(element)[c];
+            break;
+          case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: value = element[c];
+            value = accessor.normalized ? value / 255.0f : value;
+            break;
+          case TINYGLTF_COMPONENT_TYPE_BYTE: value = reinterpret_cast<const int8_t*>(element)[c];
+            value = accessor.normalized ? std::max(value / 127.0f, -1.0f) : value;
+            break;
+          case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: value = reinterpret_cast<const uint16_t*>(element)[c];
+            value = accessor.normalized ? value / 65535.0f : value;
+            break;
+          case TINYGLTF_COMPONENT_TYPE_SHORT: value = reinterpret_cast<const int16_t*>(element)[c];
+            value = accessor.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+            break;
+          case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: value = (float)reinterpret_cast<const uint32_t*>(element)[c];
+            break;
+          default: value = 0.0f;
+        }
+      }
     }
-    return false;
+    return values;
   }
 
-  bool LoadImageDataCallback(tinygltf::Image* image,
-                             const int imageIndex,
-                             std::string* error,
-                             std::string* warning,
-                             int req_width,
-                             int req_height,
-                             const unsigned char* bytes,
-                             int size,
-                             void* userData) {
-    if (IsImageKtx(*image))
-      return true;
+  // Local transform of a node in the file, which either has a matrix or separate components
+  static void GetNodeTransform(const tinygltf::Node& node, Vec3& translation, glm::quat& rotation, Vec3& scale) {
+    translation = Vec3(0.0f);
+    rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    scale = Vec3(1.0f);
+    if (node.matrix.size() == 16) {
+      const Mat4 matrix = glm::make_mat4x4(node.matrix.data());
+      translation = Vec3(matrix[3]);
+      scale = Vec3(glm::length(Vec3(matrix[0])), glm::length(Vec3(matrix[1])), glm::length(Vec3(matrix[2])));
+      if (glm::determinant(glm::mat3(matrix)) < 0.0f)
+        scale.x = -scale.x;
+      if (scale.x != 0.0f && scale.y != 0.0f && scale.z != 0.0f)
+        rotation = glm::normalize(glm::quat_cast(glm::mat3(Vec3(matrix[0]) / scale.x, Vec3(matrix[1]) / scale.y, Vec3(matrix[2]) / scale.z)));
+      return;
+    }
+    if (node.translation.size() == 3)
+      translation = Vec3(glm::make_vec3(node.translation.data()));
+    if (node.rotation.size() == 4)
+      rotation = glm::quat((float)node.rotation[3], (float)node.rotation[0], (float)node.rotation[1], (float)node.rotation[2]);
+    if (node.scale.size() == 3)
+      scale = Vec3(glm::make_vec3(node.scale.data()));
+  }
+
+  static Mat4 GetNodeMatrix(const tinygltf::Node& node) {
+    if (node.matrix.size() == 16)
+      return glm::make_mat4x4(node.matrix.data());
+    Vec3 translation, scale;
+    glm::quat rotation;
+    GetNodeTransform(node, translation, rotation, scale);
+    return glm::translate(Mat4(1.0f), translation) * Mat4(rotation) * glm::scale(Mat4(1.0f), scale);
+  }
+
+  // Keyframes of one animated joint property as they are stored in the file
+  struct ChannelKeys {
+    enum Interpolation { Linear, Step, CubicSpline };
+
+    uint32_t Joint = 0;
+    Pose::Stream FirstStream = Pose::TranslationX;
+    uint32_t Components = 3;
+    Interpolation Mode = Linear;
+    std::vector<float> Times;
+    std::vector<float> Values; // Cubic splines have an in tangent, the value and an out tangent for every key
 
-    return tinygltf::LoadImageData(image, imageIndex, error, warning, req_width, req_height, bytes, size, userData);
+    bool IsValid() const {
+      const size_t elementSize = Mode == CubicSpline ? Components * 3 : Components;
+      return !Times.empty() && Values.size() >= Times.size() * elementSize;
+    }
+
+    void Sample(const float time, float* result) const {
+      const size_t elementSize = Mode == CubicSpline ? Components * 3 : Components;
+      const size_t valueOffset = Mode == CubicSpline ? Components : 0;
+      const auto value = [&](const size_t key) { return Values.data() + key * elementSize + valueOffset; };
+
+      if (time <= Times.front() || Times.size() == 1) {
+        std::copy_n(value(0), Components, result);
+        return;
+      }
+      if (time >= Times.back()) {
+        std::copy_n(value(Times.size() - 1), Components, result);
+        return;
+      }
+
+      const size_t next = std::upper_bound(Times.begin(), Times.end(), time) - Times.begin();
+      const size_t previous = next - 1;
+      const float span = Times[next] - Times[previous];
+      const float t = span > 0.0f ? (time - Times[previous]) / span : 0.0f;
+      const float* a = value(previous);
+      const float* b = value(next);
+      const bool rotation = FirstStream == Pose::RotationX;
+      switch (Mode) {
+        case Step: std::copy_n(a, Components, result);
+          return;
+        case Linear:
+          if (rotation) {
+            const glm::quat q = glm::slerp(glm::quat(a[3], a[0], a[1], a[2]), glm::quat(b[3], b[0], b[1], b[2]), t);
+            result[0] = q.x, result[1] = q.y, result[2] = q.z, result[3] = q.w;
+            return;
+          }
+          for (uint32_t c = 0; c < Components; c++)
+            result[c] = a[c] + (b[c] - a[c]) * t;
+          return;
+        case CubicSpline: {
+          // Hermite spline between the values, with the out tangent of the first key and the in tangent of the second
+          const float* outTangent = a + Components;
+          const float* inTangent = b - Components;
+          const float t2 = t * t;
+          const float t3 = t2 * t;
+          float lengthSquared = 0.0f;
+          for (uint32_t c = 0; c < Components; c++) {
+            result[c] = (2.0f * t3 - 3.0f * t2 + 1.0f) * a[c] + (t3 - 2.0f * t2 + t) * span * outTangent[c] +
+                        (-2.0f * t3 + 3.0f * t2) * b[c] + (t3 - t2) * span * inTangent[c];
+            lengthSquared += result[c] * result[c];
+          }
+          if (rotation && lengthSquared > 0.0f) {
+            for (uint32_t c = 0; c < Components; c++)
+              result[c] /= std::sqrt(lengthSquared);
+          }
+          return;
+        }
+      }
+    }
+  };
+
+  // Texture slots of a material that mesh files can fill.
+  enum TextureSlot : uint32_t {
+    AlbedoSlot = 0,
+    NormalSlot,
+    MetallicSlot,
+    AOSlot,
+    EmissiveSlot,
+    SpecularSlot,
+    TextureSlotCount
+  };
+
+  /// Material as it is described in a mesh file, with textures as indices into the images of the file.
+  struct Mesh::MaterialInfo {
+    std::string Name;
+    decltype(Material::Parameters) Parameters;
+    decltype(Material::AlphaMode) AlphaMode = Material::AlphaMode::Opaque;
+    int32_t Images[TextureSlotCount] = {-1, -1, -1, -1, -1, -1};
+  };
+
+  struct Mesh::ImageSource {
+    std::string Path;                    // Empty for images embedded into the mesh file
+    const unsigned char* Data = nullptr; // Encoded image, the file at Path is read when it isn't set
+    size_t Size = 0;
+  };
+
+  // Layout of cooked mesh files. Tables are written as they are in memory and read in place from the mapped file.
+  // Strings are referenced by their byte offset in the string table.
+  namespace CookedMesh {
+    static constexpr uint32_t Magic = 0x4853454D; // "MESH"
+    static constexpr uint32_t Version = 4;
+    static constexpr uint64_t SectionAlignment = 16;
+
+    struct Section {
+      uint64_t Offset = 0;
+      uint64_t Count = 0;
+    };
+
+    struct Header {
+      uint32_t Magic = CookedMesh::Magic;
+      uint32_t Version = CookedMesh::Version;
+      Section Vertices;
+      Section Indices;
+      Section Nodes;
+      Section Primitives;
+      Section Meshlets;
+      Section Lods;
+      Section Materials;
+      Section Images;
+      Section Strings;
+      Section SkinVertices; // Empty for meshes without skins
+      Section Skins;
+      Section Joints;
+      Section Clips;
+      Section Poses;        // Rest poses and clip frames as floats, laid out like Pose
+    };
+
+    // Nodes are stored in LinearNodes order
+    struct NodeEntry {
+      int32_t Parent = -1;
+      uint32_t Index = 0;
+      uint32_t MeshIndex = 0;
+      int32_t SkinIndex = -1;
+      uint32_t Name = 0;
+      uint32_t ContainsMesh = 0;
+      uint32_t FirstPrimitive = 0;
+      uint32_t PrimitiveCount = 0;
+      Mat4 Matrix;
+      Vec3 Translation;
+      Vec3 Scale;
+      glm::quat Rotation;
+    };
+
+    struct PrimitiveEntry {
+      uint32_t FirstIndex;
+      uint32_t IndexCount;
+      uint32_t FirstVertex;
+      uint32_t VertexCount;
+      Vec3 Min;
+      Vec3 Max;
+      int32_t MaterialIndex;
+      uint32_t FirstMeshlet;
+      uint32_t MeshletCount;
+      uint32_t FirstLod;
+      uint32_t LodCount;
+    };
+
+    struct MaterialEntry {
+      decltype(Material::Parameters) Parameters;
+      uint32_t AlphaMode = 0;
+      uint32_t Name = 0;
+      int32_t Images[TextureSlotCount] = {};
+    };
+
+    struct SkinEntry {
+      uint32_t Name = 0;
+      uint32_t FirstJoint = 0;
+      uint32_t JointCount = 0;
+      uint64_t RestPose = 0; // First float of the rest pose in the pose section
+      Vec3 BoundsMin;
+      Vec3 BoundsMax;
+    };
+
+    // Joints are stored in Skeleton order
+    struct JointEntry {
+      int32_t Parent = -1;
+      uint32_t Node = 0;
+      Mat4 InverseBindMatrix;
+      Mat4 RootTransform;
+      Vec3 BoundsMin;
+      Vec3 BoundsMax;
+    };
+
+    struct ClipEntry {
+      uint32_t Name = 0;
+      int32_t SkinIndex = -1;
+      float Duration = 0.0f;
+      uint64_t FirstFrame = 0; // First float of the frames in the pose section
+    };
   }
 
+  template <typename T>
+  static const T* GetSection(const MappedFile& file, const CookedMesh::Section& section) {
+    if (section.Offset > file.GetSize() || section.Count > (file.GetSize() - section.Offset) / sizeof(T))
+      return nullptr;
+    return reinterpret_cast<const T*>(file.GetData() + section.Offset);
+  }
+
+  /// Checks every index and range the tables hold against the sections they point into, so nothing is created from a
+  /// broken file. Strings have to end inside their section, nodes come before their parents and joints after theirs.
+  static bool ValidateCooked(const CookedMesh::Header& header,
+                             const uint32_t* indices,
+                             const CookedMesh::NodeEntry* nodes,
+                             const CookedMesh::PrimitiveEntry* primitives,
+                             const Meshlet* meshlets,
+                             const Mesh::Lod* lods,
+                             const CookedMesh::MaterialEntry* materials,
+                             const uint32_t* images,
+                             const char* strings,
+                             const CookedMesh::SkinEntry* skins,
+                             const CookedMesh::JointEntry* joints,
+                             const CookedMesh::ClipEntry* clips) {
+    if (header.Strings.Count && strings[header.Strings.Count - 1] != '\0')
+      return false;
+    if (header.SkinVertices.Count && header.SkinVertices.Count != header.Vertices.Count)
+      return false;
+    const auto validString = [&header](const uint32_t offset) { return offset < header.Strings.Count; };
+    const auto validRange = [](const uint64_t first, const uint64_t count, const uint64_t size) { return first <= size && count <= size - first; };
+    const auto validIndex = [](const int32_t index, const uint64_t size) { return index < 0 || (uint64_t)index < size; };
+
+    for (uint64_t i = 0; i < header.Indices.Count; i++) {
+      if (indices[i] >= header.Vertices.Count)
+        return false;
+    }
+    for (uint64_t i = 0; i < header.Images.Count; i++) {
+      if (!validString(images[i]))
+        return false;
+    }
+    for (uint64_t i = 0; i < header.Materials.Count; i++) {
+      if (!validString(materials[i].Name))
+        return false;
+      for (const int32_t image : materials[i].Images) {
+        if (!validIndex(image, header.Images.Count))
+          return false;
+      }
+    }
+    for (uint64_t i = 0; i < header.Nodes.Count; i++) {
+      const auto& node = nodes[i];
+      if (!validString(node.Name) || !validRange(node.FirstPrimitive, node.PrimitiveCount, header.Primitives.Count) ||
+          !validIndex(node.SkinIndex, header.Skins.Count))
+        return false;
+      // A parent stored before its child could close a cycle
+      if (node.Parent >= 0 && ((uint64_t)node.Parent <= i || (uint64_t)node.Parent >= header.Nodes.Count))
+        return false;
+    }
+    for (uint64_t i = 0; i < header.Primitives.Count; i++) {
+      const auto& primitive = primitives[i];
+      if (!validRange(primitive.FirstIndex, primitive.IndexCount, header.Indices.Count) ||
+          !validRange(primitive.FirstVertex, primitive.VertexCount, header.Vertices.Count) ||
+          !validRange(primitive.FirstMeshlet, primitive.MeshletCount, header.Meshlets.Count) ||
+          !validRange(primitive.FirstLod, primitive.LodCount, header.Lods.Count) ||
+          !validIndex(primitive.MaterialIndex, header.Materials.Count))
+        return false;
+    }
+    for (uint64_t i = 0; i < header.Meshlets.Count; i++) {
+      if (!validRange(meshlets[i].FirstIndex, meshlets[i].IndexCount, header.Indices.Count))
+        return false;
+    }
+    for (uint64_t i = 0; i < header.Lods.Count; i++) {
+      if (!validRange(lods[i].FirstIndex, lods[i].IndexCount, header.Indices.Count) ||
+          !validRange(lods[i].FirstMeshlet, lods[i].MeshletCount, header.Meshlets.Count))
+        return false;
+    }
+
+    // Poses are sized from the joint counts the same way Pose and AnimationClip size them
+    const auto poseSize = [](const uint32_t jointCount) { return (uint64_t)((jointCount + 3) & ~3u) * Pose::StreamCount; };
+    for (uint64_t i = 0; i < header.Skins.Count; i++) {
+      const auto& skin = skins[i];
+      if (!validString(skin.Name) || !validRange(skin.FirstJoint, skin.JointCount, header.Joints.Count) ||
+          !validRange(skin.RestPose, poseSize(skin.JointCount), header.Poses.Count))
+        return false;
+      for (uint32_t j = 0; j < skin.JointCount; j++) {
+        const auto& joint = joints[skin.FirstJoint + j];
+        if (joint.Parent >= (int32_t)j || joint.Node >= header.Nodes.Count)
+          return false;
+      }
+    }
+    for (uint64_t i = 0; i < header.Clips.Count; i++) {
+      const auto& clip = clips[i];
+      if (!validString(clip.Name) || clip.SkinIndex < 0 || (uint64_t)clip.SkinIndex >= header.Skins.Count)
+        return false;
+      // Bounded by the pose count first so the frame count can't overflow
+      if (!std::isfinite(clip.Duration) || clip.Duration * AnimationClip::SampleRate > (float)header.Poses.Count)
+        return false;
+      const uint64_t frameCount = (uint64_t)std::ceil(std::max(clip.Duration, 0.0f) * AnimationClip::SampleRate) + 1;
+      if (!validRange(clip.FirstFrame, frameCount * poseSize(skins[clip.SkinIndex].JointCount), header.Poses.Count))
+        return false;
+    }
+    return true;
+  }
+
+  // Keeps images the way they are stored in the file instead of decoding them
+  static bool KeepImageDataCallback(tinygltf::Image* image,
+                                    const int imageIndex,
+                                    std::string* error,
+                                    std::string* warning,
+                                    int req_width,
+                                    int req_height,
+                                    const unsigned char* bytes,
+                                    int size,
+                                    void* userData) {
+    image->image.assign(bytes, bytes + size);
+    return true;
+  }
+
+  static std::string GetImageExtension(const tinygltf::Image& image) {
+    if (!image.uri.empty() && image.uri.rfind("data:", 0) != 0)
+      return std::filesystem::path(image.uri).extension().string();
+    if (image.mimeType == "image/jpeg" || image.uri.rfind("data:image/jpeg", 0) == 0)
+      return ".jpg";
+    return ".png";
+  }
+
+  static bool ParseGltf(const std::string& path, tinygltf::Model& model, const tinygltf::LoadImageDataFunction imageLoader) {
+    OX_SCOPED_ZONE;
+    tinygltf::TinyGLTF gltfContext;
+    gltfContext.SetImageLoader(imageLoader, nullptr);
+
+    std::string error, warning;
+    bool fileLoaded = false;
+    if (std::filesystem::path(path).extension() == ".gltf")
+      fileLoaded = gltfContext.LoadASCIIFromFile(&model, &error, &warning, path);
+    else
+      fileLoaded = gltfContext.LoadBinaryFromFile(&model, &error, &warning, path);
+    if (!fileLoaded) {
+      OX_CORE_ERROR("Couldnt load gltf file: {}", error);
+      return false;
+    }
+    if (!warning.empty())
+      OX_CORE_WARN("GLTF loader warning: {}", warning);
+    return true;
+  }
   bool Mesh::ExportAsBinary(const std::string& inPath, const std::string& outPath) {
     tinygltf::TinyGLTF gltfContext;
     tinygltf::Model gltfModel;
@@ -71,38 +516,375 @@ namespace Oxylus {
     LoadingFlags = fileLoadingFlags;
     ShouldUpdate = true;
 
+    const bool cooked = std::filesystem::path(path).extension() == CookedExtension;
+    const bool loaded = cooked ? LoadCooked(path) : LoadGltf(path, fileLoadingFlags, scale);
+    if (!loaded)
+      return;
+
+    m_Textures.clear();
+
+    timer.Stop();
+    Name = std::filesystem::path(path).filename().string();
+    OX_CORE_TRACE("Mesh file loaded: {}, {} materials, {} vertices of {} bytes, {} ms",
+      Name.c_str(),
+      m_Materials.size(),
+      VertexCount,
+      sizeof(PackedVertex),
+      timer.ElapsedMilliSeconds());
+  }
+
+  bool Mesh::Cook(const std::string& inPath, const std::string& outPath, const int fileLoadingFlags, const float scale) {
+    OX_SCOPED_ZONE;
     tinygltf::Model gltfModel;
-    tinygltf::TinyGLTF gltfContext;
-    gltfContext.SetImageLoader(LoadImageDataCallback, nullptr);
+    if (!ParseGltf(inPath, gltfModel, KeepImageDataCallback))
+      return false;
 
-    std::string error, warning;
-    bool fileLoaded = false;
-    if (std::filesystem::path(path).extension() == ".gltf")
-      fileLoaded = gltfContext.LoadASCIIFromFile(&gltfModel, &error, &warning, path);
-    else
-      fileLoaded = gltfContext.LoadBinaryFromFile(&gltfModel, &error, &warning, path);
-    if (!fileLoaded) {
-      OX_CORE_ERROR("Couldnt load gltf file: {}", error);
-      return;
+    // Only the CPU side of the mesh is filled, nothing is uploaded
+    Mesh mesh;
+    mesh.Path = inPath;
+    std::vector<PackedVertex> vertices;
+    std::vector<SkinVertex> skinVertices;
+    mesh.LoadGeometry(gltfModel, fileLoadingFlags, scale, vertices, skinVertices);
+    if (vertices.empty() || mesh.m_IndexBuffer.empty()) {
+      OX_CORE_ERROR("Mesh file has no geometry to cook: {}", inPath);
+      return false;
+    }
+
+    std::string strings;
+    const auto addString = [&strings](const std::string& string) {
+      const auto offset = (uint32_t)strings.size();
+      strings.append(string).push_back('\0');
+      return offset;
+    };
+
+    const auto infos = ReadMaterials(gltfModel);
+    std::vector<uint8_t> normalMaps(gltfModel.images.size());
+    for (const auto& info : infos) {
+      if (info.Images[NormalSlot] >= 0)
+        normalMaps[info.Images[NormalSlot]] = true;
+    }
+
+    // Images are encoded to KTX2 with their mips on the workers, so loading them needs no decoding or mip generation.
+    // The ones that can't be encoded are written out the way they were stored.
+    const auto outFile = std::filesystem::path(outPath);
+    std::vector<std::string> imageNames(gltfModel.images.size());
+    JobSystem::ParallelFor((uint32_t)gltfModel.images.size(),
+      1,
+      [&](const uint32_t i) {
+        const auto& image = gltfModel.images[i];
+        if (image.image.empty())
+          return;
+        const auto stem = fmt::format("{}_{}", outFile.stem().string(), i);
+        const auto compressedName = stem + TextureCompressor::Extension;
+        if (TextureCompressor::CompressMemory(image.image.data(), image.image.size(), (outFile.parent_path() / compressedName).string(), normalMaps[i])) {
+          imageNames[i] = compressedName;
+          return;
+        }
+        const auto imageName = stem + GetImageExtension(image);
+        std::ofstream imageFile(outFile.parent_path() / imageName, std::ios::binary);
+        imageFile.write(reinterpret_cast<const char*>(image.image.data()), (std::streamsize)image.image.size());
+        imageNames[i] = imageName;
+      });
+
+    std::vector<uint32_t> images(gltfModel.images.size());
+    for (size_t i = 0; i < gltfModel.images.size(); i++) {
+      if (imageNames[i].empty())
+        OX_CORE_WARN("Couldn't cook image {} of mesh: {}", i, inPath);
+      images[i] = addString(imageNames[i]);
+    }
+
+    std::vector<CookedMesh::MaterialEntry> materials(infos.size());
+    for (size_t i = 0; i < infos.size(); i++) {
+      materials[i].Parameters = infos[i].Parameters;
+      materials[i].AlphaMode = (uint32_t)infos[i].AlphaMode;
+      materials[i].Name = addString(infos[i].Name);
+      std::copy_n(infos[i].Images, TextureSlotCount, materials[i].Images);
+    }
+
+    std::unordered_map<const Node*, int32_t> nodeIndices;
+    for (size_t i = 0; i < mesh.LinearNodes.size(); i++)
+      nodeIndices.emplace(mesh.LinearNodes[i], (int32_t)i);
+
+    std::vector<CookedMesh::NodeEntry> nodes;
+    std::vector<CookedMesh::PrimitiveEntry> primitives;
+    nodes.reserve(mesh.LinearNodes.size());
+    for (const Node* node : mesh.LinearNodes) {
+      auto& entry = nodes.emplace_back();
+      entry.Parent = node->Parent ? nodeIndices.at(node->Parent) : -1;
+      entry.Index = node->Index;
+      entry.MeshIndex = node->MeshIndex;
+      entry.SkinIndex = node->SkinIndex;
+      entry.Name = addString(node->Name);
+      entry.ContainsMesh = node->ContainsMesh;
+      entry.FirstPrimitive = (uint32_t)primitives.size();
+      entry.PrimitiveCount = (uint32_t)node->Primitives.size();
+      entry.Matrix = node->Matrix;
+      entry.Translation = node->Translation;
+      entry.Scale = node->Scale;
+      entry.Rotation = node->Rotation;
+      for (const Primitive* primitive : node->Primitives) {
+        primitives.emplace_back(CookedMesh::PrimitiveEntry{
+          primitive->firstIndex, primitive->indexCount, primitive->firstVertex, primitive->vertexCount,
+          primitive->dimensions.min, primitive->dimensions.max, primitive->materialIndex,
+          primitive->firstMeshlet, primitive->meshletCount, primitive->firstLod, primitive->lodCount
+        });
+      }
+    }
+
+    std::vector<CookedMesh::SkinEntry> skins;
+    std::vector<CookedMesh::JointEntry> joints;
+    std::vector<CookedMesh::ClipEntry> clips;
+    std::vector<float> poses;
+    skins.reserve(mesh.Skins.size());
+    for (const Skeleton& skin : mesh.Skins) {
+      skins.push_back({addString(skin.Name), (uint32_t)joints.size(), skin.GetJointCount(), (uint64_t)poses.size(), skin.Bounds.Min, skin.Bounds.Max});
+      poses.insert(poses.end(), skin.RestPose.GetData(), skin.RestPose.GetData() + skin.RestPose.GetSize());
+      for (uint32_t joint = 0; joint < skin.GetJointCount(); joint++) {
+        joints.push_back({skin.Parents[joint], skin.JointNodes[joint], skin.InverseBindMatrices[joint], skin.RootTransforms[joint],
+                          skin.JointBounds[joint].Min, skin.JointBounds[joint].Max});
+      }
+    }
+    clips.reserve(mesh.Animations.size());
+    for (const AnimationClip& clip : mesh.Animations) {
+      clips.push_back({addString(clip.Name), clip.SkinIndex, clip.Duration, (uint64_t)poses.size()});
+      poses.insert(poses.end(), clip.GetFrames().begin(), clip.GetFrames().end());
+    }
+
+    std::ofstream file(outPath, std::ios::binary);
+    if (!file) {
+      OX_CORE_ERROR("Couldn't open file to write cooked mesh: {}", outPath);
+      return false;
+    }
+
+    CookedMesh::Header header;
+    file.write(reinterpret_cast<const char*>(&header), sizeof header);
+    const auto writeSection = [&file](const void* data, const size_t count, const size_t stride) {
+      // Sections start aligned so they can be read in place from the mapped file
+      while ((uint64_t)file.tellp() % CookedMesh::SectionAlignment)
+        file.put(0);
+      const CookedMesh::Section section{(uint64_t)file.tellp(), (uint64_t)count};
+      file.write(static_cast<const char*>(data), (std::streamsize)(count * stride));
+      return section;
+    };
+    header.Vertices = writeSection(vertices.data(), vertices.size(), sizeof(PackedVertex));
+    header.Indices = writeSection(mesh.m_IndexBuffer.data(), mesh.m_IndexBuffer.size(), sizeof(uint32_t));
+    header.Nodes = writeSection(nodes.data(), nodes.size(), sizeof(CookedMesh::NodeEntry));
+    header.Primitives = writeSection(primitives.data(), primitives.size(), sizeof(CookedMesh::PrimitiveEntry));
+    header.Meshlets = writeSection(mesh.Meshlets.data(), mesh.Meshlets.size(), sizeof(Meshlet));
+    header.Lods = writeSection(mesh.Lods.data(), mesh.Lods.size(), sizeof(Lod));
+    header.Materials = writeSection(materials.data(), materials.size(), sizeof(CookedMesh::MaterialEntry));
+    header.Images = writeSection(images.data(), images.size(), sizeof(uint32_t));
+    header.Strings = writeSection(strings.data(), strings.size(), sizeof(char));
+    header.SkinVertices = writeSection(skinVertices.data(), skinVertices.size(), sizeof(SkinVertex));
+    header.Skins = writeSection(skins.data(), skins.size(), sizeof(CookedMesh::SkinEntry));
+    header.Joints = writeSection(joints.data(), joints.size(), sizeof(CookedMesh::JointEntry));
+    header.Clips = writeSection(clips.data(), clips.size(), sizeof(CookedMesh::ClipEntry));
+    header.Poses = writeSection(poses.data(), poses.size(), sizeof(float));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof header);
+
+    if (!file) {
+      OX_CORE_ERROR("Couldn't write cooked mesh: {}", outPath);
+      return false;
+    }
+    return true;
+  }
+
+  bool Mesh::LoadGltf(const std::string& path, const int fileLoadingFlags, const float scale) {
+    OX_SCOPED_ZONE;
+    tinygltf::Model gltfModel;
+    if (!ParseGltf(path, gltfModel, KeepImageDataCallback))
+      return false;
+
+    // Images are kept encoded by the parser so they are only decoded once, on the workers
+    const auto directory = std::filesystem::path(path).remove_filename();
+    std::vector<ImageSource> images(gltfModel.images.size());
+    for (size_t i = 0; i < gltfModel.images.size(); i++) {
+      const auto& image = gltfModel.images[i];
+      if (!image.uri.empty() && image.uri.rfind("data:", 0) != 0)
+        images[i].Path = (directory / image.uri).string();
+      if (!image.image.empty()) {
+        images[i].Data = image.image.data();
+        images[i].Size = image.image.size();
+      }
+    }
+    LoadTextures(images);
+    CreateMaterials(ReadMaterials(gltfModel));
+
+    std::vector<PackedVertex> packedVertices;
+    std::vector<SkinVertex> skinVertices;
+    LoadGeometry(gltfModel, fileLoadingFlags, scale, packedVertices, skinVertices);
+
+    OX_CORE_ASSERT(IndexCount);
+    OX_CORE_ASSERT(VertexCount);
+
+    Geometry = GeometryBuffer::Get()->Upload(packedVertices.data(), VertexCount, m_IndexBuffer.data(), IndexCount,
+      skinVertices.empty() ? nullptr : skinVertices.data());
+    m_IndexBuffer.clear();
+    return true;
+  }
+
+  bool Mesh::LoadCooked(const std::string& path) {
+    OX_SCOPED_ZONE;
+    const MappedFile file(path);
+    if (!file)
+      return false;
+
+    const auto* header = reinterpret_cast<const CookedMesh::Header*>(file.GetData());
+    if (file.GetSize() < sizeof(CookedMesh::Header) || header->Magic != CookedMesh::Magic) {
+      OX_CORE_ERROR("Not a cooked mesh file: {}", path);
+      return false;
+    }
+    if (header->Version != CookedMesh::Version) {
+      OX_CORE_ERROR("Cooked mesh {} has version {} but {} is expected, it has to be cooked again", path, header->Version, CookedMesh::Version);
+      return false;
+    }
+
+    const auto* vertices = GetSection<PackedVertex>(file, header->Vertices);
+    const auto* indices = GetSection<uint32_t>(file, header->Indices);
+    const auto* nodes = GetSection<CookedMesh::NodeEntry>(file, header->Nodes);
+    const auto* primitives = GetSection<CookedMesh::PrimitiveEntry>(file, header->Primitives);
+    const auto* meshlets = GetSection<Meshlet>(file, header->Meshlets);
+    const auto* lods = GetSection<Lod>(file, header->Lods);
+    const auto* materials = GetSection<CookedMesh::MaterialEntry>(file, header->Materials);
+    const auto* images = GetSection<uint32_t>(file, header->Images);
+    const auto* strings = GetSection<char>(file, header->Strings);
+    const auto* skinVertices = GetSection<SkinVertex>(file, header->SkinVertices);
+    const auto* skins = GetSection<CookedMesh::SkinEntry>(file, header->Skins);
+    const auto* joints = GetSection<CookedMesh::JointEntry>(file, header->Joints);
+    const auto* clips = GetSection<CookedMesh::ClipEntry>(file, header->Clips);
+    const auto* poses = GetSection<float>(file, header->Poses);
+    if (!vertices || !indices || !nodes || !primitives || !meshlets || !lods || !materials || !images || !strings ||
+        !skinVertices || !skins || !joints || !clips || !poses) {
+      OX_CORE_ERROR("Cooked mesh file is truncated: {}", path);
+      return false;
+    }
+    if (!ValidateCooked(*header, indices, nodes, primitives, meshlets, lods, materials, images, strings, skins, joints, clips)) {
+      OX_CORE_ERROR("Cooked mesh file is corrupted: {}", path);
+      return false;
+    }
+
+    const auto directory = std::filesystem::path(path).remove_filename();
+    std::vector<ImageSource> imageSources(header->Images.Count);
+    for (uint64_t i = 0; i < header->Images.Count; i++) {
+      const char* imageName = strings + images[i];
+      if (*imageName)
+        imageSources[i].Path = (directory / imageName).string();
+    }
+    LoadTextures(imageSources);
+
+    std::vector<MaterialInfo> infos(header->Materials.Count);
+    for (uint64_t i = 0; i < header->Materials.Count; i++) {
+      const auto& entry = materials[i];
+      infos[i].Name = strings + entry.Name;
+      infos[i].Parameters = entry.Parameters;
+      infos[i].AlphaMode = (decltype(Material::AlphaMode))entry.AlphaMode;
+      std::copy_n(entry.Images, TextureSlotCount, infos[i].Images);
+    }
+    CreateMaterials(infos);
+
+    // Children are stored before their parents, so every node exists before it is linked
+    LinearNodes.resize(header->Nodes.Count);
+    for (uint64_t i = 0; i < header->Nodes.Count; i++) {
+      const auto& entry = nodes[i];
+      Node* node = LinearNodes[i] = new Node{};
+      node->Index = entry.Index;
+      node->MeshIndex = entry.MeshIndex;
+      node->SkinIndex = entry.SkinIndex;
+      node->Name = strings + entry.Name;
+      node->ContainsMesh = entry.ContainsMesh;
+      node->Matrix = entry.Matrix;
+      node->Translation = entry.Translation;
+      node->Scale = entry.Scale;
+      node->Rotation = entry.Rotation;
+      for (uint32_t p = 0; p < entry.PrimitiveCount; p++) {
+        const auto& primitiveEntry = primitives[entry.FirstPrimitive + p];
+        auto primitive = new Primitive(primitiveEntry.FirstIndex, primitiveEntry.IndexCount);
+        primitive->firstVertex = primitiveEntry.FirstVertex;
+        primitive->vertexCount = primitiveEntry.VertexCount;
+        primitive->materialIndex = primitiveEntry.MaterialIndex;
+        primitive->firstMeshlet = primitiveEntry.FirstMeshlet;
+        primitive->meshletCount = primitiveEntry.MeshletCount;
+        primitive->firstLod = primitiveEntry.FirstLod;
+        primitive->lodCount = primitiveEntry.LodCount;
+        primitive->SetDimensions(primitiveEntry.Min, primitiveEntry.Max);
+        node->Primitives.push_back(primitive);
+      }
+    }
+    for (uint64_t i = 0; i < header->Nodes.Count; i++) {
+      Node* node = LinearNodes[i];
+      if (nodes[i].Parent >= 0) {
+        node->Parent = LinearNodes[nodes[i].Parent];
+        node->Parent->Children.push_back(node);
+      }
+      else {
+        Nodes.push_back(node);
+      }
+    }
+
+    Meshlets.assign(meshlets, meshlets + header->Meshlets.Count);
+    Lods.assign(lods, lods + header->Lods.Count);
+
+    Skins.resize(header->Skins.Count);
+    for (uint64_t i = 0; i < header->Skins.Count; i++) {
+      const auto& entry = skins[i];
+      Skeleton& skin = Skins[i];
+      skin.Name = strings + entry.Name;
+      skin.Bounds = AABB(entry.BoundsMin, entry.BoundsMax);
+      skin.RestPose.Resize(entry.JointCount);
+      std::copy_n(poses + entry.RestPose, skin.RestPose.GetSize(), skin.RestPose.GetData());
+      for (uint32_t j = 0; j < entry.JointCount; j++) {
+        const auto& joint = joints[entry.FirstJoint + j];
+        skin.Parents.push_back(joint.Parent);
+        skin.JointNodes.push_back(joint.Node);
+        skin.InverseBindMatrices.push_back(joint.InverseBindMatrix);
+        skin.RootTransforms.push_back(joint.RootTransform);
+        skin.JointBounds.emplace_back(joint.BoundsMin, joint.BoundsMax);
+      }
+    }
+    Animations.resize(header->Clips.Count);
+    for (uint64_t i = 0; i < header->Clips.Count; i++) {
+      const auto& entry = clips[i];
+      AnimationClip& clip = Animations[i];
+      clip.Name = strings + entry.Name;
+      clip.SkinIndex = entry.SkinIndex;
+      clip.Create(entry.Duration, Skins[entry.SkinIndex].GetJointCount());
+      auto& frames = clip.GetFrames();
+      std::copy_n(poses + entry.FirstFrame, frames.size(), frames.data());
     }
-    if (!warning.empty())
-      OX_CORE_WARN("GLTF loader warning: {}", warning);
 
-    LoadTextures(gltfModel);
-    LoadMaterials(gltfModel);
+    IndexCount = (uint32_t)header->Indices.Count;
+    VertexCount = (uint32_t)header->Vertices.Count;
+    OX_CORE_ASSERT(IndexCount);
+    OX_CORE_ASSERT(VertexCount);
+    OX_CORE_ASSERT(header->SkinVertices.Count == 0 || header->SkinVertices.Count == VertexCount);
 
-    const tinygltf::Scene& scene = gltfModel.scenes[gltfModel.defaultScene > -1 ? gltfModel.defaultScene : 0];
+    // Staged straight from the mapped pages
+    Geometry = GeometryBuffer::Get()->Upload(vertices, VertexCount, indices, IndexCount, header->SkinVertices.Count ? skinVertices : nullptr);
+    return true;
+  }
+
+  void Mesh::LoadGeometry(tinygltf::Model& model,
+                          const int fileLoadingFlags,
+                          const float scale,
+                          std::vector<PackedVertex>& packedVertices,
+                          std::vector<SkinVertex>& skinVertices) {
+    OX_SCOPED_ZONE;
+    const tinygltf::Scene& scene = model.scenes[model.defaultScene > -1 ? model.defaultScene : 0];
 
     for (int nodeIndex : scene.nodes) {
-      const tinygltf::Node node = gltfModel.nodes[nodeIndex];
-      LoadNode(nullptr, node, nodeIndex, gltfModel, m_IndexBuffer, m_VertexBuffer, scale);
+      const tinygltf::Node node = model.nodes[nodeIndex];
+      LoadNode(nullptr, node, nodeIndex, model, m_IndexBuffer, m_VertexBuffer, scale);
     }
-    //TODO: Skins and animations.
 
     const bool preMultiplyColor = fileLoadingFlags & FileLoadingFlags::PreMultiplyVertexColors;
     const bool flipY = fileLoadingFlags & FileLoadingFlags::FlipY;
+    LoadSkins(model, scale, flipY);
+    LoadAnimations(model);
+
+    // Skinned vertices are placed by their joints, whose root transforms already have the scale and the flip
     for (auto& node : LinearNodes) {
-      if (!node)
+      if (!node || node->SkinIndex >= 0)
         continue;
       const Mat4 localMatrix = node->GetMatrix();
       for (const Primitive* primitive : node->Primitives) {
@@ -121,66 +903,314 @@ namespace Oxylus {
       }
     }
 
-    const vk::DeviceSize vBufferSize = m_VertexBuffer.size() * sizeof(Vertex);
-    const vk::DeviceSize iBufferSize = m_IndexBuffer.size() * sizeof(uint32_t);
+    ComputeSkinBounds();
+    BuildLods();
+    BuildMeshlets();
     IndexCount = static_cast<uint32_t>(m_IndexBuffer.size());
     VertexCount = static_cast<uint32_t>(m_VertexBuffer.size());
 
-    OX_CORE_ASSERT(iBufferSize);
-    OX_CORE_ASSERT(vBufferSize);
+    packedVertices.resize(m_VertexBuffer.size());
+    for (size_t i = 0; i < m_VertexBuffer.size(); i++)
+      packedVertices[i] = PackVertex(m_VertexBuffer[i]);
+
+    // Vertices of meshes with skins all get one, the ones of nodes without a skin have no weights
+    skinVertices.clear();
+    if (!Skins.empty()) {
+      skinVertices.resize(m_VertexBuffer.size());
+      for (const Node* node : LinearNodes) {
+        if (node->SkinIndex < 0)
+          continue;
+        for (const Primitive* primitive : node->Primitives) {
+          for (uint32_t i = primitive->firstVertex; i < primitive->firstVertex + primitive->vertexCount; i++)
+            skinVertices[i] = PackSkinVertex(m_VertexBuffer[i]);
+        }
+      }
+    }
+    m_VertexBuffer.clear();
+  }
 
-    VulkanBuffer vertexStaging, indexStaging;
+  void Mesh::LoadSkins(const tinygltf::Model& model, const float scale, const bool flipY) {
+    OX_SCOPED_ZONE;
+    std::vector<int32_t> nodeParents(model.nodes.size(), -1);
+    for (size_t i = 0; i < model.nodes.size(); i++) {
+      for (const int child : model.nodes[i].children)
+        nodeParents[child] = (int32_t)i;
+    }
 
-    vertexStaging.CreateBuffer(vk::BufferUsageFlagBits::eTransferSrc,
-      vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-      vBufferSize,
-      m_VertexBuffer.data(),
-      VMA_MEMORY_USAGE_AUTO_PREFER_HOST);
+    // Skinned vertices end up in the space the vertices of the other nodes are baked into
+    Mat4 base = glm::scale(Mat4(1.0f), Vec3(scale));
+    if (flipY)
+      base = glm::scale(Mat4(1.0f), Vec3(1.0f, -1.0f, 1.0f)) * base;
+    const auto globalMatrix = [&](int32_t node) {
+      Mat4 matrix = Mat4(1.0f);
+      for (; node >= 0; node = nodeParents[node])
+        matrix = GetNodeMatrix(model.nodes[node]) * matrix;
+      return base * matrix;
+    };
+
+    Skins.resize(model.skins.size());
+    std::vector<std::vector<uint32_t>> remaps(model.skins.size());
+    for (size_t s = 0; s < model.skins.size(); s++) {
+      const auto& skin = model.skins[s];
+      const auto jointCount = (uint32_t)skin.joints.size();
+
+      // Parents are the closest ancestors that are joints of the same skin, nodes between joints are skipped
+      std::unordered_map<int32_t, uint32_t> fileJoints;
+      for (uint32_t j = 0; j < jointCount; j++)
+        fileJoints.emplace(skin.joints[j], j);
+      std::vector<int32_t> fileParents(jointCount, -1);
+      for (uint32_t j = 0; j < jointCount; j++) {
+        for (int32_t node = nodeParents[skin.joints[j]]; node >= 0 && fileParents[j] < 0; node = nodeParents[node]) {
+          if (const auto it = fileJoints.find(node); it != fileJoints.end())
+            fileParents[j] = (int32_t)it->second;
+        }
+      }
 
-    VerticiesBuffer.CreateBuffer(vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
-      vk::MemoryPropertyFlagBits::eDeviceLocal,
-      vBufferSize,
-      nullptr,
-      VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+      // Sorting by depth puts every joint after its parent
+      std::vector<uint32_t> depths(jointCount, 0);
+      for (uint32_t j = 0; j < jointCount; j++) {
+        for (int32_t parent = fileParents[j]; parent >= 0 && depths[j] <= jointCount; parent = fileParents[parent])
+          depths[j]++;
+      }
+      std::vector<uint32_t> order(jointCount);
+      std::iota(order.begin(), order.end(), 0u);
+      std::stable_sort(order.begin(), order.end(), [&depths](const uint32_t a, const uint32_t b) { return depths[a] < depths[b]; });
+      auto& remap = remaps[s];
+      remap.resize(jointCount);
+      for (uint32_t i = 0; i < jointCount; i++)
+        remap[order[i]] = i;
+
+      const std::vector<float> inverseBindMatrices = skin.inverseBindMatrices >= 0 ? ReadAccessor(model, skin.inverseBindMatrices) : std::vector<float>();
+      Skeleton& skeleton = Skins[s];
+      skeleton.Name = skin.name;
+      skeleton.Parents.resize(jointCount);
+      skeleton.InverseBindMatrices.resize(jointCount);
+      skeleton.RootTransforms.resize(jointCount);
+      skeleton.JointNodes.resize(jointCount);
+      skeleton.RestPose.Resize(jointCount);
+      for (uint32_t i = 0; i < jointCount; i++) {
+        const uint32_t j = order[i];
+        const int32_t node = skin.joints[j];
+        skeleton.Parents[i] = fileParents[j] < 0 ? -1 : (int32_t)remap[fileParents[j]];
+        skeleton.JointNodes[i] = (uint32_t)node;
+        skeleton.RootTransforms[i] = fileParents[j] < 0 ? globalMatrix(nodeParents[node]) : Mat4(1.0f);
+        skeleton.InverseBindMatrices[i] = inverseBindMatrices.size() >= (j + 1) * 16 ? glm::make_mat4x4(&inverseBindMatrices[j * 16]) : Mat4(1.0f);
+
+        Vec3 translation, jointScale;
+        glm::quat rotation;
+        GetNodeTransform(model.nodes[node], translation, rotation, jointScale);
+        skeleton.RestPose.SetJoint(i, translation, rotation, jointScale);
+      }
+    }
 
-    indexStaging.CreateBuffer(vk::BufferUsageFlagBits::eTransferSrc,
-      vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-      iBufferSize,
-      m_IndexBuffer.data(),
-      VMA_MEMORY_USAGE_AUTO_PREFER_HOST);
+    // Vertices refer to joints in the order of the file
+    for (const Node* node : LinearNodes) {
+      if (node->SkinIndex < 0)
+        continue;
+      const auto& remap = remaps[node->SkinIndex];
+      for (const Primitive* primitive : node->Primitives) {
+        for (uint32_t i = primitive->firstVertex; i < primitive->firstVertex + primitive->vertexCount; i++) {
+          Vertex& vertex = m_VertexBuffer[i];
+          for (uint32_t k = 0; k < 4; k++) {
+            const auto joint = (uint32_t)vertex.Joint0[k];
+            vertex.Weight0[k] = joint < remap.size() ? vertex.Weight0[k] : 0.0f;
+            vertex.Joint0[k] = joint < remap.size() ? (float)remap[joint] : 0.0f;
+          }
+        }
+      }
+    }
+  }
 
-    IndiciesBuffer.CreateBuffer(vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
-      vk::MemoryPropertyFlagBits::eDeviceLocal,
-      iBufferSize,
-      nullptr,
-      VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE);
+  void Mesh::LoadAnimations(const tinygltf::Model& model) {
+    OX_SCOPED_ZONE;
+    std::vector<std::unordered_map<uint32_t, uint32_t>> skinJoints(Skins.size());
+    for (size_t s = 0; s < Skins.size(); s++) {
+      for (uint32_t joint = 0; joint < Skins[s].GetJointCount(); joint++)
+        skinJoints[s].emplace(Skins[s].JointNodes[joint], joint);
+    }
 
-    VulkanRenderer::SubmitOnce(CommandPoolManager::Get()->GetFreePool(),
-      [&](const VulkanCommandBuffer copyCmd) {
-        vk::BufferCopy copyRegion{};
+    // Animations of the file can move the joints of several skins, every skin gets its own clip.
+    // Only joint transforms are animated, morph target weights aren't supported.
+    Pose pose;
+    float values[4];
+    for (const auto& animation : model.animations) {
+      for (uint32_t s = 0; s < (uint32_t)Skins.size(); s++) {
+        std::vector<ChannelKeys> channels;
+        float duration = 0.0f;
+        for (const auto& channel : animation.channels) {
+          const auto joint = skinJoints[s].find((uint32_t)channel.target_node);
+          if (joint == skinJoints[s].end() || channel.sampler < 0)
+            continue;
+          ChannelKeys keys;
+          keys.Joint = joint->second;
+          if (channel.target_path == "translation") {
+            keys.FirstStream = Pose::TranslationX;
+          }
+          else if (channel.target_path == "rotation") {
+            keys.FirstStream = Pose::RotationX;
+            keys.Components = 4;
+          }
+          else if (channel.target_path == "scale") {
+            keys.FirstStream = Pose::ScaleX;
+          }
+          else {
+            continue;
+          }
+          const auto& sampler = animation.samplers[channel.sampler];
+          keys.Mode = sampler.interpolation == "STEP" ? ChannelKeys::Step : sampler.interpolation == "CUBICSPLINE" ? ChannelKeys::CubicSpline : ChannelKeys::Linear;
+          keys.Times = ReadAccessor(model, sampler.input);
+          keys.Values = ReadAccessor(model, sampler.output);
+          if (!keys.IsValid())
+            continue;
+          duration = std::max(duration, keys.Times.back());
+          channels.emplace_back(std::move(keys));
+        }
+        if (channels.empty())
+          continue;
+
+        AnimationClip& clip = Animations.emplace_back();
+        clip.Name = animation.name;
+        clip.SkinIndex = (int32_t)s;
+        clip.Create(duration, Skins[s].GetJointCount());
+        for (uint32_t frame = 0; frame < clip.GetFrameCount(); frame++) {
+          pose = Skins[s].RestPose;
+          const float time = clip.GetFrameTime(frame);
+          for (const auto& keys : channels) {
+            keys.Sample(time, values);
+            for (uint32_t c = 0; c < keys.Components; c++)
+              pose.GetStream((Pose::Stream)(keys.FirstStream + c))[keys.Joint] = values[c];
+          }
+          clip.SetFrame(frame, pose);
+        }
+      }
+    }
+  }
+
+  void Mesh::ComputeSkinBounds() {
+    OX_SCOPED_ZONE;
+    for (auto& skin : Skins)
+      skin.JointBounds.assign(skin.GetJointCount(), AABB());
+    for (const Node* node : LinearNodes) {
+      if (node->SkinIndex < 0)
+        continue;
+      Skeleton& skin = Skins[node->SkinIndex];
+      for (const Primitive* primitive : node->Primitives) {
+        for (uint32_t i = primitive->firstVertex; i < primitive->firstVertex + primitive->vertexCount; i++) {
+          const Vertex& vertex = m_VertexBuffer[i];
+          for (uint32_t k = 0; k < 4; k++) {
+            if (vertex.Weight0[k] > 0.0f)
+              skin.JointBounds[(uint32_t)vertex.Joint0[k]].Merge(AABB(vertex.Pos, vertex.Pos));
+          }
+        }
+      }
+    }
 
-        copyRegion.size = vBufferSize;
-        vertexStaging.CopyTo(VerticiesBuffer.Get(), copyCmd.Get(), copyRegion);
+    // The union over the rest pose and every frame of the clips holds the skinned mesh wherever the clips move it,
+    // so culling needs no per frame bounds
+    std::vector<Mat4> matrices;
+    for (auto& skin : Skins) {
+      matrices.resize(skin.GetJointCount());
+      skin.ComputeSkinningMatrices(skin.RestPose, matrices.data());
+      skin.Bounds = skin.ComputeBounds(matrices.data());
+    }
+    Pose pose;
+    for (const auto& clip : Animations) {
+      Skeleton& skin = Skins[clip.SkinIndex];
+      matrices.resize(skin.GetJointCount());
+      pose.Resize(skin.GetJointCount());
+      for (uint32_t frame = 0; frame < clip.GetFrameCount(); frame++) {
+        clip.Sample(clip.GetFrameTime(frame), false, pose);
+        skin.ComputeSkinningMatrices(pose, matrices.data());
+        skin.Bounds.Merge(skin.ComputeBounds(matrices.data()));
+      }
+    }
+  }
 
-        copyRegion.size = iBufferSize;
-        indexStaging.CopyTo(IndiciesBuffer.Get(), copyCmd.Get(), copyRegion);
+  void Mesh::BuildLods() {
+    OX_SCOPED_ZONE;
+    std::vector<Primitive*> primitives;
+    for (const Node* node : LinearNodes)
+      primitives.insert(primitives.end(), node->Primitives.begin(), node->Primitives.end());
+
+    // Every level halves the triangles of the one before, until simplifying barely removes any
+    struct LodIndices {
+      std::vector<uint32_t> Indices;
+      float Error = 0.0f;
+    };
+    std::vector<std::vector<LodIndices>> primitiveLods(primitives.size());
+    JobSystem::ParallelFor((uint32_t)primitives.size(), 1,
+      [&](const uint32_t i) {
+        const Primitive* primitive = primitives[i];
+        const uint32_t* indices = m_IndexBuffer.data() + primitive->firstIndex;
+        uint32_t indexCount = primitive->indexCount;
+        float error = 0.0f;
+        while (primitiveLods[i].size() + 1 < MaxLods && indexCount / 2 >= MinLodIndexCount) {
+          LodIndices lod;
+          error += MeshSimplifier::Simplify(&m_VertexBuffer[0].Pos, sizeof(Vertex), indices, indexCount, indexCount / 6 * 3, FLT_MAX, lod.Indices);
+          if (lod.Indices.size() * 4 > (size_t)indexCount * 3)
+            break;
+          lod.Error = error;
+          auto& added = primitiveLods[i].emplace_back(std::move(lod));
+          indices = added.Indices.data();
+          indexCount = (uint32_t)added.Indices.size();
+        }
       });
 
-    // Destroy staging resources
-    vertexStaging.Destroy();
-    indexStaging.Destroy();
+    Lods.clear();
+    for (size_t i = 0; i < primitives.size(); i++) {
+      primitives[i]->firstLod = (uint32_t)Lods.size();
+      primitives[i]->lodCount = (uint32_t)primitiveLods[i].size();
+      for (const auto& lod : primitiveLods[i]) {
+        Lods.push_back({(uint32_t)m_IndexBuffer.size(), (uint32_t)lod.Indices.size(), 0, 0, lod.Error});
+        m_IndexBuffer.insert(m_IndexBuffer.end(), lod.Indices.begin(), lod.Indices.end());
+      }
+    }
+  }
 
-    m_VertexBuffer.clear();
-    m_IndexBuffer.clear();
+  void Mesh::BuildMeshlets() {
+    OX_SCOPED_ZONE;
+    // Index ranges of every primitive and LOD, they don't overlap so they are reordered in parallel and joined in a fixed order
+    struct Range {
+      uint32_t FirstIndex;
+      uint32_t IndexCount;
+      uint32_t* FirstMeshlet;
+      uint32_t* MeshletCount;
+    };
+    std::vector<Range> ranges;
+    for (const Node* node : LinearNodes) {
+      for (Primitive* primitive : node->Primitives) {
+        ranges.push_back({primitive->firstIndex, primitive->indexCount, &primitive->firstMeshlet, &primitive->meshletCount});
+        for (uint32_t i = 0; i < primitive->lodCount; i++) {
+          Lod& lod = Lods[primitive->firstLod + i];
+          ranges.push_back({lod.FirstIndex, lod.IndexCount, &lod.FirstMeshlet, &lod.MeshletCount});
+        }
+      }
+    }
 
-    m_Textures.clear();
+    std::vector<std::vector<Meshlet>> rangeMeshlets(ranges.size());
+    JobSystem::ParallelFor((uint32_t)ranges.size(), 1,
+      [&](const uint32_t i) {
+        MeshletBuilder::Build(&m_VertexBuffer[0].Pos, sizeof(Vertex), m_IndexBuffer.data(),
+          ranges[i].FirstIndex, ranges[i].IndexCount, rangeMeshlets[i]);
+      });
 
-    timer.Stop();
-    Name = std::filesystem::path(path).filename().string();
-    OX_CORE_TRACE("Mesh file loaded: {}, {} materials, {} ms",
-      Name.c_str(),
-      gltfModel.materials.size(),
-      timer.ElapsedMilliSeconds());
+    Meshlets.clear();
+    for (size_t i = 0; i < ranges.size(); i++) {
+      *ranges[i].FirstMeshlet = (uint32_t)Meshlets.size();
+      *ranges[i].MeshletCount = (uint32_t)rangeMeshlets[i].size();
+      Meshlets.insert(Meshlets.end(), rangeMeshlets[i].begin(), rangeMeshlets[i].end());
+    }
+  }
+
+  Mesh::Lod Mesh::SelectLod(const Primitive& primitive, const float pixelsPerUnit, const float threshold) const {
+    Lod selected = {primitive.firstIndex, primitive.indexCount, primitive.firstMeshlet, primitive.meshletCount, 0.0f};
+    for (uint32_t i = 0; i < primitive.lodCount; i++) {
+      const Lod& lod = Lods[primitive.firstLod + i];
+      if (lod.Error * pixelsPerUnit > threshold)
+        break;
+      selected = lod;
+    }
+    return selected;
   }
 
   void Mesh::SetScale(const Vec3& scale) {
@@ -191,12 +1221,11 @@ namespace Oxylus {
 
   void Mesh::Draw(const vk::CommandBuffer& cmdBuffer) const {
     OX_SCOPED_ZONE;
-    constexpr vk::DeviceSize offsets[1] = {0};
-    cmdBuffer.bindVertexBuffers(0, VerticiesBuffer.Get(), offsets);
-    cmdBuffer.bindIndexBuffer(IndiciesBuffer.Get(), 0, vk::IndexType::eUint32);
+    GeometryBuffer::Get()->Bind(cmdBuffer);
+    const auto& geometry = GetGeometry();
     for (const auto& node : Nodes) {
       for (const auto& primitive : node->Primitives)
-        cmdBuffer.drawIndexed(primitive->indexCount, 1, primitive->firstIndex, 0, 0);
+        cmdBuffer.drawIndexed(primitive->indexCount, 1, geometry.IndexOffset + primitive->firstIndex, (int32_t)geometry.VertexOffset, 0);
     }
   }
 
@@ -206,50 +1235,117 @@ namespace Oxylus {
     }
   }
 
-  void Mesh::LoadTextures(const tinygltf::Model& model) {
-    m_Textures.resize(model.images.size());
-    for (size_t i = 0; i < model.images.size(); i++) {
-      auto& img = model.images[i];
-      VulkanImageDescription desc;
-      desc.CreateDescriptorSet = true;
-      desc.Width = img.width;
-      desc.Height = img.height;
-      desc.GenerateMips = true;
-      if (IsImageKtx(img) || !img.uri.empty()) {
-        desc.Path = (std::filesystem::path(Path).remove_filename() / img.uri).string();
+  void Mesh::LoadTextures(const std::vector<ImageSource>& sources) {
+    OX_SCOPED_ZONE;
+    m_Textures.resize(sources.size());
+
+    // KTX files and images other meshes already loaded come from the asset manager, the rest is decoded here
+    std::vector<uint32_t> pending;
+    for (uint32_t i = 0; i < (uint32_t)sources.size(); i++) {
+      const auto& source = sources[i];
+      if (source.Path.empty()) {
+        if (source.Data)
+          pending.emplace_back(i);
+        continue;
+      }
+      const auto extension = std::filesystem::path(source.Path).extension();
+      if (extension == ".ktx" || extension == ".ktx2") {
+        VulkanImageDescription desc;
+        desc.CreateDescriptorSet = true;
+        desc.GenerateMips = true;
+        desc.Path = source.Path;
+        desc.Streamed = extension == ".ktx2" && TextureStreamer::Get();
         m_Textures[i] = AssetManager::GetImageAsset(desc).Data;
+        if (desc.Streamed)
+          TextureStreamer::Get()->Register(m_Textures[i]);
+      }
+      else if (const auto asset = AssetManager::FindImageAsset(source.Path)) {
+        m_Textures[i] = asset.Data;
       }
       else {
-        desc.EmbeddedStbData = img.image.data();
-        desc.EmbeddedDataLength = static_cast<uint32_t>(img.image.size());
-        m_Textures[i] = CreateRef<VulkanImage>(desc);
+        pending.emplace_back(i);
+      }
+    }
+
+    struct DecodedImage {
+      stbi_uc* Pixels = nullptr;
+      int Width = 0;
+      int Height = 0;
+    };
+
+    // Decoded in chunks so only a few decoded images are alive at once, the mips of all of them are generated at the end
+    const uint32_t chunkSize = JobSystem::GetThreadCount() * 2;
+    std::vector<DecodedImage> decoded(chunkSize);
+    std::vector<Ref<VulkanImage>> createdImages;
+    createdImages.reserve(pending.size());
+    for (uint32_t chunk = 0; chunk < (uint32_t)pending.size(); chunk += chunkSize) {
+      const uint32_t count = std::min(chunkSize, (uint32_t)pending.size() - chunk);
+      JobSystem::ParallelFor(count,
+        1,
+        [&sources, &pending, &decoded, chunk](const uint32_t index) {
+          const auto& source = sources[pending[chunk + index]];
+          auto& image = decoded[index];
+          int channels = 0;
+          if (source.Data)
+            image.Pixels = stbi_load_from_memory(source.Data, (int)source.Size, &image.Width, &image.Height, &channels, STBI_rgb_alpha);
+          else
+            image.Pixels = stbi_load(source.Path.c_str(), &image.Width, &image.Height, &channels, STBI_rgb_alpha);
+        });
+
+      // Uploads only copy into staging memory, the decoded pixels can be freed right away
+      for (uint32_t index = 0; index < count; index++) {
+        const uint32_t textureIndex = pending[chunk + index];
+        const auto& source = sources[textureIndex];
+        auto& image = decoded[index];
+        if (!image.Pixels) {
+          OX_CORE_ERROR("Couldn't decode image {} of {}: {}", source.Path.empty() ? std::to_string(textureIndex) : source.Path, Path, stbi_failure_reason());
+          continue;
+        }
+
+        VulkanImageDescription desc;
+        desc.CreateDescriptorSet = true;
+        desc.GenerateMips = true;
+        desc.DeferMips = true;
+        desc.Path = source.Path;
+        desc.Width = (uint32_t)image.Width;
+        desc.Height = (uint32_t)image.Height;
+        desc.EmbeddedStbData = image.Pixels;
+        desc.EmbeddedDataLength = (size_t)image.Width * image.Height * 4;
+        auto texture = CreateRef<VulkanImage>(desc);
+        stbi_image_free(image.Pixels);
+        image = {};
+
+        m_Textures[textureIndex] = source.Path.empty() ? texture : AssetManager::AddImageAsset(texture, source.Path).Data;
+        // Another thread may have registered the same image first, ours is dropped then
+        if (m_Textures[textureIndex] != texture) {
+          texture->Destroy();
+          continue;
+        }
+        createdImages.emplace_back(std::move(texture));
       }
     }
+
+    VulkanImage::GenerateDeferredMips(createdImages);
   }
 
-  void Mesh::LoadMaterials(tinygltf::Model& model) {
+  std::vector<Mesh::MaterialInfo> Mesh::ReadMaterials(tinygltf::Model& model) {
     OX_SCOPED_ZONE;
-    // Create a empty material if the mesh file doesn't have any.
-    if (model.materials.empty()) {
-      m_Materials.emplace_back(CreateRef<Material>());
-      const bool dontCreateMaterials = LoadingFlags & FileLoadingFlags::DontCreateMaterials;
-      if (!dontCreateMaterials)
-        m_Materials[0]->Create();
-      return;
-    }
+    const auto imageOf = [&model](const int32_t textureIndex) {
+      return model.textures[textureIndex].source;
+    };
 
+    std::vector<MaterialInfo> materials;
+    materials.reserve(model.materials.size());
     for (tinygltf::Material& mat : model.materials) {
-      Material material;
-      material.Create();
-      if (!mat.name.empty())
-        material.Name = mat.name;
+      MaterialInfo& material = materials.emplace_back();
+      material.Name = mat.name;
       material.Parameters.DoubleSided = mat.doubleSided;
       if (mat.values.contains("baseColorTexture")) {
-        material.AlbedoTexture = m_Textures.at(model.textures[mat.values["baseColorTexture"].TextureIndex()].source);
+        material.Images[AlbedoSlot] = imageOf(mat.values["baseColorTexture"].TextureIndex());
         material.Parameters.UseAlbedo = true;
       }
       if (mat.values.contains("metallicRoughnessTexture")) {
-        material.MetallicTexture = m_Textures.at(model.textures[mat.values["metallicRoughnessTexture"].TextureIndex()].source);
+        material.Images[MetallicSlot] = imageOf(mat.values["metallicRoughnessTexture"].TextureIndex());
         material.Parameters.UseMetallic = true;
       }
       if (mat.values.contains("roughnessFactor")) {
@@ -268,15 +1364,15 @@ namespace Oxylus {
         material.Parameters.Emmisive = glm::vec4(glm::make_vec3(mat.additionalValues["emissiveFactor"].ColorFactor().data()), 1.0);
       }
       if (mat.additionalValues.contains("normalTexture")) {
-        material.NormalTexture = m_Textures.at(model.textures[mat.additionalValues["normalTexture"].TextureIndex()].source);
+        material.Images[NormalSlot] = imageOf(mat.additionalValues["normalTexture"].TextureIndex());
         material.Parameters.UseNormal = true;
       }
       if (mat.additionalValues.contains("emissiveTexture")) {
-        material.EmissiveTexture = m_Textures.at(model.textures[mat.additionalValues["emissiveTexture"].TextureIndex()].source);
+        material.Images[EmissiveSlot] = imageOf(mat.additionalValues["emissiveTexture"].TextureIndex());
         material.Parameters.UseEmissive = true;
       }
       if (mat.additionalValues.contains("occlusionTexture")) {
-        material.AOTexture = m_Textures.at(model.textures[mat.additionalValues["occlusionTexture"].TextureIndex()].source);
+        material.Images[AOSlot] = imageOf(mat.additionalValues["occlusionTexture"].TextureIndex());
       }
       if (mat.alphaMode == "BLEND") {
           material.AlphaMode = Material::AlphaMode::Blend;
@@ -292,7 +1388,7 @@ namespace Oxylus {
         auto ext = mat.extensions.find("KHR_materials_pbrSpecularGlossiness");
         if (ext->second.Has("specularGlossinessTexture")) {
           auto index = ext->second.Get("specularGlossinessTexture").Get("index");
-          material.SpecularTexture = m_Textures.at(model.textures[mat.additionalValues["specularGlossinessTexture"].TextureIndex()].source);
+          material.Images[SpecularSlot] = imageOf(mat.additionalValues["specularGlossinessTexture"].TextureIndex());
           material.Parameters.UseSpecular = true;
         }
         if (ext->second.Has("specularFactor")) {
@@ -324,8 +1420,40 @@ namespace Oxylus {
           material.Parameters.Specular = (float)std::pow((value - 1) / (value + 1), 2);
         }
       }
+    }
+    return materials;
+  }
 
-      m_Materials.push_back(CreateRef<Material>(material));
+  void Mesh::CreateMaterials(const std::vector<MaterialInfo>& materials) {
+    OX_SCOPED_ZONE;
+    // Create a empty material if the mesh file doesn't have any.
+    if (materials.empty()) {
+      m_Materials.emplace_back(CreateRef<Material>());
+      const bool dontCreateMaterials = LoadingFlags & FileLoadingFlags::DontCreateMaterials;
+      if (!dontCreateMaterials)
+        m_Materials[0]->Create();
+      return;
+    }
+
+    for (const auto& info : materials) {
+      auto material = CreateRef<Material>();
+      material->Create();
+      if (!info.Name.empty())
+        material->Name = info.Name;
+      material->Parameters = info.Parameters;
+      material->AlphaMode = info.AlphaMode;
+
+      Ref<VulkanImage>* slots[TextureSlotCount] = {
+        &material->AlbedoTexture, &material->NormalTexture, &material->MetallicTexture,
+        &material->AOTexture, &material->EmissiveTexture, &material->SpecularTexture
+      };
+      for (uint32_t slot = 0; slot < TextureSlotCount; slot++) {
+        const int32_t image = info.Images[slot];
+        if (image >= 0 && m_Textures.at(image))
+          *slots[slot] = m_Textures.at(image);
+      }
+
+      m_Materials.push_back(material);
     }
   }
 
@@ -349,8 +1477,14 @@ namespace Oxylus {
     }
     LinearNodes.clear();
     Nodes.clear();
-    VerticiesBuffer.Destroy();
-    IndiciesBuffer.Destroy();
+    Meshlets.clear();
+    Lods.clear();
+    Skins.clear();
+    Animations.clear();
+    // The geometry buffer may already be gone when meshes outlive the renderer
+    if (GeometryBuffer::Get())
+      GeometryBuffer::Get()->Free(Geometry);
+    Geometry = GeometryBuffer::InvalidHandle;
     m_Materials.clear();
   }
 
@@ -392,7 +1526,7 @@ namespace Oxylus {
     newNode->Index = nodeIndex;
     newNode->Parent = parent;
     newNode->Name = node.name;
-    newNode->SkinIndex = node.skin;
+    newNode->SkinIndex = node.skin < (int)model.skins.size() ? node.skin : -1;
     newNode->Matrix = Mat4(1.0f);
     newNode->Scale = Vec3(globalscale);
 
@@ -444,8 +1578,6 @@ namespace Oxylus {
           const float* bufferColors = nullptr;
           const float* bufferTangents = nullptr;
           uint32_t numColorComponents;
-          const uint16_t* bufferJoints = nullptr;
-          const float* bufferWeights = nullptr;
 
           // Position attribute is required
           assert(primitive.attributes.find("POSITION") != primitive.attributes.end());
@@ -482,21 +1614,14 @@ namespace Oxylus {
             bufferTangents = reinterpret_cast<const float*>(&model.buffers[tangentView.buffer].data[tangentAccessor.byteOffset + tangentView.byteOffset]);
           }
 
-          // Skinning
-          // Joints
-          if (primitive.attributes.contains("JOINTS_0")) {
-            const tinygltf::Accessor& jointAccessor = model.accessors[primitive.attributes.find("JOINTS_0")->second];
-            const tinygltf::BufferView& jointView = model.bufferViews[jointAccessor.bufferView];
-            bufferJoints = reinterpret_cast<const uint16_t*>(&model.buffers[jointView.buffer].data[jointAccessor.byteOffset + jointView.byteOffset]);
-          }
-
-          if (primitive.attributes.contains("WEIGHTS_0")) {
-            const tinygltf::Accessor& uvAccessor = model.accessors[primitive.attributes.find("WEIGHTS_0")->second];
-            const tinygltf::BufferView& uvView = model.bufferViews[uvAccessor.bufferView];
-            bufferWeights = reinterpret_cast<const float*>(&model.buffers[uvView.buffer].data[uvAccessor.byteOffset + uvView.byteOffset]);
+          // Skinning, joints are 8 or 16 bit and weights can be normalized integers
+          std::vector<float> joints, weights;
+          if (primitive.attributes.contains("JOINTS_0") && primitive.attributes.contains("WEIGHTS_0")) {
+            joints = ReadAccessor(model, primitive.attributes.find("JOINTS_0")->second);
+            weights = ReadAccessor(model, primitive.attributes.find("WEIGHTS_0")->second);
           }
 
-          hasSkin = bufferJoints && bufferWeights;
+          hasSkin = joints.size() >= posAccessor.count * 4 && weights.size() >= posAccessor.count * 4;
 
           vertexCount = static_cast<uint32_t>(posAccessor.count);
 
@@ -516,8 +1641,8 @@ namespace Oxylus {
               vert.Color = glm::vec4(1.0f);
             }
             vert.Tangent = bufferTangents ? glm::vec4(glm::make_vec4(&bufferTangents[v * 4])) : glm::vec4(0.0f);
-            vert.Joint0 = hasSkin ? glm::vec4(glm::make_vec4(&bufferJoints[v * 4])) : glm::vec4(0.0f);
-            vert.Weight0 = hasSkin ? glm::make_vec4(&bufferWeights[v * 4]) : glm::vec4(0.0f);
+            vert.Joint0 = hasSkin ? glm::make_vec4(&joints[v * 4]) : glm::vec4(0.0f);
+            vert.Weight0 = hasSkin ? glm::make_vec4(&weights[v * 4]) : glm::vec4(0.0f);
             vertexBuffer.push_back(vert);
           }
         }
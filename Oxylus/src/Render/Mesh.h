@@ -6,7 +6,9 @@
 #include <vector>
 #include <glm/detail/type_quat.hpp>
 
-#include "Render/Vulkan/VulkanBuffer.h"
+#include "Render/Animation.h"
+#include "Render/GeometryBuffer.h"
+#include "Render/MeshletBuilder.h"
 #include "Assets/Material.h"
 
 #define TINYGLTF_NO_STB_IMAGE_WRITE 
@@ -42,6 +44,10 @@ namespace Oxylus {
       uint32_t indexCount;
       uint32_t firstVertex;
       uint32_t vertexCount;
+      uint32_t firstMeshlet = 0; // The meshlets of the primitive cover its index range
+      uint32_t meshletCount = 0;
+      uint32_t firstLod = 0;     // Coarser versions of the primitive in Lods, each simplified from the one before
+      uint32_t lodCount = 0;
 
       struct Dimensions {
         glm::vec3 min = glm::vec3(FLT_MAX);
@@ -58,6 +64,18 @@ namespace Oxylus {
       Primitive(uint32_t firstIndex, uint32_t indexCount) : firstIndex(firstIndex), indexCount(indexCount) { }
     };
 
+    /// Simplified version of a primitive. Its indices follow the ones of all primitives in the index buffer.
+    struct Lod {
+      uint32_t FirstIndex = 0;
+      uint32_t IndexCount = 0;
+      uint32_t FirstMeshlet = 0;
+      uint32_t MeshletCount = 0;
+      float Error = 0.0f; // How far the surface moved from the full detail primitive, in mesh units
+    };
+
+    /// Levels per primitive, including the full detail one.
+    static constexpr uint32_t MaxLods = 6;
+
     struct Node {
       Node* Parent;
       uint32_t Index;
@@ -85,11 +103,32 @@ namespace Oxylus {
       glm::vec4 Weight0;
     };
 
+    /// The vertex as it is stored on the GPU. Normal and tangent are octahedral encoded 16 bit snorm pairs with the
+    /// bitangent sign folded into the tangent, UVs are half floats. Shaders decode them with VertexPacking.glsl.
+    struct PackedVertex {
+      glm::vec3 Pos;
+      uint32_t Normal;
+      uint32_t Tangent;
+      uint32_t UV;
+    };
+
+    /// Joints and weights of a vertex as the skinning pass reads them. Joints are 16 bit indices into the joints of
+    /// the skin, weights are 8 bit unorms that add up to one. Vertices of meshes without skins have none.
+    struct SkinVertex {
+      uint32_t Joints[2];
+      uint32_t Weights;
+    };
+
     std::vector<Ref<VulkanImage>> m_Textures;
     std::vector<Node*> Nodes;
     std::vector<Node*> LinearNodes;
-    VulkanBuffer VerticiesBuffer;
-    VulkanBuffer IndiciesBuffer;
+    /// Meshlets of all primitives and LODs, their index ranges are relative to the mesh like the ones of the primitives.
+    std::vector<Meshlet> Meshlets;
+    std::vector<Lod> Lods;
+    /// Vertices of nodes with a skin stay in bind space, the skinning pass moves them into mesh space.
+    std::vector<Skeleton> Skins;
+    std::vector<AnimationClip> Animations;
+    GeometryBuffer::Handle Geometry = GeometryBuffer::InvalidHandle;
     uint32_t IndexCount = 0;
     std::string Name;
     std::string Path;
@@ -100,17 +139,32 @@ namespace Oxylus {
     Mesh(std::string_view path, int fileLoadingFlags = None, float scale = 1);
     ~Mesh();
 
+    /// Extension of meshes written by Cook.
+    static constexpr auto CookedExtension = ".oxmesh";
+
+    /// Loads a glTF file, or a cooked mesh if the path has the cooked extension. Cooked meshes already have the
+    /// loading flags and scale they were cooked with applied, so both are ignored for them.
     void LoadFromFile(const std::string& path, int fileLoadingFlags = None, float scale = 1);
 
     /// Export a mesh file as glb file.
     static bool ExportAsBinary(const std::string& inPath, const std::string& outPath);
 
+    /// Converts a glTF file into the cooked format: vertices transformed by their nodes and packed, indices,
+    /// the node and primitive tables, skins with their resampled animations and the materials. Images are written next to the output file.
+    /// Loading the result maps the file and uploads the geometry from it without parsing anything.
+    static bool Cook(const std::string& inPath, const std::string& outPath, int fileLoadingFlags = None, float scale = 1);
+
     void SetScale(const glm::vec3& scale);
     void Draw(const vk::CommandBuffer& cmdBuffer) const;
     void UpdateMaterials() const;
     size_t GetNodeCount() const { return Nodes.size(); }
     const Ref<Material> GetMaterial(uint32_t index) const;
+    /// Coarsest level of the primitive whose error covers at most `threshold` pixels once it is scaled by
+    /// `pixelsPerUnit`. Level 0 is the primitive itself.
+    Lod SelectLod(const Primitive& primitive, float pixelsPerUnit, float threshold) const;
     std::vector<Ref<Material>> GetMaterialsAsRef() const;
+    /// Where the vertices and indices of the mesh are inside the shared geometry buffer.
+    const GeometryBuffer::Range& GetGeometry() const { return GeometryBuffer::Get()->GetRange(Geometry); }
     void Destroy();
 
     operator bool() const {
@@ -118,6 +172,9 @@ namespace Oxylus {
     }
 
   private:
+    struct MaterialInfo;
+    struct ImageSource;
+
     std::vector<Ref<Material>> m_Materials;
     std::vector<uint32_t> m_IndexBuffer;
     std::vector<Vertex> m_VertexBuffer;
@@ -125,8 +182,21 @@ namespace Oxylus {
     glm::vec3 m_Scale{1.0f};
     glm::vec3 center{0.0f};
     glm::vec2 uvscale{1.0f};
-    void LoadTextures(const tinygltf::Model& model);
-    void LoadMaterials(tinygltf::Model& model);
+    bool LoadGltf(const std::string& path, int fileLoadingFlags, float scale);
+    bool LoadCooked(const std::string& path);
+    void LoadGeometry(tinygltf::Model& model,
+                      int fileLoadingFlags,
+                      float scale,
+                      std::vector<PackedVertex>& packedVertices,
+                      std::vector<SkinVertex>& skinVertices);
+    void LoadSkins(const tinygltf::Model& model, float scale, bool flipY);
+    void LoadAnimations(const tinygltf::Model& model);
+    void ComputeSkinBounds();
+    void BuildLods();
+    void BuildMeshlets();
+    void LoadTextures(const std::vector<ImageSource>& sources);
+    static std::vector<MaterialInfo> ReadMaterials(tinygltf::Model& model);
+    void CreateMaterials(const std::vector<MaterialInfo>& materials);
     void LoadNode(Node* parent,
                   const tinygltf::Node& node,
                   uint32_t nodeIndex,
@@ -152,33 +222,36 @@ namespace Oxylus {
       return static_cast<uint32_t>(-1);
     }
 
+    /// Formats and offsets of the components inside Mesh::PackedVertex. Color isn't uploaded since no shader reads
+    /// it, skinning attributes are in Mesh::SkinVertex.
     static vk::Format ComponentFormat(const VertexComponent component) {
       switch (component) {
-        case VertexComponent::UV: return vk::Format::eR32G32Sfloat;
-        case VertexComponent::POSITION2D: return vk::Format::eR32G32Sfloat;
-        default: return vk::Format::eR32G32B32Sfloat;
+        case VertexComponent::POSITION: return vk::Format::eR32G32B32Sfloat;
+        case VertexComponent::NORMAL:
+        case VertexComponent::TANGENT: return vk::Format::eR16G16Snorm;
+        case VertexComponent::UV: return vk::Format::eR16G16Sfloat;
+        default:
+          OX_CORE_ASSERT(false, "Component isn't part of the packed vertex");
+          return vk::Format::eUndefined;
       }
     }
 
-    static uint32_t ComponentSize(VertexComponent component) {
+    static uint32_t ComponentOffset(const VertexComponent component) {
       switch (component) {
-        case VertexComponent::UV: return 2 * sizeof(float);
-        case VertexComponent::POSITION2D: return 2 * sizeof(float);
-        default: return 3 * sizeof(float);
+        case VertexComponent::NORMAL: return offsetof(Mesh::PackedVertex, Normal);
+        case VertexComponent::TANGENT: return offsetof(Mesh::PackedVertex, Tangent);
+        case VertexComponent::UV: return offsetof(Mesh::PackedVertex, UV);
+        default: return offsetof(Mesh::PackedVertex, Pos);
       }
     }
 
     uint32_t stride() const {
-      return sizeof(Mesh::Vertex);
+      return sizeof(Mesh::PackedVertex);
     }
 
     uint32_t offset(uint32_t index) const {
-      uint32_t res = 0;
       assert(index < components.size());
-      for (uint32_t i = 0; i < index; ++i) {
-        res += ComponentSize(components[i]);
-      }
-      return res;
+      return ComponentOffset(components[index]);
     }
   };
 }
@@ -0,0 +1,216 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+#include <glm/glm.hpp>
+
+#include "Utils/Profiler.h"
+
+namespace Oxylus {
+  // Sum of squared distances to the planes of the triangles around a vertex, weighted by their area
+  struct Quadric {
+    double A00 = 0, A01 = 0, A02 = 0, A11 = 0, A12 = 0, A22 = 0;
+    double B0 = 0, B1 = 0, B2 = 0;
+    double C = 0;
+    double Weight = 0;
+
+    void AddPlane(const glm::dvec3& normal, const double distance, const double weight) {
+      A00 += weight * normal.x * normal.x;
+      A01 += weight * normal.x * normal.y;
+      A02 += weight * normal.x * normal.z;
+      A11 += weight * normal.y * normal.y;
+      A12 += weight * normal.y * normal.z;
+      A22 += weight * normal.z * normal.z;
+      B0 += weight * normal.x * distance;
+      B1 += weight * normal.y * distance;
+      B2 += weight * normal.z * distance;
+      C += weight * distance * distance;
+      Weight += weight;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+      A00 += other.A00, A01 += other.A01, A02 += other.A02, A11 += other.A11, A12 += other.A12, A22 += other.A22;
+      B0 += other.B0, B1 += other.B1, B2 += other.B2;
+      C += other.C;
+      Weight += other.Weight;
+      return *this;
+    }
+
+    // Mean squared distance of the point to the planes
+    double Evaluate(const Vec3& point) const {
+      if (Weight <= 0.0)
+        return 0.0;
+      const double x = point.x, y = point.y, z = point.z;
+      const double error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) +
+                           2.0 * (B0 * x + B1 * y + B2 * z) + C;
+      return std::max(error / Weight, 0.0);
+    }
+  };
+
+  struct Collapse {
+    uint32_t From = 0;
+    uint32_t To = 0;
+    double Cost = 0.0;
+
+    bool operator<(const Collapse& other) const {
+      if (Cost != other.Cost)
+        return Cost < other.Cost;
+      if (From != other.From)
+        return From < other.From;
+      return To < other.To;
+    }
+  };
+
+  float MeshSimplifier::Simplify(const Vec3* positions,
+                                 const size_t stride,
+                                 const uint32_t* indices,
+                                 const uint32_t indexCount,
+                                 const uint32_t targetIndexCount,
+                                 const float maxError,
+                                 std::vector<uint32_t>& result) {
+    OX_SCOPED_ZONE;
+    result.assign(indices, indices + indexCount / 3 * 3);
+    if (result.size() <= targetIndexCount)
+      return 0.0f;
+
+    const auto position = [positions, stride](const uint32_t vertex) -> const Vec3& {
+      return *reinterpret_cast<const Vec3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+    };
+
+    // Vertices are stored relative to the lowest one so per vertex data fits into flat arrays
+    const uint32_t minVertex = *std::min_element(result.begin(), result.end());
+    const uint32_t vertexCount = *std::max_element(result.begin(), result.end()) - minVertex + 1;
+    for (auto& index : result)
+      index -= minVertex;
+    const auto local = [&position, minVertex](const uint32_t vertex) -> const Vec3& { return position(vertex + minVertex); };
+
+    std::vector<Quadric> quadrics(vertexCount);
+    std::unordered_set<uint64_t> edges;
+    edges.reserve(result.size());
+    for (size_t i = 0; i < result.size(); i += 3) {
+      const glm::dvec3 a = local(result[i]);
+      const glm::dvec3 normal = glm::cross(glm::dvec3(local(result[i + 1])) - a, glm::dvec3(local(result[i + 2])) - a);
+      const double length = glm::length(normal);
+      for (uint32_t k = 0; k < 3; k++)
+        edges.emplace((uint64_t)result[i + k] << 32 | result[i + (k + 1) % 3]);
+      if (length <= 0.0)
+        continue;
+      const glm::dvec3 unitNormal = normal / length;
+      for (uint32_t k = 0; k < 3; k++)
+        quadrics[result[i + k]].AddPlane(unitNormal, -glm::dot(unitNormal, a), length * 0.5);
+    }
+
+    // Edges without a twin are open, their vertices are locked
+    std::vector<uint8_t> locked(vertexCount, 0);
+    for (const uint64_t edge : edges) {
+      const uint32_t from = (uint32_t)(edge >> 32);
+      const uint32_t to = (uint32_t)edge;
+      if (!edges.contains((uint64_t)to << 32 | from))
+        locked[from] = locked[to] = 1;
+    }
+
+    const double maxCost = (double)maxError * (double)maxError;
+    double error = 0.0;
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<Collapse> collapses;
+    while (result.size() > targetIndexCount) {
+      const auto triangleCount = (uint32_t)(result.size() / 3);
+
+      // Triangles around every vertex
+      std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+      for (const uint32_t index : result)
+        adjacencyOffsets[index + 1]++;
+      for (uint32_t v = 0; v < vertexCount; v++)
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+      adjacency.resize(result.size());
+      std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+      for (uint32_t i = 0; i < (uint32_t)result.size(); i++)
+        adjacency[fill[result[i]]++] = i / 3;
+
+      // Every edge can collapse either way, the cost is the error of the merged quadrics at the kept vertex
+      collapses.clear();
+      for (uint32_t i = 0; i < (uint32_t)result.size(); i++) {
+        const uint32_t from = result[i];
+        const uint32_t to = result[i - i % 3 + (i + 1) % 3];
+        for (const auto [a, b] : {std::pair{from, to}, std::pair{to, from}}) {
+          if (locked[a] || a == b)
+            continue;
+          Quadric quadric = quadrics[a];
+          quadric += quadrics[b];
+          collapses.push_back({a, b, quadric.Evaluate(local(b))});
+        }
+      }
+      std::sort(collapses.begin(), collapses.end());
+
+      // Collapses of a pass don't share triangles, so each one is checked against the final shape of its neighbourhood
+      for (uint32_t v = 0; v < vertexCount; v++)
+        remap[v] = v;
+      std::fill(touched.begin(), touched.end(), 0);
+      uint32_t remainingTriangles = triangleCount;
+      bool collapsed = false;
+      for (const auto& collapse : collapses) {
+        if (collapse.Cost > maxCost || remainingTriangles * 3 <= targetIndexCount)
+          break;
+        if (touched[collapse.From] || touched[collapse.To])
+          continue;
+
+        // Triangles around the removed vertex must not flip
+        bool flips = false;
+        uint32_t removedTriangles = 0;
+        for (uint32_t a = adjacencyOffsets[collapse.From]; a < adjacencyOffsets[collapse.From + 1] && !flips; a++) {
+          const uint32_t* triangle = &result[adjacency[a] * 3];
+          if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To) {
+            removedTriangles++;
+            continue;
+          }
+          Vec3 corners[3];
+          for (uint32_t k = 0; k < 3; k++)
+            corners[k] = local(triangle[k]);
+          const Vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+          for (uint32_t k = 0; k < 3; k++) {
+            if (triangle[k] == collapse.From)
+              corners[k] = local(collapse.To);
+          }
+          const Vec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+          flips = glm::dot(before, after) <= 0.0f;
+        }
+        if (flips)
+          continue;
+
+        remap[collapse.From] = collapse.To;
+        quadrics[collapse.To] += quadrics[collapse.From];
+        for (uint32_t a = adjacencyOffsets[collapse.From]; a < adjacencyOffsets[collapse.From + 1]; a++) {
+          for (uint32_t k = 0; k < 3; k++)
+            touched[result[adjacency[a] * 3 + k]] = 1;
+        }
+        remainingTriangles -= removedTriangles;
+        error = std::max(error, collapse.Cost);
+        collapsed = true;
+      }
+      if (!collapsed)
+        break;
+
+      // Drops the triangles that lost an edge
+      size_t write = 0;
+      for (size_t i = 0; i < result.size(); i += 3) {
+        const uint32_t a = remap[result[i]];
+        const uint32_t b = remap[result[i + 1]];
+        const uint32_t c = remap[result[i + 2]];
+        if (a == b || b == c || a == c)
+          continue;
+        result[write++] = a;
+        result[write++] = b;
+        result[write++] = c;
+      }
+      result.resize(write);
+    }
+
+    for (auto& index : result)
+      index += minVertex;
+    return (float)std::sqrt(error);
+  }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.h"
+
+namespace Oxylus {
+  /// Quadric error edge collapse simplification of triangle lists.
+  class MeshSimplifier {
+  public:
+    /// Collapses edges until at most `targetIndexCount` indices are left, or until every remaining collapse would move
+    /// the surface further than `maxError`. Vertices are only merged into their neighbours, so the result indexes the
+    /// same vertices. Vertices on open edges stay where they are, which keeps primitives and attribute seams closed.
+    /// Positions are read `stride` bytes apart. Returns how far the surface moved, in the units of the positions.
+    static float Simplify(const Vec3* positions,
+                          size_t stride,
+                          const uint32_t* indices,
+                          uint32_t indexCount,
+                          uint32_t targetIndexCount,
+                          float maxError,
+                          std::vector<uint32_t>& result);
+  };
+}
@@ -0,0 +1,189 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include "Utils/Profiler.h"
+
+namespace Oxylus {
+  // Normal cones wider than this never cull anything, such meshlets skip the test altogether
+  static constexpr float MinConeDot = 0.1f;
+  // Candidates checked for the next triangle, the most recently added neighbours are the closest ones
+  static constexpr uint32_t CandidateWindow = 32;
+
+  static void ComputeBounds(Meshlet& meshlet, const Vec3* positions, const size_t stride, const uint32_t* indices) {
+    const auto position = [positions, stride](const uint32_t vertex) -> const Vec3& {
+      return *reinterpret_cast<const Vec3*>(reinterpret_cast<const uint8_t*>(positions) + vertex * stride);
+    };
+
+    meshlet.BoundsMin = Vec3(FLT_MAX);
+    meshlet.BoundsMax = Vec3(-FLT_MAX);
+    for (uint32_t i = 0; i < meshlet.IndexCount; i++) {
+      meshlet.BoundsMin = glm::min(meshlet.BoundsMin, position(indices[i]));
+      meshlet.BoundsMax = glm::max(meshlet.BoundsMax, position(indices[i]));
+    }
+    meshlet.Center = (meshlet.BoundsMin + meshlet.BoundsMax) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t i = 0; i < meshlet.IndexCount; i++)
+      radius = std::max(radius, glm::distance(meshlet.Center, position(indices[i])));
+    meshlet.Radius = radius;
+
+    // Every triangle weighs the same regardless of its area
+    std::vector<Vec3> normals;
+    normals.reserve(meshlet.IndexCount / 3);
+    Vec3 axis = Vec3(0.0f);
+    for (uint32_t i = 0; i + 2 < meshlet.IndexCount; i += 3) {
+      const Vec3& a = position(indices[i]);
+      const Vec3 normal = glm::cross(position(indices[i + 1]) - a, position(indices[i + 2]) - a);
+      const float length = glm::length(normal);
+      if (!(length > 0.0f))
+        continue;
+      normals.emplace_back(normal / length);
+      axis += normals.back();
+    }
+
+    meshlet.ConeAxis = Vec3(0.0f);
+    meshlet.ConeCutoff = 1.0f;
+    const float axisLength = glm::length(axis);
+    if (!(axisLength > 0.0f))
+      return;
+    axis /= axisLength;
+
+    float minDot = 1.0f;
+    for (const Vec3& normal : normals)
+      minDot = std::min(minDot, glm::dot(axis, normal));
+    meshlet.ConeAxis = axis;
+    if (minDot > MinConeDot)
+      meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+  }
+
+  void MeshletBuilder::Build(const Vec3* positions,
+                             const size_t stride,
+                             uint32_t* indices,
+                             const uint32_t firstIndex,
+                             const uint32_t indexCount,
+                             std::vector<Meshlet>& meshlets) {
+    OX_SCOPED_ZONE;
+    const uint32_t triangleCount = indexCount / 3;
+    if (!triangleCount)
+      return;
+    uint32_t* triangles = indices + firstIndex;
+
+    // Vertices are stored relative to the lowest one so per vertex data fits into flat arrays
+    uint32_t minVertex = UINT32_MAX;
+    uint32_t maxVertex = 0;
+    for (uint32_t i = 0; i < triangleCount * 3; i++) {
+      minVertex = std::min(minVertex, triangles[i]);
+      maxVertex = std::max(maxVertex, triangles[i]);
+    }
+    const uint32_t vertexCount = maxVertex - minVertex + 1;
+
+    // Triangles using each vertex
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32_t i = 0; i < triangleCount * 3; i++)
+      adjacencyOffsets[triangles[i] - minVertex + 1]++;
+    for (uint32_t v = 0; v < vertexCount; v++)
+      adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (uint32_t i = 0; i < triangleCount * 3; i++)
+      adjacency[fill[triangles[i] - minVertex]++] = i / 3;
+
+    std::vector<uint8_t> used(triangleCount, 0);
+    std::vector<uint8_t> inMeshlet(vertexCount, 0);
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint32_t> meshletTriangles;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> reordered;
+    meshletVertices.reserve(MaxVertices);
+    meshletTriangles.reserve(MaxTriangles);
+    reordered.reserve((size_t)triangleCount * 3);
+
+    const auto newVertices = [&](const uint32_t triangle) {
+      uint32_t count = 0;
+      for (uint32_t k = 0; k < 3; k++)
+        count += inMeshlet[triangles[triangle * 3 + k] - minVertex] ? 0 : 1;
+      return count;
+    };
+
+    const auto finishMeshlet = [&] {
+      Meshlet& meshlet = meshlets.emplace_back();
+      meshlet.FirstIndex = firstIndex + (uint32_t)reordered.size();
+      meshlet.IndexCount = (uint32_t)meshletTriangles.size() * 3;
+      for (const uint32_t triangle : meshletTriangles)
+        reordered.insert(reordered.end(), triangles + triangle * 3, triangles + triangle * 3 + 3);
+      ComputeBounds(meshlet, positions, stride, reordered.data() + reordered.size() - meshlet.IndexCount);
+
+      for (const uint32_t vertex : meshletVertices)
+        inMeshlet[vertex - minVertex] = 0;
+      meshletVertices.clear();
+      meshletTriangles.clear();
+      candidates.clear();
+    };
+
+    uint32_t nextUnused = 0;
+    while (true) {
+      // Grows the meshlet with the neighbour adding the fewest vertices, ties go to the most recent neighbour
+      uint32_t best = UINT32_MAX;
+      uint32_t bestCost = 4;
+      uint32_t checked = 0;
+      for (size_t i = candidates.size(); i-- > 0 && checked < CandidateWindow;) {
+        if (used[candidates[i]])
+          continue;
+        checked++;
+        const uint32_t cost = newVertices(candidates[i]);
+        if (cost < bestCost) {
+          best = candidates[i];
+          bestCost = cost;
+          if (cost == 0)
+            break;
+        }
+      }
+      if (candidates.size() > MaxVertices * 16)
+        std::erase_if(candidates, [&used](const uint32_t triangle) { return used[triangle] != 0; });
+
+      // Without neighbours left the meshlet continues with the next triangle in index order, which is usually close
+      if (best == UINT32_MAX) {
+        while (nextUnused < triangleCount && used[nextUnused])
+          nextUnused++;
+        if (nextUnused == triangleCount)
+          break;
+        best = nextUnused;
+        bestCost = newVertices(best);
+      }
+
+      if (meshletVertices.size() + bestCost > MaxVertices || meshletTriangles.size() == MaxTriangles) {
+        finishMeshlet();
+        bestCost = 3;
+      }
+
+      used[best] = 1;
+      meshletTriangles.emplace_back(best);
+      for (uint32_t k = 0; k < 3; k++) {
+        const uint32_t vertex = triangles[best * 3 + k];
+        if (inMeshlet[vertex - minVertex])
+          continue;
+        inMeshlet[vertex - minVertex] = 1;
+        meshletVertices.emplace_back(vertex);
+        for (uint32_t a = adjacencyOffsets[vertex - minVertex]; a < adjacencyOffsets[vertex - minVertex + 1]; a++) {
+          if (!used[adjacency[a]])
+            candidates.emplace_back(adjacency[a]);
+        }
+      }
+    }
+    if (!meshletTriangles.empty())
+      finishMeshlet();
+
+    // A trailing incomplete triangle stays where it is
+    std::copy(reordered.begin(), reordered.end(), triangles);
+  }
+
+  bool MeshletBuilder::IsBackfacing(const Meshlet& meshlet, const Vec3& viewPosition) {
+    if (meshlet.ConeCutoff >= 1.0f)
+      return false;
+    const Vec3 toCenter = meshlet.Center - viewPosition;
+    return glm::dot(toCenter, meshlet.ConeAxis) >= meshlet.ConeCutoff * glm::length(toCenter) + meshlet.Radius;
+  }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.h"
+
+namespace Oxylus {
+  /// Cluster of neighbouring triangles that is culled as a whole. Its triangles are a contiguous range of the index buffer.
+  struct Meshlet {
+    Vec3 BoundsMin = {};
+    Vec3 BoundsMax = {};
+    Vec3 Center = {}; // Bounding sphere
+    float Radius = 0.0f;
+    Vec3 ConeAxis = {};      // Average direction of the triangle normals
+    float ConeCutoff = 1.0f; // Sine of the normal cone's half angle, 1 when the normals spread too far to cull by them
+    uint32_t FirstIndex = 0;
+    uint32_t IndexCount = 0;
+  };
+
+  /// Splits triangle lists into meshlets. The result only depends on the input, so cooked and loaded meshes agree.
+  class MeshletBuilder {
+  public:
+    static constexpr uint32_t MaxVertices = 64;
+    static constexpr uint32_t MaxTriangles = 124;
+
+    /// Builds the meshlets of the `indexCount` indices starting at `firstIndex` and reorders those indices in place so
+    /// the triangles of every meshlet follow each other. Positions are read `stride` bytes apart.
+    static void Build(const Vec3* positions,
+                      size_t stride,
+                      uint32_t* indices,
+                      uint32_t firstIndex,
+                      uint32_t indexCount,
+                      std::vector<Meshlet>& meshlets);
+
+    /// True if every triangle of the meshlet faces away from the position, which has to be in the meshlet's space.
+    static bool IsBackfacing(const Meshlet& meshlet, const Vec3& viewPosition);
+  };
+}
@@ -368,11 +368,9 @@ namespace Oxylus {
             pipeline.BindPipeline(cmdBuf.Get());
             pipeline.BindDescriptorSets(cmdBuf.Get(), {descriptorset});
 
-            std::vector<vk::DeviceSize> offsets{0};
-
-            cmdBuf.Get().bindVertexBuffers(0, skybox.VerticiesBuffer.Get(), offsets);
-            cmdBuf.Get().bindIndexBuffer(skybox.IndiciesBuffer.Get(), 0, vk::IndexType::eUint32);
-            cmdBuf.Get().drawIndexed(skybox.IndexCount, 1, 0, 0, 0);
+            const auto& geometry = skybox.GetGeometry();
+            GeometryBuffer::Get()->Bind(cmdBuf.Get());
+            cmdBuf.Get().drawIndexed(skybox.IndexCount, 1, geometry.IndexOffset, (int32_t)geometry.VertexOffset, 0);
 
             cmdBuf.EndRenderPass();
 
@@ -638,10 +636,9 @@ namespace Oxylus {
             cmdBuf.Get().bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.Get());
             cmdBuf.Get().bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelinelayout, 0, descriptorset, nullptr);
 
-            std::vector<vk::DeviceSize> offsets{0};
-            cmdBuf.Get().bindVertexBuffers(0, skybox.VerticiesBuffer.Get(), offsets);
-            cmdBuf.Get().bindIndexBuffer(skybox.IndiciesBuffer.Get(), 0, vk::IndexType::eUint32);
-            cmdBuf.Get().drawIndexed(skybox.IndexCount, 1, 0, 0, 0);
+            const auto& geometry = skybox.GetGeometry();
+            GeometryBuffer::Get()->Bind(cmdBuf.Get());
+            cmdBuf.Get().drawIndexed(skybox.IndexCount, 1, geometry.IndexOffset, (int32_t)geometry.VertexOffset, 0);
 
             cmdBuf.Get().endRenderPass();
 
@@ -0,0 +1,78 @@
+#include "RangeAllocator.h"
+
+#include <algorithm>
+
+#include "Utils/Log.h"
+
+namespace Oxylus {
+  uint32_t RangeAllocator::Allocate(const uint32_t size) {
+    if (size == 0)
+      return 0;
+
+    // Best fit keeps the large ranges around for large meshes
+    auto best = m_FreeRanges.end();
+    for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); ++it) {
+      if (it->second < size || (best != m_FreeRanges.end() && it->second >= best->second))
+        continue;
+      best = it;
+      if (it->second == size)
+        break;
+    }
+    if (best == m_FreeRanges.end())
+      return InvalidOffset;
+
+    const uint32_t offset = best->first;
+    const uint32_t remaining = best->second - size;
+    m_FreeRanges.erase(best);
+    if (remaining)
+      m_FreeRanges.emplace(offset + size, remaining);
+    m_FreeSize -= size;
+    return offset;
+  }
+
+  void RangeAllocator::Free(uint32_t offset, uint32_t size) {
+    if (size == 0)
+      return;
+    OX_CORE_ASSERT(offset + size <= m_Capacity);
+    m_FreeSize += size;
+
+    auto next = m_FreeRanges.lower_bound(offset);
+    OX_CORE_ASSERT(next == m_FreeRanges.end() || offset + size <= next->first);
+    if (next != m_FreeRanges.end() && next->first == offset + size) {
+      size += next->second;
+      next = m_FreeRanges.erase(next);
+    }
+    if (next != m_FreeRanges.begin()) {
+      const auto previous = std::prev(next);
+      OX_CORE_ASSERT(previous->first + previous->second <= offset);
+      if (previous->first + previous->second == offset) {
+        previous->second += size;
+        return;
+      }
+    }
+    m_FreeRanges.emplace_hint(next, offset, size);
+  }
+
+  void RangeAllocator::Grow(const uint32_t capacity) {
+    if (capacity <= m_Capacity)
+      return;
+    const uint32_t oldCapacity = m_Capacity;
+    m_Capacity = capacity;
+    Free(oldCapacity, capacity - oldCapacity);
+  }
+
+  void RangeAllocator::Reset(const uint32_t capacity) {
+    m_FreeRanges.clear();
+    m_Capacity = capacity;
+    m_FreeSize = capacity;
+    if (capacity)
+      m_FreeRanges.emplace(0, capacity);
+  }
+
+  uint32_t RangeAllocator::GetLargestFreeRange() const {
+    uint32_t largest = 0;
+    for (const auto& [offset, size] : m_FreeRanges)
+      largest = std::max(largest, size);
+    return largest;
+  }
+}
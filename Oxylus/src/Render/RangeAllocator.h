@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace Oxylus {
+  /// Hands out ranges of a linear address space, like elements of a large buffer. Free ranges are kept
+  /// sorted by offset so neighbours merge back together when a range is freed.
+  /// Only does bookkeeping, the memory itself is owned by whoever uses the offsets.
+  class RangeAllocator {
+  public:
+    static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+    RangeAllocator() = default;
+    explicit RangeAllocator(uint32_t capacity) { Reset(capacity); }
+
+    /// Returns the offset of the smallest free range the size fits in, or InvalidOffset if there is none.
+    uint32_t Allocate(uint32_t size);
+    void Free(uint32_t offset, uint32_t size);
+
+    /// Extends the address space, existing allocations keep their offsets.
+    void Grow(uint32_t capacity);
+    /// Drops every allocation.
+    void Reset(uint32_t capacity);
+
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetFreeSize() const { return m_FreeSize; }
+    uint32_t GetLargestFreeRange() const;
+    uint32_t GetFreeRangeCount() const { return (uint32_t)m_FreeRanges.size(); }
+
+  private:
+    std::map<uint32_t, uint32_t> m_FreeRanges; // Offset to size
+    uint32_t m_Capacity = 0;
+    uint32_t m_FreeSize = 0;
+  };
+}
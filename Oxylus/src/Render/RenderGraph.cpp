@@ -1,37 +1,114 @@
 #include "RenderGraph.h"
+#include "ResourcePool.h"
 #include "Utils/Log.h"
 #include "Vulkan/VulkanContext.h"
 #include "Vulkan/VulkanRenderer.h"
 #include "Utils/Profiler.h"
 
 #include "Vulkan/Utils/VulkanUtils.h"
+#include "Vulkan/CommandPoolManager.h"
+#include "Vulkan/UploadManager.h"
+
+#include <unordered_set>
 
 namespace Oxylus {
-  const RenderGraphPass* RenderGraph::FindRenderGraphPass(const std::string& name) const {
-    const RenderGraphPass* renderGraphPass = nullptr;
+  static void GetUsageFlags(const bool isComputePass,
+                            const RenderGraphResourceUsage& usage,
+                            vk::PipelineStageFlags& stages,
+                            vk::AccessFlags& access) {
+    const bool isBuffer = usage.Type == RenderGraphResourceType::Buffer;
+    if (isComputePass) {
+      stages = vk::PipelineStageFlagBits::eComputeShader;
+      access = usage.IsWrite ? vk::AccessFlagBits::eShaderWrite : vk::AccessFlagBits::eShaderRead;
+      if (isBuffer && !usage.IsWrite)
+        access |= vk::AccessFlagBits::eUniformRead;
+      return;
+    }
 
-    for (auto& [fst, snd] : m_RenderGraphPasses) {
-      if (fst == name) {
-        renderGraphPass = &snd;
-      }
+    // Images written by graphics passes are always their attachments.
+    if (usage.IsWrite && !isBuffer) {
+      stages = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests |
+               vk::PipelineStageFlagBits::eLateFragmentTests;
+      access = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite |
+               vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+      return;
     }
 
-    return renderGraphPass;
+    stages = vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+    access = usage.IsWrite ? vk::AccessFlagBits::eShaderWrite : vk::AccessFlagBits::eShaderRead;
+    // Buffers read by graphics passes may also be indirect draw arguments.
+    if (isBuffer && !usage.IsWrite) {
+      stages |= vk::PipelineStageFlagBits::eDrawIndirect;
+      access |= vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eIndirectCommandRead;
+    }
+  }
+
+  const RenderGraphPass* RenderGraph::FindRenderGraphPass(const std::string& name) const {
+    for (const auto& pass : m_RenderGraphPasses) {
+      if (pass.Name == name)
+        return &pass;
+    }
+
+    return nullptr;
   }
 
   RenderGraphPass& RenderGraphPass::AddInnerPass(const RenderGraphPass& innerPass) {
     m_InnerPasses.emplace_back(innerPass);
+    m_ResourceUsages.insert(m_ResourceUsages.end(), innerPass.m_ResourceUsages.begin(), innerPass.m_ResourceUsages.end());
     return *this;
   }
 
   RenderGraphPass& RenderGraphPass::AddReadDependency(const RenderGraph& renderGraph, const std::string& passName) {
-    const auto& pass = renderGraph.FindRenderGraphPass(passName);
-    if (!pass) {
+    if (!renderGraph.FindRenderGraphPass(passName)) {
       OX_CORE_BERROR("Can't find {0} named render pass to add as dependency!", passName);
       return *this;
     }
-    m_WaitSemaphores.emplace_back(pass->m_SignalSemaphore);
-    pass->m_HasDependency = true;
+    m_Dependencies.emplace_back(passName);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::Read(const VulkanImage& image) {
+    AddResourceUsage(&image, RenderGraphResourceType::Image, false);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::Read(const VulkanFramebuffer& framebuffer) {
+    AddResourceUsage(&framebuffer, RenderGraphResourceType::Framebuffer, false);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::Read(const VulkanBuffer& buffer) {
+    AddResourceUsage(&buffer, RenderGraphResourceType::Buffer, false);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::ReadHistory(const VulkanImage& image) {
+    AddResourceUsage(&image, RenderGraphResourceType::Image, false, true);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::ReadHistory(const VulkanFramebuffer& framebuffer) {
+    AddResourceUsage(&framebuffer, RenderGraphResourceType::Framebuffer, false, true);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::Write(const VulkanImage& image) {
+    AddResourceUsage(&image, RenderGraphResourceType::Image, true);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::Write(const VulkanFramebuffer& framebuffer) {
+    AddResourceUsage(&framebuffer, RenderGraphResourceType::Framebuffer, true);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::Write(const VulkanBuffer& buffer) {
+    AddResourceUsage(&buffer, RenderGraphResourceType::Buffer, true);
+    return *this;
+  }
+
+  RenderGraphPass& RenderGraphPass::SetHasSideEffects(const bool sideEffects) {
+    m_HasSideEffects = sideEffects;
     return *this;
   }
 
@@ -66,12 +143,20 @@ namespace Oxylus {
   }
 
   void RenderGraphPass::Init() {
-    const auto& LogicalDevice = VulkanContext::Context.Device;
-    constexpr vk::FenceCreateInfo fenceCreateInfo{};
-    VulkanUtils::CheckResult(LogicalDevice.createFence(&fenceCreateInfo, nullptr, &m_Fence));
+    // Framebuffers are always written by the pass that renders into them.
+    for (const auto framebuffer : Framebuffers)
+      AddResourceUsage(framebuffer, RenderGraphResourceType::Framebuffer, true);
+  }
 
-    constexpr vk::SemaphoreCreateInfo semaphoreCreateInfo;
-    VulkanUtils::CheckResult(LogicalDevice.createSemaphore(&semaphoreCreateInfo, nullptr, &m_SignalSemaphore));
+  void RenderGraphPass::AddResourceUsage(const void* resource,
+                                         const RenderGraphResourceType type,
+                                         const bool isWrite,
+                                         const bool isHistory) {
+    for (const auto& usage : m_ResourceUsages) {
+      if (usage.Resource == resource && usage.IsWrite == isWrite && usage.IsHistory == isHistory)
+        return;
+    }
+    m_ResourceUsages.emplace_back(RenderGraphResourceUsage{resource, type, isWrite, isHistory});
   }
 
   RenderGraph& RenderGraph::AddRenderPass(RenderGraphPass& renderGraphPass) {
@@ -79,25 +164,431 @@ namespace Oxylus {
       OX_CORE_BERROR("There can't be two render passes with the same name!");
       return *this;
     }
-    m_RenderGraphPasses.emplace(renderGraphPass.Name, renderGraphPass);
+    m_RenderGraphPasses.emplace_back(renderGraphPass);
+    m_IsDirty = true;
     return *this;
   }
 
   RenderGraph& RenderGraph::AddComputePass(RenderGraphPass& computePass) {
     if (FindRenderGraphPass(computePass.Name)) {
       OX_CORE_BERROR("There can't be two compute passes with the same name!");
+      return *this;
     }
     computePass.m_IsComputePass = true;
-    m_RenderGraphPasses.emplace(computePass.Name, computePass);
+    m_RenderGraphPasses.emplace_back(computePass);
+    m_IsDirty = true;
     return *this;
   }
 
-  void RenderGraph::RemoveRenderPass(const std::string& Name) {
-    if (!FindRenderGraphPass(Name)) {
-      OX_CORE_BERROR("Can't find {0} named render pass to remove!", Name);
+  void RenderGraph::RemoveRenderPass(const std::string& name) {
+    const auto it = std::find_if(m_RenderGraphPasses.begin(),
+      m_RenderGraphPasses.end(),
+      [&name](const RenderGraphPass& pass) { return pass.Name == name; });
+    if (it == m_RenderGraphPasses.end()) {
+      OX_CORE_BERROR("Can't find {0} named render pass to remove!", name);
+      return;
+    }
+    m_RenderGraphPasses.erase(it);
+    m_IsDirty = true;
+  }
+
+  RenderGraph& RenderGraph::SetOutput(const VulkanImage& image) {
+    m_Output = &image;
+    m_IsDirty = true;
+    return *this;
+  }
+
+  RenderGraph& RenderGraph::SetOutput(const VulkanFramebuffer& framebuffer) {
+    m_Output = &framebuffer;
+    m_IsDirty = true;
+    return *this;
+  }
+
+  void RenderGraph::Compile(const uint32_t framesInFlight) {
+    OX_SCOPED_ZONE;
+    ProfilerTimer timer;
+
+    Schedule();
+    ImagePool::SetLifetimes(m_TransientImages);
+
+    const auto& LogicalDevice = VulkanContext::GetDevice();
+    m_CommandPool = CommandPoolManager::Get()->GetFreePool();
+    for (auto& batch : m_Batches) {
+      batch.CommandBuffers.resize(framesInFlight);
+      for (auto& commandBuffer : batch.CommandBuffers)
+        commandBuffer.CreateBuffer(m_CommandPool);
+      if (batch.SignalsSemaphore) {
+        batch.SignalSemaphores.resize(framesInFlight);
+        constexpr vk::SemaphoreCreateInfo semaphoreCreateInfo;
+        for (auto& semaphore : batch.SignalSemaphores)
+          VulkanUtils::CheckResult(LogicalDevice.createSemaphore(&semaphoreCreateInfo, nullptr, &semaphore));
+      }
+    }
+
+    m_FramesInFlight = framesInFlight;
+    m_IsDirty = false;
+
+    timer.Stop();
+    OX_CORE_TRACE("Compiled render graph: {} passes, {} culled, {} submits in {} ms",
+      m_RenderGraphPasses.size() - m_CulledPassCount,
+      m_CulledPassCount,
+      m_Batches.size(),
+      timer.ElapsedMilliSeconds());
+  }
+
+  void RenderGraph::Schedule() {
+    OX_SCOPED_ZONE;
+    ReleaseBatches();
+    m_Batches.clear();
+
+    const uint32_t passCount = (uint32_t)m_RenderGraphPasses.size();
+
+    // Build the dependency graph. Passes are connected in the order they were declared:
+    // a read depends on the last declared writer, a write depends on the last writer and on every reader since.
+    std::vector<std::vector<uint32_t>> edges(passCount);     // Pass -> passes that have to run after it
+    std::vector<std::vector<uint32_t>> producers(passCount); // Pass -> passes whose results it consumes
+    const auto addEdge = [&edges, &producers](const uint32_t from, const uint32_t to, const bool consumesResult) {
+      if (from == to)
+        return;
+      edges[from].emplace_back(to);
+      if (consumesResult)
+        producers[to].emplace_back(from);
+    };
+
+    std::unordered_map<const void*, uint32_t> lastWriters;
+    std::unordered_map<const void*, std::vector<uint32_t>> readers;
+    for (uint32_t i = 0; i < passCount; i++) {
+      const auto& pass = m_RenderGraphPasses[i];
+      for (const auto& dependency : pass.m_Dependencies) {
+        const auto* dependencyPass = FindRenderGraphPass(dependency);
+        if (!dependencyPass) {
+          OX_CORE_ERROR("Render pass {0} depends on {1} which isn't in the graph!", pass.Name, dependency);
+          continue;
+        }
+        addEdge((uint32_t)(dependencyPass - m_RenderGraphPasses.data()), i, true);
+      }
+
+      for (const auto& usage : pass.m_ResourceUsages) {
+        if (usage.IsWrite || usage.IsHistory)
+          continue;
+        if (const auto writer = lastWriters.find(usage.Resource); writer != lastWriters.end())
+          addEdge(writer->second, i, true);
+        readers[usage.Resource].emplace_back(i);
+      }
+
+      for (const auto& usage : pass.m_ResourceUsages) {
+        if (!usage.IsWrite)
+          continue;
+        if (const auto writer = lastWriters.find(usage.Resource); writer != lastWriters.end())
+          addEdge(writer->second, i, true);
+        auto& resourceReaders = readers[usage.Resource];
+        for (const auto reader : resourceReaders)
+          addEdge(reader, i, false);
+        resourceReaders.clear();
+        lastWriters[usage.Resource] = i;
+      }
+    }
+
+    // Cull the passes that don't contribute to the output.
+    std::vector<bool> alive(passCount, m_Output == nullptr);
+    if (m_Output) {
+      std::vector<uint32_t> stack;
+      for (uint32_t i = 0; i < passCount; i++) {
+        const auto& pass = m_RenderGraphPasses[i];
+        bool isRoot = pass.m_HasSideEffects || pass.m_ResourceUsages.empty();
+        for (const auto& usage : pass.m_ResourceUsages)
+          isRoot |= usage.IsWrite && usage.Resource == m_Output;
+        if (isRoot) {
+          alive[i] = true;
+          stack.emplace_back(i);
+        }
+      }
+      while (!stack.empty()) {
+        const uint32_t index = stack.back();
+        stack.pop_back();
+        for (const auto producer : producers[index]) {
+          if (!alive[producer]) {
+            alive[producer] = true;
+            stack.emplace_back(producer);
+          }
+        }
+      }
+    }
+
+    // Topological sort. Among the ready passes the ones on the same queue as the last scheduled pass
+    // are preferred so that the schedule splits into as few submits as possible.
+    std::vector<uint32_t> inDegrees(passCount, 0);
+    uint32_t aliveCount = 0;
+    for (uint32_t i = 0; i < passCount; i++) {
+      if (!alive[i])
+        continue;
+      aliveCount++;
+      for (const auto to : edges[i]) {
+        if (alive[to])
+          inDegrees[to]++;
+      }
+    }
+
+    std::vector<uint32_t> ready;
+    for (uint32_t i = 0; i < passCount; i++) {
+      if (alive[i] && inDegrees[i] == 0)
+        ready.emplace_back(i);
+    }
+
+    std::vector<uint32_t> schedule;
+    schedule.reserve(aliveCount);
+    const vk::Queue* lastQueue = nullptr;
+    while (!ready.empty()) {
+      auto next = ready.begin();
+      for (auto it = ready.begin(); it != ready.end(); ++it) {
+        const bool sameQueue = m_RenderGraphPasses[*it].SubmitQueue == lastQueue;
+        const bool nextSameQueue = m_RenderGraphPasses[*next].SubmitQueue == lastQueue;
+        if ((sameQueue && !nextSameQueue) || (sameQueue == nextSameQueue && *it < *next))
+          next = it;
+      }
+      const uint32_t index = *next;
+      ready.erase(next);
+      schedule.emplace_back(index);
+      lastQueue = m_RenderGraphPasses[index].SubmitQueue;
+      for (const auto to : edges[index]) {
+        if (alive[to] && --inDegrees[to] == 0)
+          ready.emplace_back(to);
+      }
+    }
+
+    if (schedule.size() != aliveCount) {
+      OX_CORE_ERROR("Render graph has a dependency cycle! Falling back to declaration order.");
+      schedule.clear();
+      for (uint32_t i = 0; i < passCount; i++) {
+        if (alive[i])
+          schedule.emplace_back(i);
+      }
+    }
+
+    // Group consecutive passes on the same queue into a single command buffer and submit.
+    std::vector<uint32_t> passBatches(passCount, UINT32_MAX);
+    for (const auto index : schedule) {
+      const auto& pass = m_RenderGraphPasses[index];
+      if (m_Batches.empty() || m_Batches.back().Queue != pass.SubmitQueue) {
+        auto& batch = m_Batches.emplace_back();
+        batch.Queue = pass.SubmitQueue;
+      }
+      m_Batches.back().Passes.emplace_back(index);
+      passBatches[index] = (uint32_t)m_Batches.size() - 1;
+    }
+
+    // Pipeline barriers only work inside a queue, batches on other queues are synchronized with semaphores.
+    for (const auto index : schedule) {
+      for (const auto to : edges[index]) {
+        if (!alive[to])
+          continue;
+        const uint32_t fromBatch = passBatches[index];
+        const uint32_t toBatch = passBatches[to];
+        if (m_Batches[fromBatch].Queue == m_Batches[toBatch].Queue)
+          continue;
+        auto& waits = m_Batches[toBatch].WaitBatches;
+        if (std::find(waits.begin(), waits.end(), fromBatch) == waits.end())
+          waits.emplace_back(fromBatch);
+        m_Batches[fromBatch].SignalsSemaphore = true;
+      }
+    }
+
+    // Images that are written before being read every frame don't need to keep their contents between frames.
+    // The image pool lets the ones whose lifetimes don't overlap share memory. Passes with a run condition may be
+    // skipped, readers of what they write would then see memory another image aliased, so those images are kept.
+    m_SchedulePositions.assign(passCount, UINT32_MAX);
+    std::unordered_map<const VulkanImage*, std::pair<uint32_t, uint32_t>> lifetimes;
+    std::unordered_set<const VulkanImage*> persistentImages;
+    for (uint32_t position = 0; position < (uint32_t)schedule.size(); position++) {
+      m_SchedulePositions[schedule[position]] = position;
+      const auto& pass = m_RenderGraphPasses[schedule[position]];
+      for (const auto& usage : pass.m_ResourceUsages) {
+        if (usage.Type != RenderGraphResourceType::Image)
+          continue;
+        const auto* image = static_cast<const VulkanImage*>(usage.Resource);
+        if (usage.IsHistory || usage.Resource == m_Output || (usage.IsWrite && pass.m_RunCondition)) {
+          persistentImages.emplace(image);
+          continue;
+        }
+        if (const auto lifetime = lifetimes.find(image); lifetime != lifetimes.end()) {
+          lifetime->second.second = position;
+          continue;
+        }
+        const bool readFirst = std::any_of(pass.m_ResourceUsages.begin(), pass.m_ResourceUsages.end(), [image](const RenderGraphResourceUsage& other) {
+          return other.Resource == image && !other.IsWrite;
+        });
+        if (readFirst)
+          persistentImages.emplace(image);
+        lifetimes.emplace(image, std::make_pair(position, position));
+      }
+    }
+    for (const auto* image : persistentImages)
+      lifetimes.erase(image);
+    m_TransientImages = std::move(lifetimes);
+    m_CulledPassCount = passCount - (uint32_t)schedule.size();
+  }
+
+  void RenderGraph::ReleaseBatches() {
+    if (!m_CommandPool)
       return;
+
+    VulkanRenderer::WaitDeviceIdle();
+    const auto& LogicalDevice = VulkanContext::GetDevice();
+    for (const auto& batch : m_Batches) {
+      for (const auto& commandBuffer : batch.CommandBuffers)
+        commandBuffer.FreeBuffer();
+      for (const auto& semaphore : batch.SignalSemaphores)
+        LogicalDevice.destroySemaphore(semaphore);
+    }
+    CommandPoolManager::Get()->FreePool(m_CommandPool);
+    m_CommandPool = nullptr;
+    m_Batches.clear();
+  }
+
+  std::vector<std::string> RenderGraph::GetSchedule() const {
+    std::vector<std::string> schedule;
+    for (const auto& batch : m_Batches) {
+      for (const auto index : batch.Passes)
+        schedule.emplace_back(m_RenderGraphPasses[index].Name);
+    }
+    return schedule;
+  }
+
+  void RenderGraph::InsertBarriers(const RenderGraphPass& renderPass, const uint32_t schedulePosition, const VulkanCommandBuffer& commandBuffer) {
+    // Image layouts are owned by the render passes and the images themselves,
+    // so a single global memory barrier per pass covers both image and buffer hazards.
+    vk::PipelineStageFlags srcStages = {};
+    vk::PipelineStageFlags dstStages = {};
+    vk::MemoryBarrier memoryBarrier = {};
+    std::vector<vk::ImageMemoryBarrier> imageBarriers;
+
+    for (const auto& usage : renderPass.m_ResourceUsages) {
+      if (usage.IsWrite)
+        continue;
+      vk::PipelineStageFlags stages;
+      vk::AccessFlags access;
+      GetUsageFlags(renderPass.m_IsComputePass, usage, stages, access);
+
+      auto& state = m_ResourceStates[usage.Resource];
+      if (state.WriteStages && (state.VisibleStages & stages) != stages) {
+        srcStages |= state.WriteStages;
+        dstStages |= stages;
+        memoryBarrier.srcAccessMask |= state.WriteAccess;
+        memoryBarrier.dstAccessMask |= access;
+        state.VisibleStages |= stages;
+      }
+      state.ReadStages |= stages;
+    }
+
+    for (const auto& usage : renderPass.m_ResourceUsages) {
+      if (!usage.IsWrite)
+        continue;
+      vk::PipelineStageFlags stages;
+      vk::AccessFlags access;
+      GetUsageFlags(renderPass.m_IsComputePass, usage, stages, access);
+
+      auto& state = m_ResourceStates[usage.Resource];
+
+      // First write of an aliased image in the frame. Other images of the same slot used the memory since,
+      // so wait for all of them and discard the previous contents.
+      if (usage.Type == RenderGraphResourceType::Image) {
+        const auto* image = static_cast<const VulkanImage*>(usage.Resource);
+        const auto lifetime = m_TransientImages.find(image);
+        const int32_t aliasSlot = lifetime != m_TransientImages.end() && lifetime->second.first == schedulePosition
+                                    ? ImagePool::GetAliasSlot(image)
+                                    : -1;
+        if (aliasSlot >= 0) {
+          vk::PipelineStageFlags aliasStages = {};
+          vk::AccessFlags aliasAccess = {};
+          for (const auto& [other, otherLifetime] : m_TransientImages) {
+            if (ImagePool::GetAliasSlot(other) != aliasSlot)
+              continue;
+            const auto& otherState = m_ResourceStates[other];
+            aliasStages |= otherState.WriteStages | otherState.ReadStages;
+            aliasAccess |= otherState.WriteAccess;
+          }
+          const vk::ImageSubresourceRange subresourceRange{
+            image->GetDesc().AspectFlag, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS
+          };
+          imageBarriers.emplace_back(aliasAccess,
+            access,
+            vk::ImageLayout::eUndefined,
+            image->GetImageLayout(),
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            image->GetImage(),
+            subresourceRange);
+          srcStages |= aliasStages ? aliasStages : vk::PipelineStageFlagBits::eTopOfPipe;
+          dstStages |= stages;
+          state = {stages, access, {}, {}};
+          continue;
+        }
+      }
+
+      // Write after read only needs an execution dependency.
+      if (state.ReadStages) {
+        srcStages |= state.ReadStages;
+        dstStages |= stages;
+      }
+      if (state.WriteStages) {
+        srcStages |= state.WriteStages;
+        dstStages |= stages;
+        memoryBarrier.srcAccessMask |= state.WriteAccess;
+        memoryBarrier.dstAccessMask |= access;
+      }
+      state = {stages, access, {}, {}};
+    }
+
+    if (!srcStages)
+      return;
+
+    const uint32_t memoryBarrierCount = memoryBarrier.srcAccessMask || memoryBarrier.dstAccessMask || imageBarriers.empty() ? 1 : 0;
+    commandBuffer.Get().pipelineBarrier(srcStages,
+      dstStages,
+      {},
+      memoryBarrierCount,
+      &memoryBarrier,
+      0,
+      nullptr,
+      (uint32_t)imageBarriers.size(),
+      imageBarriers.data());
+  }
+
+  void RenderGraph::RecordPass(const RenderGraphPass& renderPass, VulkanCommandBuffer& commandBuffer) {
+    if (renderPass.m_IsComputePass) {
+      renderPass.Execute(commandBuffer, 0);
+
+      for (const auto& innerPass : renderPass.m_InnerPasses)
+        innerPass.Execute(commandBuffer, 0);
+      return;
+    }
+
+    vk::RenderPassBeginInfo beginInfo;
+    if (renderPass.m_RenderArea.extent.height < 1) {
+      beginInfo.renderArea = vk::Rect2D{vk::Offset2D{}, Window::GetWindowExtent()};
+    }
+    else {
+      beginInfo.renderArea = renderPass.m_RenderArea;
+    }
+    beginInfo.renderPass = renderPass.Pipeline->GetRenderPass().Get();
+    beginInfo.clearValueCount = (uint32_t)renderPass.ClearValues.size();
+    beginInfo.pClearValues = renderPass.ClearValues.data();
+
+    for (int32_t i = 0; i < (int32_t)renderPass.Framebuffers.size(); i++) {
+      beginInfo.framebuffer = renderPass.Framebuffers[i]->Get();
+      commandBuffer.BeginRenderPass(beginInfo);
+      renderPass.Execute(commandBuffer, i);
+      commandBuffer.EndRenderPass();
+    }
+    for (const auto& innerPass : renderPass.m_InnerPasses) {
+      beginInfo.renderPass = innerPass.Pipeline->GetRenderPass().Get();
+      for (int32_t i = 0; i < (int32_t)innerPass.Framebuffers.size(); i++) {
+        beginInfo.framebuffer = innerPass.Framebuffers[i]->Get();
+        commandBuffer.BeginRenderPass(beginInfo);
+        innerPass.Execute(commandBuffer, i);
+        commandBuffer.EndRenderPass();
+      }
     }
-    m_RenderGraphPasses.erase(Name);
   }
 
   bool RenderGraph::Update(VulkanSwapchain& swapchain, const uint32_t* currentFrame) {
@@ -105,6 +596,11 @@ namespace Oxylus {
 
     static bool isFirstPass = true;
 
+    if (m_IsDirty || m_FramesInFlight != swapchain.MaxFramesInFlight)
+      Compile(swapchain.MaxFramesInFlight);
+
+    // The in-flight fence is signaled after everything submitted for this frame before the swapchain pass,
+    // so it also guards the graph's command buffers. No per pass waits are needed.
     VulkanUtils::CheckResult(LogicalDevice.waitForFences(1, &swapchain.InFlightFences[*currentFrame], true,UINT64_MAX));
     VulkanUtils::CheckResult(LogicalDevice.resetFences(1, &swapchain.InFlightFences[*currentFrame]));
 
@@ -116,79 +612,61 @@ namespace Oxylus {
       return false;
     }
 
-    for (auto& [name, renderPass] : m_RenderGraphPasses) {
-      if (renderPass.m_RunCondition != nullptr && !renderPass.m_RunCondition)
-        continue;
+    for (uint32_t batchIndex = 0; batchIndex < (uint32_t)m_Batches.size(); batchIndex++) {
       OX_SCOPED_ZONE;
-      //Render pass
-      if (!isFirstPass) {
-        VulkanUtils::CheckResult(LogicalDevice.waitForFences(1, &renderPass.m_Fence, true, UINT64_MAX));
-        VulkanUtils::CheckResult(LogicalDevice.resetFences(1, &renderPass.m_Fence));
-      }
-      const auto& commandBuffer = renderPass.CommandBuffers[0];
-      OX_CORE_ASSERT(commandBuffer)
-      commandBuffer->Begin({vk::CommandBufferUsageFlagBits::eSimultaneousUse});
-      if (!renderPass.m_IsComputePass) {
-        vk::RenderPassBeginInfo beginInfo;
-        if (renderPass.m_RenderArea.extent.height < 1) {
-          beginInfo.renderArea = vk::Rect2D{vk::Offset2D{}, Window::GetWindowExtent()};
-        }
-        else {
-          beginInfo.renderArea = renderPass.m_RenderArea;
-        }
-        beginInfo.renderPass = renderPass.Pipeline->GetRenderPass().Get();
-        beginInfo.clearValueCount = (uint32_t)renderPass.ClearValues.size();
-        beginInfo.pClearValues = renderPass.ClearValues.data();
-
-        for (int32_t i = 0; i < (int32_t)renderPass.Framebuffers.size(); i++) {
-          beginInfo.framebuffer = renderPass.Framebuffers[i]->Get();
-          commandBuffer->BeginRenderPass(beginInfo);
-          renderPass.Execute(*commandBuffer, i);
-          commandBuffer->EndRenderPass();
-        }
-        for (const auto& innerPass : renderPass.m_InnerPasses) {
-          beginInfo.renderPass = innerPass.Pipeline->GetRenderPass().Get();
-          for (int32_t i = 0; i < (int32_t)innerPass.Framebuffers.size(); i++) {
-            beginInfo.framebuffer = innerPass.Framebuffers[i]->Get();
-            commandBuffer->BeginRenderPass(beginInfo);
-            innerPass.Execute(*commandBuffer, i);
-            commandBuffer->EndRenderPass();
-          }
-        }
-
-        TracyProfiler::Collect(commandBuffer->Get());
-
-        commandBuffer->End();
+      auto& batch = m_Batches[batchIndex];
+      auto& commandBuffer = batch.CommandBuffers[*currentFrame];
+      commandBuffer.Begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+
+      for (const auto passIndex : batch.Passes) {
+        const auto& renderPass = m_RenderGraphPasses[passIndex];
+        if (renderPass.m_RunCondition != nullptr && !*renderPass.m_RunCondition)
+          continue;
+        InsertBarriers(renderPass, m_SchedulePositions[passIndex], commandBuffer);
+        RecordPass(renderPass, commandBuffer);
       }
-      else {
-        renderPass.Execute(*commandBuffer, 0);
 
-        for (const auto& innerPass : renderPass.m_InnerPasses) {
-          innerPass.Execute(*commandBuffer, 0);
+      // The output is sampled by the swapchain pass right after the graph.
+      if (m_Output && batchIndex == (uint32_t)m_Batches.size() - 1) {
+        auto& state = m_ResourceStates[m_Output];
+        constexpr auto dstStage = vk::PipelineStageFlagBits::eFragmentShader;
+        if (state.WriteStages && !(state.VisibleStages & dstStage)) {
+          const vk::MemoryBarrier memoryBarrier{state.WriteAccess, vk::AccessFlagBits::eShaderRead};
+          commandBuffer.Get().pipelineBarrier(state.WriteStages, dstStage, {}, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+          state.VisibleStages |= dstStage;
         }
+        state.ReadStages |= dstStage;
+      }
 
-        TracyProfiler::Collect(commandBuffer->Get());
+      TracyProfiler::Collect(commandBuffer.Get());
 
-        commandBuffer->End();
-      }
+      commandBuffer.End();
 
       //Submit
+      std::vector<vk::Semaphore> waitSemaphores;
+      std::vector<vk::PipelineStageFlags> waitStages;
+      for (const auto waitBatch : batch.WaitBatches) {
+        waitSemaphores.emplace_back(m_Batches[waitBatch].SignalSemaphores[*currentFrame]);
+        waitStages.emplace_back(vk::PipelineStageFlagBits::eAllCommands);
+      }
+      // Passes may read buffers and images that are still being uploaded
+      std::vector<uint64_t> waitValues(waitSemaphores.size(), 0);
+      UploadManager::Get()->AddSubmitWait(waitSemaphores, waitStages, waitValues);
+      const vk::TimelineSemaphoreSubmitInfo timelineInfo{(uint32_t)waitValues.size(), waitValues.data()};
+
       vk::SubmitInfo submitInfo = {};
+      submitInfo.pNext = &timelineInfo;
       submitInfo.commandBufferCount = 1;
-      submitInfo.pCommandBuffers = &commandBuffer->Get();
-      if (renderPass.m_HasDependency) {
+      submitInfo.pCommandBuffers = &commandBuffer.Get();
+      submitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
+      submitInfo.pWaitSemaphores = waitSemaphores.data();
+      submitInfo.pWaitDstStageMask = waitStages.data();
+      if (batch.SignalsSemaphore) {
         submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = &renderPass.m_SignalSemaphore;
-      }
-      submitInfo.waitSemaphoreCount = (uint32_t)renderPass.m_WaitSemaphores.size();
-      const std::vector<vk::PipelineStageFlags> stageColorFlag = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
-
-      if (!renderPass.m_WaitSemaphores.empty()) {
-        submitInfo.pWaitSemaphores = renderPass.m_WaitSemaphores.data();
-        submitInfo.pWaitDstStageMask = stageColorFlag.data();
+        submitInfo.pSignalSemaphores = &batch.SignalSemaphores[*currentFrame];
       }
 
-      VulkanUtils::CheckResult(renderPass.SubmitQueue->submit(1, &submitInfo, renderPass.m_Fence));
+      VulkanUtils::CheckResult(batch.Queue->submit(1, &submitInfo, vk::Fence()));
     }
 
     isFirstPass = false;
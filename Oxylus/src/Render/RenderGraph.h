@@ -1,4 +1,5 @@
 #pragma once
+#include "Vulkan/VulkanBuffer.h"
 #include "Vulkan/VulkanCommandBuffer.h"
 #include "Vulkan/VulkanDescriptorSet.h"
 #include "Vulkan/VulkanFramebuffer.h"
@@ -9,9 +10,21 @@
 namespace Oxylus {
   class RenderGraph;
 
+  enum class RenderGraphResourceType {
+    Image,
+    Framebuffer,
+    Buffer
+  };
+
+  struct RenderGraphResourceUsage {
+    const void* Resource = nullptr;
+    RenderGraphResourceType Type = RenderGraphResourceType::Image;
+    bool IsWrite = false;
+    bool IsHistory = false; // Reads the previous frame's contents. Doesn't order passes, only synchronizes them.
+  };
+
   struct RenderGraphPass {
     std::string Name;
-    std::vector<VulkanCommandBuffer*> CommandBuffers;
     std::vector<VulkanFramebuffer*> Framebuffers;
     std::function<void(VulkanCommandBuffer& commandBuffer, int32_t framebufferIndex)> Execute;
     std::array<vk::ClearValue, 2> ClearValues;
@@ -19,22 +32,32 @@ namespace Oxylus {
     VulkanPipeline* Pipeline;
 
     RenderGraphPass(std::string name,
-                    std::vector<VulkanCommandBuffer*> commandBuffers,
                     VulkanPipeline* pipeline,
                     std::vector<VulkanFramebuffer*> framebuffers,
                     std::function<void(VulkanCommandBuffer& commandBuffer, int32_t framebufferIndex)> execute,
                     const std::array<vk::ClearValue, 2>& clearValues = {},
-                    vk::Queue* submitQueue = {}) : Name(std::move(name)), CommandBuffers(std::move(commandBuffers)),
-                                                   Framebuffers(std::move(framebuffers)), Execute(std::move(execute)),
-                                                   ClearValues(clearValues), SubmitQueue(submitQueue),
-                                                   Pipeline(pipeline) {
+                    vk::Queue* submitQueue = {}) : Name(std::move(name)), Framebuffers(std::move(framebuffers)),
+                                                   Execute(std::move(execute)), ClearValues(clearValues),
+                                                   SubmitQueue(submitQueue), Pipeline(pipeline) {
       Init();
     }
 
     ~RenderGraphPass() = default;
 
     RenderGraphPass& AddInnerPass(const RenderGraphPass& innerPass);
+    /// Orders this pass after the named pass even if they don't share any declared resource.
     RenderGraphPass& AddReadDependency(const RenderGraph& renderGraph, const std::string& passName);
+    RenderGraphPass& Read(const VulkanImage& image);
+    RenderGraphPass& Read(const VulkanFramebuffer& framebuffer);
+    RenderGraphPass& Read(const VulkanBuffer& buffer);
+    /// Reads what the given resource contained at the end of the previous frame.
+    RenderGraphPass& ReadHistory(const VulkanImage& image);
+    RenderGraphPass& ReadHistory(const VulkanFramebuffer& framebuffer);
+    RenderGraphPass& Write(const VulkanImage& image);
+    RenderGraphPass& Write(const VulkanFramebuffer& framebuffer);
+    RenderGraphPass& Write(const VulkanBuffer& buffer);
+    /// Passes with side effects are never culled even if nothing reads their outputs.
+    RenderGraphPass& SetHasSideEffects(bool sideEffects = true);
     RenderGraphPass& SetRenderArea(const vk::Rect2D& renderArea);
     RenderGraphPass& AddToGraph(RenderGraph& renderGraph);
     RenderGraphPass& AddToGraph(const Ref<RenderGraph>& renderGraph);
@@ -42,17 +65,19 @@ namespace Oxylus {
     RenderGraphPass& AddToGraphCompute(const Ref<RenderGraph>& renderGraph);
     RenderGraphPass& RunWithCondition(bool& condition);
 
+    const std::vector<RenderGraphResourceUsage>& GetResourceUsages() const { return m_ResourceUsages; }
+
   private:
     void Init();
-    std::vector<RenderGraphPass> m_InnerPasses{};
+    void AddResourceUsage(const void* resource, RenderGraphResourceType type, bool isWrite, bool isHistory = false);
 
-    vk::Fence m_Fence;
-    vk::Semaphore m_SignalSemaphore{};
-    std::vector<vk::Semaphore> m_WaitSemaphores{};
+    std::vector<RenderGraphPass> m_InnerPasses{};
+    std::vector<RenderGraphResourceUsage> m_ResourceUsages{};
+    std::vector<std::string> m_Dependencies{};
 
     bool* m_RunCondition = nullptr;
     bool m_IsComputePass = false;
-    mutable bool m_HasDependency = false;
+    bool m_HasSideEffects = false;
 
     vk::Rect2D m_RenderArea{};
 
@@ -69,13 +94,59 @@ namespace Oxylus {
 
     RenderGraph& AddRenderPass(RenderGraphPass& renderGraphPass);
     RenderGraph& AddComputePass(RenderGraphPass& computePass);
-    void RemoveRenderPass(const std::string& Name);
+    void RemoveRenderPass(const std::string& name);
+
+    /// Passes that don't contribute to the output (directly or through other passes) are culled.
+    /// If no output is set every pass is kept.
+    RenderGraph& SetOutput(const VulkanImage& image);
+    RenderGraph& SetOutput(const VulkanFramebuffer& framebuffer);
 
     const RenderGraphPass* FindRenderGraphPass(const std::string& name) const;
 
+    /// Schedules the graph and creates the command buffers and semaphores of its submit batches.
+    /// Called automatically by Update() whenever the graph changed.
+    void Compile(uint32_t framesInFlight);
+    /// Sorts the passes by their declared resources, culls the unused ones and groups them into submit batches.
+    /// Doesn't touch the device, Compile() creates the batches' resources afterwards.
+    void Schedule();
+
     bool Update(VulkanSwapchain& swapchain, const uint32_t* currentFrame);
 
+    /// Names of the scheduled passes in execution order. Valid after Schedule().
+    std::vector<std::string> GetSchedule() const;
+    uint32_t GetCulledPassCount() const { return m_CulledPassCount; }
+    uint32_t GetSubmitCount() const { return (uint32_t)m_Batches.size(); }
+
   private:
-    std::unordered_map<std::string, RenderGraphPass> m_RenderGraphPasses;
+    struct ResourceState {
+      vk::PipelineStageFlags WriteStages = {};
+      vk::AccessFlags WriteAccess = {};
+      vk::PipelineStageFlags ReadStages = {};    // Stages that read the resource since the last write
+      vk::PipelineStageFlags VisibleStages = {}; // Stages the last write has already been made visible to
+    };
+
+    struct SubmitBatch {
+      vk::Queue* Queue = nullptr;
+      std::vector<uint32_t> Passes = {};
+      std::vector<uint32_t> WaitBatches = {};
+      bool SignalsSemaphore = false;
+      std::vector<VulkanCommandBuffer> CommandBuffers = {}; // One per frame in flight
+      std::vector<vk::Semaphore> SignalSemaphores = {};     // One per frame in flight
+    };
+
+    std::vector<RenderGraphPass> m_RenderGraphPasses;
+    std::vector<SubmitBatch> m_Batches;
+    std::unordered_map<const void*, ResourceState> m_ResourceStates;
+    std::unordered_map<const VulkanImage*, std::pair<uint32_t, uint32_t>> m_TransientImages; // Image -> [first, last] schedule position
+    std::vector<uint32_t> m_SchedulePositions;
+    const void* m_Output = nullptr;
+    vk::CommandPool m_CommandPool;
+    uint32_t m_FramesInFlight = 0;
+    uint32_t m_CulledPassCount = 0;
+    bool m_IsDirty = true;
+
+    void RecordPass(const RenderGraphPass& renderPass, VulkanCommandBuffer& commandBuffer);
+    void InsertBarriers(const RenderGraphPass& renderPass, uint32_t schedulePosition, const VulkanCommandBuffer& commandBuffer);
+    void ReleaseBatches();
   };
 }
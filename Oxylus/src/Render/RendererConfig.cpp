@@ -75,6 +75,24 @@ namespace Oxylus {
       node["UsePCF"] << DirectShadowsConfig.UsePCF;
     }
 
+    //GPUDriven
+    {
+      auto node = nodeRoot["GPUDriven"];
+      node |= ryml::MAP;
+
+      node["Enabled"] << GPUDrivenConfig.Enabled;
+      node["OcclusionCulling"] << GPUDrivenConfig.OcclusionCulling;
+    }
+
+    //Lod
+    {
+      auto node = nodeRoot["Lod"];
+      node |= ryml::MAP;
+
+      node["Enabled"] << LodConfig.Enabled;
+      node["ErrorThreshold"] << LodConfig.ErrorThreshold;
+    }
+
     std::stringstream ss;
     ss << tree;
     std::ofstream filestream(path);
@@ -138,6 +156,22 @@ namespace Oxylus {
       node["UsePCF"] >> DirectShadowsConfig.UsePCF;
     }
 
+    //GPUDriven
+    if (nodeRoot.has_child("GPUDriven")) {
+      const ryml::ConstNodeRef node = nodeRoot["GPUDriven"];
+
+      node["Enabled"] >> GPUDrivenConfig.Enabled;
+      node["OcclusionCulling"] >> GPUDrivenConfig.OcclusionCulling;
+    }
+
+    //Lod
+    if (nodeRoot.has_child("Lod")) {
+      const ryml::ConstNodeRef node = nodeRoot["Lod"];
+
+      node["Enabled"] >> LodConfig.Enabled;
+      node["ErrorThreshold"] >> LodConfig.ErrorThreshold;
+    }
+
     return true;
   }
 }
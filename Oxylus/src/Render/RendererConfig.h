@@ -51,6 +51,16 @@ namespace Oxylus {
       uint32_t Size = 4096;
     } DirectShadowsConfig;
 
+    struct GPUDriven {
+      bool Enabled = true;           // Cull on the GPU and draw with indirect commands
+      bool OcclusionCulling = true;  // Also test against the previous frame's depth pyramid
+    } GPUDrivenConfig;
+
+    struct Lod {
+      bool Enabled = true;
+      float ErrorThreshold = 1.0f;   // Pixels a simplified mesh may deviate from the full detail one on screen
+    } LodConfig;
+
     RendererConfig();
     ~RendererConfig() = default;
 
@@ -1,6 +1,11 @@
 ﻿#include "ResourcePool.h"
 
+#include "Core/Memory.h"
 #include "Utils/Log.h"
+#include "Utils/Profiler.h"
+#include "Vulkan/VulkanContext.h"
+#include "Vulkan/VulkanRenderer.h"
+#include "Vulkan/Utils/VulkanUtils.h"
 
 namespace Oxylus {
   std::vector<VulkanFramebuffer*> FrameBufferPool::m_Pool;
@@ -30,19 +35,163 @@ namespace Oxylus {
   }
 
   std::vector<ImagePool::ImageResource> ImagePool::m_Pool;
+  std::vector<ImagePool::MemoryBlock> ImagePool::m_TransientBlocks;
+  ImagePool::TransientMemoryStats ImagePool::m_TransientStats;
 
   void ImagePool::ResizeImages() {
-    for (const auto& [image, extent, onresize, extMult] : m_Pool) {
-      image->Destroy();
-      VulkanImageDescription desc = image->GetDesc();
-      if (extent) {
-        desc.Width = extent->width / extMult;
-        desc.Height = extent->height / extMult;
+    OX_SCOPED_ZONE;
+    const auto& allocator = VulkanContext::GetAllocator();
+
+    // Destroy everything first, the memory of the transient images is reused below.
+    std::vector<VulkanImageDescription> descriptions(m_Pool.size());
+    for (size_t i = 0; i < m_Pool.size(); i++) {
+      const auto& resource = m_Pool[i];
+      resource.Image->Destroy();
+      VulkanImageDescription desc = resource.Image->GetDesc();
+      if (resource.Extent) {
+        desc.Width = resource.Extent->width / resource.ExtentMultiplier;
+        desc.Height = resource.Extent->height / resource.ExtentMultiplier;
+      }
+      desc.AliasAllocation = nullptr;
+      descriptions[i] = desc;
+    }
+
+    // Greedily place the transient images, biggest first, into slots whose images are never alive at the same time.
+    struct AliasSlot {
+      vk::DeviceSize Size = 0;
+      vk::DeviceSize Alignment = 0;
+      uint32_t MemoryTypeBits = UINT32_MAX;
+      std::vector<uint32_t> Images = {};
+    };
+    std::vector<AliasSlot> slots;
+    std::vector<std::pair<uint32_t, vk::MemoryRequirements>> transientImages;
+    for (uint32_t i = 0; i < (uint32_t)m_Pool.size(); i++) {
+      m_Pool[i].AliasSlot = -1;
+      if (m_Pool[i].FirstUse != UINT32_MAX)
+        transientImages.emplace_back(i, VulkanImage::GetMemoryRequirements(descriptions[i]));
+    }
+    std::sort(transientImages.begin(), transientImages.end(), [](const auto& a, const auto& b) { return a.second.size > b.second.size; });
+
+    TransientMemoryStats stats = {};
+    for (const auto& [index, requirements] : transientImages) {
+      const auto& resource = m_Pool[index];
+      stats.UnaliasedSize += requirements.size;
+      stats.ImageCount++;
+
+      AliasSlot* target = nullptr;
+      for (auto& slot : slots) {
+        if (!(slot.MemoryTypeBits & requirements.memoryTypeBits))
+          continue;
+        const bool overlaps = std::any_of(slot.Images.begin(), slot.Images.end(), [&](const uint32_t other) {
+          return resource.FirstUse <= m_Pool[other].LastUse && m_Pool[other].FirstUse <= resource.LastUse;
+        });
+        if (!overlaps) {
+          target = &slot;
+          break;
+        }
+      }
+      if (!target)
+        target = &slots.emplace_back();
+
+      target->Size = std::max(target->Size, requirements.size);
+      target->Alignment = std::max(target->Alignment, requirements.alignment);
+      target->MemoryTypeBits &= requirements.memoryTypeBits;
+      target->Images.emplace_back(index);
+    }
+
+    // Reuse the smallest pooled block that fits each slot. Blocks that don't fit anything anymore are freed.
+    std::vector<MemoryBlock> freeBlocks = std::move(m_TransientBlocks);
+    m_TransientBlocks.clear();
+    for (uint32_t slotIndex = 0; slotIndex < (uint32_t)slots.size(); slotIndex++) {
+      const auto& slot = slots[slotIndex];
+      auto best = freeBlocks.end();
+      for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+        const bool fits = it->Size >= slot.Size && it->Alignment >= slot.Alignment && (slot.MemoryTypeBits & (1u << it->MemoryType));
+        if (fits && (best == freeBlocks.end() || it->Size < best->Size))
+          best = it;
+      }
+
+      if (best != freeBlocks.end()) {
+        m_TransientBlocks.emplace_back(*best);
+        freeBlocks.erase(best);
       }
-      image->Create(desc);
-      if (onresize)
-        onresize();
+      else {
+        const VkMemoryRequirements requirements{slot.Size, slot.Alignment, slot.MemoryTypeBits};
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        MemoryBlock block{};
+        VmaAllocationInfo allocationInfo{};
+        VulkanUtils::CheckResult(vmaAllocateMemory(allocator, &requirements, &allocationCreateInfo, &block.Allocation, &allocationInfo));
+        block.Size = slot.Size;
+        block.Alignment = slot.Alignment;
+        block.MemoryType = allocationInfo.memoryType;
+        GPUMemory::TotalAllocated += block.Size;
+        m_TransientBlocks.emplace_back(block);
+      }
+
+      stats.AliasedSize += m_TransientBlocks.back().Size;
+      for (const auto index : slot.Images) {
+        descriptions[index].AliasAllocation = m_TransientBlocks.back().Allocation;
+        m_Pool[index].AliasSlot = (int32_t)slotIndex;
+      }
+    }
+    for (const auto& block : freeBlocks) {
+      vmaFreeMemory(allocator, block.Allocation);
+      GPUMemory::TotalFreed += block.Size;
+    }
+    stats.AllocationCount = (uint32_t)m_TransientBlocks.size();
+    m_TransientStats = stats;
+
+    for (size_t i = 0; i < m_Pool.size(); i++) {
+      m_Pool[i].Image->Create(descriptions[i]);
+      if (m_Pool[i].OnResize)
+        m_Pool[i].OnResize();
+    }
+
+    if (stats.ImageCount > 0) {
+      OX_CORE_INFO("Transient images: {} images in {} allocations. Peak memory {:.2f} MB aliased, {:.2f} MB without aliasing.",
+        stats.ImageCount,
+        stats.AllocationCount,
+        (double)stats.AliasedSize / (1024.0 * 1024.0),
+        (double)stats.UnaliasedSize / (1024.0 * 1024.0));
+    }
+  }
+
+  void ImagePool::SetLifetimes(const std::unordered_map<const VulkanImage*, std::pair<uint32_t, uint32_t>>& lifetimes) {
+    bool changed = false;
+    for (auto& resource : m_Pool) {
+      uint32_t firstUse = UINT32_MAX;
+      uint32_t lastUse = 0;
+      if (const auto it = lifetimes.find(resource.Image); it != lifetimes.end()) {
+        firstUse = it->second.first;
+        lastUse = it->second.second;
+      }
+      changed |= resource.FirstUse != firstUse || resource.LastUse != lastUse;
+      resource.FirstUse = firstUse;
+      resource.LastUse = lastUse;
+    }
+
+    if (!changed)
+      return;
+
+    VulkanRenderer::WaitDeviceIdle();
+    ResizeImages();
+  }
+
+  int32_t ImagePool::GetAliasSlot(const VulkanImage* image) {
+    for (const auto& resource : m_Pool) {
+      if (resource.Image == image)
+        return resource.AliasSlot;
+    }
+    return -1;
+  }
+
+  void ImagePool::Release() {
+    for (const auto& block : m_TransientBlocks) {
+      vmaFreeMemory(VulkanContext::GetAllocator(), block.Allocation);
+      GPUMemory::TotalFreed += block.Size;
     }
+    m_TransientBlocks.clear();
   }
 
   void ImagePool::AddToPool(VulkanImage* image, vk::Extent2D* extent, const std::function<void()>& onresize, uint32_t extentMultiplier) {
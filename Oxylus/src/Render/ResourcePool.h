@@ -19,18 +19,46 @@ namespace Oxylus {
 
   class ImagePool {
   public:
+    struct TransientMemoryStats {
+      uint64_t UnaliasedSize = 0; // What the transient images would take with their own allocations
+      uint64_t AliasedSize = 0;   // What they take inside the shared allocations
+      uint32_t ImageCount = 0;
+      uint32_t AllocationCount = 0;
+    };
+
     static void ResizeImages();
     static void AddToPool(VulkanImage* image, vk::Extent2D* extent, const std::function<void()>& onresize, uint32_t extentMultiplier = 1);
     static void RemoveFromPool(std::string_view name);
 
+    /// Pooled images with a lifetime ([first, last] pass in the render graph schedule) are transient.
+    /// Transient images whose lifetimes don't overlap share the same allocation.
+    static void SetLifetimes(const std::unordered_map<const VulkanImage*, std::pair<uint32_t, uint32_t>>& lifetimes);
+    /// Index of the allocation the image is aliased into, -1 if it has its own memory.
+    static int32_t GetAliasSlot(const VulkanImage* image);
+    static const TransientMemoryStats& GetTransientMemoryStats() { return m_TransientStats; }
+    static void Release();
+
   private:
     struct ImageResource {
       VulkanImage* Image;
       vk::Extent2D* Extent;
       const std::function<void()> OnResize;
       uint32_t ExtentMultiplier = 1;
+      uint32_t FirstUse = UINT32_MAX;
+      uint32_t LastUse = 0;
+      int32_t AliasSlot = -1;
     };
+
+    struct MemoryBlock {
+      VmaAllocation Allocation = nullptr;
+      vk::DeviceSize Size = 0;
+      vk::DeviceSize Alignment = 0;
+      uint32_t MemoryType = 0;
+    };
+
     static std::vector<ImageResource> m_Pool;
+    static std::vector<MemoryBlock> m_TransientBlocks;
+    static TransientMemoryStats m_TransientStats;
     static uint32_t FindImage(std::string_view name);
   };
   
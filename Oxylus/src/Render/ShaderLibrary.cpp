@@ -1,15 +1,22 @@
 #include "ShaderLibrary.h"
 
+#include <mutex>
+
+#include "Thread/JobSystem.h"
+
 namespace Oxylus {
   std::unordered_map<std::string, Ref<VulkanShader>> ShaderLibrary::s_Shaders = {};
+  static std::mutex s_ShadersMutex;
 
   Ref<VulkanShader> ShaderLibrary::CreateShader(const ShaderCI& shaderCreateInfo) {
     return s_Shaders.emplace(shaderCreateInfo.Name, CreateRef<VulkanShader>(shaderCreateInfo)).first->second;
   }
 
   std::future<Ref<VulkanShader>> ShaderLibrary::CreateShaderAsync(ShaderCI shaderCreateInfo) {
-    return std::async([shaderCreateInfo] {
-      return s_Shaders.emplace(shaderCreateInfo.Name, CreateRef<VulkanShader>(shaderCreateInfo)).first->second;
+    return JobSystem::ExecuteAsync([shaderCreateInfo] {
+      auto shader = CreateRef<VulkanShader>(shaderCreateInfo);
+      std::lock_guard<std::mutex> lock(s_ShadersMutex);
+      return s_Shaders.emplace(shaderCreateInfo.Name, shader).first->second;
     });
   }
 
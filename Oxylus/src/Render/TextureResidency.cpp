@@ -0,0 +1,160 @@
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace Oxylus {
+  TextureResidency::Handle TextureResidency::Add(const std::vector<uint64_t>& levelSizes, const uint32_t residentMip) {
+    Handle handle;
+    if (!m_FreeHandles.empty()) {
+      handle = m_FreeHandles.back();
+      m_FreeHandles.pop_back();
+    }
+    else {
+      handle = (Handle)m_Textures.size();
+      m_Textures.emplace_back();
+    }
+
+    auto& texture = m_Textures[handle];
+    texture = {};
+    texture.ChainSizes.resize(levelSizes.size() + 1, 0);
+    for (size_t level = levelSizes.size(); level-- > 0;)
+      texture.ChainSizes[level] = texture.ChainSizes[level + 1] + levelSizes[level];
+    texture.BaseMip = std::min(residentMip, (uint32_t)std::max(levelSizes.size(), (size_t)1) - 1);
+    texture.ResidentMip = texture.BaseMip;
+    texture.TargetMip = texture.BaseMip;
+    texture.WantedMip = texture.BaseMip;
+    texture.LastRequestFrame = m_Frame;
+    texture.Alive = true;
+    return handle;
+  }
+
+  void TextureResidency::Remove(const Handle handle) {
+    m_Textures[handle] = {};
+    m_FreeHandles.emplace_back(handle);
+  }
+
+  void TextureResidency::Request(const Handle handle, const uint32_t mip) {
+    auto& texture = m_Textures[handle];
+    texture.RequestedMip = std::min(texture.RequestedMip, mip);
+  }
+
+  std::vector<TextureResidency::Change> TextureResidency::Update(const uint32_t maxChanges) {
+    m_Frame++;
+
+    // Textures that weren't requested for a while fall back to their base mip
+    for (auto& texture : m_Textures) {
+      if (!texture.Alive)
+        continue;
+      if (texture.RequestedMip != UINT32_MAX) {
+        texture.WantedMip = std::min(texture.RequestedMip, texture.BaseMip);
+        texture.LastRequestFrame = m_Frame;
+      }
+      else if (m_Frame - texture.LastRequestFrame > RequestLifetime) {
+        texture.WantedMip = texture.BaseMip;
+      }
+      texture.RequestedMip = UINT32_MAX;
+      texture.TargetMip = texture.WantedMip;
+    }
+
+    FitBudget();
+
+    // Memory in use once the changes in progress are done, replaced mips count until they are gone
+    uint64_t committed = 0;
+    std::vector<Handle> drops, loads;
+    for (Handle handle = 0; handle < (Handle)m_Textures.size(); handle++) {
+      const auto& texture = m_Textures[handle];
+      if (!texture.Alive)
+        continue;
+      committed += texture.ChainSizes[texture.Pending ? std::min(texture.ResidentMip, texture.PendingMip) : texture.ResidentMip];
+      if (texture.Pending || texture.TargetMip == texture.ResidentMip)
+        continue;
+      (texture.TargetMip > texture.ResidentMip ? drops : loads).emplace_back(handle);
+    }
+
+    // Textures missing the most mips load first
+    std::sort(loads.begin(), loads.end(),
+      [this](const Handle a, const Handle b) {
+        const auto& textureA = m_Textures[a];
+        const auto& textureB = m_Textures[b];
+        return textureA.ResidentMip - textureA.TargetMip > textureB.ResidentMip - textureB.TargetMip;
+      });
+
+    std::vector<Change> changes;
+    const auto addChange = [this, &changes](const Handle handle) {
+      auto& texture = m_Textures[handle];
+      texture.Pending = true;
+      texture.PendingMip = texture.TargetMip;
+      changes.push_back({handle, texture.TargetMip});
+    };
+
+    for (const Handle handle : drops) {
+      if (changes.size() >= maxChanges)
+        return changes;
+      addChange(handle);
+    }
+    for (const Handle handle : loads) {
+      if (changes.size() >= maxChanges)
+        break;
+      const auto& texture = m_Textures[handle];
+      const uint64_t growth = texture.ChainSizes[texture.TargetMip] - texture.ChainSizes[texture.ResidentMip];
+      if (committed + growth > m_Budget)
+        continue;
+      committed += growth;
+      addChange(handle);
+    }
+    return changes;
+  }
+
+  void TextureResidency::SetResident(const Handle handle, const uint32_t firstMip) {
+    auto& texture = m_Textures[handle];
+    if (!texture.Alive)
+      return;
+    texture.ResidentMip = std::min(firstMip, texture.BaseMip);
+    texture.Pending = false;
+  }
+
+  uint64_t TextureResidency::GetResidentSize() const {
+    uint64_t size = 0;
+    for (const auto& texture : m_Textures) {
+      if (texture.Alive)
+        size += texture.ChainSizes[texture.ResidentMip];
+    }
+    return size;
+  }
+
+  void TextureResidency::FitBudget() {
+    uint64_t total = 0;
+    for (const auto& texture : m_Textures) {
+      if (texture.Alive)
+        total += texture.ChainSizes[texture.TargetMip];
+    }
+    if (total <= m_Budget)
+      return;
+
+    // Drops the finest mip of the least recently requested texture, the largest mip among equally recent ones
+    const auto compare = [this](const Handle a, const Handle b) {
+      const auto& textureA = m_Textures[a];
+      const auto& textureB = m_Textures[b];
+      if (textureA.LastRequestFrame != textureB.LastRequestFrame)
+        return textureA.LastRequestFrame > textureB.LastRequestFrame;
+      return textureA.GetLevelSize(textureA.TargetMip) < textureB.GetLevelSize(textureB.TargetMip);
+    };
+    std::priority_queue<Handle, std::vector<Handle>, decltype(compare)> candidates(compare);
+    for (Handle handle = 0; handle < (Handle)m_Textures.size(); handle++) {
+      const auto& texture = m_Textures[handle];
+      if (texture.Alive && texture.TargetMip < texture.BaseMip)
+        candidates.push(handle);
+    }
+
+    while (total > m_Budget && !candidates.empty()) {
+      const Handle handle = candidates.top();
+      candidates.pop();
+      auto& texture = m_Textures[handle];
+      total -= texture.GetLevelSize(texture.TargetMip);
+      texture.TargetMip++;
+      if (texture.TargetMip < texture.BaseMip)
+        candidates.push(handle);
+    }
+  }
+}
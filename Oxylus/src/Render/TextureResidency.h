@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Oxylus {
+  /// Decides which mips of streamed textures should be resident. Only does the bookkeeping, loading the mips is left
+  /// to the caller, so it can be driven by any feedback source.
+  /// Every frame textures are requested at the finest mip they were sampled at. Update then fits the requested mips
+  /// into the budget, dropping the finest mips of the least recently requested and largest textures first.
+  class TextureResidency {
+  public:
+    using Handle = uint32_t;
+    static constexpr Handle InvalidHandle = UINT32_MAX;
+
+    /// Frames a texture keeps its requested mips after it was last requested.
+    static constexpr uint64_t RequestLifetime = 60;
+
+    struct Change {
+      Handle Texture = InvalidHandle;
+      uint32_t FirstMip = 0; // Finest mip the texture should have resident
+    };
+
+    /// Takes the sizes of every level of the mip chain. The resident mip and the ones coarser than it are never dropped.
+    Handle Add(const std::vector<uint64_t>& levelSizes, uint32_t residentMip);
+    void Remove(Handle handle);
+
+    /// Requests of the same frame are merged into the finest of them.
+    void Request(Handle handle, uint32_t mip);
+
+    /// Ends the frame and returns the textures whose resident mips have to change, drops before loads.
+    /// Loads are only returned while the resident mips and the changes in progress fit into the budget.
+    /// Returned textures get no further changes until SetResident is called for them.
+    std::vector<Change> Update(uint32_t maxChanges);
+    /// Reports a change as done. Reporting the mip the texture already has abandons the change.
+    void SetResident(Handle handle, uint32_t firstMip);
+
+    void SetBudget(uint64_t bytes) { m_Budget = bytes; }
+    uint64_t GetBudget() const { return m_Budget; }
+    uint64_t GetResidentSize() const;
+    uint32_t GetResidentMip(Handle handle) const { return m_Textures[handle].ResidentMip; }
+    uint32_t GetTargetMip(Handle handle) const { return m_Textures[handle].TargetMip; }
+
+  private:
+    struct Texture {
+      std::vector<uint64_t> ChainSizes{}; // Size of the chain starting at each level
+      uint32_t BaseMip = 0;
+      uint32_t ResidentMip = 0;
+      uint32_t TargetMip = 0;
+      uint32_t WantedMip = 0;
+      uint32_t RequestedMip = UINT32_MAX; // Finest mip requested this frame
+      uint32_t PendingMip = 0;
+      uint64_t LastRequestFrame = 0;
+      bool Pending = false;
+      bool Alive = false;
+
+      uint64_t GetLevelSize(const uint32_t mip) const { return ChainSizes[mip] - ChainSizes[mip + 1]; }
+    };
+
+    std::vector<Texture> m_Textures;
+    std::vector<Handle> m_FreeHandles;
+    uint64_t m_Budget = UINT64_MAX;
+    uint64_t m_Frame = 0;
+
+    void FitBudget();
+  };
+}
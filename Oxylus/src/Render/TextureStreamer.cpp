@@ -0,0 +1,188 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Thread/JobSystem.h"
+#include "Utils/Profiler.h"
+#include "Vulkan/VulkanRenderer.h"
+
+namespace Oxylus {
+  TextureStreamer* TextureStreamer::s_Instance = nullptr;
+
+  static constexpr uint64_t DefaultBudget = 512ull * 1024 * 1024;
+
+  void TextureStreamer::Init() {
+    if (s_Instance)
+      return;
+
+    s_Instance = new TextureStreamer();
+    s_Instance->m_Residency.SetBudget(DefaultBudget);
+  }
+
+  void TextureStreamer::Release() {
+    if (!s_Instance)
+      return;
+
+    for (auto& load : s_Instance->m_Loads) {
+      if (!load.Upload) {
+        load.Mips.wait();
+        continue;
+      }
+      UploadManager::Get()->Wait(load.Upload);
+      load.Staged.Destroy();
+    }
+    for (auto& retired : s_Instance->m_RetiredImages)
+      retired.Image.Destroy();
+
+    delete s_Instance;
+    s_Instance = nullptr;
+  }
+
+  void TextureStreamer::Register(const Ref<VulkanImage>& image) {
+    if (!image || !image->GetDesc().Streamed || image->GetLevelSizes().empty())
+      return;
+
+    std::lock_guard lock(m_Mutex);
+    const auto it = m_Handles.find(image.get());
+    if (it != m_Handles.end()) {
+      if (!m_Images[it->second].Image.expired())
+        return;
+      // A released image had the same address, its load result is dropped once it finishes
+      if (m_Images[it->second].Loading)
+        m_Images[it->second].Key = nullptr;
+      else
+        Remove(it->second);
+      m_Handles.erase(image.get());
+    }
+
+    const auto handle = m_Residency.Add(image->GetLevelSizes(), image->GetResidentMip());
+    if (handle >= m_Images.size())
+      m_Images.resize(handle + 1);
+    m_Images[handle] = {image, image.get(), false};
+    m_Handles.emplace(image.get(), handle);
+  }
+
+  void TextureStreamer::Request(const VulkanImage* image, const float pixels) {
+    std::lock_guard lock(m_Mutex);
+    const auto it = m_Handles.find(image);
+    if (it == m_Handles.end())
+      return;
+
+    // One texel per pixel, the texture is assumed to be mapped across the surface once
+    const float texels = (float)std::max(image->GetWidth(), image->GetHeight());
+    const uint32_t mip = pixels >= texels ? 0 : (uint32_t)std::log2(texels / std::max(pixels, 1.0f));
+    m_Residency.Request(it->second, mip);
+  }
+
+  const std::vector<const VulkanImage*>& TextureStreamer::Update() {
+    OX_SCOPED_ZONE;
+    std::lock_guard lock(m_Mutex);
+    m_Frame++;
+    m_UpdatedImages.clear();
+
+    // Replaced resources may still be used by the frames that were in flight when they got replaced
+    const uint64_t framesInFlight = VulkanRenderer::s_SwapChain.MaxFramesInFlight;
+    std::erase_if(m_RetiredImages,
+      [this, framesInFlight](RetiredImage& retired) {
+        if (m_Frame - retired.Frame <= framesInFlight)
+          return false;
+        retired.Image.Destroy();
+        return true;
+      });
+
+    // Read mips are uploaded into staged resources first, the image only switches to them once the upload is done
+    std::erase_if(m_Loads,
+      [this](Load& load) {
+        auto& streamed = m_Images[load.Texture];
+        if (!load.Upload) {
+          if (load.Mips.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+
+          const auto mips = load.Mips.get();
+          const auto image = streamed.Key ? streamed.Image.lock() : nullptr;
+          if (!image || mips.Data.empty()) {
+            streamed.Loading = false;
+            if (image)
+              m_Residency.SetResident(load.Texture, image->GetResidentMip());
+            else
+              Remove(load.Texture);
+            return true;
+          }
+          load.Staged = image->StageStreamedMips(mips, load.Upload);
+          load.FirstMip = mips.FirstLevel;
+          return false;
+        }
+        if (!UploadManager::Get()->IsComplete(load.Upload))
+          return false;
+
+        streamed.Loading = false;
+        const auto image = streamed.Key ? streamed.Image.lock() : nullptr;
+        if (!image) {
+          // Never used by a frame, so it can go right away
+          load.Staged.Destroy();
+          Remove(load.Texture);
+          return true;
+        }
+        m_RetiredImages.push_back({image->SetStreamedMips(load.Staged), m_Frame});
+        m_Residency.SetResident(load.Texture, load.FirstMip);
+        m_UpdatedImages.emplace_back(image.get());
+        return true;
+      });
+    std::sort(m_UpdatedImages.begin(), m_UpdatedImages.end());
+    if (!m_UpdatedImages.empty())
+      m_ViewVersion++;
+
+    // Forget the images that were released
+    for (TextureResidency::Handle handle = 0; handle < (TextureResidency::Handle)m_Images.size(); handle++) {
+      auto& streamed = m_Images[handle];
+      if (streamed.Key && !streamed.Loading && streamed.Image.expired()) {
+        m_Handles.erase(streamed.Key);
+        Remove(handle);
+      }
+    }
+
+    // Levels are read and transcoded from the file again, both to add mips and to drop them
+    const auto changes = m_Residency.Update(MaxLoadsInFlight - (uint32_t)m_Loads.size());
+    for (const auto& change : changes) {
+      auto& streamed = m_Images[change.Texture];
+      const auto image = streamed.Image.lock();
+      if (!image) {
+        m_Residency.SetResident(change.Texture, m_Residency.GetResidentMip(change.Texture));
+        continue;
+      }
+      streamed.Loading = true;
+      m_Loads.push_back({
+        change.Texture,
+        JobSystem::ExecuteAsync([path = image->GetDesc().Path, level = change.FirstMip] {
+          VulkanImage::KtxMips mips;
+          if (!VulkanImage::ReadKtxMips(path, level, UINT32_MAX, mips))
+            mips = {};
+          return mips;
+        })
+      });
+    }
+
+    return m_UpdatedImages;
+  }
+
+  void TextureStreamer::SetBudget(const uint64_t bytes) {
+    std::lock_guard lock(m_Mutex);
+    m_Residency.SetBudget(bytes);
+  }
+
+  uint64_t TextureStreamer::GetBudget() {
+    std::lock_guard lock(m_Mutex);
+    return m_Residency.GetBudget();
+  }
+
+  uint64_t TextureStreamer::GetResidentSize() {
+    std::lock_guard lock(m_Mutex);
+    return m_Residency.GetResidentSize();
+  }
+
+  void TextureStreamer::Remove(const TextureResidency::Handle handle) {
+    m_Residency.Remove(handle);
+    m_Images[handle] = {};
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "TextureResidency.h"
+#include "Core/Base.h"
+#include "Render/Vulkan/VulkanImage.h"
+
+namespace Oxylus {
+  /// Streams the mips of KTX2 textures loaded with `Streamed`. They start out with only their small mips resident.
+  /// The renderer reports the screen size every texture is drawn at, the streamer then reads the finer mips the
+  /// TextureResidency asks for on the job system and swaps them in, or drops mips to stay within its VRAM budget.
+  /// New mips are uploaded into staged resources that frames don't wait for, they are swapped in once the upload
+  /// finished.
+  class TextureStreamer {
+  public:
+    /// Files read or uploaded at once.
+    static constexpr uint32_t MaxLoadsInFlight = 4;
+
+    static void Init();
+    static void Release();
+
+    static TextureStreamer* Get() { return s_Instance; }
+
+    /// Starts streaming an image loaded with `Streamed`, other images are ignored. Can be called from any thread.
+    void Register(const Ref<VulkanImage>& image);
+
+    /// Feedback, the image covers about `pixels` pixels across on screen this frame.
+    void Request(const VulkanImage* image, float pixels);
+
+    /// Called once per frame before rendering. Swaps in the mips that finished loading and starts loading new ones.
+    /// Returns the images that got new views, descriptors using them have to be rewritten. Sorted by address.
+    const std::vector<const VulkanImage*>& Update();
+    /// Counts the updates that swapped in new views.
+    uint64_t GetViewVersion() const { return m_ViewVersion; }
+
+    void SetBudget(uint64_t bytes);
+    uint64_t GetBudget();
+    uint64_t GetResidentSize();
+
+  private:
+    static TextureStreamer* s_Instance;
+
+    struct StreamedImage {
+      std::weak_ptr<VulkanImage> Image;
+      const VulkanImage* Key = nullptr;
+      bool Loading = false;
+    };
+
+    struct Load {
+      TextureResidency::Handle Texture = TextureResidency::InvalidHandle;
+      std::future<VulkanImage::KtxMips> Mips;
+      VulkanImage Staged;                // Holds the mips once they are read
+      UploadManager::Ticket Upload = 0;  // Of the staged resources, 0 while the file is read
+      uint32_t FirstMip = 0;
+    };
+
+    struct RetiredImage {
+      VulkanImage Image;
+      uint64_t Frame = 0;
+    };
+
+    TextureResidency m_Residency;
+    std::vector<StreamedImage> m_Images; // Indexed by residency handle
+    std::unordered_map<const VulkanImage*, TextureResidency::Handle> m_Handles;
+    std::vector<Load> m_Loads;
+    std::vector<RetiredImage> m_RetiredImages;
+    std::vector<const VulkanImage*> m_UpdatedImages;
+    uint64_t m_Frame = 0;
+    uint64_t m_ViewVersion = 0;
+    std::mutex m_Mutex;
+
+    void Remove(TextureResidency::Handle handle);
+  };
+}
@@ -0,0 +1,241 @@
+#include "UploadManager.h"
+
+#include "VulkanContext.h"
+#include "Utils/Log.h"
+#include "Utils/Profiler.h"
+#include "Utils/VulkanUtils.h"
+
+namespace Oxylus {
+  UploadManager* UploadManager::s_Instance = nullptr;
+  uint32_t UploadManager::s_QueueFamilies[2] = {};
+
+  static constexpr vk::DeviceSize RingCapacity = 64ull * 1024 * 1024;
+  // Covers buffer copies and the texel blocks of every format images are uploaded with
+  static constexpr vk::DeviceSize StagingAlignment = 16;
+
+  void UploadManager::Init() {
+    if (s_Instance)
+      return;
+
+    s_Instance = new UploadManager();
+    s_QueueFamilies[0] = VulkanContext::VulkanQueue.graphicsQueueFamilyIndex;
+    s_QueueFamilies[1] = VulkanContext::VulkanQueue.transferQueueFamilyIndex;
+
+    s_Instance->m_Ring.CreateBuffer(vk::BufferUsageFlagBits::eTransferSrc,
+      vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+      RingCapacity,
+      nullptr,
+      VMA_MEMORY_USAGE_AUTO_PREFER_HOST).Map();
+
+    vk::SemaphoreTypeCreateInfo typeInfo{vk::SemaphoreType::eTimeline, 0};
+    const auto semaphore = VulkanContext::GetDevice().createSemaphore(vk::SemaphoreCreateInfo{{}, &typeInfo});
+    VulkanUtils::CheckResult(semaphore.result);
+    s_Instance->m_Semaphore = semaphore.value;
+  }
+
+  void UploadManager::Release() {
+    if (!s_Instance)
+      return;
+
+    s_Instance->Wait(s_Instance->Flush());
+    const auto& device = VulkanContext::GetDevice();
+    for (const auto& batch : s_Instance->m_FreeBatches)
+      device.destroyCommandPool(batch.CommandPool);
+    device.destroySemaphore(s_Instance->m_Semaphore);
+    s_Instance->m_Ring.Destroy();
+
+    delete s_Instance;
+    s_Instance = nullptr;
+  }
+
+  UploadManager::Ticket UploadManager::UploadBuffer(const vk::Buffer dstBuffer,
+                                                    const vk::DeviceSize dstOffset,
+                                                    const void* data,
+                                                    const vk::DeviceSize size) {
+    OX_SCOPED_ZONE;
+    std::lock_guard lock(m_Mutex);
+    const auto [srcBuffer, srcOffset] = Stage(data, size);
+    BeginBatch();
+    const vk::BufferCopy region{srcOffset, dstOffset, size};
+    m_Recording.CommandBuffer.copyBuffer(srcBuffer, dstBuffer, 1, &region);
+    m_RequiredValue = m_Recording.Value;
+    return m_Recording.Value;
+  }
+
+  UploadManager::Ticket UploadManager::UploadImage(const vk::Image image,
+                                                   const vk::ImageSubresourceRange& subresourceRange,
+                                                   const void* data,
+                                                   const vk::DeviceSize size,
+                                                   const std::vector<vk::BufferImageCopy>& regions,
+                                                   const vk::ImageLayout finalLayout,
+                                                   const bool streamed) {
+    OX_SCOPED_ZONE;
+    std::lock_guard lock(m_Mutex);
+    const auto [srcBuffer, srcOffset] = Stage(data, size);
+    BeginBatch();
+
+    vk::ImageMemoryBarrier barrier{};
+    barrier.image = image;
+    barrier.subresourceRange = subresourceRange;
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.oldLayout = vk::ImageLayout::eUndefined;
+    barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+    m_Recording.CommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, barrier);
+
+    std::vector<vk::BufferImageCopy> copies = regions;
+    for (auto& copy : copies)
+      copy.bufferOffset += srcOffset;
+    m_Recording.CommandBuffer.copyBufferToImage(srcBuffer, image, vk::ImageLayout::eTransferDstOptimal, copies);
+
+    // The transfer queue can't name the graphics stages, the semaphore wait makes the copy visible to them
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = {};
+    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.newLayout = finalLayout;
+    m_Recording.CommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, nullptr, barrier);
+    if (!streamed)
+      m_RequiredValue = m_Recording.Value;
+    return m_Recording.Value;
+  }
+
+  UploadManager::Ticket UploadManager::Flush() {
+    std::lock_guard lock(m_Mutex);
+    if (!m_IsRecording)
+      return m_SubmittedValue;
+
+    OX_SCOPED_ZONE;
+    VulkanUtils::CheckResult(m_Recording.CommandBuffer.end());
+
+    const vk::TimelineSemaphoreSubmitInfo timelineInfo{0, nullptr, 1, &m_Recording.Value};
+    vk::SubmitInfo submitInfo{};
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &m_Recording.CommandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_Semaphore;
+    VulkanUtils::CheckResult(VulkanContext::VulkanQueue.TransferQueue.submit(1, &submitInfo, vk::Fence()));
+
+    m_SubmittedValue = m_Recording.Value;
+    m_InFlight.emplace_back(std::move(m_Recording));
+    m_Recording = {};
+    m_IsRecording = false;
+    RetireBatches();
+    return m_SubmittedValue;
+  }
+
+  bool UploadManager::IsComplete(const Ticket ticket) {
+    std::lock_guard lock(m_Mutex);
+    if (ticket <= m_CompletedValue)
+      return true;
+    RetireBatches();
+    return ticket <= m_CompletedValue;
+  }
+
+  void UploadManager::Wait(const Ticket ticket) {
+    std::lock_guard lock(m_Mutex);
+    if (IsComplete(ticket))
+      return;
+
+    OX_SCOPED_ZONE;
+    if (ticket > m_SubmittedValue)
+      Flush();
+    const vk::SemaphoreWaitInfo waitInfo{{}, 1, &m_Semaphore, &ticket};
+    VulkanUtils::CheckResult(VulkanContext::GetDevice().waitSemaphores(waitInfo, UINT64_MAX));
+    RetireBatches();
+  }
+
+  void UploadManager::AddSubmitWait(std::vector<vk::Semaphore>& semaphores,
+                                    std::vector<vk::PipelineStageFlags>& stages,
+                                    std::vector<uint64_t>& values) {
+    std::lock_guard lock(m_Mutex);
+    // Streamed uploads are still flushed so they make progress, the submit only waits up to the last required one
+    Flush();
+    if (IsComplete(m_RequiredValue))
+      return;
+    semaphores.emplace_back(m_Semaphore);
+    stages.emplace_back(vk::PipelineStageFlagBits::eAllCommands);
+    values.emplace_back(m_RequiredValue);
+  }
+
+  std::pair<vk::Buffer, vk::DeviceSize> UploadManager::Stage(const void* data, const vk::DeviceSize size) {
+    // Too large for the ring, gets its own buffer that lives as long as the batch
+    if (size > RingCapacity) {
+      BeginBatch();
+      auto& buffer = m_Recording.OverflowBuffers.emplace_back();
+      buffer.CreateBuffer(vk::BufferUsageFlagBits::eTransferSrc,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+        size,
+        data,
+        VMA_MEMORY_USAGE_AUTO_PREFER_HOST);
+      return {buffer.Get(), 0};
+    }
+
+    while (true) {
+      vk::DeviceSize offset = (m_RingHead + StagingAlignment - 1) & ~(StagingAlignment - 1);
+      // Wrap around instead of splitting the data, the space left at the end counts as used by the batch
+      if (offset + size > RingCapacity)
+        offset = 0;
+      const vk::DeviceSize used = (offset >= m_RingHead ? offset - m_RingHead : RingCapacity - m_RingHead) + size;
+      if (m_RingUsed + used <= RingCapacity) {
+        if (data)
+          m_Ring.Copy(data, size, offset);
+        BeginBatch();
+        m_Recording.RingSize += used;
+        m_RingUsed += used;
+        m_RingHead = offset + size;
+        return {m_Ring.Get(), offset};
+      }
+
+      // The ring is full, wait for the oldest batch to give its space back
+      if (m_InFlight.empty())
+        Flush();
+      Wait(m_InFlight.front().Value);
+    }
+  }
+
+  void UploadManager::BeginBatch() {
+    if (m_IsRecording)
+      return;
+
+    if (!m_FreeBatches.empty()) {
+      m_Recording = std::move(m_FreeBatches.back());
+      m_FreeBatches.pop_back();
+    }
+    else {
+      const auto& device = VulkanContext::GetDevice();
+      const auto pool = device.createCommandPool(vk::CommandPoolCreateInfo{
+        vk::CommandPoolCreateFlagBits::eTransient, VulkanContext::VulkanQueue.transferQueueFamilyIndex
+      });
+      VulkanUtils::CheckResult(pool.result);
+      m_Recording.CommandPool = pool.value;
+      const auto buffers = device.allocateCommandBuffers(vk::CommandBufferAllocateInfo{pool.value, vk::CommandBufferLevel::ePrimary, 1});
+      VulkanUtils::CheckResult(buffers.result);
+      m_Recording.CommandBuffer = buffers.value[0];
+    }
+    m_Recording.Value = m_SubmittedValue + 1;
+    m_IsRecording = true;
+
+    VulkanUtils::CheckResult(m_Recording.CommandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit}));
+    // Earlier batches may have written the same ranges, e.g. when a freed range is reused
+    const vk::MemoryBarrier barrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferWrite};
+    m_Recording.CommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, 1, &barrier, 0, nullptr, 0, nullptr);
+  }
+
+  void UploadManager::RetireBatches() {
+    const auto value = VulkanContext::GetDevice().getSemaphoreCounterValue(m_Semaphore);
+    VulkanUtils::CheckResult(value.result);
+    m_CompletedValue = value.value;
+
+    while (!m_InFlight.empty() && m_InFlight.front().Value <= m_CompletedValue) {
+      Batch batch = std::move(m_InFlight.front());
+      m_InFlight.pop_front();
+      m_RingUsed -= batch.RingSize;
+      for (auto& buffer : batch.OverflowBuffers)
+        buffer.Destroy();
+      batch.OverflowBuffers.clear();
+      batch.RingSize = 0;
+      VulkanUtils::CheckResult(VulkanContext::GetDevice().resetCommandPool(batch.CommandPool));
+      m_FreeBatches.emplace_back(std::move(batch));
+    }
+  }
+}
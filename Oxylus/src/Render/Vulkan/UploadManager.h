@@ -0,0 +1,93 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <vulkan/vulkan.hpp>
+
+#include "VulkanBuffer.h"
+
+namespace Oxylus {
+  /// Streams buffer and image data to the GPU on the transfer queue without blocking the caller.
+  /// Data is copied into a persistent staging ring and the copies are recorded into a batch that is submitted on Flush.
+  /// Batches signal a timeline semaphore, so every upload returns the value that tells when it is done.
+  /// Graphics submits wait for the batches holding required uploads through AddSubmitWait, so those resources can
+  /// be used right away. Streamed uploads aren't waited for, their owners check IsComplete before using them, so a
+  /// large one doesn't stall the frames recorded meanwhile. Can be used from any thread, e.g. the asset thread
+  /// loading images.
+  class UploadManager {
+  public:
+    /// Timeline value the upload queue signals once an upload has finished.
+    using Ticket = uint64_t;
+
+    UploadManager() = default;
+    ~UploadManager() = default;
+
+    static void Init();
+    static void Release();
+
+    static UploadManager* Get() { return s_Instance; }
+
+    Ticket UploadBuffer(vk::Buffer dstBuffer, vk::DeviceSize dstOffset, const void* data, vk::DeviceSize size);
+    /// Copies the regions into the image and leaves it in the final layout. Region buffer offsets are relative to data.
+    /// Streamed images may only be used once the returned ticket is complete.
+    Ticket UploadImage(vk::Image image,
+                       const vk::ImageSubresourceRange& subresourceRange,
+                       const void* data,
+                       vk::DeviceSize size,
+                       const std::vector<vk::BufferImageCopy>& regions,
+                       vk::ImageLayout finalLayout,
+                       bool streamed = false);
+
+    /// Submits the uploads recorded so far and returns the ticket of the last submitted batch.
+    Ticket Flush();
+    bool IsComplete(Ticket ticket);
+    void Wait(Ticket ticket);
+
+    /// Flushes and adds a wait for every required upload to a submit that isn't ordered after them otherwise.
+    /// Values go into the timeline semaphore submit info, binary semaphores in the same submit need a 0.
+    void AddSubmitWait(std::vector<vk::Semaphore>& semaphores,
+                       std::vector<vk::PipelineStageFlags>& stages,
+                       std::vector<uint64_t>& values);
+
+    /// Resources written by the upload queue are shared with its queue family when it isn't the graphics family,
+    /// so they don't need ownership transfers.
+    template <typename CreateInfo>
+    static void ShareWithTransferQueue(CreateInfo& createInfo) {
+      if (s_QueueFamilies[0] == s_QueueFamilies[1])
+        return;
+      createInfo.sharingMode = vk::SharingMode::eConcurrent;
+      createInfo.queueFamilyIndexCount = 2;
+      createInfo.pQueueFamilyIndices = s_QueueFamilies;
+    }
+
+  private:
+    static UploadManager* s_Instance;
+    static uint32_t s_QueueFamilies[2];
+
+    struct Batch {
+      vk::CommandPool CommandPool;
+      vk::CommandBuffer CommandBuffer;
+      Ticket Value = 0;
+      vk::DeviceSize RingSize = 0;               // Bytes of the ring used by the batch, including skipped space
+      std::vector<VulkanBuffer> OverflowBuffers; // Uploads that don't fit into the ring at all
+    };
+
+    VulkanBuffer m_Ring;
+    vk::DeviceSize m_RingHead = 0;
+    vk::DeviceSize m_RingUsed = 0;
+    vk::Semaphore m_Semaphore;
+    Ticket m_SubmittedValue = 0;
+    Ticket m_CompletedValue = 0;
+    Ticket m_RequiredValue = 0; // Batch of the last upload that isn't streamed
+    Batch m_Recording;
+    bool m_IsRecording = false;
+    std::deque<Batch> m_InFlight;
+    std::vector<Batch> m_FreeBatches;
+    std::recursive_mutex m_Mutex;
+
+    /// Copies the data into staging memory and returns the buffer and offset to copy from.
+    std::pair<vk::Buffer, vk::DeviceSize> Stage(const void* data, vk::DeviceSize size);
+    void BeginBatch();
+    void RetireBatches();
+  };
+}
@@ -295,9 +295,25 @@ static vk::StructureChain<vk::InstanceCreateInfo>
       graphicsQueueFamilyProperty));
   }
 
+  uint32_t ContextUtils::FindTransferQueueFamilyIndex(
+    std::vector<vk::QueueFamilyProperties> const& queueFamilyProperties,
+    const uint32_t graphicsQueueFamilyIndex) {
+    uint32_t fallback = graphicsQueueFamilyIndex;
+    for (uint32_t i = 0; i < (uint32_t)queueFamilyProperties.size(); i++) {
+      const auto flags = queueFamilyProperties[i].queueFlags;
+      if (!(flags & vk::QueueFlagBits::eTransfer) || (flags & vk::QueueFlagBits::eGraphics))
+        continue;
+      if (!(flags & vk::QueueFlagBits::eCompute))
+        return i;
+      if (fallback == graphicsQueueFamilyIndex)
+        fallback = i;
+    }
+    return fallback;
+  }
+
   vk::Device ContextUtils::CreateDevice(
     const vk::PhysicalDevice& physicalDevice,
-    uint32_t queueFamilyIndex,
+    const std::vector<uint32_t>& queueFamilyIndices,
     const std::vector<std::string>& extensions,
     const vk::PhysicalDeviceFeatures* physicalDeviceFeatures,
     const void* pNext) {
@@ -313,12 +329,15 @@ static vk::StructureChain<vk::InstanceCreateInfo>
 #endif
 
     constexpr float queuePriority = 0.0f;
-    vk::DeviceQueueCreateInfo deviceQueueCreateInfo({},
-      queueFamilyIndex,
-      1,
-      &queuePriority);
+    std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos;
+    for (const uint32_t queueFamilyIndex : queueFamilyIndices) {
+      deviceQueueCreateInfos.emplace_back(vk::DeviceQueueCreateFlags{},
+        queueFamilyIndex,
+        1,
+        &queuePriority);
+    }
     const vk::DeviceCreateInfo deviceCreateInfo({},
-      deviceQueueCreateInfo,
+      deviceQueueCreateInfos,
       {},
       enabledExtensions,
       physicalDeviceFeatures,
@@ -70,8 +70,9 @@ namespace Oxylus {
 
     static std::vector<std::string> GetInstanceExtensions();
 
+    /// Creates one queue for each of the queue families.
     static vk::Device CreateDevice(vk::PhysicalDevice const& physicalDevice,
-                                   uint32_t queueFamilyIndex,
+                                   std::vector<uint32_t> const& queueFamilyIndices,
                                    std::vector<std::string> const& extensions,
                                    vk::PhysicalDeviceFeatures const* physicalDeviceFeatures,
                                    void const* pNext = nullptr);
@@ -79,5 +80,9 @@ namespace Oxylus {
     static std::vector<std::string> GetDeviceExtensions() { return {VK_KHR_SWAPCHAIN_EXTENSION_NAME}; }
 
     static uint32_t FindGraphicsQueueFamilyIndex(std::vector<vk::QueueFamilyProperties> const& queueFamilyProperties);
+    /// Prefers a family that can only do transfers, those run on the copy engines next to graphics work.
+    /// Falls back to the graphics family.
+    static uint32_t FindTransferQueueFamilyIndex(std::vector<vk::QueueFamilyProperties> const& queueFamilyProperties,
+                                                 uint32_t graphicsQueueFamilyIndex);
   };
 }
@@ -1,6 +1,7 @@
 ﻿#include <vk_mem_alloc.h>
 #include "VulkanBuffer.h"
 
+#include "UploadManager.h"
 #include "VulkanContext.h"
 #include "Core/Memory.h"
 
@@ -14,10 +15,13 @@ namespace Oxylus {
                                            VmaMemoryUsage memoryUsageFlag) {
     Size = size;
     UsageFlags = usageFlags;
+    m_Freed = false;
 
     vk::BufferCreateInfo bufferCI;
     bufferCI.usage = usageFlags;
     bufferCI.size = size;
+    if (usageFlags & vk::BufferUsageFlagBits::eTransferDst)
+      UploadManager::ShareWithTransferQueue(bufferCI);
 
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = memoryUsageFlag;
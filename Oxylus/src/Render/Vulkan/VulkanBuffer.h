@@ -49,6 +49,7 @@ namespace Oxylus {
     vk::Buffer Get() const { return m_Buffer; }
     const vk::DescriptorBufferInfo& GetDescriptor() const { return m_Descriptor; }
     vk::DescriptorBufferInfo& GetDescriptor() { return m_Descriptor; }
+    const void* GetMapped() const { return m_Mapped; }
 
   private:
     VkBuffer m_Buffer;
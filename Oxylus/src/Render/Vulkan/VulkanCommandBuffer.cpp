@@ -1,4 +1,5 @@
 #include "VulkanCommandBuffer.h"
+#include "UploadManager.h"
 #include "VulkanContext.h"
 #include "VulkanRenderer.h"
 #include "Utils/VulkanUtils.h"
@@ -94,7 +95,22 @@ namespace Oxylus {
   }
 
   void VulkanCommandBuffer::FlushBuffer() const {
-    VulkanUtils::CheckResult(VulkanContext::VulkanQueue.GraphicsQueue.submit(vk::SubmitInfo{0, nullptr, nullptr, 1, &m_Buffer}, vk::Fence()));
+    // The commands may use anything that was uploaded before them
+    std::vector<vk::Semaphore> waitSemaphores;
+    std::vector<vk::PipelineStageFlags> waitStages;
+    std::vector<uint64_t> waitValues;
+    if (UploadManager::Get())
+      UploadManager::Get()->AddSubmitWait(waitSemaphores, waitStages, waitValues);
+
+    const vk::TimelineSemaphoreSubmitInfo timelineInfo{(uint32_t)waitValues.size(), waitValues.data()};
+    vk::SubmitInfo submitInfo{};
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &m_Buffer;
+    VulkanUtils::CheckResult(VulkanContext::VulkanQueue.GraphicsQueue.submit(1, &submitInfo, vk::Fence()));
     VulkanUtils::CheckResult(VulkanContext::VulkanQueue.GraphicsQueue.waitIdle());
   }
 
@@ -93,6 +93,13 @@ namespace Oxylus {
     features12.shaderInputAttachmentArrayNonUniformIndexing = VK_TRUE;
     features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
     features12.shaderUniformBufferArrayNonUniformIndexing = VK_TRUE;
+    features12.timelineSemaphore = VK_TRUE;
+
+    const auto supportedFeatures = Context.PhysicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    const auto& supportedFeatures10 = supportedFeatures.get<vk::PhysicalDeviceFeatures2>().features;
+    Context.SupportsDrawIndirectCount = supportedFeatures.get<vk::PhysicalDeviceVulkan12Features>().drawIndirectCount &&
+                                        supportedFeatures10.multiDrawIndirect && supportedFeatures10.drawIndirectFirstInstance;
+    features12.drawIndirectCount = Context.SupportsDrawIndirectCount;
 
     vk::PhysicalDeviceVulkan13Features features13 = {};
     features13.maintenance4 = VK_TRUE;
@@ -105,8 +112,14 @@ namespace Oxylus {
     Context.DeviceFeatures.shaderStorageImageArrayDynamicIndexing = VK_TRUE;
     Context.DeviceFeatures.depthClamp = VK_TRUE;
 
+    VulkanQueue.transferQueueFamilyIndex = ContextUtils::FindTransferQueueFamilyIndex(VulkanQueue.queueFamilyProperties,
+      VulkanQueue.graphicsQueueFamilyIndex);
+    std::vector queueFamilyIndices = {VulkanQueue.graphicsQueueFamilyIndex};
+    if (VulkanQueue.transferQueueFamilyIndex != VulkanQueue.graphicsQueueFamilyIndex)
+      queueFamilyIndices.emplace_back(VulkanQueue.transferQueueFamilyIndex);
+
     Context.Device = ContextUtils::CreateDevice(Context.PhysicalDevice,
-      VulkanQueue.graphicsQueueFamilyIndex,
+      queueFamilyIndices,
       ContextUtils::GetDeviceExtensions(),
       &Context.DeviceFeatures,
       &features13);
@@ -118,6 +131,7 @@ namespace Oxylus {
     VulkanQueue.GraphicsQueue = Context.Device.getQueue(VulkanQueue.graphicsQueueFamilyIndex, 0);
     //VulkanQueue.ComputeQueue = Context.Device.getQueue(VulkanQueue.graphicsQueueFamilyIndex, 1);
     VulkanQueue.PresentQueue = Context.Device.getQueue(VulkanQueue.presentQueueFamilyIndex, 0);
+    VulkanQueue.TransferQueue = Context.Device.getQueue(VulkanQueue.transferQueueFamilyIndex, 0);
 
     // VMA
     VmaAllocatorCreateInfo allocatorInfo{};
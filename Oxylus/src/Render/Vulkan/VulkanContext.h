@@ -18,16 +18,19 @@ namespace Oxylus {
       vk::Device Device;
       VmaAllocator Allocator;
       vk::DynamicLoader DynamicLoader;
+      bool SupportsDrawIndirectCount = false; // vkCmdDrawIndexedIndirectCount with multiple draws and a first instance
     };
 
     struct VkQueue {
       vk::Queue GraphicsQueue;
       vk::Queue PresentQueue;
       vk::Queue ComputeQueue;
+      vk::Queue TransferQueue; // Same as the graphics queue when there is no separate transfer family
       std::vector<vk::QueueFamilyProperties> queueFamilyProperties;
       uint32_t graphicsQueueFamilyIndex;
       uint32_t presentQueueFamilyIndex;
       uint32_t computeQueueFamilyIndex; //TODO:
+      uint32_t transferQueueFamilyIndex;
     };
 
     static void CreateContext(const AppSpec& spec);
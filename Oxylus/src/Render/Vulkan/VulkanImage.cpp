@@ -1,4 +1,5 @@
 #include "VulkanImage.h"
+#include "UploadManager.h"
 #include "VulkanContext.h"
 #include "VulkanRenderer.h"
 #include "Utils/VulkanUtils.h"
@@ -69,26 +70,44 @@ namespace Oxylus {
     }
   }
 
-  void VulkanImage::CreateImage() {
-    if (m_ImageDescription.FlipOnLoad)
-      stbi_set_flip_vertically_on_load(true);
-
+  vk::ImageCreateInfo VulkanImage::GetImageCreateInfo(const VulkanImageDescription& imageDescription) {
     vk::ImageCreateInfo imageCreateInfo;
     imageCreateInfo.imageType = vk::ImageType::e2D;
-    imageCreateInfo.extent = vk::Extent3D{m_ImageDescription.Width, m_ImageDescription.Height, m_ImageDescription.Depth};
-    imageCreateInfo.mipLevels = m_ImageDescription.MipLevels;
-    imageCreateInfo.format = m_ImageDescription.Format;
-    imageCreateInfo.arrayLayers = m_ImageDescription.Type == ImageType::TYPE_CUBE ? 6 : m_ImageDescription.ImageArrayLayerCount;
-    imageCreateInfo.tiling = m_ImageDescription.ImageTiling;
+    imageCreateInfo.extent = vk::Extent3D{imageDescription.Width, imageDescription.Height, imageDescription.Depth};
+    imageCreateInfo.mipLevels = imageDescription.MipLevels;
+    imageCreateInfo.format = imageDescription.Format;
+    imageCreateInfo.arrayLayers = imageDescription.Type == ImageType::TYPE_CUBE ? 6 : imageDescription.ImageArrayLayerCount;
+    imageCreateInfo.tiling = imageDescription.ImageTiling;
     imageCreateInfo.initialLayout = vk::ImageLayout::eUndefined;
-    imageCreateInfo.usage = m_ImageDescription.UsageFlags;
-    imageCreateInfo.samples = m_ImageDescription.SampleCount;
-    imageCreateInfo.sharingMode = m_ImageDescription.SharingMode;
-    imageCreateInfo.flags = m_ImageDescription.Type == ImageType::TYPE_CUBE
+    imageCreateInfo.usage = imageDescription.UsageFlags;
+    imageCreateInfo.samples = imageDescription.SampleCount;
+    imageCreateInfo.sharingMode = imageDescription.SharingMode;
+    imageCreateInfo.flags = imageDescription.Type == ImageType::TYPE_CUBE
                               ? vk::ImageCreateFlagBits::eCubeCompatible
                               : vk::ImageCreateFlags{};
+    return imageCreateInfo;
+  }
+
+  vk::MemoryRequirements VulkanImage::GetMemoryRequirements(const VulkanImageDescription& imageDescription) {
+    const vk::ImageCreateInfo imageCreateInfo = GetImageCreateInfo(imageDescription);
+    const vk::DeviceImageMemoryRequirements requirementsInfo{&imageCreateInfo};
+    return VulkanContext::GetDevice().getImageMemoryRequirements(requirementsInfo).memoryRequirements;
+  }
+
+  void VulkanImage::CreateImage() {
+    if (m_ImageDescription.FlipOnLoad)
+      stbi_set_flip_vertically_on_load(true);
+
+    const VkImageCreateInfo _imageci = (VkImageCreateInfo)GetImageCreateInfo(m_ImageDescription);
+
+    // Memory is owned by whoever provided the allocation (e.g. the ImagePool).
+    if (m_ImageDescription.AliasAllocation) {
+      VulkanUtils::CheckResult(vmaCreateAliasingImage(VulkanContext::GetAllocator(), m_ImageDescription.AliasAllocation, &_imageci, &m_Image));
+      m_Allocation = nullptr;
+      ImageSize = 0;
+      return;
+    }
 
-    const VkImageCreateInfo _imageci = (VkImageCreateInfo)imageCreateInfo;
     VmaAllocationCreateInfo allocationCreateInfo{};
     allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
     VmaAllocationInfo allocInfo{};
@@ -105,11 +124,19 @@ namespace Oxylus {
       CreateImage();
     }
 
-    if (m_ImageDescription.TransitionLayoutAtCreate) {
+    const bool hasMips = !m_MipsLoaded && (m_ImageDescription.MipLevels > 1 && m_ImageDescription.Type != ImageType::TYPE_CUBE || m_ImageDescription.GenerateMips);
+    const bool deferMips = hasMips && m_ImageDescription.DeferMips;
+
+    if (m_ImageDescription.TransitionLayoutAtCreate && !deferMips && !m_MipsLoaded) {
       TransitionLayout();
     }
 
-    if (m_ImageDescription.MipLevels > 1 && m_ImageDescription.Type != ImageType::TYPE_CUBE || m_ImageDescription.GenerateMips) {
+    if (deferMips) {
+      // Level 0 stays in the layout it was loaded with until GenerateDeferredMips
+      if (m_ImageDescription.MipLevels == 1)
+        m_ImageDescription.MipLevels = GetMaxMipmapLevel(GetWidth(), GetHeight(), 1);
+    }
+    else if (hasMips) {
       GenerateMips();
     }
 
@@ -301,6 +328,8 @@ namespace Oxylus {
 
     m_Image = texture.image;
     m_ImageLayout = static_cast<vk::ImageLayout>(texture.imageLayout);
+    // Block compressed formats can't be blitted into, the file's mips are used as they are
+    m_MipsLoaded = true;
 
     m_ImageDescription.Format = static_cast<vk::Format>(texture.imageFormat);
 
@@ -365,22 +394,7 @@ namespace Oxylus {
 
     const int sizeMultiplier = GetDesc().Type == ImageType::TYPE_CUBE ? 6 : 1;
 
-    VulkanBuffer stagingBuffer;
-    stagingBuffer.CreateBuffer(vk::BufferUsageFlagBits::eTransferSrc,
-      vk::MemoryPropertyFlagBits::eHostVisible |
-      vk::MemoryPropertyFlagBits::eHostCoherent,
-      imageSize,
-      m_ImageData,
-      VMA_MEMORY_USAGE_AUTO_PREFER_HOST).Map();
-
-    if (m_ImageData)
-      stagingBuffer.Copy(m_ImageData, imageSize);
-    stagingBuffer.Flush();
-    stagingBuffer.Unmap();
-
-    if (!m_ImageDescription.Path.empty())
-      delete m_ImageData;
-
+    UploadManager::ShareWithTransferQueue(imageCreateInfo);
     const VkImageCreateInfo _imagecreateinfo = imageCreateInfo;
     VmaAllocationCreateInfo allocationInfo{};
     allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
@@ -396,15 +410,7 @@ namespace Oxylus {
     subresourceRange.levelCount = 1;
     subresourceRange.layerCount = sizeMultiplier;
 
-    vk::ImageMemoryBarrier imageMemoryBarrier{};
-    imageMemoryBarrier.image = m_Image;
-    imageMemoryBarrier.subresourceRange = subresourceRange;
-    imageMemoryBarrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
-    imageMemoryBarrier.oldLayout = vk::ImageLayout::eUndefined;
-    imageMemoryBarrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
-
     std::vector<vk::BufferImageCopy> bufferCopyRegions;
-    bufferCopyRegions.clear();
 
     vk::BufferImageCopy bufferCopyRegion = {};
     bufferCopyRegion.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
@@ -414,36 +420,20 @@ namespace Oxylus {
     bufferCopyRegion.imageExtent.depth = 1;
     bufferCopyRegions.push_back(bufferCopyRegion);
 
-    VulkanRenderer::SubmitOnce(m_CommandPool,
-      [&imageMemoryBarrier, &stagingBuffer, *this, &bufferCopyRegions](const VulkanCommandBuffer& copyCmd) {
-        copyCmd.Get().pipelineBarrier(vk::PipelineStageFlagBits::eHost,
-          vk::PipelineStageFlagBits::eTransfer,
-          {},
-          nullptr,
-          nullptr,
-          imageMemoryBarrier);
-        copyCmd.Get().copyBufferToImage(stagingBuffer.Get(),
-          m_Image,
-          vk::ImageLayout::eTransferDstOptimal,
-          static_cast<uint32_t>(bufferCopyRegions.size()),
-          bufferCopyRegions.data());
-
-        imageMemoryBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-        imageMemoryBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-        imageMemoryBarrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-        imageMemoryBarrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-
-        copyCmd.Get().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-          vk::PipelineStageFlagBits::eFragmentShader,
-          vk::DependencyFlags{},
-          nullptr,
-          nullptr,
-          imageMemoryBarrier);
-      });
+    // Copied on the upload queue, anything submitted after this waits for it
+    UploadManager::Get()->UploadImage(m_Image,
+      subresourceRange,
+      m_ImageData,
+      imageSize,
+      bufferCopyRegions,
+      vk::ImageLayout::eShaderReadOnlyOptimal);
 
     m_ImageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
 
-    stagingBuffer.Destroy();
+    // Pixels handed in through the description belong to the caller
+    if (m_ImageData != m_ImageDescription.EmbeddedStbData)
+      stbi_image_free(const_cast<uint8_t*>(m_ImageData));
+    m_ImageData = nullptr;
 
     timer.Stop();
     if (!m_ImageDescription.Path.empty())
@@ -452,25 +442,156 @@ namespace Oxylus {
       timer.ElapsedMilliSeconds());
   }
 
+  static ktx_transcode_fmt_e GetTranscodeFormat() {
+    const auto features = VulkanContext::GetPhysicalDevice().getFeatures();
+    if (features.textureCompressionBC)
+      return KTX_TTF_BC7_RGBA;
+    if (features.textureCompressionASTC_LDR)
+      return KTX_TTF_ASTC_4x4_RGBA;
+    return KTX_TTF_RGBA32;
+  }
+
+  bool VulkanImage::ReadKtxMips(const std::string& path, const uint32_t firstLevel, const uint32_t maxExtent, KtxMips& mips) {
+    OX_SCOPED_ZONE;
+    ktxTexture2* texture = nullptr;
+    ktxResult result = ktxTexture2_CreateFromNamedFile(path.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &texture);
+    if (result != KTX_SUCCESS) {
+      OX_CORE_ERROR("Couldn't load the KTX texture file. {0}, {1}", ktxErrorString(result), path);
+      return false;
+    }
+
+    // Basis textures written by the packager are transcoded to a block format the device can sample
+    if (ktxTexture2_NeedsTranscoding(texture))
+      result = ktxTexture2_TranscodeBasis(texture, GetTranscodeFormat(), 0);
+    if (result != KTX_SUCCESS) {
+      OX_CORE_ERROR("Couldn't transcode the KTX texture. {0}, {1}", ktxErrorString(result), path);
+      ktxTexture_Destroy(ktxTexture(texture));
+      return false;
+    }
+
+    mips.Format = static_cast<vk::Format>(texture->vkFormat);
+    mips.Width = texture->baseWidth;
+    mips.Height = texture->baseHeight;
+    mips.LevelCount = texture->numLevels;
+    mips.FirstLevel = std::min(firstLevel, mips.LevelCount - 1);
+    while (mips.FirstLevel + 1 < mips.LevelCount && (std::max(mips.Width, mips.Height) >> mips.FirstLevel) > maxExtent)
+      mips.FirstLevel++;
+
+    mips.LevelSizes.resize(mips.LevelCount);
+    for (uint32_t level = 0; level < mips.LevelCount; level++)
+      mips.LevelSizes[level] = ktxTexture_GetImageSize(ktxTexture(texture), level);
+
+    // Levels are aligned the same way the upload staging is, which covers the texel blocks of every format
+    const auto align = [](const size_t offset) { return (offset + 15) & ~(size_t)15; };
+    size_t size = 0;
+    for (uint32_t level = mips.FirstLevel; level < mips.LevelCount; level++)
+      size = align(size) + mips.LevelSizes[level];
+
+    const uint8_t* data = ktxTexture_GetData(ktxTexture(texture));
+    mips.Data.resize(size);
+    mips.Regions.clear();
+    size = 0;
+    for (uint32_t level = mips.FirstLevel; level < mips.LevelCount; level++) {
+      ktx_size_t offset = 0;
+      ktxTexture_GetImageOffset(ktxTexture(texture), level, 0, 0, &offset);
+      size = align(size);
+      memcpy(mips.Data.data() + size, data + offset, mips.LevelSizes[level]);
+
+      vk::BufferImageCopy region = {};
+      region.bufferOffset = size;
+      region.imageSubresource = vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, level - mips.FirstLevel, 0, 1};
+      region.imageExtent = vk::Extent3D{std::max(mips.Width >> level, 1u), std::max(mips.Height >> level, 1u), 1};
+      mips.Regions.emplace_back(region);
+      size += mips.LevelSizes[level];
+    }
+
+    ktxTexture_Destroy(ktxTexture(texture));
+    return true;
+  }
+
+  UploadManager::Ticket VulkanImage::UploadKtxMips(const KtxMips& mips, const bool streamed) {
+    m_ImageDescription.Width = mips.Width;
+    m_ImageDescription.Height = mips.Height;
+    m_ImageDescription.MipLevels = mips.LevelCount;
+    m_ImageDescription.Format = mips.Format;
+    m_ResidentMip = mips.FirstLevel;
+    m_LevelSizes = mips.LevelSizes;
+
+    // Levels finer than the first one aren't part of the image, its level 0 is the first one that was read
+    vk::ImageCreateInfo imageCreateInfo = GetImageCreateInfo(m_ImageDescription);
+    imageCreateInfo.extent = vk::Extent3D{std::max(mips.Width >> mips.FirstLevel, 1u), std::max(mips.Height >> mips.FirstLevel, 1u), 1};
+    imageCreateInfo.mipLevels = mips.LevelCount - mips.FirstLevel;
+    UploadManager::ShareWithTransferQueue(imageCreateInfo);
+    const VkImageCreateInfo _imagecreateinfo = imageCreateInfo;
+    VmaAllocationCreateInfo allocationInfo{};
+    allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    VmaAllocationInfo allocInfo{};
+    VulkanUtils::CheckResult(
+      vmaCreateImage(VulkanContext::GetAllocator(), &_imagecreateinfo, &allocationInfo, &m_Image, &m_Allocation, &allocInfo));
+    GPUMemory::TotalAllocated += allocInfo.size;
+    ImageSize = allocInfo.size;
+
+    const vk::ImageSubresourceRange subresourceRange{vk::ImageAspectFlagBits::eColor, 0, imageCreateInfo.mipLevels, 0, 1};
+    m_ImageLayout = m_ImageDescription.FinalImageLayout;
+    return UploadManager::Get()->UploadImage(m_Image,
+      subresourceRange,
+      mips.Data.data(),
+      mips.Data.size(),
+      mips.Regions,
+      m_ImageDescription.FinalImageLayout,
+      streamed);
+  }
+
+  VulkanImage VulkanImage::StageStreamedMips(const KtxMips& mips, UploadManager::Ticket& ticket) const {
+    OX_SCOPED_ZONE;
+    // Only the description is taken over, the views and the sampler stay with this image
+    VulkanImage staged;
+    staged.m_ImageDescription = m_ImageDescription;
+    ticket = staged.UploadKtxMips(mips, true);
+    return staged;
+  }
+
+  VulkanImage VulkanImage::SetStreamedMips(const VulkanImage& staged) {
+    OX_SCOPED_ZONE;
+    VulkanImage previous = *this;
+    // The sampler doesn't depend on the levels and is kept
+    previous.m_Sampler = nullptr;
+
+    m_ImageDescription = staged.m_ImageDescription;
+    m_Image = staged.m_Image;
+    m_Allocation = staged.m_Allocation;
+    m_ImageLayout = staged.m_ImageLayout;
+    m_ResidentMip = staged.m_ResidentMip;
+    m_LevelSizes = staged.m_LevelSizes;
+    ImageSize = staged.ImageSize;
+    if (m_ImageDescription.CreateView)
+      m_Views = CreateImageView();
+    // The previous set may still be used by a frame in flight
+    if (m_DescSet)
+      m_DescSet = CreateDescriptorSet();
+
+    DescriptorImageInfo.imageLayout = m_ImageLayout;
+    DescriptorImageInfo.imageView = m_Views[0];
+    DescriptorImageInfo.sampler = m_Sampler;
+    return previous;
+  }
+
   void VulkanImage::LoadKtxFile(const int version) {
     ProfilerTimer timer;
-    const auto& LogicalDevice = VulkanContext::GetDevice();
-    const auto& PhysicalDevice = VulkanContext::GetPhysicalDevice();
-
     const auto& path = m_ImageDescription.Path;
-    ktxTexture1* kTexture1 = nullptr;
-    ktxTexture2* kTexture2 = nullptr;
-    ktxVulkanTexture texture = {};
-    ktxVulkanDeviceInfo kvdi = {};
-
-    ktxVulkanDeviceInfo_Construct(&kvdi,
-      PhysicalDevice,
-      LogicalDevice,
-      VulkanContext::VulkanQueue.GraphicsQueue,
-      m_CommandPool,
-      nullptr);
 
     if (version == 1) {
+      ktxTexture1* kTexture1 = nullptr;
+      ktxVulkanTexture texture = {};
+      ktxVulkanDeviceInfo kvdi = {};
+
+      ktxVulkanDeviceInfo_Construct(&kvdi,
+        VulkanContext::GetPhysicalDevice(),
+        VulkanContext::GetDevice(),
+        VulkanContext::VulkanQueue.GraphicsQueue,
+        m_CommandPool,
+        nullptr);
+
       ktxResult result = ktxTexture1_CreateFromNamedFile(path.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture1);
 
       if (result != KTX_SUCCESS)
@@ -491,37 +612,35 @@ namespace Oxylus {
       m_ImageDescription.MipLevels = kTexture1->numLevels;
 
       ktxTexture_Destroy(ktxTexture(kTexture1));
-    }
-
-    if (version == 2) {
-      ktxResult result = ktxTexture2_CreateFromNamedFile(path.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture2);
-
-      if (result != KTX_SUCCESS)
-        OX_CORE_ERROR("Couldn't load the KTX texture file. {0}, {1}", ktxErrorString(result), path);
-
-      result = ktxTexture2_VkUploadEx(kTexture2,
-        &kvdi,
-        &texture,
-        VK_IMAGE_TILING_OPTIMAL,
-        static_cast<VkImageUsageFlags>(m_ImageDescription.UsageFlags),
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-      if (result != KTX_SUCCESS)
-        OX_CORE_ERROR("Failed to upload the ktx texture. {0}, {1}", ktxErrorString(result), path);
 
-      m_ImageDescription.Width = kTexture2->baseWidth;
-      m_ImageDescription.Height = kTexture2->baseHeight;
-      m_ImageDescription.MipLevels = kTexture2->numLevels;
+      m_Image = texture.image;
+      m_ImageLayout = static_cast<vk::ImageLayout>(texture.imageLayout);
+      m_ImageDescription.Format = static_cast<vk::Format>(texture.imageFormat);
 
-      ktxTexture_Destroy(ktxTexture(kTexture2));
+      ktxVulkanDeviceInfo_Destruct(&kvdi);
     }
 
-    m_Image = texture.image;
-    m_ImageLayout = static_cast<vk::ImageLayout>(texture.imageLayout);
-
-    m_ImageDescription.Format = static_cast<vk::Format>(texture.imageFormat);
+    if (version == 2) {
+      KtxMips mips;
+      if (!ReadKtxMips(path, 0, m_ImageDescription.Streamed ? StreamedTailExtent : UINT32_MAX, mips)) {
+        // Magenta texel so the image stays usable
+        mips = {};
+        mips.Format = vk::Format::eR8G8B8A8Unorm;
+        mips.Width = 1;
+        mips.Height = 1;
+        mips.LevelCount = 1;
+        mips.Data = {255, 0, 255, 255};
+        mips.LevelSizes = {4};
+        vk::BufferImageCopy region = {};
+        region.imageSubresource = vk::ImageSubresourceLayers{vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+        region.imageExtent = vk::Extent3D{1, 1, 1};
+        mips.Regions.emplace_back(region);
+      }
+      UploadKtxMips(mips);
+    }
 
-    ktxVulkanDeviceInfo_Destruct(&kvdi);
+    // Block compressed formats can't be blitted into, the file's mips are used as they are
+    m_MipsLoaded = true;
 
     timer.Stop();
     OX_CORE_TRACE("Image loaded: {}, {} ms",
@@ -588,81 +707,141 @@ namespace Oxylus {
     VulkanUtils::CheckResult(LogicalDevice.createSampler(&sampler, nullptr, &m_Sampler));
   }
 
-  void VulkanImage::GenerateMips() {
+  bool VulkanImage::SupportsLinearBlit() const {
     vk::FormatProperties formatProperties;
     VulkanContext::GetPhysicalDevice().getFormatProperties(m_ImageDescription.Format, &formatProperties);
+    return (bool)(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear);
+  }
 
-    if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
+  void VulkanImage::GenerateMips() {
+    // The mips are left to be filled by the user (e.g. compute passes), only move them out of the transfer layout
+    if (!SupportsLinearBlit()) {
       OX_CORE_WARN("Image format doesn't support linear blitting!");
+      const vk::ImageSubresourceRange subresourceRange{m_ImageDescription.AspectFlag, 0, m_ImageDescription.MipLevels, 0, 1};
+      SetImageLayout(vk::ImageLayout::eTransferDstOptimal, m_ImageDescription.FinalImageLayout, subresourceRange);
       return;
     }
 
     VulkanRenderer::SubmitOnce(m_CommandPool,
       [this](const VulkanCommandBuffer& cmdBuffer) {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.image = GetImage();
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.subresourceRange.levelCount = 1;
-
-        auto mipWidth = (int32_t)GetWidth();
-        auto mipHeight = (int32_t)GetHeight();
-
-        vkCmdPipelineBarrier(cmdBuffer.Get(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-        for (uint32_t i = 1; i < m_ImageDescription.MipLevels; i++) {
-          barrier.subresourceRange.baseMipLevel = i - 1;
-          barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-          barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-          barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-          barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-          vk::ImageMemoryBarrier bar = barrier;
-          cmdBuffer.Get().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 1, &bar);
-
-          VkImageBlit blit{};
-          blit.srcOffsets[0] = {0, 0, 0};
-          blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
-          blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-          blit.srcSubresource.mipLevel = i - 1;
-          blit.srcSubresource.baseArrayLayer = 0;
-          blit.srcSubresource.layerCount = 1;
-          blit.dstOffsets[0] = {0, 0, 0};
-          blit.dstOffsets[1] = {mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1};
-          blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-          blit.dstSubresource.mipLevel = i;
-          blit.dstSubresource.baseArrayLayer = 0;
-          blit.dstSubresource.layerCount = 1;
-          vk::ImageBlit bli = blit;
-          cmdBuffer.Get().blitImage(GetImage(), vk::ImageLayout::eTransferSrcOptimal, GetImage(), vk::ImageLayout::eTransferDstOptimal, 1, &bli, vk::Filter::eLinear);
-
-          barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-          barrier.newLayout = (VkImageLayout)m_ImageDescription.FinalImageLayout;
-          barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-          barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-          vkCmdPipelineBarrier(cmdBuffer.Get(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-          if (mipWidth > 1)
-            mipWidth /= 2;
-          if (mipHeight > 1)
-            mipHeight /= 2;
-        }
-
-        barrier.subresourceRange.baseMipLevel = m_ImageDescription.MipLevels - 1;
-        barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = (VkImageLayout)m_ImageDescription.FinalImageLayout;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        vkCmdPipelineBarrier(cmdBuffer.Get(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-        m_ImageLayout = (vk::ImageLayout)barrier.newLayout;
+        RecordMips(cmdBuffer.Get());
+      });
+  }
+
+  void VulkanImage::RecordMips(const vk::CommandBuffer& commandBuffer) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = GetImage();
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.levelCount = 1;
+
+    auto mipWidth = (int32_t)GetWidth();
+    auto mipHeight = (int32_t)GetHeight();
+
+    for (uint32_t i = 1; i < m_ImageDescription.MipLevels; i++) {
+      barrier.subresourceRange.baseMipLevel = i - 1;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+      barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+      vk::ImageMemoryBarrier bar = barrier;
+      commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, 0, nullptr, 0, nullptr, 1, &bar);
+
+      VkImageBlit blit{};
+      blit.srcOffsets[0] = {0, 0, 0};
+      blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+      blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      blit.srcSubresource.mipLevel = i - 1;
+      blit.srcSubresource.baseArrayLayer = 0;
+      blit.srcSubresource.layerCount = 1;
+      blit.dstOffsets[0] = {0, 0, 0};
+      blit.dstOffsets[1] = {mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1};
+      blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      blit.dstSubresource.mipLevel = i;
+      blit.dstSubresource.baseArrayLayer = 0;
+      blit.dstSubresource.layerCount = 1;
+      vk::ImageBlit bli = blit;
+      commandBuffer.blitImage(GetImage(), vk::ImageLayout::eTransferSrcOptimal, GetImage(), vk::ImageLayout::eTransferDstOptimal, 1, &bli, vk::Filter::eLinear);
+
+      barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+      barrier.newLayout = (VkImageLayout)m_ImageDescription.FinalImageLayout;
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+      barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+      vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+      if (mipWidth > 1)
+        mipWidth /= 2;
+      if (mipHeight > 1)
+        mipHeight /= 2;
+    }
+
+    barrier.subresourceRange.baseMipLevel = m_ImageDescription.MipLevels - 1;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = (VkImageLayout)m_ImageDescription.FinalImageLayout;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    m_ImageLayout = (vk::ImageLayout)barrier.newLayout;
+  }
+
+  void VulkanImage::GenerateDeferredMips(const std::vector<Ref<VulkanImage>>& images) {
+    OX_SCOPED_ZONE;
+    std::vector<vk::ImageMemoryBarrier> barriers;
+    std::vector<VulkanImage*> blittedImages;
+    for (const auto& image : images) {
+      auto& desc = image->m_ImageDescription;
+      if (!desc.DeferMips || desc.MipLevels <= 1)
+        continue;
+      desc.DeferMips = false;
+
+      const bool blit = image->SupportsLinearBlit();
+      if (!blit)
+        OX_CORE_WARN("Image format doesn't support linear blitting!");
+
+      // Level 0 keeps what was uploaded into it, the others are written by the blits
+      vk::ImageMemoryBarrier barrier{};
+      barrier.image = image->m_Image;
+      barrier.newLayout = blit ? vk::ImageLayout::eTransferDstOptimal : desc.FinalImageLayout;
+      barrier.dstAccessMask = blit ? vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eTransferRead : vk::AccessFlagBits::eShaderRead;
+      barrier.oldLayout = image->m_ImageLayout;
+      barrier.subresourceRange = vk::ImageSubresourceRange{desc.AspectFlag, 0, 1, 0, 1};
+      barriers.emplace_back(barrier);
+      barrier.oldLayout = vk::ImageLayout::eUndefined;
+      barrier.subresourceRange = vk::ImageSubresourceRange{desc.AspectFlag, 1, VK_REMAINING_MIP_LEVELS, 0, 1};
+      barriers.emplace_back(barrier);
+
+      if (blit)
+        blittedImages.emplace_back(image.get());
+      else
+        image->m_ImageLayout = desc.FinalImageLayout;
+    }
+
+    if (barriers.empty())
+      return;
+
+    // Uploads are made visible by the upload queue wait every submit gets
+    VulkanRenderer::SubmitOnce(CommandPoolManager::Get()->GetFreePool(),
+      [&barriers, &blittedImages](const VulkanCommandBuffer& cmdBuffer) {
+        cmdBuffer.Get().pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+          vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eFragmentShader,
+          {},
+          nullptr,
+          nullptr,
+          barriers);
+        for (auto* image : blittedImages)
+          image->RecordMips(cmdBuffer.Get());
       });
+
+    for (const auto& image : images)
+      image->DescriptorImageInfo.imageLayout = image->m_ImageLayout;
   }
 
   vk::DescriptorSet VulkanImage::CreateDescriptorSet() const {
@@ -791,7 +970,8 @@ namespace Oxylus {
       if (view)
       LogicalDevice.destroyImageView(view, nullptr);
     }
-    vmaDestroyImage(VulkanContext::GetAllocator(), m_Image, m_Allocation);
+    if (m_Image)
+      vmaDestroyImage(VulkanContext::GetAllocator(), m_Image, m_Allocation);
     GPUMemory::TotalFreed += ImageSize;
     if (m_Sampler) {
       LogicalDevice.destroySampler(m_Sampler);
@@ -2,6 +2,7 @@
 #include <future>
 #include <vk_mem_alloc.h>
 
+#include "UploadManager.h"
 #include "VulkanCommandBuffer.h"
 #include "Core/Base.h"
 #include "Core/Types.h"
@@ -40,6 +41,8 @@ namespace Oxylus {
     bool CreateDescriptorSet = false;
     bool FlipOnLoad = false;
     bool TransitionLayoutAtCreate = true;
+    bool DeferMips = false;     // Mips are left to `GenerateDeferredMips`, which generates them for many images in one submit.
+    bool Streamed = false;      // KTX2 only. Loads the small mips, the TextureStreamer brings in the larger ones.
     vk::DescriptorSetLayout DescriptorSetLayout; //Optional
     vk::Filter MinFiltering = vk::Filter::eLinear;
     vk::Filter MagFiltering = vk::Filter::eLinear;
@@ -47,10 +50,26 @@ namespace Oxylus {
     vk::SamplerAddressMode SamplerAddressMode = vk::SamplerAddressMode::eRepeat;
     int32_t ImageArrayLayerCount = 1;
     int32_t BaseArrayLayerIndex = 0;
+    VmaAllocation AliasAllocation = nullptr; // Optional. If set the image is bound to this allocation instead of owning its memory.
   };
 
   class VulkanImage { 
   public:
+    /// Transcoded levels of a KTX2 file, ready to be uploaded.
+    struct KtxMips {
+      vk::Format Format = vk::Format::eUndefined;
+      uint32_t Width = 0;      // Of level 0
+      uint32_t Height = 0;
+      uint32_t LevelCount = 0; // Of the whole chain
+      uint32_t FirstLevel = 0; // First level held in Data
+      std::vector<uint8_t> Data{};
+      std::vector<vk::BufferImageCopy> Regions{}; // Relative to Data and FirstLevel
+      std::vector<uint64_t> LevelSizes{};         // Of the whole chain
+    };
+
+    /// Streamed images load the levels up to this size at first.
+    static constexpr uint32_t StreamedTailExtent = 128;
+
     vk::DescriptorImageInfo DescriptorImageInfo;
     std::string Name = "Image";
     bool LoadCallback = false; //True when an image is loaded.
@@ -71,6 +90,19 @@ namespace Oxylus {
                                     bool flipY = false,
                                     bool srgb = true);
 
+    /// Reads and transcodes the levels starting at firstLevel, skipping the ones larger than maxExtent.
+    /// Doesn't touch the device, can be called from any thread.
+    static bool ReadKtxMips(const std::string& path, uint32_t firstLevel, uint32_t maxExtent, KtxMips& mips);
+    /// Uploads the mips into new resources for a streamed image without touching it. Frames don't wait for the
+    /// upload, the staged resources are swapped in with SetStreamedMips once the ticket is complete.
+    VulkanImage StageStreamedMips(const KtxMips& mips, UploadManager::Ticket& ticket) const;
+    /// Replaces the resources of a streamed image with staged ones.
+    /// Returns the previous resources, destroy them once no frame in flight uses them.
+    VulkanImage SetStreamedMips(const VulkanImage& staged);
+
+    /// Generates the mips of images created with `DeferMips` in a single submit.
+    static void GenerateDeferredMips(const std::vector<Ref<VulkanImage>>& images);
+
     void SetImageLayout(vk::ImageLayout oldImageLayout,
                         vk::ImageLayout newImageLayout,
                         const vk::ImageSubresourceRange& subresourceRange,
@@ -85,6 +117,9 @@ namespace Oxylus {
     const vk::DescriptorSet& GetDescriptorSet() const { return m_DescSet; }
     const vk::DescriptorImageInfo& GetDescImageInfo() const { return DescriptorImageInfo; }
     const vk::ImageLayout& GetImageLayout() const { return m_ImageLayout; }
+    /// Finest level of the mip chain the image holds, only streamed images are missing levels.
+    uint32_t GetResidentMip() const { return m_ResidentMip; }
+    const std::vector<uint64_t>& GetLevelSizes() const { return m_LevelSizes; }
     std::vector<vk::DescriptorImageInfo> GetMipDescriptors() const;
     static VulkanImageDescription GetColorAttachmentImageDescription(vk::Format format,
                                                                      uint32_t width,
@@ -92,6 +127,8 @@ namespace Oxylus {
     static Ref<VulkanImage> GetBlankImage();
     static IVec3 GetMipMapLevelSize(uint32_t width, uint32_t height, uint32_t depth, uint32_t level);
     static uint32_t GetMaxMipmapLevel(uint32_t width, uint32_t height, uint32_t depth);
+    /// Memory requirements of an image created from the description, without creating it.
+    static vk::MemoryRequirements GetMemoryRequirements(const VulkanImageDescription& imageDescription);
 
     void Destroy() const;
 
@@ -100,11 +137,15 @@ namespace Oxylus {
     void LoadCubeMapFromFile(int version);
     void LoadKtxFile(int version = 1);
     void LoadStbFile();
+    UploadManager::Ticket UploadKtxMips(const KtxMips& mips, bool streamed = false);
     void CreateImage();
+    static vk::ImageCreateInfo GetImageCreateInfo(const VulkanImageDescription& imageDescription);
     void LoadAndCreateResources(bool hasPath);
     std::vector<vk::ImageView> CreateImageView(uint32_t mipmapIndex = 0) const;
     void CreateSampler();
     void GenerateMips();
+    bool SupportsLinearBlit() const;
+    void RecordMips(const vk::CommandBuffer& commandBuffer);
     void TransitionLayout();
     vk::DescriptorSet CreateDescriptorSet() const;
 
@@ -115,6 +156,9 @@ namespace Oxylus {
     vk::DescriptorSet m_DescSet = {};
     VulkanImageDescription m_ImageDescription = {};
     const uint8_t* m_ImageData = nullptr;
+    bool m_MipsLoaded = false; // Mips came with the file and the image is already in its final layout
+    uint32_t m_ResidentMip = 0;
+    std::vector<uint64_t> m_LevelSizes = {}; // Of KTX2 files
     VmaAllocation m_Allocation = {};
     vk::CommandPool m_CommandPool = {};
   };
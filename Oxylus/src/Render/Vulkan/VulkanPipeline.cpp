@@ -1,14 +1,91 @@
 ﻿#include "VulkanPipeline.h"
 
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <future>
 
+#include "Core/Resources.h"
 #include "Render/ShaderLibrary.h"
+#include "Thread/JobSystem.h"
 #include "VulkanContext.h"
+#include "Utils/Profiler.h"
 #include "Utils/VulkanUtils.h"
 
 namespace Oxylus {
   vk::PipelineCache VulkanPipeline::s_Cache;
 
+  static std::filesystem::path GetPipelineCachePath() {
+    return Resources::GetResourcesPath("Shaders/Compiled/PipelineCache.bin");
+  }
+
+  // Some drivers crash on caches of other devices instead of rejecting them, so the header is checked up front
+  static bool IsPipelineCacheCompatible(const std::vector<char>& data) {
+    if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+      return false;
+    VkPipelineCacheHeaderVersionOne header;
+    std::memcpy(&header, data.data(), sizeof header);
+    const auto& properties = VulkanContext::Context.DeviceProperties;
+    return header.headerSize >= sizeof header &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+  }
+
+  void VulkanPipeline::InitCache() {
+    OX_SCOPED_ZONE;
+    std::vector<char> data;
+    std::ifstream in(GetPipelineCachePath(), std::ios::in | std::ios::binary | std::ios::ate);
+    if (in.is_open()) {
+      data.resize((size_t)in.tellg());
+      in.seekg(0, std::ios::beg);
+      in.read(data.data(), (std::streamsize)data.size());
+      if (!in || !IsPipelineCacheCompatible(data)) {
+        OX_CORE_WARN("Pipeline cache was written by another device or driver, starting with an empty one");
+        data.clear();
+      }
+    }
+
+    vk::PipelineCacheCreateInfo createInfo;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.data();
+    auto result = VulkanContext::GetDevice().createPipelineCache(createInfo);
+    if (result.result != vk::Result::eSuccess && !data.empty()) {
+      // The driver can still refuse data that passed the header check
+      createInfo.initialDataSize = 0;
+      createInfo.pInitialData = nullptr;
+      result = VulkanContext::GetDevice().createPipelineCache(createInfo);
+    }
+    VulkanUtils::CheckResult(result.result);
+    s_Cache = result.value;
+    OX_CORE_TRACE("Pipeline cache loaded with {} bytes", data.size());
+  }
+
+  void VulkanPipeline::ReleaseCache() {
+    if (!s_Cache)
+      return;
+
+    const auto& LogicalDevice = VulkanContext::GetDevice();
+    const auto cacheData = LogicalDevice.getPipelineCacheData(s_Cache);
+    const auto& data = cacheData.value;
+    if (cacheData.result == vk::Result::eSuccess && !data.empty()) {
+      const auto path = GetPipelineCachePath();
+      std::error_code error;
+      std::filesystem::create_directories(path.parent_path(), error);
+      auto temporaryPath = path;
+      temporaryPath += ".tmp";
+      std::ofstream out(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (out.is_open()) {
+        out.write((const char*)data.data(), (std::streamsize)data.size());
+        out.close();
+        std::filesystem::rename(temporaryPath, path, error);
+      }
+    }
+    LogicalDevice.destroyPipelineCache(s_Cache);
+    s_Cache = nullptr;
+  }
+
   void VulkanPipeline::CreateGraphicsPipeline(PipelineDescription& pipelineSpecification) {
     const auto& LogicalDevice = VulkanContext::Context.Device;
 
@@ -242,7 +319,7 @@ namespace Oxylus {
   }
 
   std::future<void> VulkanPipeline::CreateGraphicsPipelineAsync(PipelineDescription& pipelineSpecification) {
-    return std::async([this, &pipelineSpecification] {
+    return JobSystem::ExecuteAsync([this, &pipelineSpecification] {
       CreateGraphicsPipeline(pipelineSpecification);
     });
   }
@@ -305,7 +382,7 @@ namespace Oxylus {
   }
 
   std::future<void> VulkanPipeline::CreateComputePipelineAsync(const PipelineDescription& pipelineSpecification) {
-    return std::async([this, &pipelineSpecification] {
+    return JobSystem::ExecuteAsync([this, &pipelineSpecification] {
       CreateComputePipeline(pipelineSpecification);
     });
   }
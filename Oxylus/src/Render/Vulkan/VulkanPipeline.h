@@ -164,6 +164,12 @@ namespace Oxylus {
     const std::vector<vk::DescriptorSetLayout>& GetDescriptorSetLayout() const { return m_DescriptorSetLayouts; }
     Ref<VulkanShader> GetShader() { return m_Shader; }
 
+    /// Loads the pipeline cache written by the last run. Files written by another device or driver are ignored,
+    /// so the cache starts out empty for them.
+    static void InitCache();
+    /// Writes the cache to disk and destroys it.
+    static void ReleaseCache();
+
   private:
     vk::Pipeline m_Pipeline;
     vk::PipelineLayout m_Layout;
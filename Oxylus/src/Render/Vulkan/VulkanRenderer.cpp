@@ -2,17 +2,20 @@
 
 #include <future>
 
+#include "UploadManager.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanContext.h"
 #include "VulkanPipeline.h"
 #include "VulkanSwapchain.h"
 #include "Utils/VulkanUtils.h"
 #include "Core/Resources.h"
+#include "Render/GeometryBuffer.h"
 #include "Render/Mesh.h"
 #include "Render/Window.h"
 #include "Render/Vulkan/VulkanBuffer.h"
 #include "Render/ResourcePool.h"
 #include "Render/ShaderLibrary.h"
+#include "Render/TextureStreamer.h"
 #include "Utils/Profiler.h"
 
 #include <backends/imgui_impl_vulkan.h>
@@ -61,6 +64,11 @@ namespace Oxylus {
     s_CommandPoolManager = CreateRef<CommandPoolManager>();
     s_CommandPoolManager->Init();
 
+    UploadManager::Init();
+    GeometryBuffer::Init();
+    TextureStreamer::Init();
+    VulkanPipeline::InitCache();
+
     s_SwapChain.SetVsync(RendererConfig::Get()->DisplayConfig.VSync, false);
     s_SwapChain.CreateSwapChain();
 
@@ -147,29 +155,14 @@ namespace Oxylus {
         {{3.0f, -1.0f, 0.0f}, {}, {2.0f, 1.0f}},
       };
 
-      VulkanBuffer vertexStaging;
-
       uint64_t vBufferSize = (uint32_t)vertexBuffer.size() * sizeof(RendererData::Vertex);
 
-      vertexStaging.CreateBuffer(vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-        vBufferSize,
-        vertexBuffer.data());
-
       s_TriangleVertexBuffer.CreateBuffer(
         vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
         vk::MemoryPropertyFlagBits::eDeviceLocal,
         vBufferSize);
 
-      SubmitOnce(CommandPoolManager::Get()->GetFreePool(),
-        [&vBufferSize, &vertexStaging](const VulkanCommandBuffer copyCmd) {
-          vk::BufferCopy copyRegion{};
-
-          copyRegion.size = vBufferSize;
-          vertexStaging.CopyTo(s_TriangleVertexBuffer.Get(), copyCmd.Get(), copyRegion);
-        });
-
-      vertexStaging.Destroy();
+      UploadManager::Get()->UploadBuffer(s_TriangleVertexBuffer.Get(), 0, vertexBuffer.data(), vBufferSize);
     }
 
     // Debug renderer
@@ -190,6 +183,11 @@ namespace Oxylus {
   void VulkanRenderer::Shutdown() {
     RendererConfig::Get()->SaveConfig("renderer.oxconfig");
     DebugRenderer::Release();
+    TextureStreamer::Release();
+    UploadManager::Release();
+    GeometryBuffer::Release();
+    VulkanPipeline::ReleaseCache();
+    ImagePool::Release();
     s_DescriptorPoolManager->Release();
     s_CommandPoolManager->Release();
 #if GPU_PROFILER_ENABLED
@@ -68,11 +68,37 @@ namespace Oxylus {
     return "";
   }
 
-  std::filesystem::path VulkanShader::GetCachedDirectory(const vk::ShaderStageFlagBits stage,
-                                                         const std::filesystem::path& cacheDirectory) {
-    return cacheDirectory / m_VulkanFilePath[stage].stem()
-                                                   .string()
-                                                   .append(GetCompiledFileExtension(stage));
+  /// Changes whenever cached binaries have to be thrown away, e.g. when the compiler or the key changes.
+  static constexpr uint32_t CacheVersion = 1;
+
+  // FNV-1a, unlike std::hash it stays the same between runs, builds and platforms
+  static uint64_t HashString(const std::string_view data, uint64_t hash = 14695981039346656037ull) {
+    for (const char c : data) {
+      hash ^= (uint8_t)c;
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  static std::string GetCachedFileName(const std::filesystem::path& sourcePath, const vk::ShaderStageFlagBits stage, const uint64_t hash) {
+    return fmt::format("{}_{:016x}{}", sourcePath.stem().string(), hash, GetCompiledFileExtension(stage));
+  }
+
+  // Removes the binaries that earlier versions of the source left behind
+  static void RemoveStaleCachedFiles(const std::filesystem::path& sourcePath, const vk::ShaderStageFlagBits stage, const std::string& currentName) {
+    const std::string prefix = sourcePath.stem().string() + "_";
+    const std::string_view extension = GetCompiledFileExtension(stage);
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(GetCacheDirectory(), error)) {
+      const std::string name = entry.path().filename().string();
+      if (name == currentName || name.size() != currentName.size() || !name.starts_with(prefix) || !name.ends_with(extension))
+        continue;
+      // Stems that only share a prefix, e.g. "PBR" and "PBR_Blend", don't have a hash in the same place
+      const std::string_view hash = std::string_view(name).substr(prefix.size(), 16);
+      if (hash.find_first_not_of("0123456789abcdef") != std::string_view::npos)
+        continue;
+      std::filesystem::remove(entry.path(), error);
+    }
   }
 
   static shaderc_shader_kind GLShaderStageToShaderC(vk::ShaderStageFlagBits stage) {
@@ -97,29 +123,36 @@ namespace Oxylus {
     ProfilerTimer timer;
 
     shaderc::CompileOptions options;
-    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
-    options.SetTargetSpirv(shaderc_spirv_version_1_6);
 #if defined (OX_RELEASE) || defined (OX_DISTRIBUTION)
-    options.SetOptimizationLevel(shaderc_optimization_level_performance);
+    constexpr auto optimizationLevel = shaderc_optimization_level_performance;
 #else
-    options.SetOptimizationLevel(shaderc_optimization_level_zero);
+    constexpr auto optimizationLevel = shaderc_optimization_level_zero;
 #endif
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+    options.SetTargetSpirv(shaderc_spirv_version_1_6);
+    options.SetOptimizationLevel(optimizationLevel);
     options.SetIncluder(std::make_unique<Includer>());
+    // Every option above that changes the generated code has to be part of the key. Macro definitions are already
+    // applied to the preprocessed source the key is hashed with.
+    const std::string optionsKey = fmt::format("v{} env:vulkan1.3 spirv:1.6 opt:{} entry:{}",
+                                               CacheVersion,
+                                               (int)optimizationLevel,
+                                               m_ShaderDesc.EntryPoint);
 
     if (!m_ShaderDesc.ComputePath.empty()) {
       m_VulkanFilePath[vk::ShaderStageFlagBits::eCompute] = m_ShaderDesc.ComputePath;
       const auto& content = FileUtils::ReadFile(m_ShaderDesc.ComputePath);
-      ReadOrCompile(vk::ShaderStageFlagBits::eCompute, content.value_or(""), options);
+      ReadOrCompile(vk::ShaderStageFlagBits::eCompute, content.value_or(""), options, optionsKey);
     }
     if (!m_ShaderDesc.VertexPath.empty()) {
       m_VulkanFilePath[vk::ShaderStageFlagBits::eVertex] = m_ShaderDesc.VertexPath;
       const auto& content = FileUtils::ReadFile(m_ShaderDesc.VertexPath);
-      ReadOrCompile(vk::ShaderStageFlagBits::eVertex, content.value_or(""), options);
+      ReadOrCompile(vk::ShaderStageFlagBits::eVertex, content.value_or(""), options, optionsKey);
     }
     if (!m_ShaderDesc.FragmentPath.empty()) {
       m_VulkanFilePath[vk::ShaderStageFlagBits::eFragment] = m_ShaderDesc.FragmentPath;
       const auto& content = FileUtils::ReadFile(m_ShaderDesc.FragmentPath);
-      ReadOrCompile(vk::ShaderStageFlagBits::eFragment, content.value_or(""), options);
+      ReadOrCompile(vk::ShaderStageFlagBits::eFragment, content.value_or(""), options, optionsKey);
     }
 
     for (auto&& [stage, source] : m_VulkanSPIRV) {
@@ -171,37 +204,60 @@ namespace Oxylus {
 
   void VulkanShader::ReadOrCompile(vk::ShaderStageFlagBits stage,
                                    const std::string& source,
-                                   const shaderc::CompileOptions& options) {
-    std::filesystem::path cacheDirectory = GetCacheDirectory();
-    std::filesystem::path cachedPath = GetCachedDirectory(stage, cacheDirectory);
-    std::ifstream in(cachedPath, std::ios::in | std::ios::binary);
+                                   const shaderc::CompileOptions& options,
+                                   const std::string_view optionsKey) {
+    OX_SCOPED_ZONE;
+    const auto& sourcePath = m_VulkanFilePath[stage];
+    OX_CORE_ASSERT(!source.empty(), fmt::format("Couldn't read the shader source: {}", sourcePath.string()).c_str());
+
+    // Includes are resolved by the preprocessor, so editing one of them changes the key as well
+    shaderc::Compiler compiler;
+    const auto kind = GLShaderStageToShaderC(stage);
+    const auto preprocessed = compiler.PreprocessGlsl(source, kind, sourcePath.string().c_str(), options);
+    if (preprocessed.GetCompilationStatus() != shaderc_compilation_status_success) {
+      OX_CORE_ERROR(preprocessed.GetErrorMessage());
+    }
+    const std::string preprocessedSource(preprocessed.cbegin(), preprocessed.cend());
+    const uint64_t hash = HashString(preprocessedSource, HashString(optionsKey));
+    const std::string cachedName = GetCachedFileName(sourcePath, stage, hash);
+    const std::filesystem::path cachedPath = std::filesystem::path(GetCacheDirectory()) / cachedName;
+
+    auto& data = m_VulkanSPIRV[stage];
+    std::ifstream in(cachedPath, std::ios::in | std::ios::binary | std::ios::ate);
     if (in.is_open()) {
-      in.seekg(0, std::ios::end);
-      auto size = in.tellg();
+      const auto size = (size_t)in.tellg();
       in.seekg(0, std::ios::beg);
-
-      auto& data = m_VulkanSPIRV[stage];
       data.resize(size / sizeof(uint32_t));
-      in.read((char*)data.data(), size);
+      in.read((char*)data.data(), (std::streamsize)(data.size() * sizeof(uint32_t)));
+      // Anything that isn't a whole SPIR-V module gets compiled again
+      constexpr uint32_t spirvMagic = 0x07230203;
+      if (!in || size % sizeof(uint32_t) != 0 || data.empty() || data[0] != spirvMagic)
+        data.clear();
     }
-    else if (!source.empty()) {
-      shaderc::Compiler compiler;
-      shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(source,
-        GLShaderStageToShaderC(stage),
-        m_VulkanFilePath[stage].string().c_str(),
+
+    if (data.empty() && !preprocessedSource.empty()) {
+      const shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(preprocessedSource,
+        kind,
+        sourcePath.string().c_str(),
         options);
       if (module.GetCompilationStatus() != shaderc_compilation_status_success) {
         OX_CORE_ERROR(module.GetErrorMessage());
       }
-
-      m_VulkanSPIRV[stage] = std::vector(module.cbegin(), module.cend());
-
-      std::ofstream out(cachedPath, std::ios::out | std::ios::binary);
+      data = std::vector(module.cbegin(), module.cend());
+
+      // Written next to the final path first, so a crash or another process never sees half a file
+      std::filesystem::path temporaryPath = cachedPath;
+      temporaryPath += ".tmp";
+      std::ofstream out;
+      if (!data.empty())
+        out.open(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
       if (out.is_open()) {
-        auto& data = m_VulkanSPIRV[stage];
-        out.write((char*)data.data(), data.size() * sizeof(uint32_t));
-        out.flush();
+        out.write((char*)data.data(), (std::streamsize)(data.size() * sizeof(uint32_t)));
         out.close();
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, cachedPath, error);
+        if (!error)
+          RemoveStaleCachedFiles(sourcePath, stage, cachedName);
       }
     }
     OX_CORE_ASSERT(!m_VulkanSPIRV[stage].empty());
@@ -365,13 +421,8 @@ namespace Oxylus {
   }
 
   void VulkanShader::Reload() {
+    // Edited sources hash to a new cache entry, so nothing has to be deleted to pick them up
     VulkanRenderer::WaitDeviceIdle();
-    // Delete compiled files
-    for (const auto& [stage, flag] : m_ShaderStage) {
-      const std::filesystem::path cacheDirectory = GetCacheDirectory();
-      std::filesystem::path cachedPath = GetCachedDirectory(stage, cacheDirectory);
-      std::filesystem::remove(cachedPath);
-    }
     m_OnReloadBeginEvent();
     Unload();
     CreateShader();
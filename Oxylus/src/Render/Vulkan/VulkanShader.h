@@ -58,11 +58,14 @@ namespace Oxylus {
     bool m_Loaded = false;
 
     void CreateShader();
-    void ReadOrCompile(vk::ShaderStageFlagBits stage, const std::string& source, const shaderc::CompileOptions& options);
+    /// Compiled stages are cached under a hash of the preprocessed source and `optionsKey`, so editing the shader,
+    /// one of its includes or the compile options never loads a stale binary.
+    void ReadOrCompile(vk::ShaderStageFlagBits stage,
+                       const std::string& source,
+                       const shaderc::CompileOptions& options,
+                       std::string_view optionsKey);
     void CreateShaderModule(vk::ShaderStageFlagBits stage, const std::vector<unsigned>& source);
 
-    std::filesystem::path GetCachedDirectory(vk::ShaderStageFlagBits stage, const std::filesystem::path& cacheDirectory);
-
     // Layouts
     std::vector<vk::DescriptorSetLayout> m_DescriptorSetLayouts = {};
     vk::PipelineLayout m_PipelineLayout;
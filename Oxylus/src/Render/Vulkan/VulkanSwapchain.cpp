@@ -1,4 +1,5 @@
 ﻿#include "VulkanSwapchain.h"
+#include "UploadManager.h"
 #include "VulkanContext.h"
 #include "VulkanRenderer.h"
 #include "Utils/VulkanUtils.h"
@@ -281,10 +282,16 @@ namespace Oxylus {
     submitInfo.pCommandBuffers = &GetCommandBuffer().Get();
     submitInfo.signalSemaphoreCount = 1;
     submitInfo.pSignalSemaphores = &RenderCompleteSemaphores[CurrentFrame];
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = &ImageAcquiredSemaphores[CurrentFrame];
-    const vk::PipelineStageFlags pipelineStageFlags = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-    submitInfo.pWaitDstStageMask = &pipelineStageFlags;
+    // UI images may still be uploading
+    std::vector waitSemaphores = {ImageAcquiredSemaphores[CurrentFrame]};
+    std::vector<vk::PipelineStageFlags> waitStages = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
+    std::vector<uint64_t> waitValues = {0};
+    UploadManager::Get()->AddSubmitWait(waitSemaphores, waitStages, waitValues);
+    const vk::TimelineSemaphoreSubmitInfo timelineInfo{(uint32_t)waitValues.size(), waitValues.data()};
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
 
     VulkanUtils::CheckResult(
       VulkanContext::VulkanQueue.GraphicsQueue.submit(1, &submitInfo, InFlightFences[CurrentFrame]));
@@ -31,17 +31,17 @@ namespace Oxylus {
     }
 
     if (entity.HasComponent<RelationshipComponent>()) {
-      const auto& [Parent, Children] = entity.GetComponent<RelationshipComponent>();
+      const Entity parent = entity.GetParent();
 
       auto node = entityNode["RelationshipComponent"];
       node |= ryml::MAP;
-      node["Parent"] << Parent;
-      node["ChildCount"] << (uint32_t)Children.size();
+      node["Parent"] << (parent ? parent.GetUUID() : UUID(0));
+      node["ChildCount"] << entity.GetRelationship().ChildCount;
       auto childrenNode = node["Children"];
       childrenNode |= ryml::SEQ;
-      for (size_t i = 0; i < Children.size(); i++) {
-        childrenNode.append_child() << Children[i];
-      }
+      entity.ForEachChild([&childrenNode](Entity child) {
+        childrenNode.append_child() << child.GetUUID();
+      });
     }
 
     if (entity.HasComponent<TransformComponent>()) {
@@ -64,6 +64,17 @@ namespace Oxylus {
       node["SubmeshIndex"] << mrc.SubmesIndex;
     }
 
+    if (entity.HasComponent<AnimationComponent>()) {
+      const auto& ac = entity.GetComponent<AnimationComponent>();
+      auto node = entityNode["AnimationComponent"];
+      node |= ryml::MAP;
+      node["ClipIndex"] << ac.ClipIndex;
+      node["Speed"] << ac.Speed;
+      node["Loop"] << ac.Loop;
+      node["BlendClipIndex"] << ac.BlendClipIndex;
+      node["BlendWeight"] << ac.BlendWeight;
+    }
+
     if (entity.HasComponent<MaterialComponent>()) {
       const auto& mc = entity.GetComponent<MaterialComponent>();
       auto node = entityNode["MaterialComponent"];
@@ -243,6 +254,38 @@ namespace Oxylus {
     }
   }
 
+  void EntitySerializer::DeserializeChildren(ryml::ConstNodeRef entityNode,
+                                             Scene* scene,
+                                             const std::unordered_map<UUID, UUID>& idMap) {
+    if (!entityNode.has_child("RelationshipComponent"))
+      return;
+
+    const auto mapId = [&idMap](UUID id) {
+      const auto it = idMap.find(id);
+      return it != idMap.end() ? it->second : id;
+    };
+
+    const auto st = std::string(entityNode["Entity"].val().data());
+    const uint64_t entityID = std::stoull(st.substr(0, st.find('\n')));
+    const Entity parent = scene->GetEntityByUUID(mapId(entityID));
+    if (!parent)
+      return;
+
+    const auto node = entityNode["RelationshipComponent"];
+    size_t childCount = 0;
+    node["ChildCount"] >> childCount;
+    const auto children = node["Children"];
+
+    if (children.num_children() == childCount) {
+      for (size_t i = 0; i < childCount; i++) {
+        uint64_t childID = 0;
+        children[i] >> childID;
+        if (const Entity child = childID ? scene->GetEntityByUUID(mapId(childID)) : Entity{})
+          child.SetParent(parent);
+      }
+    }
+  }
+
   UUID EntitySerializer::DeserializeEntity(ryml::ConstNodeRef entityNode, Scene* scene, bool preserveUUID) {
     const auto st = std::string(entityNode["Entity"].val().data());
     const uint64_t uuid = std::stoull(st.substr(0, st.find('\n')));
@@ -266,30 +309,6 @@ namespace Oxylus {
       glm::read(node["Scale"], &tc.Scale);
     }
 
-    if (entityNode.has_child("RelationshipComponent")) {
-      auto& rc = deserializedEntity.GetComponent<RelationshipComponent>();
-      const auto node = entityNode["RelationshipComponent"];
-      uint64_t parentID = 0;
-      node["Parent"] >> parentID;
-      rc.Parent = parentID;
-
-      size_t childCount = 0;
-      node["ChildCount"] >> childCount;
-      rc.Children.clear();
-      rc.Children.reserve(childCount);
-      const auto children = node["Children"];
-
-      if (children.num_children() == childCount) {
-        for (size_t i = 0; i < childCount; i++) {
-          uint64_t childID = 0;
-          children[i] >> childID;
-          UUID child = childID;
-          if (child)
-            rc.Children.push_back(child);
-        }
-      }
-    }
-
     if (entityNode.has_child("MeshRendererComponent")) {
       const auto& node = entityNode["MeshRendererComponent"];
 
@@ -304,6 +323,16 @@ namespace Oxylus {
       submeshIndex;
     }
 
+    if (entityNode.has_child("AnimationComponent")) {
+      auto& ac = deserializedEntity.AddComponentI<AnimationComponent>();
+      const auto& node = entityNode["AnimationComponent"];
+      node["ClipIndex"] >> ac.ClipIndex;
+      node["Speed"] >> ac.Speed;
+      node["Loop"] >> ac.Loop;
+      node["BlendClipIndex"] >> ac.BlendClipIndex;
+      node["BlendWeight"] >> ac.BlendWeight;
+    }
+
     if (entityNode.has_child("MaterialComponent")) {
       auto& mc = deserializedEntity.AddComponentI<MaterialComponent>();
 
@@ -582,17 +611,8 @@ namespace Oxylus {
 
       rootEntity.AddComponentI<PrefabComponent>().ID = prefabID;
 
-      // Fix parent/children UUIDs
-      for (const auto& [_, newId] : oldNewIdMap) {
-        auto& relationshipComponent = scene->GetEntityByUUID(newId).GetRelationship();
-        UUID parent = relationshipComponent.Parent;
-        if (parent)
-          relationshipComponent.Parent = oldNewIdMap.at(parent);
-
-        auto& children = relationshipComponent.Children;
-        for (auto& id : children)
-          id = oldNewIdMap.at(id);
-      }
+      for (const auto& entity : entitiesNode)
+        DeserializeChildren(entity, scene, oldNewIdMap);
 
       return rootEntity;
     }
@@ -14,6 +14,8 @@ namespace Oxylus {
     static void SerializeEntity(Scene* scene, ryml::NodeRef& entities, Entity entity);
 
     static UUID DeserializeEntity(ryml::ConstNodeRef entityNode, Scene* scene, bool preserveUUID);
+    /// Links the serialized children to an entity once all of them were deserialized. idMap remaps serialized UUIDs.
+    static void DeserializeChildren(ryml::ConstNodeRef entityNode, Scene* scene, const std::unordered_map<UUID, UUID>& idMap = {});
 
     static void SerializeEntityAsPrefab(const char* filepath, Entity entity);
 
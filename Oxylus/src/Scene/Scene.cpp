@@ -3,22 +3,24 @@
 #include "Core/Entity.h"
 #include "Render/Camera.h"
 #include "Render/Vulkan/VulkanRenderer.h"
+#include "Thread/JobSystem.h"
 #include "Utils/Profiler.h"
 #include "Utils/Timestep.h"
 
 #include <glm/glm.hpp>
 
+#include <tuple>
 #include <unordered_map>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "Jolt/Physics/Body/BodyLock.h"
+#include "Jolt/Physics/Body/BodyLockMulti.h"
 #include "Jolt/Physics/Character/Character.h"
 #include "Jolt/Physics/Collision/Shape/CapsuleShape.h"
-#include "Jolt/Physics/Collision/Shape/CylinderShape.h"
-#include "Jolt/Physics/Collision/Shape/MutableCompoundShape.h"
 #include "Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h"
-#include "Jolt/Physics/Collision/Shape/TaperedCapsuleShape.h"
 #include "Physics/PhysicsMaterial.h"
 #include "Physics/PhysicsUtils.h"
+#include "Physics/ShapeCache.h"
 
 namespace Oxylus {
   Scene::Scene() {
@@ -74,6 +76,7 @@ namespace Oxylus {
 
     while (m_PhysicsFrameAccumulator >= physicsTs) {
       Physics::Step(physicsTs);
+      m_ContactListener3D->TakeEvents(m_ContactEvents);
 
       m_PhysicsFrameAccumulator -= physicsTs;
       stepped = true;
@@ -81,46 +84,72 @@ namespace Oxylus {
 
     const float interpolationFactor = m_PhysicsFrameAccumulator / physicsTs;
 
-    const auto& bodyInterface = Physics::GetPhysicsSystem()->GetBodyInterface();
-    const auto view = m_Registry.group<RigidbodyComponent>(entt::get<TransformComponent>);
-    for (auto&& [e, rb, tc] : view.each()) {
-      if (!rb.RuntimeBody)
-        continue;
-
-      PhysicsUtils::DebugDraw(this, e);
-
-      const auto* body = static_cast<const JPH::Body*>(rb.RuntimeBody);
-
-      if (!bodyInterface.IsActive(body->GetID()))
-        continue;
-
-      if (rb.Interpolation) {
-        if (stepped) {
-          JPH::Vec3 position = body->GetPosition();
-          JPH::Vec3 rotation = body->GetRotation().GetEulerAngles();
-
-          rb.PreviousTranslation = rb.Translation;
-          rb.PreviousRotation = rb.Rotation;
-          rb.Translation = {position.GetX(), position.GetY(), position.GetZ()};
-          rb.Rotation = glm::vec3(rotation.GetX(), rotation.GetY(), rotation.GetZ());
-        }
+    // Only bodies that moved are synced. Sleeping bodies are left alone, the ones that fell asleep during the last
+    // steps are synced one last time so they rest where the simulation left them.
+    std::vector<JPH::BodyID> bodyIds = m_BodyActivationListener3D->GetActiveBodies();
+    const uint32_t activeCount = (uint32_t)bodyIds.size();
+    if (stepped)
+      m_BodyActivationListener3D->TakeDeactivatedBodies(bodyIds);
+
+    // Grab the storages up front, the jobs below must not touch the registry itself
+    auto& transforms = m_Registry.storage<TransformComponent>();
+    const auto& rigidbodies = m_Registry.storage<RigidbodyComponent>();
+    auto& poses = m_RigidbodyPoses;
+    const auto getEntity = [&poses, &rigidbodies](const JPH::BodyID& id) {
+      // Character bodies are active too but aren't rigidbodies
+      const uint32_t index = id.GetIndex();
+      return index < poses.Entities.size() && rigidbodies.contains(poses.Entities[index]) ? poses.Entities[index] : entt::entity(entt::null);
+    };
+
+    if (stepped) {
+      OX_SCOPED_ZONE_N("Read Rigidbody Poses");
+      const JPH::BodyLockMultiRead lock(Physics::GetPhysicsSystem()->GetBodyLockInterface(), bodyIds.data(), (int)bodyIds.size());
+      JobSystem::ParallelFor((uint32_t)bodyIds.size(),
+        256,
+        [&](const uint32_t i) {
+          const JPH::Body* body = lock.GetBody((int)i);
+          const entt::entity e = getEntity(bodyIds[i]);
+          if (!body || e == entt::null)
+            return;
+
+          const uint32_t index = bodyIds[i].GetIndex();
+          const JPH::RVec3 position = body->GetPosition();
+          const JPH::Quat rotation = body->GetRotation();
+          poses.PreviousTranslations[index] = poses.Translations[index];
+          poses.PreviousRotations[index] = poses.Rotations[index];
+          poses.Translations[index] = {position.GetX(), position.GetY(), position.GetZ()};
+          poses.Rotations[index] = glm::quat(rotation.GetW(), rotation.GetX(), rotation.GetY(), rotation.GetZ());
+
+          // Bodies that fell asleep don't take part in the interpolation below
+          if (i >= activeCount || !rigidbodies.get(e).Interpolation) {
+            auto& tc = transforms.get(e);
+            tc.Translation = poses.Translations[index];
+            tc.Rotation = glm::eulerAngles(poses.Rotations[index]);
+          }
+        });
+    }
 
-        tc.Translation = glm::lerp(rb.PreviousTranslation, rb.Translation, interpolationFactor);
-        tc.Rotation = glm::eulerAngles(glm::slerp(rb.PreviousRotation, rb.Rotation, interpolationFactor));
-      }
-      else {
-        const JPH::Vec3 position = body->GetPosition();
-        JPH::Vec3 rotation = body->GetRotation().GetEulerAngles();
-
-        rb.PreviousTranslation = rb.Translation;
-        rb.PreviousRotation = rb.Rotation;
-        rb.Translation = {position.GetX(), position.GetY(), position.GetZ()};
-        rb.Rotation = glm::vec3(rotation.GetX(), rotation.GetY(), rotation.GetZ());
-        tc.Translation = rb.Translation;
-        tc.Rotation = glm::eulerAngles(rb.Rotation);
-      }
+    {
+      OX_SCOPED_ZONE_N("Interpolate Rigidbodies");
+      JobSystem::ParallelFor(activeCount,
+        256,
+        [&](const uint32_t i) {
+          const entt::entity e = getEntity(bodyIds[i]);
+          if (e == entt::null || !rigidbodies.get(e).Interpolation)
+            return;
+
+          const uint32_t index = bodyIds[i].GetIndex();
+          auto& tc = transforms.get(e);
+          tc.Translation = glm::lerp(poses.PreviousTranslations[index], poses.Translations[index], interpolationFactor);
+          tc.Rotation = glm::eulerAngles(glm::slerp(poses.PreviousRotations[index], poses.Rotations[index], interpolationFactor));
+        });
     }
 
+#ifndef OX_DISTRIBUTION
+    for (const auto e : m_Registry.view<RigidbodyComponent>())
+      PhysicsUtils::DebugDraw(this, e);
+#endif
+
     // Character
     {
       const auto chView = m_Registry.view<TransformComponent, CharacterControllerComponent>();
@@ -151,9 +180,13 @@ namespace Oxylus {
           tc.Translation = ch.Translation;
           tc.Rotation = glm::eulerAngles(ch.Rotation);
         }
+#ifndef OX_DISTRIBUTION
         PhysicsUtils::DebugDraw(this, e);
+#endif
       }
     }
+
+    DispatchContacts();
   }
 
   void Scene::IterateOverMeshNode(const Ref<Mesh>& mesh, const std::vector<Mesh::Node*>& node, Entity parent) {
@@ -181,12 +214,9 @@ namespace Oxylus {
 
   void Scene::DestroyEntity(const Entity entity) {
     entity.Deparent();
-    const auto children = entity.GetComponent<RelationshipComponent>().Children;
-
-    for (size_t i = 0; i < children.size(); i++) {
-      if (const Entity childEntity = GetEntityByUUID(children[i]))
-        DestroyEntity(childEntity);
-    }
+    entity.ForEachChild([this](Entity child) {
+      DestroyEntity(child);
+    });
 
     m_EntityMap.erase(entity.GetUUID());
     m_Registry.destroy(entity);
@@ -234,6 +264,8 @@ namespace Oxylus {
     OX_SCOPED_ZONE;
     const Entity newEntity = CreateEntity(entity.GetName());
     CopyComponentIfExists(AllComponents{}, newEntity, entity);
+    if (const Entity parent = entity.GetParent())
+      newEntity.SetParent(parent);
   }
 
   void Scene::OnRuntimeStart() {
@@ -246,28 +278,21 @@ namespace Oxylus {
     // Physics
     {
       OX_SCOPED_ZONE_N("Physics Start");
-      Physics::Init();
+      const auto project = Project::GetActive();
+      Physics::Init(project ? project->GetConfig().Physics : PhysicsConfig{});
       m_BodyActivationListener3D = new Physics3DBodyActivationListener();
-      m_ContactListener3D = new Physics3DContactListener(this);
+      m_ContactListener3D = new Physics3DContactListener();
       const auto physicsSystem = Physics::GetPhysicsSystem();
       physicsSystem->SetBodyActivationListener(m_BodyActivationListener3D);
       physicsSystem->SetContactListener(m_ContactListener3D);
 
-      // Rigidbodies
-      {
-        const auto group = m_Registry.group<RigidbodyComponent>(entt::get<TransformComponent>);
-        for (auto&& [e, rb, tc] : group.each()) {
-          rb.PreviousTranslation = rb.Translation = tc.Translation;
-          rb.PreviousRotation = rb.Rotation = tc.Rotation;
-          CreateRigidbody({e, this}, tc, rb);
-        }
-      }
+      CreateRigidbodies();
 
       // Characters
       {
         const auto group = m_Registry.group<CharacterControllerComponent>(entt::get<TransformComponent>);
         for (auto&& [e, ch, tc] : group.each()) {
-          CreateCharacterController(tc, ch);
+          CreateCharacterController({e, this}, tc, ch);
         }
       }
 
@@ -299,6 +324,8 @@ namespace Oxylus {
         }
       }
 
+      m_RigidbodyPoses.Clear();
+      m_ContactEvents.clear();
       delete m_BodyActivationListener3D;
       delete m_ContactListener3D;
       m_BodyActivationListener3D = nullptr;
@@ -350,10 +377,11 @@ namespace Oxylus {
     }
 
     for (const auto e : view) {
-      Entity src = {e, other.get()};
-      Entity dst = newScene->GetEntityByUUID(view.get<IDComponent>(e).ID);
-      if (Entity srcParent = src.GetParent())
-        dst.SetParent(newScene->GetEntityByUUID(srcParent.GetUUID()));
+      const Entity src = {e, other.get()};
+      const Entity dst = newScene->GetEntityByUUID(view.get<IDComponent>(e).ID);
+      src.ForEachChild([&newScene, &dst](Entity srcChild) {
+        newScene->GetEntityByUUID(srcChild.GetUUID()).SetParent(dst);
+      });
     }
 
     // Copy components (except IDComponent and TagComponent)
@@ -362,102 +390,282 @@ namespace Oxylus {
     return newScene;
   }
 
-  void Scene::OnContactAdded(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, const JPH::ContactSettings& settings) {
-    for (const auto& system : m_Systems)
-      system->OnContactAdded(this, body1, body2, manifold, settings);
-  }
+  void Scene::DispatchContacts() {
+    OX_SCOPED_ZONE;
+    if (m_ContactEvents.empty())
+      return;
 
-  void Scene::OnContactPersisted(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, JPH::ContactSettings& settings) {
-    for (const auto& system : m_Systems)
-      system->OnContactPersisted(this, body1, body2, manifold, settings);
-  }
+    ReduceContactEvents(m_ContactEvents);
+
+    // Removed contacts only know their bodies
+    const auto& lockInterface = Physics::GetPhysicsSystem()->GetBodyLockInterface();
+    const auto getEntity = [&lockInterface](const JPH::BodyID& id) {
+      const JPH::BodyLockRead lock(lockInterface, id);
+      return lock.Succeeded() ? static_cast<entt::entity>(lock.GetBody().GetUserData()) : entt::entity(entt::null);
+    };
+    for (auto& contact : m_ContactEvents) {
+      if (contact.Type == ContactEvent::Phase::Removed) {
+        contact.Entity1 = getEntity(contact.Body1);
+        contact.Entity2 = getEntity(contact.Body2);
+      }
+    }
 
-  void Scene::RenderScene() {
-    m_SceneRenderer.Render();
+    using Handler = void (System::*)(Scene*, const ContactEvent&);
+    constexpr Handler handlers[] = {&System::OnContactAdded, &System::OnContactPersisted, &System::OnContactRemoved};
+    for (auto begin = m_ContactEvents.begin(); begin != m_ContactEvents.end();) {
+      const ContactEvent::Phase phase = begin->Type;
+      const auto end = std::find_if(begin, m_ContactEvents.end(), [phase](const ContactEvent& contact) { return contact.Type != phase; });
+      const Handler handler = handlers[(uint32_t)phase];
+      for (const auto& system : m_Systems) {
+        for (auto it = begin; it != end; ++it)
+          (system.get()->*handler)(this, *it);
+      }
+      begin = end;
+    }
+
+    m_ContactEvents.clear();
+  }
+
+  struct TransformUpdateNode {
+    entt::entity Entity = entt::null;
+    const Mat4* ParentWorld = nullptr;
+    uint32_t ParentVersion = 0;
+    bool ParentChanged = false;
+  };
+
+  struct TransformUpdateContext {
+    const entt::storage_for_t<TransformComponent>& Transforms;
+    const entt::storage_for_t<RelationshipComponent>& Relationships;
+    entt::storage_for_t<WorldTransformComponent>& WorldTransforms;
+  };
+
+  // Updates one entity and appends its children to outChildren.
+  static void UpdateTransformNode(const TransformUpdateContext& context,
+                                  const TransformUpdateNode& node,
+                                  std::vector<TransformUpdateNode>& outChildren) {
+    const auto& tc = context.Transforms.get(node.Entity);
+    const auto& rc = context.Relationships.get(node.Entity);
+    auto& wt = context.WorldTransforms.get(node.Entity);
+
+    const bool changed = node.ParentChanged || !wt.Valid || wt.Parent != rc.Parent || wt.Translation != tc.Translation ||
+                         wt.Rotation != tc.Rotation || wt.Scale != tc.Scale;
+    if (changed) {
+      wt.Translation = tc.Translation;
+      wt.Rotation = tc.Rotation;
+      wt.Scale = tc.Scale;
+      wt.Parent = rc.Parent;
+      wt.ParentVersion = node.ParentVersion;
+      wt.Valid = true;
+
+      const Mat4 local = glm::translate(Mat4(1.0f), tc.Translation) * glm::toMat4(glm::quat(tc.Rotation)) *
+                         glm::scale(Mat4(1.0f), tc.Scale);
+      wt.World = node.ParentWorld ? *node.ParentWorld * local : local;
+      wt.Version++;
+    }
+
+    for (auto child = rc.FirstChild; child != entt::null; child = context.Relationships.get(child).NextSibling)
+      outChildren.push_back({child, &wt.World, wt.Version, changed});
   }
 
-  void Scene::CreateRigidbody(Entity entity, const TransformComponent& transform, RigidbodyComponent& component) const {
+  void Scene::SortHierarchy() {
     OX_SCOPED_ZONE;
-    if (!m_IsRunning)
-      return;
+    m_HierarchyChanged = false;
+
+    // Depth first order, so walking a subtree touches its components front to back
+    std::vector<uint32_t> order;
+    std::vector<entt::entity> stack;
+    uint32_t position = 0;
+    auto& relationships = m_Registry.storage<RelationshipComponent>();
+    for (auto&& [e, rc] : relationships.each()) {
+      if (rc.Parent != entt::null)
+        continue;
 
-    auto& bodyInterface = Physics::GetBodyInterface();
-    if (component.RuntimeBody) {
-      bodyInterface.DestroyBody(static_cast<JPH::Body*>(component.RuntimeBody)->GetID());
-      component.RuntimeBody = nullptr;
-    }
+      stack.push_back(e);
+      while (!stack.empty()) {
+        const auto entity = stack.back();
+        stack.pop_back();
 
-    JPH::MutableCompoundShapeSettings compoundShapeSettings;
-    float maxScaleComponent = glm::max(glm::max(transform.Scale.x, transform.Scale.y), transform.Scale.z);
+        const auto index = entt::to_entity(entity);
+        if (index >= order.size())
+          order.resize(index + 1, UINT32_MAX);
+        order[index] = position++;
 
-    const auto& entityName = entity.GetComponent<TagComponent>().Tag;
+        // Pushed in reverse so the first child is visited first
+        for (auto child = relationships.get(entity).LastChild; child != entt::null; child = relationships.get(child).PrevSibling)
+          stack.push_back(child);
+      }
+    }
 
-    if (entity.HasComponent<BoxColliderComponent>()) {
-      const auto& bc = entity.GetComponent<BoxColliderComponent>();
-      const auto* mat = new PhysicsMaterial3D(entityName, JPH::ColorArg(255, 0, 0), bc.Friction, bc.Restitution);
+    m_Registry.sort<RelationshipComponent>([&order](const entt::entity lhs, const entt::entity rhs) {
+      return order[entt::to_entity(lhs)] < order[entt::to_entity(rhs)];
+    });
+    m_Registry.sort<TransformComponent, RelationshipComponent>();
+    m_Registry.sort<WorldTransformComponent, RelationshipComponent>();
+  }
 
-      Vec3 scale = bc.Size;
-      JPH::BoxShapeSettings shapeSettings({glm::abs(scale.x), glm::abs(scale.y), glm::abs(scale.z)}, 0.05f, mat);
-      shapeSettings.SetDensity(glm::max(0.001f, bc.Density));
+  void Scene::UpdateTransforms() {
+    OX_SCOPED_ZONE;
 
-      compoundShapeSettings.AddShape({bc.Offset.x, bc.Offset.y, bc.Offset.z}, JPH::Quat::sIdentity(), shapeSettings.Create().Get());
+    // Entities created since the last update
+    {
+      const auto view = m_Registry.view<TransformComponent>(entt::exclude<WorldTransformComponent>);
+      const std::vector<entt::entity> newEntities(view.begin(), view.end());
+      for (const auto e : newEntities)
+        m_Registry.emplace<WorldTransformComponent>(e);
     }
 
-    if (entity.HasComponent<SphereColliderComponent>()) {
-      const auto& sc = entity.GetComponent<SphereColliderComponent>();
-      const auto* mat = new PhysicsMaterial3D(entityName, JPH::ColorArg(255, 0, 0), sc.Friction, sc.Restitution);
+    if (m_HierarchyChanged)
+      SortHierarchy();
 
-      float radius = 2.0f * sc.Radius * maxScaleComponent;
-      JPH::SphereShapeSettings shapeSettings(glm::max(0.01f, radius), mat);
-      shapeSettings.SetDensity(glm::max(0.001f, sc.Density));
+    // Grab the storages up front, the jobs below must not touch the registry itself
+    const TransformUpdateContext context = {
+      m_Registry.storage<TransformComponent>(),
+      m_Registry.storage<RelationshipComponent>(),
+      m_Registry.storage<WorldTransformComponent>()
+    };
 
-      compoundShapeSettings.AddShape({sc.Offset.x, sc.Offset.y, sc.Offset.z}, JPH::Quat::sIdentity(), shapeSettings.Create().Get());
+    std::vector<TransformUpdateNode> subtrees;
+    for (auto&& [e, rc] : m_Registry.view<RelationshipComponent>().each()) {
+      if (rc.Parent == entt::null)
+        subtrees.push_back({e});
     }
 
-    if (entity.HasComponent<CapsuleColliderComponent>()) {
-      const auto& cc = entity.GetComponent<CapsuleColliderComponent>();
-      const auto* mat = new PhysicsMaterial3D(entityName, JPH::ColorArg(255, 0, 0), cc.Friction, cc.Restitution);
+    // A single imported model is usually one deep tree, so walk down a few levels
+    // on this thread until there are enough independent subtrees to keep every worker busy.
+    const size_t wantedSubtrees = JobSystem::GetThreadCount() * 4;
+    std::vector<TransformUpdateNode> nextLevel;
+    while (!subtrees.empty() && subtrees.size() < wantedSubtrees) {
+      nextLevel.clear();
+      for (const auto& node : subtrees)
+        UpdateTransformNode(context, node, nextLevel);
+      std::swap(subtrees, nextLevel);
+    }
 
-      float radius = 2.0f * cc.Radius * maxScaleComponent;
-      JPH::CapsuleShapeSettings shapeSettings(glm::max(0.01f, cc.Height) * 0.5f, glm::max(0.01f, radius), mat);
-      shapeSettings.SetDensity(glm::max(0.001f, cc.Density));
+    JobSystem::ParallelFor((uint32_t)subtrees.size(),
+      0,
+      [&context, &subtrees](uint32_t index) {
+        // Depth first so every parent is done before its children
+        std::vector<TransformUpdateNode> stack = {subtrees[index]};
+        while (!stack.empty()) {
+          const TransformUpdateNode node = stack.back();
+          stack.pop_back();
+          UpdateTransformNode(context, node, stack);
+        }
+      });
+  }
 
-      compoundShapeSettings.AddShape({cc.Offset.x, cc.Offset.y, cc.Offset.z}, JPH::Quat::sIdentity(), shapeSettings.Create().Get());
+  void Scene::RenderScene() {
+    UpdateTransforms();
+    m_SceneRenderer.Render();
+  }
+
+  void Scene::UpdateAnimations(const float deltaTime) {
+    OX_SCOPED_ZONE;
+    std::vector<entt::entity> entities;
+    for (const auto&& [e, animation, meshRenderer] : m_Registry.view<AnimationComponent, MeshRendererComponent>().each()) {
+      if (meshRenderer.MeshGeometry && meshRenderer.SubmesIndex < meshRenderer.MeshGeometry->LinearNodes.size())
+        entities.emplace_back(e);
     }
 
-    if (entity.HasComponent<TaperedCapsuleColliderComponent>()) {
-      const auto& tcc = entity.GetComponent<TaperedCapsuleColliderComponent>();
-      const auto* mat = new PhysicsMaterial3D(entityName, JPH::ColorArg(255, 0, 0), tcc.Friction, tcc.Restitution);
+    // Grab the storages up front, the jobs below must not touch the registry itself. The poses are reused per worker.
+    auto& animations = m_Registry.storage<AnimationComponent>();
+    const auto& meshRenderers = m_Registry.storage<MeshRendererComponent>();
+    JobSystem::ParallelFor((uint32_t)entities.size(),
+      0,
+      [&animations, &meshRenderers, &entities, deltaTime](const uint32_t index) {
+        auto& animation = animations.get(entities[index]);
+        const auto& meshRenderer = meshRenderers.get(entities[index]);
+        const Mesh& mesh = *meshRenderer.MeshGeometry;
+        const int32_t skinIndex = mesh.LinearNodes[meshRenderer.SubmesIndex]->SkinIndex;
+        const auto isPlayable = [&mesh, skinIndex](const int64_t clip) {
+          return clip >= 0 && clip < (int64_t)mesh.Animations.size() && mesh.Animations[clip].SkinIndex == skinIndex;
+        };
+        if (skinIndex < 0 || !isPlayable(animation.ClipIndex)) {
+          animation.SkinningMatrices.clear();
+          return;
+        }
 
-      float topRadius = 2.0f * tcc.TopRadius * maxScaleComponent;
-      float bottomRadius = 2.0f * tcc.BottomRadius * maxScaleComponent;
-      JPH::TaperedCapsuleShapeSettings shapeSettings(glm::max(0.01f, tcc.Height) * 0.5f, glm::max(0.01f, topRadius), glm::max(0.01f, bottomRadius), mat);
-      shapeSettings.SetDensity(glm::max(0.001f, tcc.Density));
+        thread_local Pose pose;
+        thread_local Pose blendPose;
+        const Skeleton& skin = mesh.Skins[skinIndex];
+        animation.Time += deltaTime * animation.Speed;
+        pose.Resize(skin.GetJointCount());
+        mesh.Animations[animation.ClipIndex].Sample(animation.Time, animation.Loop, pose);
+        if (isPlayable(animation.BlendClipIndex) && animation.BlendWeight > 0.0f) {
+          blendPose.Resize(skin.GetJointCount());
+          mesh.Animations[animation.BlendClipIndex].Sample(animation.Time, animation.Loop, blendPose);
+          Pose::Blend(pose, blendPose, std::min(animation.BlendWeight, 1.0f), pose);
+        }
+
+        animation.SkinningMatrices.resize(skin.GetJointCount());
+        skin.ComputeSkinningMatrices(pose, animation.SkinningMatrices.data());
+      });
+  }
+
+  /// Colliders of a rigidbody entity, fetched up front so the body settings can be built without the registry.
+  struct RigidbodyColliders {
+    const BoxColliderComponent* Box = nullptr;
+    const SphereColliderComponent* Sphere = nullptr;
+    const CapsuleColliderComponent* Capsule = nullptr;
+    const TaperedCapsuleColliderComponent* TaperedCapsule = nullptr;
+    const CylinderColliderComponent* Cylinder = nullptr;
+  };
+
+  static JPH::BodyCreationSettings CreateBodySettings(const entt::entity entity,
+                                                      const TagComponent& tag,
+                                                      const TransformComponent& transform,
+                                                      const RigidbodyComponent& component,
+                                                      const RigidbodyColliders& colliders) {
+    float maxScaleComponent = glm::max(glm::max(transform.Scale.x, transform.Scale.y), transform.Scale.z);
+
+    ColliderDescription descriptions[5];
+    uint32_t count = 0;
+    const auto addCollider = [&](const ColliderDescription::Type type, const Vec3& dimensions, const Vec3& offset, const float density, const float friction, const float restitution) {
+      descriptions[count++] = {type, dimensions, offset, glm::max(0.001f, density), friction, restitution};
+    };
 
-      compoundShapeSettings.AddShape({tcc.Offset.x, tcc.Offset.y, tcc.Offset.z}, JPH::Quat::sIdentity(), shapeSettings.Create().Get());
+    if (colliders.Box) {
+      const auto& bc = *colliders.Box;
+      addCollider(ColliderDescription::Type::Box, glm::abs(bc.Size), bc.Offset, bc.Density, bc.Friction, bc.Restitution);
     }
 
-    if (entity.HasComponent<CylinderColliderComponent>()) {
-      const auto& cc = entity.GetComponent<CylinderColliderComponent>();
-      const auto* mat = new PhysicsMaterial3D(entityName, JPH::ColorArg(255, 0, 0), cc.Friction, cc.Restitution);
+    if (colliders.Sphere) {
+      const auto& sc = *colliders.Sphere;
+      float radius = 2.0f * sc.Radius * maxScaleComponent;
+      addCollider(ColliderDescription::Type::Sphere, {glm::max(0.01f, radius), 0.0f, 0.0f}, sc.Offset, sc.Density, sc.Friction, sc.Restitution);
+    }
 
+    if (colliders.Capsule) {
+      const auto& cc = *colliders.Capsule;
       float radius = 2.0f * cc.Radius * maxScaleComponent;
-      JPH::CylinderShapeSettings shapeSettings(glm::max(0.01f, cc.Height) * 0.5f, glm::max(0.01f, radius), 0.05f, mat);
-      shapeSettings.SetDensity(glm::max(0.001f, cc.Density));
+      addCollider(ColliderDescription::Type::Capsule, {glm::max(0.01f, cc.Height) * 0.5f, glm::max(0.01f, radius), 0.0f}, cc.Offset, cc.Density, cc.Friction, cc.Restitution);
+    }
 
-      compoundShapeSettings.AddShape({cc.Offset.x, cc.Offset.y, cc.Offset.z}, JPH::Quat::sIdentity(), shapeSettings.Create().Get());
+    if (colliders.TaperedCapsule) {
+      const auto& tcc = *colliders.TaperedCapsule;
+      float topRadius = 2.0f * tcc.TopRadius * maxScaleComponent;
+      float bottomRadius = 2.0f * tcc.BottomRadius * maxScaleComponent;
+      addCollider(ColliderDescription::Type::TaperedCapsule,
+                  {glm::max(0.01f, tcc.Height) * 0.5f, glm::max(0.01f, topRadius), glm::max(0.01f, bottomRadius)},
+                  tcc.Offset, tcc.Density, tcc.Friction, tcc.Restitution);
+    }
+
+    if (colliders.Cylinder) {
+      const auto& cc = *colliders.Cylinder;
+      float radius = 2.0f * cc.Radius * maxScaleComponent;
+      addCollider(ColliderDescription::Type::Cylinder, {glm::max(0.01f, cc.Height) * 0.5f, glm::max(0.01f, radius), 0.0f}, cc.Offset, cc.Density, cc.Friction, cc.Restitution);
     }
 
     // Body
     auto rotation = glm::quat(transform.Rotation);
 
-    auto layer = entity.GetComponent<TagComponent>().Layer;
+    auto layer = tag.Layer;
     uint8_t layerIndex = 1;	// Default Layer
     auto collisionMaskIt = Physics::LayerCollisionMask.find(layer);
     if (collisionMaskIt != Physics::LayerCollisionMask.end())
       layerIndex = collisionMaskIt->second.Index;
 
-    JPH::BodyCreationSettings bodySettings(compoundShapeSettings.Create().Get(), {transform.Translation.x, transform.Translation.y, transform.Translation.z}, {rotation.x, rotation.y, rotation.z, rotation.w}, static_cast<JPH::EMotionType>(component.Type), layerIndex);
+    JPH::BodyCreationSettings bodySettings(ShapeCache::GetShape(descriptions, count), {transform.Translation.x, transform.Translation.y, transform.Translation.z}, {rotation.x, rotation.y, rotation.z, rotation.w}, static_cast<JPH::EMotionType>(component.Type), layerIndex);
 
     JPH::MassProperties massProperties;
     massProperties.mMass = glm::max(0.01f, component.Mass);
@@ -470,16 +678,140 @@ namespace Oxylus {
     bodySettings.mGravityFactor = component.GravityScale;
 
     bodySettings.mIsSensor = component.IsSensor;
+    // Lets contact events find the entity of the body
+    bodySettings.mUserData = static_cast<JPH::uint64>(entity);
+
+    return bodySettings;
+  }
+
+  void Scene::RigidbodyPoses::Set(const JPH::BodyID& id, const entt::entity entity, const Vec3& translation, const glm::quat& rotation) {
+    const uint32_t index = id.GetIndex();
+    if (index >= Entities.size()) {
+      const size_t size = std::max<size_t>(index + 1, Entities.size() * 2);
+      Entities.resize(size, entt::null);
+      PreviousTranslations.resize(size);
+      Translations.resize(size);
+      PreviousRotations.resize(size);
+      Rotations.resize(size);
+    }
+    Entities[index] = entity;
+    PreviousTranslations[index] = Translations[index] = translation;
+    PreviousRotations[index] = Rotations[index] = rotation;
+  }
 
-    JPH::Body* body = bodyInterface.CreateBody(bodySettings);
+  void Scene::RigidbodyPoses::Clear() {
+    Entities.clear();
+    PreviousTranslations.clear();
+    Translations.clear();
+    PreviousRotations.clear();
+    Rotations.clear();
+  }
+
+  static JPH::EActivation GetActivation(const RigidbodyComponent& component) {
+    return component.Awake && component.Type != RigidbodyComponent::BodyType::Static ? JPH::EActivation::Activate : JPH::EActivation::DontActivate;
+  }
+
+  void Scene::CreateRigidbody(Entity entity, const TransformComponent& transform, RigidbodyComponent& component) const {
+    OX_SCOPED_ZONE;
+    if (!m_IsRunning)
+      return;
 
-    JPH::EActivation activation = component.Awake && component.Type != RigidbodyComponent::BodyType::Static ? JPH::EActivation::Activate : JPH::EActivation::DontActivate;
-    bodyInterface.AddBody(body->GetID(), activation);
+    auto& bodyInterface = Physics::GetBodyInterface();
+    if (component.RuntimeBody) {
+      const JPH::BodyID id = static_cast<JPH::Body*>(component.RuntimeBody)->GetID();
+      m_RigidbodyPoses.Set(id, entt::null, Vec3(0.0f), glm::quat());
+      bodyInterface.DestroyBody(id);
+      component.RuntimeBody = nullptr;
+    }
+
+    const RigidbodyColliders colliders = {
+      m_Registry.try_get<BoxColliderComponent>(entity),
+      m_Registry.try_get<SphereColliderComponent>(entity),
+      m_Registry.try_get<CapsuleColliderComponent>(entity),
+      m_Registry.try_get<TaperedCapsuleColliderComponent>(entity),
+      m_Registry.try_get<CylinderColliderComponent>(entity),
+    };
+    JPH::Body* body = bodyInterface.CreateBody(CreateBodySettings(entity, entity.GetComponent<TagComponent>(), transform, component, colliders));
+    if (!body) {
+      OX_CORE_ERROR("Couldn't create the rigidbody of {}, the physics world is full", entity.GetName());
+      return;
+    }
+    bodyInterface.AddBody(body->GetID(), GetActivation(component));
 
     component.RuntimeBody = body;
+    m_RigidbodyPoses.Set(body->GetID(), entity, transform.Translation, glm::quat(transform.Rotation));
   }
 
-  void Scene::CreateCharacterController(const TransformComponent& transform, CharacterControllerComponent& component) const {
+  void Scene::CreateRigidbodies() {
+    OX_SCOPED_ZONE;
+    ProfilerTimer timer;
+
+    std::vector<entt::entity> entities;
+    const auto group = m_Registry.group<RigidbodyComponent>(entt::get<TransformComponent>);
+    for (const auto e : group)
+      entities.emplace_back(e);
+
+    // Shapes and settings are built on the workers, which must not touch the registry itself
+    const auto& tags = m_Registry.storage<TagComponent>();
+    const auto& transforms = m_Registry.storage<TransformComponent>();
+    auto& rigidbodies = m_Registry.storage<RigidbodyComponent>();
+    const auto& boxes = m_Registry.storage<BoxColliderComponent>();
+    const auto& spheres = m_Registry.storage<SphereColliderComponent>();
+    const auto& capsules = m_Registry.storage<CapsuleColliderComponent>();
+    const auto& taperedCapsules = m_Registry.storage<TaperedCapsuleColliderComponent>();
+    const auto& cylinders = m_Registry.storage<CylinderColliderComponent>();
+    std::vector<JPH::BodyCreationSettings> settings(entities.size());
+    JobSystem::ParallelFor((uint32_t)entities.size(),
+      64,
+      [&](const uint32_t index) {
+        const entt::entity e = entities[index];
+        const RigidbodyColliders colliders = {
+          boxes.contains(e) ? &boxes.get(e) : nullptr,
+          spheres.contains(e) ? &spheres.get(e) : nullptr,
+          capsules.contains(e) ? &capsules.get(e) : nullptr,
+          taperedCapsules.contains(e) ? &taperedCapsules.get(e) : nullptr,
+          cylinders.contains(e) ? &cylinders.get(e) : nullptr,
+        };
+        settings[index] = CreateBodySettings(e, tags.get(e), transforms.get(e), rigidbodies.get(e), colliders);
+      });
+
+    // Adding the bodies in batches inserts them into the broadphase once instead of one at a time. A batch is
+    // activated as a whole, so sleeping and awake bodies go into separate ones.
+    auto& bodyInterface = Physics::GetBodyInterface();
+    std::vector<JPH::BodyID> sleepingBodies;
+    std::vector<JPH::BodyID> awakeBodies;
+    uint32_t createdCount = 0;
+    for (; createdCount < (uint32_t)entities.size(); createdCount++) {
+      JPH::Body* body = bodyInterface.CreateBody(settings[createdCount]);
+      if (!body) {
+        OX_CORE_ERROR("The physics world is full, only {} of {} rigidbodies were created. Raise MaxBodies in the project settings.",
+                      createdCount,
+                      entities.size());
+        break;
+      }
+      auto& component = rigidbodies.get(entities[createdCount]);
+      component.RuntimeBody = body;
+      const auto& transform = transforms.get(entities[createdCount]);
+      m_RigidbodyPoses.Set(body->GetID(), entities[createdCount], transform.Translation, glm::quat(transform.Rotation));
+      auto& bodies = GetActivation(component) == JPH::EActivation::Activate ? awakeBodies : sleepingBodies;
+      bodies.emplace_back(body->GetID());
+    }
+
+    for (auto [bodies, activation] : {std::pair{&sleepingBodies, JPH::EActivation::DontActivate}, std::pair{&awakeBodies, JPH::EActivation::Activate}}) {
+      if (bodies->empty())
+        continue;
+      const auto state = bodyInterface.AddBodiesPrepare(bodies->data(), (int)bodies->size());
+      bodyInterface.AddBodiesFinalize(bodies->data(), (int)bodies->size(), state, activation);
+    }
+
+    timer.Print(fmt::format("Created {} rigidbodies sharing {} shapes ({} KB) and {} materials",
+                            createdCount,
+                            ShapeCache::GetShapeCount(),
+                            ShapeCache::GetShapeMemory() / 1024,
+                            ShapeCache::GetMaterialCount()));
+  }
+
+  void Scene::CreateCharacterController(Entity entity, const TransformComponent& transform, CharacterControllerComponent& component) const {
     if (!m_IsRunning)
       return;
     auto position = JPH::Vec3(transform.Translation.x, transform.Translation.y, transform.Translation.z);
@@ -495,7 +827,7 @@ namespace Oxylus {
     settings->mShape = capsuleShape;
     settings->mFriction = 0.0f; // For now this is not set. 
     settings->mSupportingVolume = JPH::Plane(JPH::Vec3::sAxisY(), -component.CharacterRadiusStanding); // Accept contacts that touch the lower sphere of the capsule
-    component.Character = new JPH::Character(settings.get(), position, JPH::Quat::sIdentity(), 0, Physics::GetPhysicsSystem());
+    component.Character = new JPH::Character(settings.get(), position, JPH::Quat::sIdentity(), static_cast<JPH::uint64>((entt::entity)entity), Physics::GetPhysicsSystem());
     component.Character->AddToPhysicsSystem(JPH::EActivation::Activate);
   }
 
@@ -513,6 +845,7 @@ namespace Oxylus {
       }
     }
 
+    UpdateAnimations(deltaTime);
     RenderScene();
 
     {
@@ -613,6 +946,9 @@ namespace Oxylus {
     entity.AddComponentI<MaterialComponent>();
   }
 
+  template <>
+  void Scene::OnComponentAdded<AnimationComponent>(Entity entity, AnimationComponent& component) { }
+
   template <>
   void Scene::OnComponentAdded<SkyLightComponent>(Entity entity, SkyLightComponent& component) { }
 
@@ -671,7 +1007,7 @@ namespace Oxylus {
 
   template <>
   void Scene::OnComponentAdded<CharacterControllerComponent>(Entity entity, CharacterControllerComponent& component) {
-    CreateCharacterController(entity.GetComponent<TransformComponent>(), component);
+    CreateCharacterController(entity, entity.GetComponent<TransformComponent>(), component);
   }
 
   template <>
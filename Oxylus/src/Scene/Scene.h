@@ -9,6 +9,7 @@
 #include "Core/Systems/System.h"
 #include "Jolt/Physics/PhysicsSystem.h"
 #include "Jolt/Physics/Body/BodyInterface.h"
+#include "Physics/ContactEvent.h"
 #include "Physics/PhyiscsInterfaces.h"
 #include "Render/Mesh.h"
 #include "Render/Camera.h"
@@ -47,14 +48,13 @@ namespace Oxylus {
 
     void OnImGuiRender(float deltaTime);
 
+    /// Rebuilds the cached world matrices of every entity whose transform or parent changed.
+    void UpdateTransforms();
+
     Entity FindEntity(const std::string_view& name);
     bool HasEntity(UUID uuid) const;
     static Ref<Scene> Copy(const Ref<Scene>& other);
 
-    // Physics interfaces
-    void OnContactAdded(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, const JPH::ContactSettings& settings);
-    void OnContactPersisted(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, JPH::ContactSettings& settings);
-
     Entity GetEntityByUUID(UUID uuid);
     SceneRenderer& GetRenderer() { return m_SceneRenderer; }
 
@@ -68,15 +68,23 @@ namespace Oxylus {
     // Physics
     void UpdatePhysics(Timestep deltaTime);
     void CreateRigidbody(Entity entity, const TransformComponent& transform, RigidbodyComponent& component) const;
-    void CreateCharacterController(const TransformComponent& transform, CharacterControllerComponent& component) const;
+    /// Creates the bodies of every rigidbody at once when the runtime starts.
+    void CreateRigidbodies();
+    void CreateCharacterController(Entity entity, const TransformComponent& transform, CharacterControllerComponent& component) const;
+    /// Hands the contacts recorded during the physics steps of this frame to the systems.
+    void DispatchContacts();
 
     void RenderScene();
+    void UpdateAnimations(float deltaTime);
     template <typename T>
     void OnComponentAdded(Entity entity, T& component);
 
     void IterateOverMeshNode(const Ref<Mesh>& mesh, const std::vector<Mesh::Node*>& node, Entity parent);
 
+    void SortHierarchy();
+
     bool m_IsRunning = false;
+    bool m_HierarchyChanged = true;
 
     // Renderer
     SceneRenderer m_SceneRenderer;
@@ -85,6 +93,20 @@ namespace Oxylus {
     std::vector<Scope<System>> m_Systems;
 
     // Physics
+    /// Poses of the rigidbodies after the last two physics steps, indexed by the index of their body ID.
+    struct RigidbodyPoses {
+      std::vector<entt::entity> Entities;
+      std::vector<Vec3> PreviousTranslations;
+      std::vector<Vec3> Translations;
+      std::vector<glm::quat> PreviousRotations;
+      std::vector<glm::quat> Rotations;
+
+      void Set(const JPH::BodyID& id, entt::entity entity, const Vec3& translation, const glm::quat& rotation);
+      void Clear();
+    };
+
+    RigidbodyPoses m_RigidbodyPoses;
+    std::vector<ContactEvent> m_ContactEvents;
     Physics3DContactListener* m_ContactListener3D = nullptr;
     Physics3DBodyActivationListener* m_BodyActivationListener3D = nullptr;
     float m_PhysicsFrameAccumulator = 0.0f;
@@ -79,6 +79,10 @@ namespace Oxylus {
         EntitySerializer::DeserializeEntity(entity, m_Scene.get(), true);
       }
 
+      for (const auto entity : entities) {
+        EntitySerializer::DeserializeChildren(entity, m_Scene.get());
+      }
+
       timer.Stop();
       OX_CORE_INFO("Scene loaded : {0}, {1} ms", StringUtils::GetName(m_Scene->SceneName), timer.ElapsedMilliSeconds());
       return true;
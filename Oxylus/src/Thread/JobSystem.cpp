@@ -0,0 +1,251 @@
+#include "JobSystem.h"
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "WorkStealingQueue.h"
+#include "Core/Base.h"
+#include "Utils/Log.h"
+#include "Utils/Profiler.h"
+
+namespace Oxylus {
+  struct Job {
+    std::function<void()> Function;
+    JobCounter* Counter = nullptr;
+  };
+
+  using JobQueue = WorkStealingQueue<Job*, 4096>;
+
+  struct PriorityQueues {
+    std::vector<Scope<JobQueue>> WorkerQueues;
+
+    // Jobs scheduled from threads the job system doesn't own, or from workers whose queue is full
+    std::deque<Job*> SharedQueue;
+    std::mutex SharedQueueMutex;
+    std::atomic<uint32_t> SharedQueueSize = 0;
+  };
+
+  static std::vector<std::thread> s_Workers;
+  static std::array<PriorityQueues, (size_t)JobPriority::Count> s_PriorityQueues;
+
+  static std::mutex s_WakeMutex;
+  static std::condition_variable s_WakeCondition;
+  static std::atomic<uint32_t> s_QueuedJobs = 0;
+  static std::atomic<uint32_t> s_SleepingWorkers = 0;
+  static std::atomic<bool> s_Running = false;
+
+  static thread_local uint32_t t_ThreadIndex = UINT32_MAX;
+
+  static void RunJob(Job* job) {
+    job->Function();
+    if (job->Counter)
+      job->Counter->Pending.fetch_sub(1, std::memory_order_release);
+    delete job;
+  }
+
+  static Job* TakeSharedJob(PriorityQueues& queues) {
+    if (queues.SharedQueueSize.load(std::memory_order_relaxed) == 0)
+      return nullptr;
+
+    std::lock_guard<std::mutex> lock(queues.SharedQueueMutex);
+    if (queues.SharedQueue.empty())
+      return nullptr;
+    Job* job = queues.SharedQueue.front();
+    queues.SharedQueue.pop_front();
+    queues.SharedQueueSize.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+  }
+
+  static Job* TakeJob(PriorityQueues& queues, uint32_t index) {
+    Job* job = nullptr;
+    if (index != UINT32_MAX)
+      queues.WorkerQueues[index]->Pop(job);
+
+    if (!job)
+      job = TakeSharedJob(queues);
+
+    if (!job) {
+      // Steal from the others, starting next to ourselves so thieves spread out
+      const uint32_t queueCount = (uint32_t)queues.WorkerQueues.size();
+      const uint32_t start = index == UINT32_MAX ? 0 : index + 1;
+      for (uint32_t i = 0; i < queueCount && !job; i++) {
+        const uint32_t victim = (start + i) % queueCount;
+        if (victim != index)
+          queues.WorkerQueues[victim]->Steal(job);
+      }
+    }
+
+    return job;
+  }
+
+  void JobSystem::Init(uint32_t workerCount) {
+    OX_SCOPED_ZONE;
+    if (workerCount == 0)
+      workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+    s_Running = true;
+    t_ThreadIndex = 0;
+
+    for (auto& queues : s_PriorityQueues) {
+      queues.WorkerQueues.reserve(workerCount + 1);
+      for (uint32_t i = 0; i <= workerCount; i++)
+        queues.WorkerQueues.emplace_back(CreateScope<JobQueue>());
+    }
+
+    s_Workers.reserve(workerCount);
+    for (uint32_t i = 1; i <= workerCount; i++)
+      s_Workers.emplace_back(&JobSystem::WorkerLoop, i);
+
+    OX_CORE_INFO("Job system initialized with {} worker threads.", workerCount);
+  }
+
+  void JobSystem::Shutdown() {
+    if (!s_Running)
+      return;
+
+    // Finish whatever is still queued so nothing waits on a counter forever
+    while (TryRunJob()) { }
+
+    {
+      std::lock_guard<std::mutex> lock(s_WakeMutex);
+      s_Running = false;
+    }
+    s_WakeCondition.notify_all();
+
+    for (auto& worker : s_Workers)
+      worker.join();
+
+    // Jobs the workers scheduled while shutting down
+    while (TryRunJob()) { }
+
+    s_Workers.clear();
+    for (auto& queues : s_PriorityQueues)
+      queues.WorkerQueues.clear();
+    t_ThreadIndex = UINT32_MAX;
+  }
+
+  void JobSystem::Execute(std::function<void()> function, JobCounter* counter, JobPriority priority) {
+    if (counter)
+      counter->Pending.fetch_add(1, std::memory_order_relaxed);
+
+    Job* job = new Job{std::move(function), counter};
+
+    if (!s_Running) {
+      RunJob(job);
+      return;
+    }
+
+    s_QueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+    auto& queues = s_PriorityQueues[(size_t)priority];
+    const uint32_t index = t_ThreadIndex;
+    if (index == UINT32_MAX || !queues.WorkerQueues[index]->Push(job)) {
+      std::lock_guard<std::mutex> lock(queues.SharedQueueMutex);
+      queues.SharedQueue.push_back(job);
+      queues.SharedQueueSize.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // A worker increments the sleeping count before it checks for queued jobs,
+    // so either it sees this job or we see it sleeping.
+    if (s_SleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+      { std::lock_guard<std::mutex> lock(s_WakeMutex); }
+      s_WakeCondition.notify_one();
+    }
+  }
+
+  void JobSystem::Wait(const JobCounter& counter) {
+    OX_SCOPED_ZONE;
+    while (!counter.IsDone()) {
+      if (!TryRunJob())
+        std::this_thread::yield();
+    }
+  }
+
+  void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t index)>& function) {
+    ParallelForRange(count,
+      batchSize,
+      [&function](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+          function(i);
+      });
+  }
+
+  void JobSystem::ParallelForRange(uint32_t count,
+                                   uint32_t batchSize,
+                                   const std::function<void(uint32_t begin, uint32_t end)>& function) {
+    OX_SCOPED_ZONE;
+    if (count == 0)
+      return;
+
+    if (batchSize == 0) {
+      // A few batches per thread so a slow batch doesn't stall the whole range
+      batchSize = std::max(count / (GetThreadCount() * 4), 1u);
+    }
+
+    if (batchSize >= count || !s_Running) {
+      function(0, count);
+      return;
+    }
+
+    JobCounter counter;
+    // Keep the first batch for the calling thread
+    for (uint32_t begin = batchSize; begin < count; begin += batchSize) {
+      const uint32_t end = std::min(begin + batchSize, count);
+      Execute([&function, begin, end] { function(begin, end); }, &counter);
+    }
+    function(0, batchSize);
+
+    Wait(counter);
+  }
+
+  uint32_t JobSystem::GetThreadCount() {
+    return std::max((uint32_t)s_PriorityQueues[0].WorkerQueues.size(), 1u);
+  }
+
+  uint32_t JobSystem::GetThreadIndex() {
+    return t_ThreadIndex;
+  }
+
+  bool JobSystem::IsInitialized() {
+    return s_Running;
+  }
+
+  bool JobSystem::TryRunJob() {
+    Job* job = nullptr;
+    // Every high priority job anywhere goes before our own normal ones
+    for (auto& queues : s_PriorityQueues) {
+      job = TakeJob(queues, t_ThreadIndex);
+      if (job)
+        break;
+    }
+
+    if (!job)
+      return false;
+
+    s_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    RunJob(job);
+    return true;
+  }
+
+  void JobSystem::WorkerLoop(uint32_t index) {
+    t_ThreadIndex = index;
+
+    while (s_Running.load(std::memory_order_relaxed)) {
+      if (TryRunJob())
+        continue;
+
+      std::unique_lock<std::mutex> lock(s_WakeMutex);
+      s_SleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+      s_WakeCondition.wait(lock,
+        [] {
+          return s_QueuedJobs.load(std::memory_order_seq_cst) > 0 || !s_Running;
+        });
+      s_SleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    t_ThreadIndex = UINT32_MAX;
+  }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+
+namespace Oxylus {
+  /// Counts the unfinished jobs that were scheduled with it. Must outlive those jobs.
+  struct JobCounter {
+    std::atomic<uint32_t> Pending = 0;
+
+    bool IsDone() const { return Pending.load(std::memory_order_acquire) == 0; }
+  };
+
+  enum class JobPriority : uint32_t {
+    High = 0, // Frame critical work like physics steps
+    Normal,
+    Count
+  };
+
+  /// Engine wide work-stealing scheduler with one thread per core.
+  /// The thread that calls Init() takes part as worker 0 whenever it waits on a counter.
+  class JobSystem {
+  public:
+    /// Zero spawns one worker per core besides the calling thread.
+    static void Init(uint32_t workerCount = 0);
+    static void Shutdown();
+
+    static void Execute(std::function<void()> function, JobCounter* counter = nullptr, JobPriority priority = JobPriority::Normal);
+
+    /// Runs the function on a worker and hands its result back through a future.
+    template <typename Function>
+    static auto ExecuteAsync(Function&& function, JobPriority priority = JobPriority::Normal) -> std::future<std::invoke_result_t<Function>> {
+      using Result = std::invoke_result_t<Function>;
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+      auto future = task->get_future();
+      Execute([task] { (*task)(); }, nullptr, priority);
+      return future;
+    }
+
+    /// Runs other jobs on the calling thread until the counter reaches zero.
+    static void Wait(const JobCounter& counter);
+
+    /// Calls function(index) for every index in [0, count) and waits for all of them.
+    /// A batch size of zero picks one that spreads the range evenly across the workers.
+    static void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t index)>& function);
+    /// Same as ParallelFor but hands every job its whole [begin, end) range.
+    static void ParallelForRange(uint32_t count,
+                                 uint32_t batchSize,
+                                 const std::function<void(uint32_t begin, uint32_t end)>& function);
+
+    /// Worker threads plus the main thread.
+    static uint32_t GetThreadCount();
+    /// Index of the calling thread, or UINT32_MAX if it isn't owned by the job system.
+    static uint32_t GetThreadIndex();
+    static bool IsInitialized();
+
+  private:
+    static bool TryRunJob();
+    static void WorkerLoop(uint32_t index);
+  };
+}
@@ -19,14 +19,14 @@ namespace Oxylus {
   void Thread::QueueJob(std::function<void()> function) {
     std::lock_guard<std::mutex> lock(m_QueueMutex);
     m_JobQueue.push(std::move(function));
-    m_Condition.notify_one();
+    m_Condition.notify_all();
   }
 
   void Thread::Wait() {
     std::unique_lock<std::mutex> lock(m_QueueMutex);
     m_Condition.wait(lock,
       [this]() {
-        return m_JobQueue.empty();
+        return m_JobQueue.empty() && !m_Busy;
       });
   }
 
@@ -42,15 +42,17 @@ namespace Oxylus {
         if (m_Destroying) {
           break;
         }
-        job = m_JobQueue.front();
+        job = std::move(m_JobQueue.front());
+        m_JobQueue.pop();
+        m_Busy = true;
       }
 
       job();
 
       {
         std::lock_guard<std::mutex> lock(m_QueueMutex);
-        m_JobQueue.pop();
-        m_Condition.notify_one();
+        m_Busy = false;
+        m_Condition.notify_all();
       }
     }
   }
@@ -20,6 +20,7 @@ namespace Oxylus {
     void QueueLoop();
 
     bool m_Destroying = false;
+    bool m_Busy = false;
     std::thread m_Worker;
     std::queue<std::function<void()>> m_JobQueue;
     std::mutex m_QueueMutex;
@@ -9,7 +9,5 @@ namespace Oxylus {
 
   void ThreadManager::WaitAllThreads() {
     AssetThread.Wait();
-    AudioThread.Wait();
-    RenderThread.Wait();
   }
 }
@@ -5,10 +5,9 @@
 namespace Oxylus {
   class ThreadManager {
   public:
+    /// Serial queue for editor asset operations. Parallel work goes through the JobSystem.
     Thread AssetThread;
-    Thread AudioThread;
-    Thread RenderThread;
-    
+
     ThreadManager();
 
     ~ThreadManager() = default;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Oxylus {
+  /// Fixed capacity Chase-Lev deque. The owning thread pushes and pops at the bottom, any other thread steals from the top.
+  template <typename T, uint32_t Capacity>
+  class WorkStealingQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+    /// Owner only. Returns false if the queue is full.
+    bool Push(T item) {
+      const int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+      const int64_t top = m_Top.load(std::memory_order_acquire);
+      if (bottom - top >= (int64_t)Capacity)
+        return false;
+
+      m_Items[bottom & Mask].store(item, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /// Owner only. Takes the most recently pushed item.
+    bool Pop(T& item) {
+      const int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+      m_Bottom.store(bottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t top = m_Top.load(std::memory_order_relaxed);
+
+      if (top > bottom) {
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+      }
+
+      const T popped = m_Items[bottom & Mask].load(std::memory_order_relaxed);
+      if (top == bottom) {
+        // Last item, race against the thieves for it
+        const bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        if (!won)
+          return false;
+      }
+      item = popped;
+      return true;
+    }
+
+    /// Any thread. Takes the oldest item.
+    bool Steal(T& item) {
+      int64_t top = m_Top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+      if (top >= bottom)
+        return false;
+
+      const T stolen = m_Items[top & Mask].load(std::memory_order_relaxed);
+      if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return false;
+      item = stolen;
+      return true;
+    }
+
+    bool Empty() const {
+      return m_Bottom.load(std::memory_order_relaxed) <= m_Top.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr int64_t Mask = Capacity - 1;
+
+    alignas(64) std::atomic<int64_t> m_Top = 0;
+    alignas(64) std::atomic<int64_t> m_Bottom = 0;
+    alignas(64) std::array<std::atomic<T>, Capacity> m_Items = {};
+  };
+}
@@ -0,0 +1,86 @@
+#include "MappedFile.h"
+
+#ifdef OX_PLATFORM_WINDOWS
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Utils/Log.h"
+
+namespace Oxylus {
+  bool MappedFile::Open(const std::string& path) {
+    Close();
+
+#ifdef OX_PLATFORM_WINDOWS
+    const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      OX_CORE_ERROR("Couldn't open file for mapping: {}", path);
+      return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+      CloseHandle(file);
+      OX_CORE_ERROR("Couldn't map empty file: {}", path);
+      return false;
+    }
+    const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data) {
+      if (mapping)
+        CloseHandle(mapping);
+      CloseHandle(file);
+      OX_CORE_ERROR("Couldn't map file: {}", path);
+      return false;
+    }
+    m_File = file;
+    m_Mapping = mapping;
+    m_Data = static_cast<const uint8_t*>(data);
+    m_Size = static_cast<size_t>(size.QuadPart);
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+      OX_CORE_ERROR("Couldn't open file for mapping: {}", path);
+      return false;
+    }
+    struct stat status{};
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+      close(file);
+      OX_CORE_ERROR("Couldn't map empty file: {}", path);
+      return false;
+    }
+    void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps its own reference to the file
+    close(file);
+    if (data == MAP_FAILED) {
+      OX_CORE_ERROR("Couldn't map file: {}", path);
+      return false;
+    }
+    // The whole file is read right after mapping it
+    madvise(data, (size_t)status.st_size, MADV_WILLNEED);
+    m_Data = static_cast<const uint8_t*>(data);
+    m_Size = (size_t)status.st_size;
+#endif
+    return true;
+  }
+
+  void MappedFile::Close() {
+    if (!m_Data)
+      return;
+
+#ifdef OX_PLATFORM_WINDOWS
+    UnmapViewOfFile(m_Data);
+    CloseHandle(m_Mapping);
+    CloseHandle(m_File);
+    m_File = nullptr;
+    m_Mapping = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+  }
+}
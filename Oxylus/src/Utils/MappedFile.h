@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Core/PlatformDetection.h"
+
+namespace Oxylus {
+  /// Read only view of a whole file mapped into memory. Pages are brought in by the OS on first access,
+  /// so nothing is copied until the data is actually read.
+  class MappedFile {
+  public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { Open(path); }
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+
+    operator bool() const { return m_Data != nullptr; }
+
+  private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+#ifdef OX_PLATFORM_WINDOWS
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+  };
+}
@@ -58,4 +58,15 @@ namespace Oxylus::Math {
 
     return true;
   }
+
+  glm::vec2 OctEncode(const glm::vec3& n) {
+    const glm::vec3 p = n / (glm::abs(n.x) + glm::abs(n.y) + glm::abs(n.z));
+    if (p.z >= 0.0f)
+      return {p.x, p.y};
+    // Fold the lower hemisphere over the diagonals
+    return {
+      (1.0f - glm::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+      (1.0f - glm::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f)
+    };
+  }
 }
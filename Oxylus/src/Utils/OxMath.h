@@ -8,6 +8,9 @@
 namespace Oxylus::Math {
   bool DecomposeTransform(const glm::mat4& transform, glm::vec3& translation, glm::vec3& rotation, glm::vec3& scale);
 
+  /// Maps a unit vector onto the [-1, 1] square, decoded by OctDecode in VertexPacking.glsl.
+  glm::vec2 OctEncode(const glm::vec3& n);
+
   template<typename T>
   static T SmoothDamp(const T& current,
                       const T& target,
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Oxylus::Benchmark {
+  struct BenchmarkCase {
+    const char* Suite;
+    const char* Name;
+    void (*Function)();
+  };
+
+  /// Every benchmark registered with OX_BENCHMARK, in the order of their static initialization.
+  std::vector<BenchmarkCase>& GetBenchmarks();
+
+  /// Runs the function once to warm up, then repeatedly until it ran for long enough. Returns the fastest run in
+  /// milliseconds, setup the function does itself is part of it.
+  double Measure(const std::function<void()>& function);
+  /// Same as above, but calls setup before every run of the function without timing it.
+  double Measure(const std::function<void()>& setup, const std::function<void()>& function);
+  /// Prints a result of the running benchmark, e.g. Report("Job system", 1234.5, "poses/ms").
+  void Report(const char* label, double value, const char* unit);
+  /// Keeps the compiler from dropping the computation of a result nothing else reads.
+  void Consume(const void* result);
+
+  struct Registrar {
+    Registrar(const char* suite, const char* name, void (*function)()) { GetBenchmarks().push_back({suite, name, function}); }
+  };
+}
+
+#define OX_BENCHMARK(suite, name)                                                                         \
+  static void suite##_##name();                                                                           \
+  static ::Oxylus::Benchmark::Registrar suite##_##name##_Registrar(#suite, #name, suite##_##name);        \
+  static void suite##_##name()
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "Benchmark.h"
+#include "Thread/JobSystem.h"
+#include "Utils/Log.h"
+
+namespace Oxylus::Benchmark {
+  static constexpr double MinDuration = 500.0; // Milliseconds every benchmark runs for at least
+  static constexpr uint32_t MinRuns = 5;
+
+  static const void* volatile s_Sink = nullptr;
+
+  std::vector<BenchmarkCase>& GetBenchmarks() {
+    static std::vector<BenchmarkCase> benchmarks;
+    return benchmarks;
+  }
+
+  double Measure(const std::function<void()>& function) {
+    return Measure([] { }, function);
+  }
+
+  double Measure(const std::function<void()>& setup, const std::function<void()>& function) {
+    using Clock = std::chrono::steady_clock;
+    setup();
+    function();
+
+    double fastest = DBL_MAX;
+    double total = 0.0;
+    for (uint32_t run = 0; run < MinRuns || total < MinDuration; run++) {
+      setup();
+      const auto start = Clock::now();
+      function();
+      const double duration = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+      fastest = std::min(fastest, duration);
+      total += duration;
+    }
+    return fastest;
+  }
+
+  void Report(const char* label, const double value, const char* unit) {
+    std::printf("  %-32s %12.1f %s\n", label, value, unit);
+  }
+
+  void Consume(const void* result) {
+    s_Sink = result;
+  }
+}
+
+/// Runs every benchmark, or only the ones of the suite passed as the first argument.
+int main(const int argc, char** argv) {
+  using namespace Oxylus;
+  Log::Init();
+  JobSystem::Init();
+
+  const char* suite = argc > 1 ? argv[1] : nullptr;
+  uint32_t run = 0;
+  for (const Benchmark::BenchmarkCase& benchmark : Benchmark::GetBenchmarks()) {
+    if (suite && std::strcmp(suite, benchmark.Suite) != 0)
+      continue;
+    std::printf("%s.%s\n", benchmark.Suite, benchmark.Name);
+    benchmark.Function();
+    run++;
+  }
+
+  JobSystem::Shutdown();
+  if (!run) {
+    std::printf("No benchmarks in suite %s\n", suite ? suite : "");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,60 @@
+#include <random>
+
+#include "Benchmark.h"
+#include "Physics/Physics.h"
+#include "Physics/PhysicsQueries.h"
+
+#include "Jolt/Physics/PhysicsSystem.h"
+#include "Jolt/Physics/Body/BodyCreationSettings.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+
+namespace Oxylus {
+  static constexpr uint32_t BodyCount = 10000;
+  static constexpr uint32_t RayCount = 10000; // Rays AI and projectiles of a busy frame issue
+  static constexpr float WorldSize = 500.0f;
+
+  OX_BENCHMARK(PhysicsQueries, Raycast) {
+    Physics::Init();
+    std::mt19937 random(13);
+    std::uniform_real_distribution<float> position(-WorldSize * 0.5f, WorldSize * 0.5f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    // A field of static boxes, the layer and user data are set up like the ones of scene rigidbodies
+    auto& bodyInterface = Physics::GetBodyInterface();
+    const JPH::ObjectLayer layer = Physics::LayerCollisionMask[BIT(0)].Index;
+    const JPH::Ref<JPH::Shape> box = new JPH::BoxShape(JPH::Vec3(1.0f, 2.0f, 1.0f));
+    for (uint32_t i = 0; i < BodyCount; i++) {
+      JPH::BodyCreationSettings settings(box, {position(random), 2.0f, position(random)}, JPH::Quat::sIdentity(), JPH::EMotionType::Static, layer);
+      settings.mUserData = i;
+      bodyInterface.CreateAndAddBody(settings, JPH::EActivation::DontActivate);
+    }
+    Physics::GetPhysicsSystem()->OptimizeBroadPhase();
+
+    std::vector<PhysicsQueries::RaycastRequest> requests(RayCount);
+    for (auto& request : requests) {
+      request.Origin = Vec3(position(random), 1.5f, position(random));
+      request.Direction = glm::normalize(Vec3(unit(random), unit(random) * 0.1f, unit(random))) * 50.0f;
+    }
+
+    std::vector<PhysicsQueries::CastHit> hits;
+    const double batched = Benchmark::Measure([&] { PhysicsQueries::Raycast(requests, hits); });
+    uint32_t hitCount = 0;
+    for (const auto& hit : hits)
+      hitCount += hit.HasHit() ? 1 : 0;
+
+    // One request per call, like gameplay code casting its rays one at a time
+    std::vector<PhysicsQueries::RaycastRequest> single(1);
+    const double oneByOne = Benchmark::Measure([&] {
+      for (const auto& request : requests) {
+        single[0] = request;
+        PhysicsQueries::Raycast(single, hits);
+      }
+    });
+    Benchmark::Consume(hits.data());
+
+    Benchmark::Report("Hits", hitCount, "rays");
+    Benchmark::Report("Batched", RayCount / batched, "rays/ms");
+    Benchmark::Report("One ray per call", RayCount / oneByOne, "rays/ms");
+    Physics::Shutdown();
+  }
+}
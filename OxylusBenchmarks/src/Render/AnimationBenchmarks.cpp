@@ -0,0 +1,83 @@
+#include <cmath>
+
+#include "Benchmark.h"
+#include "Render/Animation.h"
+#include "Thread/JobSystem.h"
+
+namespace Oxylus {
+  static constexpr uint32_t JointCount = 64;      // About a game character with fingers
+  static constexpr uint32_t CharacterCount = 1024;
+  static constexpr float DeltaTime = 1.0f / 60.0f;
+
+  static Skeleton CreateSkeleton() {
+    Skeleton skeleton;
+    for (uint32_t joint = 0; joint < JointCount; joint++) {
+      skeleton.Parents.emplace_back(joint == 0 ? -1 : (int32_t)(joint - 1) / 2);
+      skeleton.InverseBindMatrices.emplace_back(1.0f);
+      skeleton.RootTransforms.emplace_back(1.0f);
+    }
+    skeleton.RestPose.Resize(JointCount);
+    return skeleton;
+  }
+
+  /// Every joint swings around its own axis with its own phase.
+  static AnimationClip CreateClip(const float duration, const float frequency) {
+    AnimationClip clip;
+    clip.Create(duration, JointCount);
+    Pose pose;
+    pose.Resize(JointCount);
+    for (uint32_t frame = 0; frame < clip.GetFrameCount(); frame++) {
+      const float time = clip.GetFrameTime(frame);
+      for (uint32_t joint = 0; joint < JointCount; joint++) {
+        const Vec3 axis = glm::normalize(Vec3(std::sin((float)joint), std::cos((float)joint), 1.0f));
+        const float angle = std::sin(time * frequency + (float)joint) * 0.5f;
+        pose.SetJoint(joint, Vec3(0.0f, 0.1f, 0.0f), glm::angleAxis(angle, axis), Vec3(1.0f));
+      }
+      clip.SetFrame(frame, pose);
+    }
+    return clip;
+  }
+
+  struct Character {
+    float Time = 0.0f;
+    std::vector<Mat4> SkinningMatrices;
+  };
+
+  /// What Scene::UpdateAnimations does for a character playing two blended clips.
+  static void EvaluateCharacter(const Skeleton& skeleton, const AnimationClip& walk, const AnimationClip& run, Character& character) {
+    thread_local Pose pose;
+    thread_local Pose blendPose;
+    character.Time += DeltaTime;
+    pose.Resize(JointCount);
+    blendPose.Resize(JointCount);
+    walk.Sample(character.Time, true, pose);
+    run.Sample(character.Time, true, blendPose);
+    Pose::Blend(pose, blendPose, 0.5f, pose);
+    skeleton.ComputeSkinningMatrices(pose, character.SkinningMatrices.data());
+  }
+
+  OX_BENCHMARK(Animation, PosesPerMillisecond) {
+    const Skeleton skeleton = CreateSkeleton();
+    const AnimationClip walk = CreateClip(1.2f, 5.0f);
+    const AnimationClip run = CreateClip(0.8f, 8.0f);
+    std::vector<Character> characters(CharacterCount);
+    for (uint32_t i = 0; i < CharacterCount; i++) {
+      characters[i].Time = (float)i * 0.37f;
+      characters[i].SkinningMatrices.resize(JointCount);
+    }
+
+    const double singleThread = Benchmark::Measure([&] {
+      for (auto& character : characters)
+        EvaluateCharacter(skeleton, walk, run, character);
+    });
+    const double jobSystem = Benchmark::Measure([&] {
+      JobSystem::ParallelFor(CharacterCount, 0, [&](const uint32_t index) {
+        EvaluateCharacter(skeleton, walk, run, characters[index]);
+      });
+    });
+    Benchmark::Consume(characters.data());
+
+    Benchmark::Report("Single thread", CharacterCount / singleThread, "poses/ms");
+    Benchmark::Report("Job system", CharacterCount / jobSystem, "poses/ms");
+  }
+}
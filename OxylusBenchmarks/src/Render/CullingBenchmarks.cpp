@@ -0,0 +1,82 @@
+#include <cmath>
+#include <random>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.h"
+#include "Render/BoundingVolumeHierarchy.h"
+#include "Render/Frustum.h"
+
+namespace Oxylus {
+  static constexpr uint32_t ObjectCount = 100000;
+  static constexpr float WorldSize = 2000.0f; // Open world where a small part is on screen
+
+  static std::vector<AABB> CreateObjects() {
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> position(-WorldSize * 0.5f, WorldSize * 0.5f);
+    std::uniform_real_distribution<float> size(0.5f, 8.0f);
+    std::vector<AABB> objects;
+    objects.reserve(ObjectCount);
+    for (uint32_t i = 0; i < ObjectCount; i++) {
+      const Vec3 center = Vec3(position(random), size(random), position(random));
+      const Vec3 extents = Vec3(size(random), size(random), size(random)) * 0.5f;
+      objects.emplace_back(center - extents, center + extents);
+    }
+    return objects;
+  }
+
+  static Frustum CreateCameraFrustum() {
+    const Mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    const Mat4 view = glm::lookAt(Vec3(0.0f, 2.0f, 0.0f), Vec3(1.0f, 2.0f, 1.0f), Vec3(0.0f, 1.0f, 0.0f));
+    return Frustum(projection * view);
+  }
+
+  OX_BENCHMARK(Culling, FrustumQuery) {
+    const std::vector<AABB> objects = CreateObjects();
+    const Frustum frustum = CreateCameraFrustum();
+    BoundingVolumeHierarchy bvh;
+    for (uint32_t i = 0; i < ObjectCount; i++)
+      bvh.CreateProxy(objects[i], i);
+
+    std::vector<uint32_t> visible;
+    visible.reserve(ObjectCount);
+    const double bruteForce = Benchmark::Measure([&] {
+      visible.clear();
+      for (uint32_t i = 0; i < ObjectCount; i++) {
+        if (frustum.IsVisible(objects[i]))
+          visible.emplace_back(i);
+      }
+    });
+    const double query = Benchmark::Measure([&] {
+      visible.clear();
+      bvh.Query(frustum, visible);
+    });
+    Benchmark::Consume(visible.data());
+
+    Benchmark::Report("Visible", (double)visible.size(), "objects");
+    Benchmark::Report("Frustum test of every object", ObjectCount / bruteForce, "objects/ms");
+    Benchmark::Report("BVH query", ObjectCount / query, "objects/ms");
+  }
+
+  /// Bounds updates for a tenth of the objects moving a little every frame, like the renderer does for moved entities.
+  OX_BENCHMARK(Culling, MoveProxies) {
+    static constexpr uint32_t MovingCount = ObjectCount / 10;
+    std::vector<AABB> objects = CreateObjects();
+    BoundingVolumeHierarchy bvh;
+    std::vector<int32_t> proxies;
+    for (uint32_t i = 0; i < ObjectCount; i++)
+      proxies.emplace_back(bvh.CreateProxy(objects[i], i));
+
+    float time = 0.0f;
+    const double moves = Benchmark::Measure([&] {
+      time += 1.0f / 60.0f;
+      const Vec3 offset = Vec3(std::sin(time), 0.0f, std::cos(time)) * 0.05f;
+      for (uint32_t i = 0; i < MovingCount; i++) {
+        objects[i].Min += offset;
+        objects[i].Max += offset;
+        bvh.MoveProxy(proxies[i], objects[i]);
+      }
+    });
+
+    Benchmark::Report("MoveProxy", MovingCount / moves, "objects/ms");
+  }
+}
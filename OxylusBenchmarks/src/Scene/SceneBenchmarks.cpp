@@ -0,0 +1,131 @@
+#include <random>
+
+#include "Benchmark.h"
+#include "Core/Entity.h"
+#include "Scene/Scene.h"
+
+namespace Oxylus {
+  static constexpr uint32_t ModelCount = 100;
+  static constexpr uint32_t NodesPerModel = 1000; // 100k entities in total
+  static constexpr uint32_t NodeFanOut = 4;
+
+  /// Models like imported glTF files, every node of a model is a child of one of the nodes created before it.
+  /// Returns the entities model by model, the root of each one first.
+  static std::vector<Entity> CreateHierarchy(Scene& scene) {
+    std::vector<Entity> entities;
+    entities.reserve(ModelCount * NodesPerModel);
+    for (uint32_t model = 0; model < ModelCount; model++) {
+      const size_t root = entities.size();
+      for (uint32_t node = 0; node < NodesPerModel; node++) {
+        Entity entity = scene.CreateEntity("Node");
+        auto& transform = entity.GetTransform();
+        transform.Translation = Vec3((float)node * 0.01f, 1.0f, 0.0f);
+        transform.Rotation = Vec3(0.0f, (float)node * 0.1f, 0.0f);
+        if (node)
+          entity.SetParent(entities[root + (node - 1) / NodeFanOut]);
+        entities.emplace_back(entity);
+      }
+    }
+    return entities;
+  }
+
+  OX_BENCHMARK(Scene, UpdateTransforms) {
+    Scene scene("Benchmark");
+    const std::vector<Entity> entities = CreateHierarchy(scene);
+    scene.UpdateTransforms();
+
+    float offset = 0.0f;
+    const double allMoved = Benchmark::Measure([&] {
+      offset += 0.001f;
+      for (uint32_t model = 0; model < ModelCount; model++)
+        entities[model * NodesPerModel].GetTransform().Translation.x = offset;
+      scene.UpdateTransforms();
+    });
+
+    // One node per model, anywhere in its tree
+    std::mt19937 random(5);
+    std::vector<Entity> moved;
+    for (uint32_t model = 0; model < ModelCount; model++)
+      moved.emplace_back(entities[model * NodesPerModel + random() % NodesPerModel]);
+    const double someMoved = Benchmark::Measure([&] {
+      offset += 0.001f;
+      for (const Entity& entity : moved)
+        entity.GetTransform().Translation.z = offset;
+      scene.UpdateTransforms();
+    });
+
+    const double noneMoved = Benchmark::Measure([&] { scene.UpdateTransforms(); });
+
+    Benchmark::Report("Every root moved", (double)entities.size() / allMoved, "entities/ms");
+    Benchmark::Report("Every root moved", allMoved * 1000.0, "us/update");
+    Benchmark::Report("One node per model moved", someMoved * 1000.0, "us/update");
+    Benchmark::Report("Nothing moved", noneMoved * 1000.0, "us/update");
+  }
+
+  OX_BENCHMARK(Scene, HierarchyTraversal) {
+    Scene scene("Benchmark");
+    const std::vector<Entity> entities = CreateHierarchy(scene);
+    scene.UpdateTransforms(); // Sorts the storages depth first
+
+    std::vector<Entity> descendants;
+    descendants.reserve(entities.size());
+    const double traversal = Benchmark::Measure([&] {
+      descendants.clear();
+      for (uint32_t model = 0; model < ModelCount; model++)
+        Entity::GetAllChildren(entities[model * NodesPerModel], descendants);
+    });
+    Benchmark::Consume(descendants.data());
+
+    Benchmark::Report("GetAllChildren", (double)entities.size() / traversal, "entities/ms");
+  }
+
+  OX_BENCHMARK(Scene, Reparenting) {
+    static constexpr uint32_t ReparentCount = 10000;
+    Scene scene("Benchmark");
+    const std::vector<Entity> entities = CreateHierarchy(scene);
+    scene.UpdateTransforms();
+
+    // Nodes move to the root of the next model and back to their parent, neither can be one of their descendants
+    struct Move {
+      Entity Node;
+      Entity Parent;
+      Entity Root;
+    };
+    std::mt19937 random(7);
+    std::vector<Move> moves;
+    for (uint32_t i = 0; i < ReparentCount; i++) {
+      const uint32_t model = random() % ModelCount;
+      const Entity& node = entities[model * NodesPerModel + 1 + random() % (NodesPerModel - 1)];
+      moves.push_back({node, node.GetParent(), entities[(model + 1) % ModelCount * NodesPerModel]});
+    }
+    const auto moveAndRestore = [&moves] {
+      for (const Move& move : moves)
+        move.Node.SetParent(move.Root);
+      for (const Move& move : moves)
+        move.Node.SetParent(move.Parent);
+    };
+
+    const double reparenting = Benchmark::Measure(moveAndRestore);
+    // The next update sorts the storages depth first again
+    const double update = Benchmark::Measure(moveAndRestore, [&scene] { scene.UpdateTransforms(); });
+
+    Benchmark::Report("SetParent", ReparentCount * 2 / reparenting, "reparents/ms");
+    Benchmark::Report("UpdateTransforms after reparenting", update * 1000.0, "us/update");
+  }
+
+  OX_BENCHMARK(Scene, DestroyEntity) {
+    Scope<Scene> scene = nullptr;
+    std::vector<Entity> entities;
+    const double destroy = Benchmark::Measure([&] {
+        scene = CreateScope<Scene>("Benchmark");
+        entities = CreateHierarchy(*scene);
+        scene->UpdateTransforms();
+      },
+      [&] {
+        for (uint32_t model = 0; model < ModelCount; model++)
+          scene->DestroyEntity(entities[model * NodesPerModel]);
+      });
+
+    Benchmark::Report("DestroyEntity of every model", (double)(ModelCount * NodesPerModel) / destroy, "entities/ms");
+  }
+}
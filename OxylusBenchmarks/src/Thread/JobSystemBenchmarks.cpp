@@ -0,0 +1,69 @@
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Thread/JobSystem.h"
+#include "Thread/Thread.h"
+
+namespace Oxylus {
+  static constexpr uint32_t JobCount = 10000;
+  static constexpr uint32_t RoundTripCount = 1000;
+
+  /// A few hundred nanoseconds of work, small enough for the scheduling overhead to show.
+  static void SmallJob(float& result) {
+    float value = result;
+    for (uint32_t i = 0; i < 64; i++)
+      value = std::sqrt(value + (float)i);
+    result = value;
+  }
+
+  OX_BENCHMARK(JobSystem, Throughput) {
+    std::vector<float> results(JobCount, 1.0f);
+
+    Thread thread;
+    const double threadQueue = Benchmark::Measure([&] {
+      for (uint32_t i = 0; i < JobCount; i++)
+        thread.QueueJob([&results, i] { SmallJob(results[i]); });
+      thread.Wait();
+    });
+    const double jobSystem = Benchmark::Measure([&] {
+      JobCounter counter;
+      for (uint32_t i = 0; i < JobCount; i++)
+        JobSystem::Execute([&results, i] { SmallJob(results[i]); }, &counter);
+      JobSystem::Wait(counter);
+    });
+    const double parallelFor = Benchmark::Measure([&] {
+      JobSystem::ParallelFor(JobCount, 0, [&results](const uint32_t index) { SmallJob(results[index]); });
+    });
+    Benchmark::Consume(results.data());
+
+    Benchmark::Report("Thread::QueueJob", JobCount / threadQueue, "jobs/ms");
+    Benchmark::Report("JobSystem::Execute", JobCount / jobSystem, "jobs/ms");
+    Benchmark::Report("JobSystem::ParallelFor", JobCount / parallelFor, "jobs/ms");
+  }
+
+  /// Time from scheduling a single job until the caller saw it finish, with nothing else queued.
+  OX_BENCHMARK(JobSystem, Latency) {
+    float result = 1.0f;
+
+    Thread thread;
+    const double threadQueue = Benchmark::Measure([&] {
+      for (uint32_t i = 0; i < RoundTripCount; i++) {
+        thread.QueueJob([&result] { SmallJob(result); });
+        thread.Wait();
+      }
+    });
+    const double jobSystem = Benchmark::Measure([&] {
+      for (uint32_t i = 0; i < RoundTripCount; i++) {
+        JobCounter counter;
+        JobSystem::Execute([&result] { SmallJob(result); }, &counter);
+        JobSystem::Wait(counter);
+      }
+    });
+    Benchmark::Consume(&result);
+
+    Benchmark::Report("Thread::QueueJob", threadQueue * 1000.0 / RoundTripCount, "us/job");
+    Benchmark::Report("JobSystem::Execute", jobSystem * 1000.0 / RoundTripCount, "us/job");
+  }
+}
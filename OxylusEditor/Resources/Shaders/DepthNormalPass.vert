@@ -1,12 +1,14 @@
 #version 450
 
+#include "VertexPacking.glsl"
+
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_ARB_shading_language_420pack : enable
 
 layout(location = 0) in vec3 inPos;
-layout(location = 1) in vec3 inNormal;
+layout(location = 1) in vec2 inPackedNormal;
 layout(location = 2) in vec2 inUV;
-layout(location = 3) in vec4 inTangent;
+layout(location = 3) in vec2 inPackedTangent;
 
 layout(set = 0, binding = 0) uniform UBO {
   mat4 projection;
@@ -26,6 +28,8 @@ layout(location = 3) out mat3 outWorldTangent;
 out gl_PerVertex { vec4 gl_Position; };
 
 void main() {
+  const vec3 inNormal = OctDecode(inPackedNormal);
+  const vec4 inTangent = DecodeTangent(inPackedTangent);
   vec3 locPos = vec3(u_ModelUbo.model * vec4(inPos, 1.0));
   outWorldPos = locPos;
 
@@ -36,7 +40,7 @@ void main() {
 
   outUV = inUV;
 
-  vec3 T = normalize((u_ModelUbo.model * (inTangent + vec4(0.00001))).xyz);
+  vec3 T = normalize((u_ModelUbo.model * vec4(inTangent.xyz, 0.0)).xyz);
   vec3 N = normalize((u_ModelUbo.model * vec4(inNormal, 0.0)).xyz);
   T = normalize(T - dot(T, N) * N);
   vec3 B = cross(N, T);
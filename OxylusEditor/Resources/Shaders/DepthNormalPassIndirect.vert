@@ -0,0 +1,51 @@
+#version 450
+
+#include "VertexPacking.glsl"
+
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_420pack : enable
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec2 inPackedNormal;
+layout(location = 2) in vec2 inUV;
+layout(location = 3) in vec2 inPackedTangent;
+
+layout(set = 0, binding = 0) uniform UBO {
+  mat4 projection;
+  mat4 view;
+  vec3 camPos;
+}
+u_Ubo;
+
+layout(set = 2, binding = 0) readonly buffer Instances { mat4 u_Instances[]; };
+
+layout(location = 0) out vec3 outWorldPos;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec2 outUV;
+layout(location = 3) out mat3 outWorldTangent;
+
+out gl_PerVertex { vec4 gl_Position; };
+
+void main() {
+  const vec3 inNormal = OctDecode(inPackedNormal);
+  const vec4 inTangent = DecodeTangent(inPackedTangent);
+  const mat4 model = u_Instances[gl_InstanceIndex];
+  vec3 locPos = vec3(model * vec4(inPos, 1.0));
+  outWorldPos = locPos;
+
+  // normal in viewspace
+  mat4 view = u_Ubo.view;
+  mat3 normalMatrix = transpose(inverse(mat3(model)));
+  outNormal = normalMatrix * inNormal;
+
+  outUV = inUV;
+
+  vec3 T = normalize((model * vec4(inTangent.xyz, 0.0)).xyz);
+  vec3 N = normalize((model * vec4(inNormal, 0.0)).xyz);
+  T = normalize(T - dot(T, N) * N);
+  vec3 B = cross(N, T);
+
+  outWorldTangent = mat3(T, B, N);
+
+  gl_Position = u_Ubo.projection * u_Ubo.view * vec4(outWorldPos, 1.0);
+}
\ No newline at end of file
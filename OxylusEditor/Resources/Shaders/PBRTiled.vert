@@ -1,10 +1,12 @@
 #version 450
 
+#include "VertexPacking.glsl"
+
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_ARB_shading_language_420pack : enable
 
 layout(location = 0) in vec3 in_Pos;
-layout(location = 1) in vec3 in_Normal;
+layout(location = 1) in vec2 in_PackedNormal;
 layout(location = 2) in vec2 in_UV;
 
 layout(binding = 0) uniform UBO {
@@ -25,6 +27,7 @@ layout(location = 3) out vec3 out_ViewPos;
 out gl_PerVertex { vec4 gl_Position; };
 
 void main() {
+  const vec3 in_Normal = OctDecode(in_PackedNormal);
   vec3 locPos = vec3(u_ModelUbo.model * vec4(in_Pos, 1.0));
   out_WorldPos = locPos;
   out_ViewPos = (u_Ubo.view * vec4(locPos.xyz, 1.0)).xyz;
@@ -3,7 +3,6 @@
 layout(location = 0) in vec3 in_Position;
 layout(location = 1) in vec3 in_Normal;
 layout(location = 2) in vec2 in_TexCoord;
-layout(location = 3) in vec4 in_Color;
 
 layout(location = 0) out vec3 out_Position;
 layout(location = 2) out vec2 out_TexCoord;
@@ -0,0 +1,29 @@
+// Encoding and decoding of the attributes in Mesh::PackedVertex
+
+vec2 OctEncode(vec3 n) {
+  const vec3 p = n / (abs(n.x) + abs(n.y) + abs(n.z));
+  if (p.z >= 0.0)
+    return p.xy;
+  // Fold the lower hemisphere over the diagonals
+  return vec2((1.0 - abs(p.y)) * (p.x >= 0.0 ? 1.0 : -1.0), (1.0 - abs(p.x)) * (p.y >= 0.0 ? 1.0 : -1.0));
+}
+
+vec3 OctDecode(vec2 e) {
+  vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+  const float t = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -t : t;
+  n.y += n.y >= 0.0 ? -t : t;
+  return normalize(n);
+}
+
+// xyz: tangent, w: bitangent sign. The sign is stored in the second component, which holds the
+// octahedral coordinate remapped to [0.5, 1].
+vec4 DecodeTangent(vec2 e) {
+  const float sign = e.y < 0.0 ? -1.0 : 1.0;
+  return vec4(OctDecode(vec2(e.x, (abs(e.y) - 0.75) * 4.0)), sign);
+}
+
+vec2 EncodeTangent(vec4 t) {
+  const vec2 e = OctEncode(t.xyz);
+  return vec2(e.x, (t.w < 0.0 ? -1.0 : 1.0) * (0.75 + 0.25 * e.y));
+}
@@ -65,6 +65,7 @@ namespace Oxylus {
 
     {".gltf", FileType::Model},
     {".glb", FileType::Model},
+    {".oxmesh", FileType::Model},
     {".oxmat", FileType::Material},
 
     {".mp3", FileType::Audio},
@@ -260,6 +260,7 @@ namespace Oxylus {
     }
     if (ImGui::BeginPopup("Add Component")) {
       DrawAddComponent<MeshRendererComponent>(m_SelectedEntity, "Mesh Renderer");
+      DrawAddComponent<AnimationComponent>(m_SelectedEntity, "Animation");
       DrawAddComponent<MaterialComponent>(m_SelectedEntity, "Material");
       DrawAddComponent<AudioSourceComponent>(m_SelectedEntity, "Audio Source");
       DrawAddComponent<LightComponent>(m_SelectedEntity, "Light");
@@ -310,6 +311,19 @@ namespace Oxylus {
         ImGui::Text("Loaded Mesh: %s", fileName);
       });
 
+    DrawComponent<AnimationComponent>(ICON_MDI_ANIMATION " Animation Component",
+      entity,
+      [](AnimationComponent& component) {
+        IGUI::BeginProperties();
+        IGUI::Property("Clip", component.ClipIndex);
+        IGUI::Property("Time", component.Time);
+        IGUI::Property("Speed", component.Speed);
+        IGUI::Property("Loop", component.Loop);
+        IGUI::Property("Blend Clip", component.BlendClipIndex);
+        IGUI::Property("Blend Weight", component.BlendWeight, 0.0f, 1.0f);
+        IGUI::EndProperties();
+      });
+
     DrawComponent<MaterialComponent>(ICON_MDI_SPRAY " Material Component",
       entity,
       [](MaterialComponent& component) {
@@ -57,6 +57,18 @@ namespace Oxylus {
       ConfigProperty(IGUI::Property<>("Max Distance", RendererConfig::Get()->SSRConfig.MaxDist, 50.0f, 500.0f));
       IGUI::EndProperties();
 
+      ImGui::Text("GPU Driven Rendering");
+      IGUI::BeginProperties();
+      ConfigProperty(IGUI::Property("Enabled", RendererConfig::Get()->GPUDrivenConfig.Enabled));
+      ConfigProperty(IGUI::Property("Occlusion Culling", RendererConfig::Get()->GPUDrivenConfig.OcclusionCulling));
+      IGUI::EndProperties();
+
+      ImGui::Text("LOD");
+      IGUI::BeginProperties();
+      ConfigProperty(IGUI::Property("Enabled", RendererConfig::Get()->LodConfig.Enabled));
+      ConfigProperty(IGUI::Property<float>("Error Threshold", RendererConfig::Get()->LodConfig.ErrorThreshold, 0, 16));
+      IGUI::EndProperties();
+
       OnEnd();
     }
   }
@@ -35,15 +35,15 @@ namespace Oxylus {
     ImGui::TableNextColumn();
 
     const auto& rc = entity.GetRelationship();
-    const size_t childrenSize = rc.Children.size();
+    const size_t childrenSize = rc.ChildCount;
 
     auto& tagComponent = entity.GetComponent<TagComponent>();
     auto& tag = tagComponent.Tag;
 
     if (m_Filter.IsActive() && !m_Filter.PassFilter(tag.c_str())) {
-      for (const auto& childId : rc.Children) {
-        DrawEntityNode(m_Context->GetEntityByUUID(childId));
-      }
+      entity.ForEachChild([this](Entity child) {
+        DrawEntityNode(child);
+      });
       return {0, 0, 0, 0};
     }
 
@@ -220,9 +220,8 @@ namespace Oxylus {
         ImVec2 verticalLineEnd = verticalLineStart;
         constexpr float lineThickness = 1.5f;
 
-        for (const auto& childId : rc.Children) {
-          Entity child = m_Context->GetEntityByUUID(childId);
-          const float HorizontalTreeLineSize = child.GetRelationship().Children.empty() ? 18.0f : 9.0f;
+        entity.ForEachChild([&](Entity child) {
+          const float HorizontalTreeLineSize = child.GetRelationship().ChildCount == 0 ? 18.0f : 9.0f;
           // chosen arbitrarily
           const ImRect childRect = DrawEntityNode(child, depth + 1, forceExpandTree, isPartOfPrefab);
 
@@ -232,7 +231,7 @@ namespace Oxylus {
             treeLineColor,
             lineThickness);
           verticalLineEnd.y = midpoint;
-        }
+        });
 
         drawList->AddLine(verticalLineStart, verticalLineEnd, treeLineColor, lineThickness);
       }
@@ -255,7 +254,7 @@ namespace Oxylus {
         if (path.extension() == ".oxscene") {
           EditorLayer::Get()->OpenScene(path);
         }
-        if (path.extension() == ".gltf" || path.extension() == ".glb") {
+        if (path.extension() == ".gltf" || path.extension() == ".glb" || path.extension() == Mesh::CookedExtension) {
           m_Context->CreateEntityWithMesh(AssetManager::GetMeshAsset(path.string()));
         }
         if (path.extension() == ".oxprefab") {
@@ -0,0 +1,100 @@
+#include <Core/Application.h>
+#include <Core/Entity.h>
+#include <Core/Resources.h>
+#include <Render/DefaultRenderPipeline.h>
+#include <Render/Frustum.h>
+#include <Render/RendererConfig.h>
+#include <Render/Vulkan/VulkanContext.h>
+#include <Render/Vulkan/VulkanRenderer.h>
+#include <Scene/Scene.h>
+#include <Utils/Log.h>
+
+#include "GPUTest.h"
+
+namespace Oxylus {
+  /// Renders a static grid of cubes on the CPU path, then on the GPU driven path, and checks both drew the same.
+  /// Cubes crossing the camera frustum are left out, the CPU path tests instance boxes and the GPU path meshlet bounds.
+  class DrawCountParityLayer : public GPUTest::TestLayer {
+  public:
+    /// Enough for the GPU driven count to be read back from a frame that already drew the whole scene.
+    static constexpr uint32_t FramesPerPath = 8;
+    static constexpr int32_t GridExtent = 4;
+    static constexpr float GridSpacing = 6.0f;
+
+    DrawCountParityLayer() : TestLayer("Draw Count Parity Layer") { }
+
+    void OnAttach(EventDispatcher& dispatcher) override {
+      auto& config = *RendererConfig::Get();
+      config.GPUDrivenConfig.Enabled = false;
+      config.GPUDrivenConfig.OcclusionCulling = false; // Depends on the previous frame
+      config.LodConfig.Enabled = false;                // The paths pick levels from different bounds
+
+      m_Scene = CreateRef<Scene>();
+      auto& camera = *m_Scene->CreateEntity("Camera").AddComponentI<CameraComponent>().System;
+      camera.Update(Vec3(0.0f), Vec3(0.0f));
+      const Frustum frustum(camera.GetProjectionMatrixFlipped() * camera.GetViewMatrix());
+
+      const auto cube = CreateRef<Mesh>(Resources::GetResourcesPath("Objects/cube.glb"));
+      const Mesh::Node* node = nullptr;
+      for (const auto* linearNode : cube->LinearNodes) {
+        if (linearNode->ContainsMesh) {
+          node = linearNode;
+          break;
+        }
+      }
+      OX_CORE_ASSERT(node && node->Children.empty());
+      AABB bounds = {};
+      for (const auto* primitive : node->Primitives)
+        bounds.Merge(AABB(primitive->dimensions.min, primitive->dimensions.max));
+      // Bounding spheres of the meshlets stay within this margin around the box
+      const float margin = glm::length(bounds.GetExtents());
+
+      for (int32_t x = -GridExtent; x <= GridExtent; x++) {
+        for (int32_t y = -GridExtent; y <= GridExtent; y++) {
+          for (int32_t z = -GridExtent; z <= GridExtent; z++) {
+            const Vec3 translation = Vec3((float)x, (float)y, (float)z) * GridSpacing;
+            const auto intersection = frustum.Intersect(AABB(bounds.Min + translation, bounds.Max + translation).Expanded(margin));
+            if (intersection == FrustumIntersection::Intersects)
+              continue;
+
+            Entity entity = m_Scene->CreateEntity("Cube");
+            entity.GetComponent<TransformComponent>().Translation = translation;
+            entity.AddComponentI<MeshRendererComponent>(cube).SubmesIndex = node->Index;
+            entity.GetComponent<MaterialComponent>().Materials = cube->GetMaterialsAsRef();
+            if (intersection == FrustumIntersection::Inside)
+              m_ExpectedDrawCount += (uint32_t)node->Primitives.size();
+          }
+        }
+      }
+      m_Scene->OnRuntimeStart();
+    }
+
+    void OnUpdate(const Timestep deltaTime) override {
+      m_Scene->OnRuntimeUpdate(deltaTime);
+      if (++m_Frame % FramesPerPath)
+        return;
+
+      auto& gpuDriven = RendererConfig::Get()->GPUDrivenConfig;
+      const uint32_t drawCount = VulkanRenderer::GetDefaultRenderPipeline()->GetCameraDrawCount();
+      if (!gpuDriven.Enabled) {
+        m_CPUDrawCount = drawCount;
+        gpuDriven.Enabled = true;
+        return;
+      }
+
+      OX_CORE_INFO("Expected {} draws, the CPU path drew {}, the GPU driven path {}", m_ExpectedDrawCount, m_CPUDrawCount, drawCount);
+      if (!VulkanContext::Context.SupportsDrawIndirectCount)
+        OX_CORE_ERROR("The device can't draw indirect counts, the GPU driven path never ran");
+      m_Passed = VulkanContext::Context.SupportsDrawIndirectCount && m_ExpectedDrawCount && m_CPUDrawCount == m_ExpectedDrawCount && drawCount == m_CPUDrawCount;
+      Application::Get()->Close();
+    }
+
+  private:
+    Ref<Scene> m_Scene = nullptr;
+    uint32_t m_Frame = 0;
+    uint32_t m_ExpectedDrawCount = 0;
+    uint32_t m_CPUDrawCount = 0;
+  };
+
+  OX_GPU_TEST(DrawCountParity);
+}
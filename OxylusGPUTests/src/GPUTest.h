@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include <Core/Layer.h>
+
+namespace Oxylus::GPUTest {
+  /// Layer the application runs a test with. It closes the application once it's done.
+  class TestLayer : public Layer {
+  public:
+    using Layer::Layer;
+
+    bool Passed() const { return m_Passed; }
+
+  protected:
+    bool m_Passed = false;
+  };
+
+  struct TestCase {
+    const char* Name;
+    TestLayer* (*Create)();
+  };
+
+  /// Every test registered with OX_GPU_TEST, in the order of their static initialization.
+  std::vector<TestCase>& GetTests();
+
+  struct Registrar {
+    Registrar(const char* name, TestLayer* (*create)()) { GetTests().push_back({name, create}); }
+  };
+}
+
+/// Registers the layer class name##Layer as the test name.
+#define OX_GPU_TEST(name) \
+  static ::Oxylus::GPUTest::Registrar name##_Registrar(#name, []() -> ::Oxylus::GPUTest::TestLayer* { return new name##Layer(); })
@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <cstring>
+
+#include <Core/Application.h>
+#include <Utils/Log.h>
+
+#include "GPUTest.h"
+
+namespace Oxylus {
+  namespace GPUTest {
+    std::vector<TestCase>& GetTests() {
+      static std::vector<TestCase> tests;
+      return tests;
+    }
+  }
+
+  class OxylusGPUTests : public Application {
+  public:
+    OxylusGPUTests(const AppSpec& spec) : Application(spec) { }
+  };
+}
+
+// Like the engine's entry point, but runs the test named by the first argument and its result is the exit code
+int main(int argc, char** argv) {
+  using namespace Oxylus;
+  Log::Init();
+
+  const GPUTest::TestCase* test = nullptr;
+  for (const auto& testCase : GPUTest::GetTests()) {
+    if (argc > 1 && std::strcmp(argv[1], testCase.Name) == 0)
+      test = &testCase;
+  }
+  if (!test) {
+    printf("No GPU test named %s\n", argc > 1 ? argv[1] : "");
+    return 1;
+  }
+
+  AppSpec spec;
+  spec.Name = "OxylusGPUTests";
+  spec.WorkingDirectory = OX_GPU_TESTS_WORKING_DIRECTORY;
+  spec.CommandLineArgs = {argc, argv};
+  spec.UseImGui = false;
+
+  const auto app = new OxylusGPUTests(spec);
+  const auto layer = test->Create();
+  app->PushLayer(layer);
+  app->InitSystems();
+  app->Run();
+  const bool passed = layer->Passed();
+  delete app;
+
+  printf("%s %s\n", passed ? "[ OK ]" : "[FAIL]", test->Name);
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+#include <Core/Application.h>
+#include <Core/Entity.h>
+#include <Core/Resources.h>
+#include <Render/Vulkan/VulkanImage.h>
+#include <Scene/Scene.h>
+#include <Thread/JobSystem.h>
+#include <Utils/Log.h>
+
+#include "GPUTest.h"
+
+namespace Oxylus {
+  /// Measures the frame times of a small scene while textures are loaded in the middle of it, once the way uploads
+  /// used to work, read and waited for on the render thread, and once streamed: read on the job system and uploaded
+  /// without frames waiting for them. Logs the median and the longest frame of every phase.
+  class StreamedLoadFrameTimesLayer : public GPUTest::TestLayer {
+  public:
+    static constexpr uint32_t WarmupFrames = 30; // Pipelines are created and the first uploads finish
+    static constexpr uint32_t PhaseFrames = 120;
+    static constexpr uint32_t TextureCount = 32; // Copies of the same file, a level's worth of textures
+
+    StreamedLoadFrameTimesLayer() : TestLayer("Streamed Load Frame Times Layer") { }
+
+    void OnAttach(EventDispatcher& dispatcher) override {
+      m_Scene = CreateRef<Scene>();
+      m_Scene->CreateEntity("Camera").AddComponentI<CameraComponent>().System->Update(Vec3(0.0f), Vec3(0.0f));
+      const auto cube = CreateRef<Mesh>(Resources::GetResourcesPath("Objects/cube.glb"));
+      for (int32_t x = -2; x <= 2; x++) {
+        for (int32_t z = -2; z <= 2; z++) {
+          Entity entity = m_Scene->CreateEntity("Cube");
+          entity.GetComponent<TransformComponent>().Translation = Vec3((float)x * 3.0f, 0.0f, (float)z * 3.0f - 12.0f);
+          entity.AddComponentI<MeshRendererComponent>(cube);
+          entity.GetComponent<MaterialComponent>().Materials = cube->GetMaterialsAsRef();
+        }
+      }
+      m_Scene->OnRuntimeStart();
+
+      VulkanImageDescription description;
+      description.Path = Resources::GetResourcesPath("HDRs/belfast_sunset.ktx2");
+      m_Texture.Create(description);
+    }
+
+    void OnUpdate(const Timestep deltaTime) override {
+      // The time passed is the one of the previous frame, so it goes to the phase that frame was in
+      if (m_Frame++ >= WarmupFrames)
+        m_FrameTimes[m_Phase].emplace_back(deltaTime.GetMilliseconds());
+      m_Scene->OnRuntimeUpdate(deltaTime);
+
+      if (m_Phase == Streamed)
+        UpdateStreamedLoad();
+      if (m_FrameTimes[m_Phase].size() < PhaseFrames || (m_Phase == Streamed && !m_StreamedLoadDone))
+        return;
+
+      if (m_Phase == Idle) {
+        m_Phase = Blocking;
+        LoadBlocking();
+      }
+      else if (m_Phase == Blocking) {
+        m_Phase = Streamed;
+        for (uint32_t i = 0; i < TextureCount; i++)
+          m_Loads.emplace_back(JobSystem::ExecuteAsync([path = m_Texture.GetDesc().Path] { return ReadMips(path); }));
+      }
+      else {
+        Report();
+        // Layers are deleted after the device, and no frame used the texture
+        m_Texture.Destroy();
+        m_Passed = true;
+        Application::Get()->Close();
+      }
+    }
+
+  private:
+    enum Phase { Idle, Blocking, Streamed, PhaseCount };
+    static constexpr const char* PhaseNames[PhaseCount] = {"Idle", "Blocking load", "Streamed load"};
+
+    Ref<Scene> m_Scene = nullptr;
+    VulkanImage m_Texture;
+    uint32_t m_Frame = 0;
+    Phase m_Phase = Idle;
+    std::vector<float> m_FrameTimes[PhaseCount];
+    std::vector<std::future<VulkanImage::KtxMips>> m_Loads;
+    std::vector<VulkanImage> m_Staged;
+    UploadManager::Ticket m_LastUpload = 0;
+    bool m_StreamedLoadDone = false;
+
+    static VulkanImage::KtxMips ReadMips(const std::string& path) {
+      VulkanImage::KtxMips mips;
+      if (!VulkanImage::ReadKtxMips(path, 0, UINT32_MAX, mips))
+        mips = {};
+      return mips;
+    }
+
+    /// Like uploads through SubmitOnce, every texture is read, uploaded and waited for within one frame.
+    void LoadBlocking() {
+      for (uint32_t i = 0; i < TextureCount; i++) {
+        const auto mips = ReadMips(m_Texture.GetDesc().Path);
+        if (!mips.Data.empty())
+          m_Staged.emplace_back(m_Texture.StageStreamedMips(mips, m_LastUpload));
+      }
+      UploadManager::Get()->Wait(m_LastUpload);
+      // No frame used them
+      for (const auto& staged : m_Staged)
+        staged.Destroy();
+      m_Staged.clear();
+    }
+
+    /// Like the TextureStreamer, read textures are uploaded on the render thread and frames don't wait for them.
+    void UpdateStreamedLoad() {
+      std::erase_if(m_Loads,
+        [this](std::future<VulkanImage::KtxMips>& load) {
+          if (load.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+          const auto mips = load.get();
+          if (!mips.Data.empty())
+            m_Staged.emplace_back(m_Texture.StageStreamedMips(mips, m_LastUpload));
+          return true;
+        });
+      UploadManager::Get()->Flush();
+      if (!m_Loads.empty() || !UploadManager::Get()->IsComplete(m_LastUpload))
+        return;
+
+      for (const auto& staged : m_Staged)
+        staged.Destroy();
+      m_Staged.clear();
+      m_StreamedLoadDone = true;
+    }
+
+    void Report() {
+      for (uint32_t phase = 0; phase < PhaseCount; phase++) {
+        auto frameTimes = m_FrameTimes[phase];
+        std::sort(frameTimes.begin(), frameTimes.end());
+        OX_CORE_INFO("{}: {} frames, median {:.2f} ms, longest {:.2f} ms",
+          PhaseNames[phase],
+          frameTimes.size(),
+          frameTimes[frameTimes.size() / 2],
+          frameTimes.back());
+      }
+    }
+  };
+
+  OX_GPU_TEST(StreamedLoadFrameTimes);
+}
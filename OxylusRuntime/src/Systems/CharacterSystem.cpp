@@ -1,6 +1,7 @@
 ﻿#include "CharacterSystem.h"
 
 #include "Core/Components.h"
+#include "Physics/ContactEvent.h"
 #include "Scene/Scene.h"
 #include "UI/IGUI.h"
 
@@ -159,34 +160,29 @@ namespace OxylusRuntime {
     }
   }
 
-  void CharacterSystem::OnContactAdded(Scene* scene, const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, const JPH::ContactSettings& settings) {
+  void CharacterSystem::OnContactAdded(Scene* scene, const ContactEvent& contact) {
     auto& registery = scene->m_Registry;
-    const auto characterView = registery.view<TransformComponent, CharacterControllerComponent>();
-    const auto rbView = registery.view<TagComponent, TransformComponent, RigidbodyComponent>();
-
-    for (const auto rbEntity : rbView) {
-      auto&& [tag, rbTransform, rb] = rbView.get<TagComponent, TransformComponent, RigidbodyComponent>(rbEntity);
-
-      const auto& id = ((JPH::Body*)rb.RuntimeBody)->GetID();
+    if (!registery.valid(contact.Entity1) || !registery.all_of<TagComponent, TransformComponent, RigidbodyComponent>(contact.Entity1))
+      return;
 
-      if (!body1.IsSensor() || id != body1.GetID()) {
-        continue;
-      }
+    auto&& [tag, rbTransform, rb] = registery.get<TagComponent, TransformComponent, RigidbodyComponent>(contact.Entity1);
+    if (!rb.IsSensor)
+      return;
 
-      if (tag.Tag == "BouncePad") {
-        for (const auto chEntity : characterView) {
-          auto&& [chTransform, ch] = characterView.get<TransformComponent, CharacterControllerComponent>(chEntity);
-          if (body2.GetID() == ch.Character->GetBodyID()) {
-            ch.Character->SetLinearVelocity(JPH::Vec3{0.0f, 12.0f, 0.0f}, false);
-          }
+    const auto characterView = registery.view<TransformComponent, CharacterControllerComponent>();
+    if (tag.Tag == "BouncePad") {
+      for (const auto chEntity : characterView) {
+        auto&& [chTransform, ch] = characterView.get<TransformComponent, CharacterControllerComponent>(chEntity);
+        if (contact.Body2 == ch.Character->GetBodyID()) {
+          ch.Character->SetLinearVelocity(JPH::Vec3{0.0f, 12.0f, 0.0f}, false);
         }
       }
-      else if (tag.Tag == "AccelPad") {
-        for (const auto chEntity : characterView) {
-          auto&& [chTransform, ch] = characterView.get<TransformComponent, CharacterControllerComponent>(chEntity);
-          if (body2.GetID() == ch.Character->GetBodyID()) {
-            ch.Character->SetLinearVelocity(JPH::Vec3(rb.Translation.x, rb.Translation.y, rb.Translation.z) * 30, false);
-          }
+    }
+    else if (tag.Tag == "AccelPad") {
+      for (const auto chEntity : characterView) {
+        auto&& [chTransform, ch] = characterView.get<TransformComponent, CharacterControllerComponent>(chEntity);
+        if (contact.Body2 == ch.Character->GetBodyID()) {
+          ch.Character->SetLinearVelocity(JPH::Vec3(rbTransform.Translation.x, rbTransform.Translation.y, rbTransform.Translation.z) * 30, false);
         }
       }
     }
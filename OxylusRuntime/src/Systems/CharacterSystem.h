@@ -10,7 +10,7 @@ namespace OxylusRuntime {
     void OnInit() override;
     void OnUpdate(Oxylus::Scene* scene, Oxylus::Timestep deltaTime) override;
     void OnImGuiRender(Oxylus::Scene* scene, Oxylus::Timestep deltaTime) override;
-    void OnContactAdded(Oxylus::Scene* scene, const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, const JPH::ContactSettings& settings) override;
+    void OnContactAdded(Oxylus::Scene* scene, const Oxylus::ContactEvent& contact) override;
 
   private:
     struct MovementArgs {
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Test.h"
+#include "Assets/AssetManager.h"
+#include "Render/Vulkan/VulkanImage.h"
+
+namespace Oxylus {
+  // Images are registered without GPU resources, only their size counts against the budget
+  static constexpr size_t ImageSize = 1024;
+
+  static Ref<VulkanImage> CreateImage() {
+    auto image = CreateRef<VulkanImage>();
+    image->ImageSize = ImageSize;
+    return image;
+  }
+
+  static uint32_t GetThreadCount() {
+    return std::max(4u, std::thread::hardware_concurrency());
+  }
+
+  OX_TEST(AssetManager, EvictsLeastRecentlyUsedFirst) {
+    AssetManager::FreeUnusedAssets();
+    const size_t budget = AssetManager::GetMemoryBudget(AssetType::Image);
+    AssetManager::SetMemoryBudget(AssetType::Image, 3 * ImageSize);
+
+    AssetManager::AddImageAsset(CreateImage(), "lru/a");
+    AssetManager::AddImageAsset(CreateImage(), "lru/b");
+    AssetManager::AddImageAsset(CreateImage(), "lru/c");
+    AssetManager::FindImageAsset("lru/a");
+    AssetManager::AddImageAsset(CreateImage(), "lru/d");
+    OX_CHECK(AssetManager::GetMemoryUsage(AssetType::Image) == 4 * ImageSize);
+
+    AssetManager::Update();
+    OX_CHECK(AssetManager::GetMemoryUsage(AssetType::Image) == 3 * ImageSize);
+    OX_CHECK(!AssetManager::FindImageAsset("lru/b"));
+    OX_CHECK(AssetManager::FindImageAsset("lru/a"));
+    OX_CHECK(AssetManager::FindImageAsset("lru/c"));
+    OX_CHECK(AssetManager::FindImageAsset("lru/d"));
+
+    {
+      // Referenced assets stay even when they are over budget
+      const auto held = AssetManager::FindImageAsset("lru/c");
+      AssetManager::SetMemoryBudget(AssetType::Image, 0);
+      AssetManager::Update();
+      OX_CHECK(AssetManager::GetMemoryUsage(AssetType::Image) == ImageSize);
+      OX_CHECK(AssetManager::FindImageAsset("lru/c").Data == held.Data);
+      OX_CHECK(AssetManager::GetImageAsset(held.Handle).Data == held.Data);
+      OX_CHECK(!AssetManager::FindImageAsset("lru/a"));
+      OX_CHECK(!AssetManager::FindImageAsset("lru/d"));
+    }
+
+    AssetManager::SetMemoryBudget(AssetType::Image, budget);
+    AssetManager::FreeUnusedAssets();
+    OX_CHECK(AssetManager::GetMemoryUsage(AssetType::Image) == 0);
+  }
+
+  OX_TEST(AssetManager, ConcurrentLookupsAgree) {
+    constexpr uint32_t pathCount = 256;
+    const uint32_t threadCount = GetThreadCount();
+    AssetManager::FreeUnusedAssets();
+
+    // Every thread looks up every path, starting at a different one, and registers the ones that are missing
+    std::vector<std::vector<Ref<VulkanImage>>> found(threadCount, std::vector<Ref<VulkanImage>>(pathCount));
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 0; thread < threadCount; thread++) {
+      threads.emplace_back([thread, &found] {
+        for (uint32_t i = 0; i < pathCount; i++) {
+          const uint32_t index = (i * 7 + thread * 31) % pathCount;
+          const std::string path = "concurrent/" + std::to_string(index);
+          auto asset = AssetManager::FindImageAsset(path);
+          if (!asset)
+            asset = AssetManager::AddImageAsset(CreateImage(), path);
+          OX_CHECK(AssetManager::GetImageAsset(asset.Handle).Data == asset.Data);
+          found[thread][index] = asset.Data;
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    for (uint32_t index = 0; index < pathCount; index++) {
+      bool same = found[0][index] != nullptr;
+      for (uint32_t thread = 1; thread < threadCount; thread++)
+        same &= found[thread][index] == found[0][index];
+      OX_CHECK(same);
+    }
+    OX_CHECK(AssetManager::GetMemoryUsage(AssetType::Image) == pathCount * ImageSize);
+
+    found.clear();
+    AssetManager::FreeUnusedAssets();
+    OX_CHECK(AssetManager::GetMemoryUsage(AssetType::Image) == 0);
+  }
+
+  OX_TEST(AssetManager, EvictionDuringConcurrentLookups) {
+    constexpr uint32_t pathCount = 512;
+    constexpr uint32_t lookupsPerThread = 4000;
+    constexpr uint32_t heldPerThread = 8;
+    const uint32_t threadCount = GetThreadCount();
+    AssetManager::FreeUnusedAssets();
+    const size_t budget = AssetManager::GetMemoryBudget(AssetType::Image);
+    AssetManager::SetMemoryBudget(AssetType::Image, 32 * ImageSize);
+
+    // Threads keep a few assets referenced while the main thread evicts, those must never go away
+    std::atomic<uint32_t> finished = 0;
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 0; thread < threadCount; thread++) {
+      threads.emplace_back([thread, &finished] {
+        std::mt19937 random(thread);
+        std::vector<Asset<VulkanImage>> held(heldPerThread);
+        for (uint32_t i = 0; i < lookupsPerThread; i++) {
+          const std::string path = "eviction/" + std::to_string(random() % pathCount);
+          auto asset = AssetManager::FindImageAsset(path);
+          if (!asset)
+            asset = AssetManager::AddImageAsset(CreateImage(), path);
+          held[i % heldPerThread] = asset;
+
+          const auto& check = held[random() % heldPerThread];
+          if (check)
+            OX_CHECK(AssetManager::FindImageAsset(check.Path).Data == check.Data);
+        }
+        finished++;
+      });
+    }
+    while (finished < threadCount) {
+      AssetManager::Update();
+      std::this_thread::yield();
+    }
+    for (auto& thread : threads)
+      thread.join();
+
+    // Nothing is referenced anymore
+    AssetManager::Update();
+    OX_CHECK(AssetManager::GetMemoryUsage(AssetType::Image) <= 32 * ImageSize);
+
+    AssetManager::SetMemoryBudget(AssetType::Image, budget);
+    AssetManager::FreeUnusedAssets();
+    OX_CHECK(AssetManager::GetMemoryUsage(AssetType::Image) == 0);
+  }
+}
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "Test.h"
+#include "Physics/ContactEvent.h"
+
+namespace Oxylus {
+  using Phase = ContactEvent::Phase;
+
+  /// The penetration depth tells the events apart, it stands in for the manifold.
+  static ContactEvent CreateEvent(const Phase phase, const uint32_t body1, const uint32_t body2, const float depth = 0.0f, const uint32_t subShape = 0) {
+    ContactEvent event;
+    event.Type = phase;
+    event.Body1 = JPH::BodyID(body1);
+    event.Body2 = JPH::BodyID(body2);
+    event.SubShape1.SetValue(subShape);
+    event.PenetrationDepth = depth;
+    return event;
+  }
+
+  static std::vector<Phase> GetPhases(const std::vector<ContactEvent>& events) {
+    std::vector<Phase> phases;
+    for (const auto& event : events)
+      phases.emplace_back(event.Type);
+    return phases;
+  }
+
+  OX_TEST(ContactEvents, AddedThenRemovedKeepsBoth) {
+    std::vector<ContactEvent> events = {CreateEvent(Phase::Added, 1, 2, 1.0f), CreateEvent(Phase::Removed, 1, 2)};
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Added, Phase::Removed}));
+    OX_CHECK(!events.empty() && events[0].PenetrationDepth == 1.0f);
+  }
+
+  OX_TEST(ContactEvents, RemovedThenAddedPersists) {
+    std::vector<ContactEvent> events = {CreateEvent(Phase::Removed, 1, 2), CreateEvent(Phase::Added, 1, 2, 2.0f)};
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Persisted}));
+    OX_CHECK(!events.empty() && events[0].PenetrationDepth == 2.0f);
+  }
+
+  OX_TEST(ContactEvents, SeveralStepsInOneFrame) {
+    // Every step reports each contact once, the latest manifold is kept
+    std::vector<ContactEvent> events = {CreateEvent(Phase::Added, 1, 2, 1.0f), CreateEvent(Phase::Persisted, 1, 2, 2.0f), CreateEvent(Phase::Persisted, 1, 2, 3.0f)};
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Added}));
+    OX_CHECK(!events.empty() && events[0].PenetrationDepth == 3.0f);
+
+    events = {CreateEvent(Phase::Persisted, 1, 2, 1.0f), CreateEvent(Phase::Persisted, 1, 2, 2.0f), CreateEvent(Phase::Removed, 1, 2)};
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Removed}));
+
+    events = {CreateEvent(Phase::Persisted, 1, 2, 1.0f), CreateEvent(Phase::Persisted, 1, 2, 2.0f), CreateEvent(Phase::Persisted, 1, 2, 3.0f)};
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Persisted}));
+    OX_CHECK(!events.empty() && events[0].PenetrationDepth == 3.0f);
+
+    events = {CreateEvent(Phase::Added, 1, 2, 1.0f), CreateEvent(Phase::Removed, 1, 2), CreateEvent(Phase::Added, 1, 2, 3.0f)};
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Added}));
+    OX_CHECK(!events.empty() && events[0].PenetrationDepth == 3.0f);
+
+    events = {CreateEvent(Phase::Removed, 1, 2), CreateEvent(Phase::Added, 1, 2, 2.0f), CreateEvent(Phase::Removed, 1, 2)};
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Removed}));
+  }
+
+  OX_TEST(ContactEvents, SubShapesAreSeparateContacts) {
+    std::vector<ContactEvent> events = {CreateEvent(Phase::Added, 1, 2, 1.0f, 0), CreateEvent(Phase::Removed, 1, 2, 0.0f, 1)};
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Added, Phase::Removed}));
+    OX_CHECK(events.size() == 2 && events[0].SubShape1.GetValue() == 0 && events[1].SubShape1.GetValue() == 1);
+  }
+
+  OX_TEST(ContactEvents, GroupedByPhase) {
+    std::vector<ContactEvent> events = {
+      CreateEvent(Phase::Removed, 5, 6),
+      CreateEvent(Phase::Persisted, 3, 4),
+      CreateEvent(Phase::Added, 1, 2),
+      CreateEvent(Phase::Added, 7, 8),
+      CreateEvent(Phase::Removed, 1, 2),
+    };
+    ReduceContactEvents(events);
+    OX_CHECK(GetPhases(events) == std::vector({Phase::Added, Phase::Added, Phase::Persisted, Phase::Removed, Phase::Removed}));
+  }
+
+  OX_TEST(ContactEvents, ThousandsOfContactsOverManySteps) {
+    constexpr uint32_t contactCount = 5000;
+    constexpr uint32_t stepCount = 4;
+    std::mt19937 random(11);
+
+    // Random touching states over the steps, every step reports its events in an order of its own
+    std::vector<uint8_t> initial(contactCount);
+    std::vector<uint8_t> touching(contactCount);
+    std::vector<uint8_t> reported(contactCount, 0);
+    std::vector<float> lastDepth(contactCount, 0.0f);
+    for (uint32_t contact = 0; contact < contactCount; contact++)
+      initial[contact] = touching[contact] = random() % 2;
+
+    std::vector<ContactEvent> events;
+    for (uint32_t step = 0; step < stepCount; step++) {
+      std::vector<ContactEvent> stepEvents;
+      for (uint32_t contact = 0; contact < contactCount; contact++) {
+        const bool wasTouching = touching[contact];
+        const bool isTouching = random() % 2;
+        touching[contact] = isTouching;
+        if (!wasTouching && !isTouching)
+          continue;
+        const Phase phase = !wasTouching ? Phase::Added : isTouching ? Phase::Persisted : Phase::Removed;
+        const float depth = (float)(step + 1);
+        stepEvents.emplace_back(CreateEvent(phase, contact, contactCount + contact, depth));
+        reported[contact] = 1;
+        if (isTouching)
+          lastDepth[contact] = depth;
+      }
+      std::shuffle(stepEvents.begin(), stepEvents.end(), random);
+      events.insert(events.end(), stepEvents.begin(), stepEvents.end());
+    }
+
+    ReduceContactEvents(events);
+
+    bool grouped = true;
+    for (size_t i = 1; i < events.size(); i++)
+      grouped &= events[i - 1].Type <= events[i].Type;
+    OX_CHECK(grouped);
+
+    std::unordered_map<uint32_t, std::vector<const ContactEvent*>> byContact;
+    for (const auto& event : events)
+      byContact[event.Body1.GetIndex()].emplace_back(&event);
+
+    uint32_t mismatches = 0;
+    for (uint32_t contact = 0; contact < contactCount; contact++) {
+      std::vector<Phase> expected;
+      if (touching[contact])
+        expected = {initial[contact] ? Phase::Persisted : Phase::Added};
+      else if (initial[contact])
+        expected = {Phase::Removed};
+      else if (reported[contact])
+        expected = {Phase::Added, Phase::Removed};
+
+      const auto it = byContact.find(contact);
+      std::vector<Phase> phases;
+      if (it != byContact.end()) {
+        for (const ContactEvent* event : it->second)
+          phases.emplace_back(event->Type);
+      }
+      if (phases != expected)
+        mismatches++;
+      else if (touching[contact] && it->second[0]->PenetrationDepth != lastDepth[contact])
+        mismatches++;
+    }
+    OX_CHECK(mismatches == 0);
+  }
+}
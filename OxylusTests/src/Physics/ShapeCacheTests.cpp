@@ -0,0 +1,130 @@
+#include <vector>
+
+#include "Test.h"
+#include "Physics/ShapeCache.h"
+
+#include "Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h"
+
+namespace Oxylus {
+  /// Shapes are created without a physics system, Jolt only needs its allocator for them.
+  static void ResetCache() {
+    JPH::RegisterDefaultAllocator();
+    ShapeCache::Clear();
+  }
+
+  static ColliderDescription CreateBox() {
+    ColliderDescription collider;
+    collider.ShapeType = ColliderDescription::Type::Box;
+    collider.Dimensions = Vec3(0.5f, 1.0f, 2.0f);
+    return collider;
+  }
+
+  static const JPH::PhysicsMaterial* GetMaterial(const JPH::RefConst<JPH::Shape>& shape) {
+    return shape->GetMaterial(JPH::SubShapeID());
+  }
+
+  OX_TEST(ShapeCache, IdenticalCollidersShareShapeAndMaterial) {
+    ResetCache();
+    const ColliderDescription a = CreateBox();
+    const ColliderDescription b = CreateBox();
+    const auto shapeA = ShapeCache::GetShape(&a, 1);
+    const auto shapeB = ShapeCache::GetShape(&b, 1);
+
+    OX_CHECK(shapeA != nullptr);
+    OX_CHECK(shapeA == shapeB);
+    OX_CHECK(ShapeCache::GetShapeCount() == 1);
+    OX_CHECK(ShapeCache::GetMaterialCount() == 1);
+    OX_CHECK(GetMaterial(shapeA) == ShapeCache::GetMaterial(a.Friction, a.Restitution).GetPtr());
+
+    // A sphere with the same surface uses the same material
+    ColliderDescription sphere = CreateBox();
+    sphere.ShapeType = ColliderDescription::Type::Sphere;
+    const auto sphereShape = ShapeCache::GetShape(&sphere, 1);
+    OX_CHECK(sphereShape != shapeA);
+    OX_CHECK(GetMaterial(sphereShape) == GetMaterial(shapeA));
+    OX_CHECK(ShapeCache::GetMaterialCount() == 1);
+    ResetCache();
+  }
+
+  OX_TEST(ShapeCache, EveryKeyFieldSeparatesShapes) {
+    ResetCache();
+    const ColliderDescription base = CreateBox();
+    const auto baseShape = ShapeCache::GetShape(&base, 1);
+
+    std::vector<ColliderDescription> variants(9, base);
+    variants[0].ShapeType = ColliderDescription::Type::Cylinder;
+    variants[1].Dimensions.x = 0.6f;
+    variants[2].Dimensions.y = 1.1f;
+    variants[3].Dimensions.z = 2.1f;
+    variants[4].Offset.x = 1.0f;
+    variants[5].Offset.z = -1.0f;
+    variants[6].Density = 2.0f;
+    variants[7].Friction = 0.8f;
+    variants[8].Restitution = 0.3f;
+
+    std::vector<JPH::RefConst<JPH::Shape>> shapes;
+    for (const ColliderDescription& variant : variants) {
+      const auto shape = ShapeCache::GetShape(&variant, 1);
+      OX_CHECK(shape != nullptr && shape != baseShape);
+      for (const auto& other : shapes)
+        OX_CHECK(shape != other);
+      shapes.emplace_back(shape);
+    }
+
+    // Only the surface fields get materials of their own
+    OX_CHECK(GetMaterial(shapes[6]) == GetMaterial(baseShape));
+    OX_CHECK(GetMaterial(shapes[7]) != GetMaterial(baseShape));
+    OX_CHECK(GetMaterial(shapes[8]) != GetMaterial(baseShape));
+    OX_CHECK(GetMaterial(shapes[7]) != GetMaterial(shapes[8]));
+    OX_CHECK(ShapeCache::GetMaterialCount() == 3);
+
+    // Offset colliders translate the shared centered shape
+    for (const uint32_t offset : {4u, 5u}) {
+      const auto* translated = static_cast<const JPH::RotatedTranslatedShape*>(shapes[offset].GetPtr());
+      OX_CHECK(shapes[offset]->GetSubType() == JPH::EShapeSubType::RotatedTranslated);
+      OX_CHECK(translated->GetInnerShape() == baseShape.GetPtr());
+    }
+    ResetCache();
+  }
+
+  OX_TEST(ShapeCache, NegativeZeroIsZero) {
+    ResetCache();
+    const ColliderDescription a = CreateBox();
+    ColliderDescription b = CreateBox();
+    b.Offset = Vec3(-0.0f, 0.0f, -0.0f);
+    b.Restitution = -0.0f;
+    OX_CHECK(ShapeCache::GetShape(&a, 1) == ShapeCache::GetShape(&b, 1));
+    OX_CHECK(ShapeCache::GetShapeCount() == 1);
+    OX_CHECK(ShapeCache::GetMaterialCount() == 1);
+    ResetCache();
+  }
+
+  OX_TEST(ShapeCache, CompoundsShareTheirColliders) {
+    ResetCache();
+    std::vector<ColliderDescription> colliders(2, CreateBox());
+    colliders[0].Offset = Vec3(0.0f, 1.0f, 0.0f);
+    colliders[1].ShapeType = ColliderDescription::Type::Sphere;
+    colliders[1].Offset = Vec3(0.0f, -1.0f, 0.0f);
+    const std::vector<ColliderDescription> copy = colliders;
+
+    const auto compound = ShapeCache::GetShape(colliders.data(), 2);
+    OX_CHECK(compound != nullptr);
+    OX_CHECK(compound == ShapeCache::GetShape(copy.data(), 2));
+    // The compound and its two centered colliders
+    OX_CHECK(ShapeCache::GetShapeCount() == 3);
+
+    const ColliderDescription box = CreateBox();
+    OX_CHECK(ShapeCache::GetShape(&box, 1) != compound);
+    OX_CHECK(ShapeCache::GetShapeCount() == 3);
+
+    // Shared shapes only count once
+    const uint64_t memory = ShapeCache::GetShapeMemory();
+    ShapeCache::GetShape(&colliders[0], 1);
+    OX_CHECK(ShapeCache::GetShapeCount() == 4);
+    OX_CHECK(ShapeCache::GetShapeMemory() - memory == sizeof(JPH::RotatedTranslatedShape));
+
+    ShapeCache::Clear();
+    OX_CHECK(ShapeCache::GetShapeCount() == 0);
+    OX_CHECK(ShapeCache::GetMaterialCount() == 0);
+  }
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "Test.h"
+#include "Render/MeshletBuilder.h"
+
+namespace Oxylus {
+  struct Vertex {
+    Vec3 Position;
+    Vec2 UV;
+  };
+
+  /// Grid of quads in the XY plane facing +Z, vertices are interleaved like the ones of a mesh.
+  static void BuildGrid(const uint32_t size, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    const auto base = (uint32_t)vertices.size();
+    for (uint32_t y = 0; y <= size; y++) {
+      for (uint32_t x = 0; x <= size; x++)
+        vertices.push_back({Vec3((float)x, (float)y, 0.0f), Vec2((float)x, (float)y) / (float)size});
+    }
+    for (uint32_t y = 0; y < size; y++) {
+      for (uint32_t x = 0; x < size; x++) {
+        const uint32_t v = base + y * (size + 1) + x;
+        indices.insert(indices.end(), {v, v + 1, v + size + 2, v, v + size + 2, v + size + 1});
+      }
+    }
+  }
+
+  static std::vector<std::array<uint32_t, 3>> SortedTriangles(const uint32_t* indices, const uint32_t count) {
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t i = 0; i + 2 < count; i += 3)
+      triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+  }
+
+  OX_TEST(MeshletBuilder, RespectsVertexAndTriangleLimits) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    BuildGrid(40, vertices, indices);
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build(&vertices[0].Position, sizeof(Vertex), indices.data(), 0, (uint32_t)indices.size(), meshlets);
+
+    OX_CHECK(meshlets.size() > 1);
+    uint32_t next = 0;
+    for (const Meshlet& meshlet : meshlets) {
+      OX_CHECK(meshlet.FirstIndex == next);
+      OX_CHECK(meshlet.IndexCount % 3 == 0);
+      OX_CHECK(meshlet.IndexCount > 0 && meshlet.IndexCount / 3 <= MeshletBuilder::MaxTriangles);
+      const std::unordered_set<uint32_t> unique(indices.begin() + meshlet.FirstIndex, indices.begin() + meshlet.FirstIndex + meshlet.IndexCount);
+      OX_CHECK(unique.size() <= MeshletBuilder::MaxVertices);
+      next += meshlet.IndexCount;
+    }
+    OX_CHECK(next == indices.size());
+  }
+
+  OX_TEST(MeshletBuilder, ReordersWholeTrianglesOfTheRangeOnly) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    BuildGrid(4, vertices, indices);
+    const auto firstIndex = (uint32_t)indices.size();
+    BuildGrid(30, vertices, indices);
+    const auto indexCount = (uint32_t)indices.size() - firstIndex;
+    BuildGrid(4, vertices, indices);
+    const std::vector<uint32_t> original = indices;
+
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build(&vertices[0].Position, sizeof(Vertex), indices.data(), firstIndex, indexCount, meshlets);
+
+    OX_CHECK(std::equal(indices.begin(), indices.begin() + firstIndex, original.begin()));
+    OX_CHECK(std::equal(indices.begin() + firstIndex + indexCount, indices.end(), original.begin() + firstIndex + indexCount));
+    OX_CHECK(SortedTriangles(indices.data() + firstIndex, indexCount) == SortedTriangles(original.data() + firstIndex, indexCount));
+    OX_CHECK(!meshlets.empty() && meshlets.front().FirstIndex == firstIndex);
+    OX_CHECK(!meshlets.empty() && meshlets.back().FirstIndex + meshlets.back().IndexCount == firstIndex + indexCount);
+  }
+
+  OX_TEST(MeshletBuilder, IsDeterministic) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    BuildGrid(50, vertices, indices);
+    // Shuffled so the builder doesn't just get the grid in order
+    std::vector<std::array<uint32_t, 3>> triangles = SortedTriangles(indices.data(), (uint32_t)indices.size());
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(3));
+    for (size_t i = 0; i < triangles.size(); i++)
+      std::copy(triangles[i].begin(), triangles[i].end(), indices.begin() + i * 3);
+
+    std::vector<uint32_t> first = indices;
+    std::vector<uint32_t> second = indices;
+    std::vector<Meshlet> firstMeshlets;
+    std::vector<Meshlet> secondMeshlets;
+    MeshletBuilder::Build(&vertices[0].Position, sizeof(Vertex), first.data(), 0, (uint32_t)first.size(), firstMeshlets);
+    MeshletBuilder::Build(&vertices[0].Position, sizeof(Vertex), second.data(), 0, (uint32_t)second.size(), secondMeshlets);
+
+    OX_CHECK(first == second);
+    OX_CHECK(firstMeshlets.size() == secondMeshlets.size());
+    for (size_t i = 0; i < std::min(firstMeshlets.size(), secondMeshlets.size()); i++) {
+      OX_CHECK(firstMeshlets[i].FirstIndex == secondMeshlets[i].FirstIndex);
+      OX_CHECK(firstMeshlets[i].IndexCount == secondMeshlets[i].IndexCount);
+      OX_CHECK(firstMeshlets[i].Center == secondMeshlets[i].Center);
+      OX_CHECK(firstMeshlets[i].ConeAxis == secondMeshlets[i].ConeAxis);
+      OX_CHECK(firstMeshlets[i].ConeCutoff == secondMeshlets[i].ConeCutoff);
+    }
+  }
+
+  OX_TEST(MeshletBuilder, FlatMeshletsFaceTheirNormal) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    BuildGrid(4, vertices, indices);
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build(&vertices[0].Position, sizeof(Vertex), indices.data(), 0, (uint32_t)indices.size(), meshlets);
+
+    OX_CHECK(meshlets.size() == 1);
+    const Meshlet& meshlet = meshlets.front();
+    OX_CHECK(glm::distance(meshlet.ConeAxis, Vec3(0.0f, 0.0f, 1.0f)) < 1e-5f);
+    OX_CHECK(std::abs(meshlet.ConeCutoff) < 1e-3f);
+    OX_CHECK(glm::distance(meshlet.Center, Vec3(2.0f, 2.0f, 0.0f)) < 1e-5f);
+    OX_CHECK(std::abs(meshlet.Radius - std::sqrt(8.0f)) < 1e-5f);
+
+    OX_CHECK(MeshletBuilder::IsBackfacing(meshlet, Vec3(2.0f, 2.0f, -10.0f)));
+    OX_CHECK(MeshletBuilder::IsBackfacing(meshlet, Vec3(5.0f, -3.0f, -10.0f)));
+    OX_CHECK(!MeshletBuilder::IsBackfacing(meshlet, Vec3(2.0f, 2.0f, 10.0f)));
+    // Close to the plane parts of the meshlet can still face the viewer
+    OX_CHECK(!MeshletBuilder::IsBackfacing(meshlet, Vec3(2.0f, 2.0f, -1.0f)));
+    OX_CHECK(!MeshletBuilder::IsBackfacing(meshlet, Vec3(100.0f, 2.0f, -1.0f)));
+  }
+
+  OX_TEST(MeshletBuilder, ConeOfTwoSlopedTriangles) {
+    // Normals are (1, 0, 1) and (-1, 0, 1), so the cone's half angle is 45 degrees around +Z
+    const std::vector<Vec3> positions = {{0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, -1.0f}, {-1.0f, 0.0f, -1.0f}};
+    std::vector<uint32_t> indices = {0, 2, 1, 0, 1, 3};
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build(positions.data(), sizeof(Vec3), indices.data(), 0, (uint32_t)indices.size(), meshlets);
+
+    OX_CHECK(meshlets.size() == 1);
+    const Meshlet& meshlet = meshlets.front();
+    OX_CHECK(glm::distance(meshlet.ConeAxis, Vec3(0.0f, 0.0f, 1.0f)) < 1e-5f);
+    OX_CHECK(std::abs(meshlet.ConeCutoff - std::sqrt(0.5f)) < 1e-5f);
+    OX_CHECK(glm::distance(meshlet.Center, Vec3(0.0f, 0.5f, -0.5f)) < 1e-5f);
+
+    // Behind the cone only far enough away for the bounding sphere to fit into it
+    OX_CHECK(MeshletBuilder::IsBackfacing(meshlet, meshlet.Center - Vec3(0.0f, 0.0f, 10.0f)));
+    OX_CHECK(!MeshletBuilder::IsBackfacing(meshlet, meshlet.Center - Vec3(0.0f, 0.0f, 3.0f)));
+    // Outside of the cone, one of the triangles is seen from the front
+    OX_CHECK(!MeshletBuilder::IsBackfacing(meshlet, meshlet.Center + Vec3(-100.0f, 0.0f, -10.0f)));
+  }
+
+  OX_TEST(MeshletBuilder, ClosedMeshletsAreNeverCulled) {
+    // Tetrahedron with outward facing triangles
+    const std::vector<Vec3> positions = {{1.0f, 1.0f, 1.0f}, {1.0f, -1.0f, -1.0f}, {-1.0f, 1.0f, -1.0f}, {-1.0f, -1.0f, 1.0f}};
+    std::vector<uint32_t> indices = {0, 1, 2, 0, 3, 1, 0, 2, 3, 1, 3, 2};
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build(positions.data(), sizeof(Vec3), indices.data(), 0, (uint32_t)indices.size(), meshlets);
+
+    OX_CHECK(meshlets.size() == 1);
+    OX_CHECK(meshlets.front().ConeCutoff == 1.0f);
+    for (const Vec3& view : {Vec3(10.0f, 0.0f, 0.0f), Vec3(0.0f, -10.0f, 0.0f), Vec3(0.0f, 0.0f, 100.0f)})
+      OX_CHECK(!MeshletBuilder::IsBackfacing(meshlets.front(), view));
+  }
+
+  OX_TEST(MeshletBuilder, DegenerateTrianglesAreNeverCulled) {
+    const std::vector<Vec3> positions = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}};
+    std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 0};
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build(positions.data(), sizeof(Vec3), indices.data(), 0, (uint32_t)indices.size(), meshlets);
+
+    OX_CHECK(meshlets.size() == 1);
+    OX_CHECK(meshlets.front().ConeCutoff == 1.0f);
+    OX_CHECK(!MeshletBuilder::IsBackfacing(meshlets.front(), Vec3(1.0f, 0.0f, -10.0f)));
+  }
+
+  OX_TEST(MeshletBuilder, EmptyRangeBuildsNothing) {
+    const std::vector<Vec3> positions = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}};
+    std::vector<uint32_t> indices = {0, 1};
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build(positions.data(), sizeof(Vec3), indices.data(), 0, (uint32_t)indices.size(), meshlets);
+    OX_CHECK(meshlets.empty());
+    OX_CHECK(indices == std::vector<uint32_t>({0, 1}));
+  }
+}
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Test.h"
+#include "Render/RangeAllocator.h"
+
+namespace Oxylus {
+  OX_TEST(RangeAllocator, AllocatesFromTheStart) {
+    RangeAllocator allocator(100);
+    OX_CHECK(allocator.Allocate(10) == 0);
+    OX_CHECK(allocator.Allocate(20) == 10);
+    OX_CHECK(allocator.Allocate(0) == 0);
+    OX_CHECK(allocator.GetFreeSize() == 70);
+    OX_CHECK(allocator.GetFreeRangeCount() == 1);
+    OX_CHECK(allocator.Allocate(71) == RangeAllocator::InvalidOffset);
+    OX_CHECK(allocator.Allocate(70) == 30);
+    OX_CHECK(allocator.GetFreeSize() == 0);
+    OX_CHECK(allocator.Allocate(1) == RangeAllocator::InvalidOffset);
+  }
+
+  OX_TEST(RangeAllocator, PicksTheSmallestRangeThatFits) {
+    RangeAllocator allocator(100);
+    // Once freed there are ranges of 10 at 0, 5 at 20 and 30 at 40 next to the free 20 at the end
+    const uint32_t a = allocator.Allocate(10);
+    allocator.Allocate(10);
+    const uint32_t b = allocator.Allocate(5);
+    allocator.Allocate(15);
+    const uint32_t c = allocator.Allocate(30);
+    allocator.Allocate(10);
+    OX_CHECK(allocator.GetFreeSize() == 20);
+    allocator.Free(a, 10);
+    allocator.Free(b, 5);
+    allocator.Free(c, 30);
+    OX_CHECK(allocator.GetFreeRangeCount() == 4);
+
+    OX_CHECK(allocator.Allocate(4) == 20);
+    OX_CHECK(allocator.Allocate(6) == 0);
+    OX_CHECK(allocator.Allocate(20) == 80); // Exact fit at the end wins over the larger range before it
+    OX_CHECK(allocator.Allocate(12) == 40);
+    OX_CHECK(allocator.GetFreeSize() == 4 + 1 + 18);
+  }
+
+  OX_TEST(RangeAllocator, FreeMergesWithBothNeighbours) {
+    RangeAllocator allocator(30);
+    const uint32_t a = allocator.Allocate(10);
+    const uint32_t b = allocator.Allocate(10);
+    const uint32_t c = allocator.Allocate(10);
+
+    allocator.Free(a, 10);
+    allocator.Free(c, 10);
+    OX_CHECK(allocator.GetFreeRangeCount() == 2);
+    OX_CHECK(allocator.GetLargestFreeRange() == 10);
+
+    allocator.Free(b, 10);
+    OX_CHECK(allocator.GetFreeRangeCount() == 1);
+    OX_CHECK(allocator.GetLargestFreeRange() == 30);
+    OX_CHECK(allocator.Allocate(30) == 0);
+  }
+
+  OX_TEST(RangeAllocator, FreeMergesWithOneNeighbour) {
+    RangeAllocator allocator(40);
+    const uint32_t a = allocator.Allocate(10);
+    const uint32_t b = allocator.Allocate(10);
+    const uint32_t c = allocator.Allocate(10);
+
+    allocator.Free(b, 10); // Merges with nothing, c is still allocated
+    OX_CHECK(allocator.GetFreeRangeCount() == 2);
+    allocator.Free(a, 10); // Merges with the next one
+    OX_CHECK(allocator.GetFreeRangeCount() == 2);
+    OX_CHECK(allocator.GetLargestFreeRange() == 20);
+    allocator.Free(c, 10); // Merges with the previous and the tail
+    OX_CHECK(allocator.GetFreeRangeCount() == 1);
+    OX_CHECK(allocator.GetFreeSize() == 40);
+  }
+
+  OX_TEST(RangeAllocator, GrowKeepsAllocations) {
+    RangeAllocator allocator(10);
+    OX_CHECK(allocator.Allocate(10) == 0);
+    OX_CHECK(allocator.Allocate(5) == RangeAllocator::InvalidOffset);
+
+    allocator.Grow(30);
+    OX_CHECK(allocator.GetCapacity() == 30);
+    OX_CHECK(allocator.GetFreeSize() == 20);
+    OX_CHECK(allocator.Allocate(5) == 10);
+
+    // The new tail merges with a free range ending at the old capacity
+    allocator.Free(10, 5);
+    allocator.Grow(40);
+    OX_CHECK(allocator.GetFreeRangeCount() == 1);
+    OX_CHECK(allocator.GetLargestFreeRange() == 30);
+
+    // Shrinking is ignored
+    allocator.Grow(20);
+    OX_CHECK(allocator.GetCapacity() == 40);
+    OX_CHECK(allocator.GetFreeSize() == 30);
+  }
+
+  OX_TEST(RangeAllocator, GrowFromEmpty) {
+    RangeAllocator allocator;
+    OX_CHECK(allocator.Allocate(1) == RangeAllocator::InvalidOffset);
+    allocator.Grow(16);
+    OX_CHECK(allocator.Allocate(16) == 0);
+  }
+
+  OX_TEST(RangeAllocator, ResetDropsEverything) {
+    RangeAllocator allocator(64);
+    allocator.Allocate(10);
+    allocator.Allocate(20);
+    allocator.Free(0, 10);
+
+    allocator.Reset(32);
+    OX_CHECK(allocator.GetCapacity() == 32);
+    OX_CHECK(allocator.GetFreeSize() == 32);
+    OX_CHECK(allocator.GetFreeRangeCount() == 1);
+    OX_CHECK(allocator.Allocate(32) == 0);
+
+    allocator.Reset(0);
+    OX_CHECK(allocator.GetFreeRangeCount() == 0);
+    OX_CHECK(allocator.Allocate(1) == RangeAllocator::InvalidOffset);
+  }
+
+  OX_TEST(RangeAllocator, FragmentedSpaceCanNotFitLargeRanges) {
+    RangeAllocator allocator(100);
+    std::vector<uint32_t> offsets;
+    for (uint32_t i = 0; i < 10; i++)
+      offsets.emplace_back(allocator.Allocate(10));
+    for (uint32_t i = 0; i < 10; i += 2)
+      allocator.Free(offsets[i], 10);
+
+    OX_CHECK(allocator.GetFreeSize() == 50);
+    OX_CHECK(allocator.GetFreeRangeCount() == 5);
+    OX_CHECK(allocator.GetLargestFreeRange() == 10);
+    OX_CHECK(allocator.Allocate(11) == RangeAllocator::InvalidOffset);
+
+    // Freeing the ranges in between merges everything back together
+    for (uint32_t i = 1; i < 10; i += 2)
+      allocator.Free(offsets[i], 10);
+    OX_CHECK(allocator.GetFreeRangeCount() == 1);
+    OX_CHECK(allocator.Allocate(100) == 0);
+  }
+
+  OX_TEST(RangeAllocator, RandomAllocationsNeverOverlap) {
+    constexpr uint32_t capacity = 1 << 16;
+    RangeAllocator allocator(capacity);
+    std::vector<std::pair<uint32_t, uint32_t>> allocations;
+    std::mt19937 random(7);
+    for (uint32_t step = 0; step < 20000; step++) {
+      if (!allocations.empty() && random() % 3 == 0) {
+        const size_t index = random() % allocations.size();
+        allocator.Free(allocations[index].first, allocations[index].second);
+        allocations[index] = allocations.back();
+        allocations.pop_back();
+        continue;
+      }
+      const uint32_t size = 1 + random() % 512;
+      const uint32_t offset = allocator.Allocate(size);
+      if (offset != RangeAllocator::InvalidOffset)
+        allocations.emplace_back(offset, size);
+    }
+
+    std::sort(allocations.begin(), allocations.end());
+    uint32_t used = 0;
+    bool overlaps = false;
+    for (size_t i = 0; i < allocations.size(); i++) {
+      used += allocations[i].second;
+      if (i + 1 < allocations.size() && allocations[i].first + allocations[i].second > allocations[i + 1].first)
+        overlaps = true;
+    }
+    OX_CHECK(!overlaps);
+    OX_CHECK(allocations.empty() || allocations.back().first + allocations.back().second <= capacity);
+    OX_CHECK(allocator.GetFreeSize() == capacity - used);
+
+    for (const auto& [offset, size] : allocations)
+      allocator.Free(offset, size);
+    OX_CHECK(allocator.GetFreeRangeCount() == 1);
+    OX_CHECK(allocator.GetFreeSize() == capacity);
+  }
+}
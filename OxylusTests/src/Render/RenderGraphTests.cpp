@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+
+#include "Test.h"
+#include "Render/RenderGraph.h"
+
+namespace Oxylus {
+  // Schedule() only looks at the addresses of resources and queues, none of them is ever created on a device
+  static vk::Queue s_GraphicsQueue;
+  static vk::Queue s_ComputeQueue;
+
+  static RenderGraphPass CreatePass(const std::string& name, vk::Queue* queue = &s_GraphicsQueue) {
+    return RenderGraphPass(name, nullptr, {}, [](VulkanCommandBuffer&, int32_t) { }, {}, queue);
+  }
+
+  OX_TEST(RenderGraph, GroupsPassesByQueue) {
+    VulkanImage x, y, z, output;
+    RenderGraph graph;
+    CreatePass("A").Write(x).AddToGraph(graph);
+    CreatePass("B", &s_ComputeQueue).Write(y).AddToGraphCompute(graph);
+    CreatePass("C").Read(x).Write(z).AddToGraph(graph);
+    CreatePass("D").Read(y).Read(z).Write(output).AddToGraph(graph);
+    graph.SetOutput(output);
+    graph.Schedule();
+
+    // C moves in front of B so A and C share a submit
+    OX_CHECK(graph.GetSchedule() == std::vector<std::string>({"A", "C", "B", "D"}));
+    OX_CHECK(graph.GetSubmitCount() == 3);
+    OX_CHECK(graph.GetCulledPassCount() == 0);
+  }
+
+  OX_TEST(RenderGraph, ReadsWaitForTheirWriters) {
+    VulkanImage x, y, output;
+    RenderGraph graph;
+    CreatePass("Write", &s_ComputeQueue).Write(x).AddToGraphCompute(graph);
+    CreatePass("Blur", &s_ComputeQueue).Read(x).Write(y).AddToGraphCompute(graph);
+    CreatePass("Overwrite", &s_ComputeQueue).Write(x).AddToGraphCompute(graph);
+    CreatePass("Composite").Read(x).Read(y).Write(output).AddToGraph(graph);
+    graph.SetOutput(output);
+    graph.Schedule();
+
+    OX_CHECK(graph.GetSchedule() == std::vector<std::string>({"Write", "Blur", "Overwrite", "Composite"}));
+    OX_CHECK(graph.GetSubmitCount() == 2);
+  }
+
+  OX_TEST(RenderGraph, CullsPassesNotReachingTheOutput) {
+    VulkanImage unused, debug, chain, chainResult, output;
+    RenderGraph graph;
+    CreatePass("Unused").Write(unused).AddToGraph(graph);
+    CreatePass("Main").Write(output).AddToGraph(graph);
+    CreatePass("Debug").Write(debug).SetHasSideEffects().AddToGraph(graph);
+    CreatePass("NoResources").AddToGraph(graph);
+    CreatePass("ChainStart", &s_ComputeQueue).Write(chain).AddToGraphCompute(graph);
+    CreatePass("ChainEnd", &s_ComputeQueue).Read(chain).Write(chainResult).AddToGraphCompute(graph);
+    graph.SetOutput(output);
+    graph.Schedule();
+
+    OX_CHECK(graph.GetSchedule() == std::vector<std::string>({"Main", "Debug", "NoResources"}));
+    OX_CHECK(graph.GetCulledPassCount() == 3);
+    OX_CHECK(graph.GetSubmitCount() == 1);
+  }
+
+  OX_TEST(RenderGraph, KeepsEveryPassWithoutOutput) {
+    VulkanImage unused, output;
+    RenderGraph graph;
+    CreatePass("Unused").Write(unused).AddToGraph(graph);
+    CreatePass("Main").Write(output).AddToGraph(graph);
+    graph.Schedule();
+
+    OX_CHECK(graph.GetSchedule() == std::vector<std::string>({"Unused", "Main"}));
+    OX_CHECK(graph.GetCulledPassCount() == 0);
+  }
+
+  OX_TEST(RenderGraph, ReadDependenciesOrderPasses) {
+    VulkanImage a, b, c;
+    RenderGraph graph;
+    CreatePass("A").Write(a).AddToGraph(graph);
+    CreatePass("B", &s_ComputeQueue).Write(b).AddToGraphCompute(graph);
+    CreatePass("C").Write(c).AddReadDependency(graph, "B").AddToGraph(graph);
+    graph.Schedule();
+
+    // Without the dependency C would join A's submit
+    OX_CHECK(graph.GetSchedule() == std::vector<std::string>({"A", "B", "C"}));
+    OX_CHECK(graph.GetSubmitCount() == 3);
+  }
+
+  OX_TEST(RenderGraph, RescheduleStartsOver) {
+    VulkanImage x, y, output;
+    RenderGraph graph;
+    CreatePass("A").Write(x).AddToGraph(graph);
+    CreatePass("B", &s_ComputeQueue).Read(x).Write(y).AddToGraphCompute(graph);
+    CreatePass("C").Read(y).Write(output).AddToGraph(graph);
+    graph.SetOutput(output);
+    graph.Schedule();
+    graph.Schedule();
+    OX_CHECK(graph.GetSchedule() == std::vector<std::string>({"A", "B", "C"}));
+    OX_CHECK(graph.GetSubmitCount() == 3);
+
+    graph.RemoveRenderPass("B");
+    graph.Schedule();
+    // Nothing writes y anymore, so A only feeds a removed pass
+    OX_CHECK(graph.GetSchedule() == std::vector<std::string>({"C"}));
+    OX_CHECK(graph.GetCulledPassCount() == 1);
+    OX_CHECK(graph.GetSubmitCount() == 1);
+  }
+}
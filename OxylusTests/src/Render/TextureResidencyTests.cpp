@@ -0,0 +1,191 @@
+#include <cstddef>
+#include <vector>
+
+#include "Test.h"
+#include "Render/TextureResidency.h"
+
+namespace Oxylus {
+  // Chains are 85 and 340 bytes, both have mip 2 resident from the start
+  static const std::vector<uint64_t> SmallLevels = {64, 16, 4, 1};
+  static const std::vector<uint64_t> LargeLevels = {256, 64, 16, 4};
+
+  static bool HasChanges(const std::vector<TextureResidency::Change>& changes, const std::vector<TextureResidency::Change>& expected) {
+    if (changes.size() != expected.size())
+      return false;
+    for (size_t i = 0; i < changes.size(); i++) {
+      if (changes[i].Texture != expected[i].Texture || changes[i].FirstMip != expected[i].FirstMip)
+        return false;
+    }
+    return true;
+  }
+
+  /// Requests the mip and applies the change right away.
+  static void Load(TextureResidency& residency, const TextureResidency::Handle handle, const uint32_t mip) {
+    residency.Request(handle, mip);
+    for (const auto& change : residency.Update(UINT32_MAX))
+      residency.SetResident(change.Texture, change.FirstMip);
+  }
+
+  OX_TEST(TextureResidency, RequestsLoadMips) {
+    TextureResidency residency;
+    const auto texture = residency.Add(SmallLevels, 2);
+    OX_CHECK(residency.GetResidentMip(texture) == 2);
+    OX_CHECK(residency.GetResidentSize() == 5);
+
+    residency.Request(texture, 1);
+    residency.Request(texture, 0);
+    residency.Request(texture, 3);
+    OX_CHECK(HasChanges(residency.Update(4), {{texture, 0}}));
+    // No new change while one is in progress
+    residency.Request(texture, 0);
+    OX_CHECK(residency.Update(4).empty());
+
+    residency.SetResident(texture, 0);
+    OX_CHECK(residency.GetResidentMip(texture) == 0);
+    OX_CHECK(residency.GetResidentSize() == 85);
+    residency.Request(texture, 0);
+    OX_CHECK(residency.Update(4).empty());
+  }
+
+  OX_TEST(TextureResidency, AbandonedChangesAreRetried) {
+    TextureResidency residency;
+    const auto texture = residency.Add(SmallLevels, 2);
+    residency.Request(texture, 0);
+    OX_CHECK(HasChanges(residency.Update(4), {{texture, 0}}));
+
+    residency.SetResident(texture, 2);
+    residency.Request(texture, 0);
+    OX_CHECK(HasChanges(residency.Update(4), {{texture, 0}}));
+  }
+
+  OX_TEST(TextureResidency, BaseMipIsNeverDropped) {
+    TextureResidency residency;
+    const auto texture = residency.Add(SmallLevels, 2);
+    residency.SetBudget(0);
+    residency.Request(texture, 0);
+    OX_CHECK(residency.Update(4).empty());
+    OX_CHECK(residency.GetTargetMip(texture) == 2);
+    OX_CHECK(residency.GetResidentSize() == 5);
+  }
+
+  OX_TEST(TextureResidency, RequestsExpireAfterTheirLifetime) {
+    TextureResidency residency;
+    const auto texture = residency.Add(SmallLevels, 2);
+    Load(residency, texture, 0);
+    OX_CHECK(residency.GetResidentMip(texture) == 0);
+
+    for (uint64_t frame = 0; frame < TextureResidency::RequestLifetime; frame++)
+      OX_CHECK(residency.Update(4).empty());
+    OX_CHECK(residency.GetTargetMip(texture) == 0);
+
+    OX_CHECK(HasChanges(residency.Update(4), {{texture, 2}}));
+    residency.SetResident(texture, 2);
+    OX_CHECK(residency.GetResidentSize() == 5);
+  }
+
+  OX_TEST(TextureResidency, BudgetDropsLeastRecentlyRequestedFirst) {
+    TextureResidency residency;
+    const auto a = residency.Add(SmallLevels, 2);
+    const auto b = residency.Add(SmallLevels, 2);
+    residency.Request(a, 0);
+    Load(residency, b, 0);
+    residency.Request(a, 0);
+    OX_CHECK(residency.Update(4).empty());
+    OX_CHECK(residency.GetResidentSize() == 170);
+
+    // Room for everything but one level 0
+    residency.SetBudget(170 - 64);
+    residency.Request(a, 0);
+    OX_CHECK(HasChanges(residency.Update(4), {{b, 1}}));
+    OX_CHECK(residency.GetTargetMip(a) == 0);
+  }
+
+  OX_TEST(TextureResidency, BudgetDropsLargestLevelAmongEquallyRecent) {
+    TextureResidency residency;
+    const auto small = residency.Add(SmallLevels, 2);
+    const auto large = residency.Add(LargeLevels, 2);
+    residency.Request(small, 0);
+    Load(residency, large, 0);
+    OX_CHECK(residency.GetResidentSize() == 425);
+
+    residency.SetBudget(425 - 64);
+    residency.Request(small, 0);
+    residency.Request(large, 0);
+    OX_CHECK(HasChanges(residency.Update(4), {{large, 1}}));
+
+    // After the 256 bytes level is gone the small texture's level 0 is the largest one left
+    residency.SetResident(large, 1);
+    residency.SetBudget(169 - 64);
+    residency.Request(small, 0);
+    residency.Request(large, 0);
+    OX_CHECK(HasChanges(residency.Update(4), {{small, 1}}));
+  }
+
+  OX_TEST(TextureResidency, DropsComeBeforeLoads) {
+    TextureResidency residency;
+    const auto loaded = residency.Add(SmallLevels, 2);
+    const auto expired = residency.Add(SmallLevels, 2);
+    Load(residency, expired, 0);
+    for (uint64_t frame = 0; frame < TextureResidency::RequestLifetime; frame++)
+      residency.Update(4);
+
+    residency.Request(loaded, 0);
+    const auto changes = residency.Update(4);
+    OX_CHECK(HasChanges(changes, {{expired, 2}, {loaded, 0}}));
+  }
+
+  OX_TEST(TextureResidency, LoadsWaitForDropsToFreeTheBudget) {
+    TextureResidency residency;
+    const auto old = residency.Add(SmallLevels, 2);
+    const auto loaded = residency.Add(SmallLevels, 2);
+    Load(residency, old, 0);
+
+    residency.SetBudget(85 + 21);
+    residency.Request(loaded, 0);
+    OX_CHECK(HasChanges(residency.Update(4), {{old, 1}}));
+    residency.Request(loaded, 0);
+    OX_CHECK(residency.Update(4).empty());
+
+    residency.SetResident(old, 1);
+    residency.Request(loaded, 0);
+    OX_CHECK(HasChanges(residency.Update(4), {{loaded, 0}}));
+  }
+
+  OX_TEST(TextureResidency, MaxChangesLimitsEveryUpdate) {
+    TextureResidency residency;
+    std::vector<TextureResidency::Handle> textures;
+    for (uint32_t i = 0; i < 5; i++)
+      textures.emplace_back(residency.Add(SmallLevels, 2));
+
+    // Textures missing the most mips come first
+    const auto request = [&residency, &textures] {
+      for (uint32_t i = 0; i < 5; i++)
+        residency.Request(textures[i], i == 3 ? 0 : 1);
+    };
+    request();
+    const auto first = residency.Update(2);
+    OX_CHECK(first.size() == 2);
+    OX_CHECK(!first.empty() && first[0].Texture == textures[3] && first[0].FirstMip == 0);
+
+    request();
+    OX_CHECK(residency.Update(2).size() == 2);
+    request();
+    OX_CHECK(residency.Update(2).size() == 1);
+    request();
+    OX_CHECK(residency.Update(2).empty());
+    OX_CHECK(residency.Update(0).empty());
+  }
+
+  OX_TEST(TextureResidency, RemovedHandlesAreReused) {
+    TextureResidency residency;
+    const auto a = residency.Add(LargeLevels, 1);
+    Load(residency, a, 0);
+    residency.Remove(a);
+    OX_CHECK(residency.GetResidentSize() == 0);
+
+    const auto b = residency.Add(SmallLevels, 3);
+    OX_CHECK(b == a);
+    OX_CHECK(residency.GetResidentMip(b) == 3);
+    OX_CHECK(residency.GetResidentSize() == 1);
+  }
+}
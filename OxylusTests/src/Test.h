@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Oxylus::Test {
+  struct TestCase {
+    const char* Suite;
+    const char* Name;
+    void (*Function)();
+  };
+
+  /// Every test registered with OX_TEST, in the order of their static initialization.
+  std::vector<TestCase>& GetTests();
+  /// Marks the running test as failed, it keeps running so every failed check gets reported.
+  void Fail(const char* file, int line, const char* expression);
+
+  struct Registrar {
+    Registrar(const char* suite, const char* name, void (*function)()) { GetTests().push_back({suite, name, function}); }
+  };
+}
+
+#define OX_TEST(suite, name)                                                                              \
+  static void suite##_##name();                                                                           \
+  static ::Oxylus::Test::Registrar suite##_##name##_Registrar(#suite, #name, suite##_##name);             \
+  static void suite##_##name()
+
+#define OX_CHECK(check)                                                                                   \
+  do {                                                                                                    \
+    if (!(check))                                                                                         \
+      ::Oxylus::Test::Fail(__FILE__, __LINE__, #check);                                                   \
+  } while (false)
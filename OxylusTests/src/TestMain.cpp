@@ -0,0 +1,47 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#include "Test.h"
+#include "Utils/Log.h"
+
+namespace Oxylus::Test {
+  static std::atomic<uint32_t> s_Failures = 0; // Checks may fail on any thread
+
+  std::vector<TestCase>& GetTests() {
+    static std::vector<TestCase> tests;
+    return tests;
+  }
+
+  void Fail(const char* file, const int line, const char* expression) {
+    std::printf("  %s:%d: check failed: %s\n", file, line, expression);
+    s_Failures++;
+  }
+}
+
+/// Runs every test, or only the ones of the suite passed as the first argument.
+int main(const int argc, char** argv) {
+  using namespace Oxylus;
+  Log::Init();
+
+  const char* suite = argc > 1 ? argv[1] : nullptr;
+  uint32_t run = 0;
+  uint32_t failed = 0;
+  for (const Test::TestCase& test : Test::GetTests()) {
+    if (suite && std::strcmp(suite, test.Suite) != 0)
+      continue;
+    const uint32_t failures = Test::s_Failures;
+    test.Function();
+    run++;
+    if (Test::s_Failures != failures)
+      failed++;
+    std::printf("[%s] %s.%s\n", Test::s_Failures != failures ? "FAIL" : " OK ", test.Suite, test.Name);
+  }
+
+  if (!run) {
+    std::printf("No tests in suite %s\n", suite ? suite : "");
+    return 1;
+  }
+  std::printf("%u of %u tests passed\n", run - failed, run);
+  return failed ? 1 : 0;
+}